@@ -0,0 +1,301 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkautotune_ggo.h"
+#include "rtkGgoFunctions.h"
+#include "rtkConfiguration.h"
+
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkDrawSheppLoganFilter.h"
+#include "rtkFDKConeBeamReconstructionFilter.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkTuningProfile.h"
+
+#include <itkStreamingImageFilter.h>
+#include <itkImageRegionSplitterDirection.h>
+#include <itkTimeProbe.h>
+#if ITK_VERSION_MAJOR<5
+  #include <itkMultiThreader.h>
+#else
+  #include <itkMultiThreaderBase.h>
+#endif
+
+#include <algorithm>
+#include <sstream>
+
+int main(int argc, char * argv[])
+{
+  GGO(rtkautotune, args_info);
+
+  using OutputPixelType = float;
+  constexpr unsigned int Dimension = 3;
+  using OutputImageType = itk::Image< OutputPixelType, Dimension >;
+
+  const unsigned int dimension = std::max(args_info.dimension_arg, 8);
+  const unsigned int nproj = std::max(args_info.nproj_arg, 1);
+  const unsigned int ntrials = std::max(args_info.trials_arg, 1);
+
+  // Synthetic problem: Shepp-Logan phantom covering the field of view of a
+  // circular geometry with a magnification of 1.5
+  const double fov = 256.;
+  rtk::ThreeDCircularProjectionGeometry::Pointer geometry = rtk::ThreeDCircularProjectionGeometry::New();
+  for(unsigned int i=0; i<nproj; i++)
+    geometry->AddProjection(1000., 1500., i*360./nproj);
+
+  using ConstantImageSourceType = rtk::ConstantImageSource< OutputImageType >;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SpacingType spacing;
+  ConstantImageSourceType::SizeType size;
+  size.Fill(dimension);
+  size[2] = nproj;
+  spacing.Fill(1.5*fov/dimension);
+  origin.Fill(-0.5*spacing[0]*(dimension-1));
+  origin[2] = 0.;
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+
+  using SLPType = rtk::SheppLoganPhantomFilter<OutputImageType, OutputImageType>;
+  SLPType::Pointer slp = SLPType::New();
+  slp->SetInput( projectionsSource->GetOutput() );
+  slp->SetGeometry( geometry );
+  slp->SetPhantomScale( 0.5*fov );
+  if(args_info.verbose_flag)
+    std::cout << "Projecting the Shepp-Logan phantom..." << std::flush;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() )
+  OutputImageType::Pointer projections = slp->GetOutput();
+  projections->DisconnectPipeline();
+  if(args_info.verbose_flag)
+    std::cout << " done." << std::endl;
+
+  ConstantImageSourceType::Pointer volumeSource = ConstantImageSourceType::New();
+  size.Fill(dimension);
+  spacing.Fill(fov/dimension);
+  origin.Fill(-0.5*spacing[0]*(dimension-1));
+  volumeSource->SetOrigin( origin );
+  volumeSource->SetSpacing( spacing );
+  volumeSource->SetSize( size );
+  volumeSource->SetConstant( 0. );
+
+  // Shepp-Logan phantom in the volume for the forward projections
+  using DSLType = rtk::DrawSheppLoganFilter<OutputImageType, OutputImageType>;
+  DSLType::Pointer dsl = DSLType::New();
+  dsl->SetInput( volumeSource->GetOutput() );
+  dsl->SetPhantomScale( 0.5*fov );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() )
+  OutputImageType::Pointer volume = dsl->GetOutput();
+  volume->DisconnectPipeline();
+
+  // Fastest of ntrials FDK reconstructions with the given parameters. A new
+  // pipeline is created for each run so that nothing is reused.
+  using FDKType = rtk::FDKConeBeamReconstructionFilter< OutputImageType >;
+  using StreamerType = itk::StreamingImageFilter<OutputImageType, OutputImageType>;
+  auto timeFDK = [&](unsigned int subsetSize, int greatestPrimeFactor, unsigned int divisions)
+    {
+    double fastest = itk::NumericTraits<double>::max();
+    for(unsigned int t=0; t<ntrials; t++)
+      {
+      FDKType::Pointer feldkamp = FDKType::New();
+      feldkamp->SetInput( 0, volumeSource->GetOutput() );
+      feldkamp->SetInput( 1, projections );
+      feldkamp->SetGeometry( geometry );
+      feldkamp->SetProjectionSubsetSize( subsetSize );
+      feldkamp->GetRampFilter()->SetGreatestPrimeFactor( greatestPrimeFactor );
+
+      StreamerType::Pointer streamer = StreamerType::New();
+      streamer->SetInput( feldkamp->GetOutput() );
+      streamer->SetNumberOfStreamDivisions( divisions );
+      itk::ImageRegionSplitterDirection::Pointer splitter = itk::ImageRegionSplitterDirection::New();
+      splitter->SetDirection(2);
+      streamer->SetRegionSplitter(splitter);
+
+      itk::TimeProbe probe;
+      probe.Start();
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( streamer->Update() )
+      probe.Stop();
+      fastest = std::min(fastest, probe.GetTotal());
+      }
+    if(args_info.verbose_flag)
+      std::cout << "  subset size " << subsetSize
+                << ", greatest prime factor " << greatestPrimeFactor
+                << ", " << divisions << " stream division(s): "
+                << fastest << " s" << std::endl;
+    return fastest;
+    };
+
+  // Fastest of ntrials Joseph forward projections of the phantom. The bricked
+  // copy of the volume is made by a first projection and reused by the timed
+  // ones, as in iterative reconstructions.
+  using JosephType = rtk::JosephForwardProjectionImageFilter< OutputImageType, OutputImageType >;
+  auto timeJoseph = [&](unsigned int tileSize, unsigned int brickSize)
+    {
+    JosephType::Pointer joseph = JosephType::New();
+    joseph->InPlaceOff();
+    joseph->SetInput( 0, projectionsSource->GetOutput() );
+    joseph->SetInput( 1, volume );
+    joseph->SetGeometry( geometry );
+    joseph->SetTileSize( tileSize );
+    joseph->SetBrickSize( brickSize );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( joseph->Update() )
+
+    double fastest = itk::NumericTraits<double>::max();
+    for(unsigned int t=0; t<ntrials; t++)
+      {
+      joseph->Modified();
+      itk::TimeProbe probe;
+      probe.Start();
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( joseph->Update() )
+      probe.Stop();
+      fastest = std::min(fastest, probe.GetTotal());
+      }
+    if(args_info.verbose_flag)
+      std::cout << "  tile size " << tileSize
+                << ", brick size " << brickSize << ": "
+                << fastest << " s" << std::endl;
+    return fastest;
+    };
+
+  // Default values of the filters
+  unsigned int bestSubsetSize = 16;
+  int bestGreatestPrimeFactor = 2;
+  unsigned int bestDivisions = 1;
+  double bestTime = itk::NumericTraits<double>::max();
+
+  // The greatest prime factor of the FFT sizes of the ramp filter, only
+  // relevant with FFTW. The padded sizes depend on the number of pixels of
+  // the projections.
+#if defined(USE_FFTWF)
+  std::vector<int> greatestPrimeFactors = {2, 3, 5, 7, 11, 13};
+#else
+  std::vector<int> greatestPrimeFactors(1, 2);
+#endif
+  if(args_info.verbose_flag)
+    std::cout << "Timing FDK reconstructions of " << dimension << "^3 voxels from "
+              << nproj << " projections..." << std::endl;
+  for(int gpf : greatestPrimeFactors)
+    {
+    const double t = timeFDK(bestSubsetSize, gpf, bestDivisions);
+    if(t < bestTime)
+      {
+      bestTime = t;
+      bestGreatestPrimeFactor = gpf;
+      }
+    }
+
+  // Number of projections filtered and backprojected at a time
+  bestTime = itk::NumericTraits<double>::max();
+  for(unsigned int subsetSize=1; subsetSize<2*nproj && subsetSize<=256; subsetSize*=2)
+    {
+    const double t = timeFDK(subsetSize, bestGreatestPrimeFactor, bestDivisions);
+    if(t < bestTime)
+      {
+      bestTime = t;
+      bestSubsetSize = subsetSize;
+      }
+    }
+
+  // Number of stream divisions of the volume, i.e., of slabs reconstructed
+  // one after the other
+  bestTime = itk::NumericTraits<double>::max();
+  for(unsigned int divisions=1; divisions<=8 && divisions<=dimension; divisions*=2)
+    {
+    const double t = timeFDK(bestSubsetSize, bestGreatestPrimeFactor, divisions);
+    if(t < bestTime)
+      {
+      bestTime = t;
+      bestDivisions = divisions;
+      }
+    }
+
+  // Size of the detector tiles and of the bricks of the volume of the Joseph
+  // forward projector, 0 is the default ITK split and no bricks
+  unsigned int bestTileSize = 0;
+  unsigned int bestBrickSize = 0;
+  if(args_info.verbose_flag)
+    std::cout << "Timing Joseph forward projections of " << dimension << "^3 voxels to "
+              << nproj << " projections..." << std::endl;
+  bestTime = itk::NumericTraits<double>::max();
+  for(unsigned int tileSize : {0, 16, 32, 64})
+    {
+    const double t = timeJoseph(tileSize, bestBrickSize);
+    if(t < bestTime)
+      {
+      bestTime = t;
+      bestTileSize = tileSize;
+      }
+    }
+  for(unsigned int brickSize : {8, 16, 32})
+    {
+    const double t = timeJoseph(bestTileSize, brickSize);
+    if(t < bestTime)
+      {
+      bestTime = t;
+      bestBrickSize = brickSize;
+      }
+    }
+
+  // Number of threads, powers of 2 up to the default of ITK which is the
+  // number of cores of the machine. The sum of the FDK and Joseph timings
+  // with the best parameters is minimized. The filters are created in the
+  // timing functions, after the change of the global default.
+#if ITK_VERSION_MAJOR<5
+  using MultiThreaderType = itk::MultiThreader;
+#else
+  using MultiThreaderType = itk::MultiThreaderBase;
+#endif
+  const itk::ThreadIdType defaultThreads = MultiThreaderType::GetGlobalDefaultNumberOfThreads();
+  itk::ThreadIdType bestThreads = defaultThreads;
+  bestTime = itk::NumericTraits<double>::max();
+  for(itk::ThreadIdType nThreads=1; nThreads<2*defaultThreads; nThreads*=2)
+    {
+    nThreads = std::min(nThreads, defaultThreads);
+    MultiThreaderType::SetGlobalDefaultNumberOfThreads(nThreads);
+    if(args_info.verbose_flag)
+      std::cout << "Timing with " << nThreads << " thread(s)..." << std::endl;
+    const double t = timeFDK(bestSubsetSize, bestGreatestPrimeFactor, bestDivisions) +
+                     timeJoseph(bestTileSize, bestBrickSize);
+    if(t < bestTime)
+      {
+      bestTime = t;
+      bestThreads = nThreads;
+      }
+    }
+  MultiThreaderType::SetGlobalDefaultNumberOfThreads(defaultThreads);
+
+  rtk::TuningProfile::ParametersType parameters;
+  const std::string fileName = args_info.output_arg;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rtk::TuningProfile::Read(fileName, parameters) )
+  parameters["FDKProjectionSubsetSize"] = bestSubsetSize;
+  if(greatestPrimeFactors.size() > 1)
+    parameters["FFTGreatestPrimeFactor"] = bestGreatestPrimeFactor;
+  parameters["NumberOfStreamDivisions"] = bestDivisions;
+  parameters["JosephTileSize"] = bestTileSize;
+  parameters["JosephBrickSize"] = bestBrickSize;
+  parameters["NumberOfThreads"] = bestThreads;
+
+  std::ostringstream comment;
+  comment << "rtkautotune with " << dimension << "^3 voxels and " << nproj << " projections";
+  if(args_info.verbose_flag)
+    std::cout << "Writing tuning profile " << fileName << "..." << std::endl;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rtk::TuningProfile::Write(fileName, parameters, comment.str()) )
+
+  return EXIT_SUCCESS;
+}
@@ -131,11 +131,21 @@ int main(int argc, char * argv[])
     conjugategradient->SetGamma(args_info.gamma_arg);
   if (args_info.tikhonov_given)
     conjugategradient->SetTikhonov(args_info.tikhonov_arg);
+  conjugategradient->SetNumberOfProjectionsPerBatch(args_info.batch_arg);
 
   conjugategradient->SetGeometry( geometryReader->GetOutputObject() );
   conjugategradient->SetNumberOfIterations( args_info.niterations_arg );
   conjugategradient->SetDisableDisplacedDetectorFilter(args_info.nodisplaced_flag);
 
+  // Coarse full field-of-view volume for region-of-interest reconstruction
+  using BackgroundReaderType = itk::ImageFileReader< OutputImageType >;
+  BackgroundReaderType::Pointer backgroundReader = BackgroundReaderType::New();
+  if(args_info.background_given)
+    {
+    backgroundReader->SetFileName( args_info.background_arg );
+    conjugategradient->SetBackgroundVolume( backgroundReader->GetOutput() );
+    }
+
   TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() )
 
   if(args_info.costs_given)
@@ -31,11 +31,70 @@
 #  include "rtkCudaFDKConeBeamReconstructionFilter.h"
 #endif
 #include "rtkFDKWarpBackProjectionImageFilter.h"
+#include "rtkFDKHierarchicalBackProjectionImageFilter.h"
+#include "rtkFDKPointsBackProjectionImageFilter.h"
 #include "rtkCyclicDeformationImageFilter.h"
+#include "rtkProgressiveFDKConeBeamReconstructionFilter.h"
+#include "rtkTuningProfile.h"
 
 #include <itkStreamingImageFilter.h>
 #include <itkImageRegionSplitterDirection.h>
 #include <itkImageFileWriter.h>
+#include <itksys/SystemTools.hxx>
+
+// Reports and writes the previews of a progressive reconstruction
+template<class TFilter>
+class PreviewCommand : public itk::Command
+{
+public:
+  using Self = PreviewCommand;
+  using Pointer = itk::SmartPointer<Self>;
+  itkNewMacro(Self);
+
+  void SetFileName(const std::string &fileName) { m_FileName = fileName; }
+  void SetVerbose(bool verbose) { m_Verbose = verbose; }
+
+  void Execute(itk::Object *caller, const itk::EventObject &event) override
+    {
+    Execute( (const itk::Object *)caller, event);
+    }
+
+  void Execute(const itk::Object *caller, const itk::EventObject &event) override
+    {
+    if( !itk::IterationEvent().CheckEvent(&event) )
+      return;
+    TFilter *filter = const_cast<TFilter *>( dynamic_cast<const TFilter *>(caller) );
+    if(m_Verbose)
+      std::cout << "Preview " << m_Count << ": level " << filter->GetPreviewLevel()
+                << ", " << 100.*filter->GetPreviewAngularFraction()
+                << "% of the angular weights" << std::endl;
+    if(!m_FileName.empty())
+      {
+      std::ostringstream fileName;
+      std::string path = itksys::SystemTools::GetFilenamePath(m_FileName);
+      if(!path.empty())
+        path += '/';
+      fileName << path
+               << itksys::SystemTools::GetFilenameWithoutLastExtension(m_FileName)
+               << '_' << m_Count
+               << itksys::SystemTools::GetFilenameLastExtension(m_FileName);
+      using WriterType = itk::ImageFileWriter<typename TFilter::OutputImageType>;
+      typename WriterType::Pointer writer = WriterType::New();
+      writer->SetFileName( fileName.str() );
+      writer->SetInput( filter->GetPreview() );
+      writer->Update();
+      }
+    m_Count++;
+    }
+
+protected:
+  PreviewCommand() = default;
+
+private:
+  std::string  m_FileName;
+  bool         m_Verbose{false};
+  unsigned int m_Count{0};
+};
 
 int main(int argc, char * argv[])
 {
@@ -51,6 +110,28 @@ int main(int argc, char * argv[])
   using OutputImageType = CPUOutputImageType;
 #endif
 
+  // Performance parameters measured by rtkautotune, the command line options
+  // have precedence. Other greatest prime factors than 2 are only supported
+  // by FFTW. The number of threads is set before any filter is created.
+  rtk::TuningProfile::ParametersType profile;
+  if(args_info.profile_given)
+    {
+    bool profileRead = false;
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( profileRead = rtk::TuningProfile::Read(args_info.profile_arg, profile) )
+    if(!profileRead)
+      {
+      std::cerr << "Could not read the tuning profile " << args_info.profile_arg << std::endl;
+      return EXIT_FAILURE;
+      }
+    rtk::TuningProfile::SetGlobalNumberOfThreads(profile);
+    }
+  double subsetSize = args_info.subsetsize_arg;
+  if(!args_info.subsetsize_given)
+    rtk::TuningProfile::GetValue(profile, "FDKProjectionSubsetSize", subsetSize);
+  subsetSize = std::max(1., subsetSize);
+  double greatestPrimeFactor = 0.;
+  rtk::TuningProfile::GetValue(profile, "FFTGreatestPrimeFactor", greatestPrimeFactor);
+
   // Projections reader
   using ReaderType = rtk::ProjectionsReader< OutputImageType >;
   ReaderType::Pointer reader = ReaderType::New();
@@ -74,6 +155,16 @@ int main(int argc, char * argv[])
   geometryReader->SetFilename(args_info.geometry_arg);
   TRY_AND_EXIT_ON_ITK_EXCEPTION( geometryReader->GenerateOutputInformation() )
 
+  // Detector distortion
+  if(args_info.distortion_given)
+    {
+    using DistortionReaderType = itk::ImageFileReader<rtk::ThreeDCircularProjectionGeometry::DetectorDisplacementFieldType>;
+    DistortionReaderType::Pointer distortionReader = DistortionReaderType::New();
+    distortionReader->SetFileName( args_info.distortion_arg );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( distortionReader->Update() )
+    geometryReader->GetOutputObject()->SetDetectorDisplacementField( distortionReader->GetOutput() );
+    }
+
   // Check on hardware parameter
 #ifndef RTK_USE_CUDA
   if(!strcmp(args_info.hardware_arg, "cuda") )
@@ -122,6 +213,17 @@ int main(int argc, char * argv[])
   ConstantImageSourceType::Pointer constantImageSource = ConstantImageSourceType::New();
   rtk::SetConstantImageSourceFromGgo<ConstantImageSourceType, args_info_rtkfdk>(constantImageSource, args_info);
 
+  // Physical points at which one reconstructs, stored in their own grid
+  using PointsBPType = rtk::FDKPointsBackProjectionImageFilter<OutputImageType, OutputImageType>;
+  using PointsReaderType = itk::ImageFileReader<PointsBPType::PointsImageType>;
+  PointsReaderType::Pointer pointsReader = PointsReaderType::New();
+  if(args_info.points_given)
+    {
+    pointsReader->SetFileName( args_info.points_arg );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( pointsReader->UpdateOutputInformation() )
+    constantImageSource->SetInformationFromImage( pointsReader->GetOutput() );
+    }
+
   // Motion-compensated objects for the compensation of a cyclic deformation.
   // Although these will only be used if the command line options for motion
   // compensation are set, we still create the object before hand to avoid auto
@@ -148,11 +250,15 @@ int main(int argc, char * argv[])
     f->GetRampFilter()->SetTruncationCorrection(args_info.pad_arg); \
     f->GetRampFilter()->SetHannCutFrequency(args_info.hann_arg); \
     f->GetRampFilter()->SetHannCutFrequencyY(args_info.hannY_arg); \
-    f->SetProjectionSubsetSize(args_info.subsetsize_arg)
+    f->SetProjectionSubsetSize( (unsigned int)subsetSize ); \
+    if(greatestPrimeFactor > 0. && f->GetRampFilter()->GetGreatestPrimeFactor() > 2) \
+      f->GetRampFilter()->SetGreatestPrimeFactor( std::max(2, int(greatestPrimeFactor)) )
 
   // FDK reconstruction filtering
   using FDKCPUType = rtk::FDKConeBeamReconstructionFilter< OutputImageType >;
   FDKCPUType::Pointer feldkamp;
+  using ProgressiveFDKType = rtk::ProgressiveFDKConeBeamReconstructionFilter< OutputImageType >;
+  ProgressiveFDKType::Pointer progressive;
 #ifdef RTK_USE_CUDA
   using FDKCUDAType = rtk::CudaFDKConeBeamReconstructionFilter;
   FDKCUDAType::Pointer feldkampCUDA;
@@ -160,7 +266,14 @@ int main(int argc, char * argv[])
   itk::Image< OutputPixelType, Dimension > *pfeldkamp = nullptr;
   if(!strcmp(args_info.hardware_arg, "cpu") )
     {
-    feldkamp = FDKCPUType::New();
+    // The progressive filter runs its own FDK filter, which is set as usual
+    if(args_info.progressive_given)
+      {
+      progressive = ProgressiveFDKType::New();
+      feldkamp = progressive->GetFDKFilter();
+      }
+    else
+      feldkamp = FDKCPUType::New();
     SET_FELDKAMP_OPTIONS( feldkamp );
 
     // Motion compensated CBCT settings
@@ -170,7 +283,36 @@ int main(int argc, char * argv[])
       def->SetSignalFilename(args_info.signal_arg);
       feldkamp->SetBackProjectionFilter( bp.GetPointer() );
       }
+    else if(args_info.hierarchical_flag)
+      {
+      using HierarchicalBPType = rtk::FDKHierarchicalBackProjectionImageFilter<OutputImageType, OutputImageType>;
+      HierarchicalBPType::Pointer hbp = HierarchicalBPType::New();
+      hbp->SetLeafSize(args_info.leafsize_arg);
+      hbp->SetAngularOversampling(args_info.oversampling_arg);
+      feldkamp->SetBackProjectionFilter( hbp.GetPointer() );
+      }
+    else if(args_info.points_given)
+      {
+      PointsBPType::Pointer pbp = PointsBPType::New();
+      pbp->SetPoints( pointsReader->GetOutput() );
+      feldkamp->SetBackProjectionFilter( pbp.GetPointer() );
+      }
     pfeldkamp = feldkamp->GetOutput();
+
+    if(args_info.progressive_given)
+      {
+      progressive->SetInput( 0, constantImageSource->GetOutput() );
+      progressive->SetInput( 1, pssf->GetOutput() );
+      progressive->SetGeometry( geometryReader->GetOutputObject() );
+      progressive->SetNumberOfLevels( args_info.progressive_arg );
+      using PreviewCommandType = PreviewCommand<ProgressiveFDKType>;
+      PreviewCommandType::Pointer previewCommand = PreviewCommandType::New();
+      previewCommand->SetVerbose( args_info.verbose_flag );
+      if(args_info.preview_given)
+        previewCommand->SetFileName( args_info.preview_arg );
+      progressive->AddObserver( itk::IterationEvent(), previewCommand );
+      pfeldkamp = progressive->GetOutput();
+      }
     }
 #ifdef RTK_USE_CUDA
   else if(!strcmp(args_info.hardware_arg, "cuda") )
@@ -181,6 +323,11 @@ int main(int argc, char * argv[])
       std::cerr << "Motion compensation is not supported in CUDA. Aborting" << std::endl;
       return EXIT_FAILURE;
       }
+    if(args_info.points_given)
+      {
+      std::cerr << "Reconstruction at points is not supported in CUDA. Aborting" << std::endl;
+      return EXIT_FAILURE;
+      }
 
     feldkampCUDA = FDKCUDAType::New();
     SET_FELDKAMP_OPTIONS( feldkampCUDA );
@@ -192,7 +339,12 @@ int main(int argc, char * argv[])
   using StreamerType = itk::StreamingImageFilter<CPUOutputImageType, CPUOutputImageType>;
   StreamerType::Pointer streamerBP = StreamerType::New();
   streamerBP->SetInput( pfeldkamp );
-  streamerBP->SetNumberOfStreamDivisions( args_info.divisions_arg );
+  double divisions = args_info.divisions_arg;
+  if(!args_info.divisions_given)
+    rtk::TuningProfile::GetValue(profile, "NumberOfStreamDivisions", divisions);
+  if(args_info.progressive_given)
+    divisions = 1.; // The progressive reconstruction always computes the whole volume
+  streamerBP->SetNumberOfStreamDivisions( std::max(1, int(divisions)) );
   itk::ImageRegionSplitterDirection::Pointer splitter = itk::ImageRegionSplitterDirection::New();
   splitter->SetDirection(2); // Prevent splitting along z axis. As a result, splitting will be performed along y axis
   streamerBP->SetRegionSplitter(splitter);
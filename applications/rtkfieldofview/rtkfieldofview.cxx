@@ -21,6 +21,7 @@
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
 #include "rtkRayEllipsoidIntersectionImageFilter.h"
 #include "rtkFieldOfViewImageFilter.h"
+#include "rtkConvexFieldOfViewImageFilter.h"
 #include "rtkConstantImageSource.h"
 #include "rtkBackProjectionImageFilter.h"
 #ifdef RTK_USE_CUDA
@@ -77,7 +78,25 @@ int main(int argc, char * argv[])
   ImageReaderType::Pointer unmasked_reconstruction = ImageReaderType::New();
   unmasked_reconstruction->SetFileName(args_info.reconstruction_arg);
 
-  if(!args_info.bp_flag)
+  if(args_info.convex_flag)
+    {
+    using FOVFilterType = rtk::ConvexFieldOfViewImageFilter<OutputImageType, OutputImageType>;
+    FOVFilterType::Pointer fieldofview=FOVFilterType::New();
+    fieldofview->SetMask(args_info.mask_flag);
+    fieldofview->SetInput(0, unmasked_reconstruction->GetOutput());
+    fieldofview->SetProjectionsStack(reader->GetOutput());
+    fieldofview->SetGeometry(geometryReader->GetOutputObject());
+    fieldofview->SetDisplacedDetector(args_info.displaced_flag);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( fieldofview->Update() )
+
+    // Write
+    using WriterType = itk::ImageFileWriter<  OutputImageType >;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( args_info.output_arg );
+    writer->SetInput( fieldofview->GetOutput() );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() )
+    }
+  else if(!args_info.bp_flag)
     {
     // FOV filter
     using FOVFilterType = rtk::FieldOfViewImageFilter<OutputImageType, OutputImageType>;
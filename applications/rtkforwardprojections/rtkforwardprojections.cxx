@@ -22,6 +22,8 @@
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
 #include "rtkJosephForwardProjectionImageFilter.h"
 #include "rtkJosephForwardAttenuatedProjectionImageFilter.h"
+#include "rtkNUFFTForwardProjectionImageFilter.h"
+#include "rtkTuningProfile.h"
 #ifdef RTK_USE_CUDA
 #include "rtkCudaForwardProjectionImageFilter.h"
 #endif
@@ -42,6 +44,28 @@ int main(int argc, char * argv[])
     using OutputImageType = itk::Image< OutputPixelType, Dimension >;
   #endif
 
+  // Performance parameters measured by rtkautotune, the command line options
+  // have precedence. The number of threads is set before any filter is
+  // created.
+  rtk::TuningProfile::ParametersType profile;
+  if(args_info.profile_given)
+    {
+    bool profileRead = false;
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( profileRead = rtk::TuningProfile::Read(args_info.profile_arg, profile) )
+    if(!profileRead)
+      {
+      std::cerr << "Could not read the tuning profile " << args_info.profile_arg << std::endl;
+      return EXIT_FAILURE;
+      }
+    rtk::TuningProfile::SetGlobalNumberOfThreads(profile);
+    }
+  double brickSize = args_info.bricks_arg;
+  if(!args_info.bricks_given)
+    rtk::TuningProfile::GetValue(profile, "JosephBrickSize", brickSize);
+  double tileSize = args_info.tiles_arg;
+  if(!args_info.tiles_given)
+    rtk::TuningProfile::GetValue(profile, "JosephTileSize", tileSize);
+
   // Geometry
   if(args_info.verbose_flag)
     std::cout << "Reading geometry information from "
@@ -52,6 +76,17 @@ int main(int argc, char * argv[])
   geometryReader = rtk::ThreeDCircularProjectionGeometryXMLFileReader::New();
   geometryReader->SetFilename(args_info.geometry_arg);
   TRY_AND_EXIT_ON_ITK_EXCEPTION( geometryReader->GenerateOutputInformation() )
+
+  // Detector distortion
+  if(args_info.distortion_given)
+    {
+    using DistortionReaderType = itk::ImageFileReader<rtk::ThreeDCircularProjectionGeometry::DetectorDisplacementFieldType>;
+    DistortionReaderType::Pointer distortionReader = DistortionReaderType::New();
+    distortionReader->SetFileName( args_info.distortion_arg );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( distortionReader->Update() )
+    geometryReader->GetOutputObject()->SetDetectorDisplacementField( distortionReader->GetOutput() );
+    }
+
   if(args_info.verbose_flag)
     std::cout << " done." << std::endl;
 
@@ -102,11 +137,22 @@ int main(int argc, char * argv[])
   switch(args_info.fp_arg)
   {
   case(fp_arg_Joseph):
-    forwardProjection = rtk::JosephForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
+    {
+    using JosephType = rtk::JosephForwardProjectionImageFilter<OutputImageType, OutputImageType>;
+    JosephType::Pointer joseph = JosephType::New();
+    joseph->SetBrickSize(std::max(0, int(brickSize)));
+    joseph->SetTileSize(std::max(0, int(tileSize)));
+    joseph->SetEmptySpaceCellSize(args_info.emptycells_arg);
+    joseph->SetEmptySpaceThreshold(args_info.emptythreshold_arg);
+    forwardProjection = joseph;
+    }
       break;
   case(fp_arg_JosephAttenuated):
     forwardProjection = rtk::JosephForwardAttenuatedProjectionImageFilter<OutputImageType, OutputImageType>::New();
       break;
+  case(fp_arg_NUFFT):
+    forwardProjection = rtk::NUFFTForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
+      break;
   case(fp_arg_CudaRayCast):
 #ifdef RTK_USE_CUDA
     forwardProjection = rtk::CudaForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
@@ -103,6 +103,20 @@ int main(int argc, char * argv[])
 
   osem->SetNumberOfIterations( args_info.niterations_arg );
   osem->SetNumberOfProjectionsPerSubset( args_info.nprojpersubset_arg );
+  osem->SetBatchSubsets( args_info.batch_flag );
+  osem->SetConcurrentBranches( args_info.concurrent_flag );
+  osem->SetProjectionsCacheMemoryBudget( itk::SizeValueType(args_info.cache_arg) * 1024 * 1024 );
+  if(args_info.store_given)
+    osem->SetProjectionsStoreFileName( args_info.store_arg );
+
+  // Coarse full field-of-view volume for region-of-interest reconstruction
+  using BackgroundReaderType = itk::ImageFileReader< OutputImageType >;
+  BackgroundReaderType::Pointer backgroundReader = BackgroundReaderType::New();
+  if(args_info.background_given)
+    {
+    backgroundReader->SetFileName( args_info.background_arg );
+    osem->SetBackgroundVolume( backgroundReader->GetOutput() );
+    }
 
   // Write
   using WriterType = itk::ImageFileWriter< OutputImageType >;
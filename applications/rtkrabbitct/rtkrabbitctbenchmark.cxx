@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkrabbitctbenchmark_ggo.h"
+#include "rtkGgoFunctions.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSheppLoganPhantomFilter.h"
+
+#include "rabbitct.h"
+
+#include <itkImageFileWriter.h>
+#include <itkImportImageFilter.h>
+#include <itkTimeProbe.h>
+
+FNCSIGN bool RCTLoadAlgorithm(RabbitCtGlobalData* rcgd);
+FNCSIGN bool RCTFinishAlgorithm(RabbitCtGlobalData* rcgd);
+FNCSIGN bool RCTUnloadAlgorithm(RabbitCtGlobalData* rcgd);
+FNCSIGN bool RCTAlgorithmBackprojection(RabbitCtGlobalData* rcgd);
+
+int main(int argc, char * argv[])
+{
+  GGO(rtkrabbitctbenchmark, args_info);
+
+  constexpr unsigned int Dimension = 3;
+  using ImageType = itk::Image< float, Dimension >;
+  using GeometryType = rtk::ThreeDCircularProjectionGeometry;
+
+  // Geometry
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(int i=0; i<args_info.nproj_arg; i++)
+    geometry->AddProjection(args_info.sid_arg,
+                            args_info.sdd_arg,
+                            i * args_info.arc_arg / args_info.nproj_arg);
+
+  // Projections of a Shepp & Logan phantom inscribed in the volume
+  using ConstantImageSourceType = rtk::ConstantImageSource< ImageType >;
+  ConstantImageSourceType::Pointer constantImageSource = ConstantImageSourceType::New();
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+  size[0] = args_info.dimu_arg;
+  size[1] = args_info.dimv_arg;
+  size[2] = args_info.nproj_arg;
+  spacing.Fill(args_info.pixelsize_arg);
+  origin[0] = -0.5 * (size[0]-1) * spacing[0];
+  origin[1] = -0.5 * (size[1]-1) * spacing[1];
+  origin[2] = 0.;
+  constantImageSource->SetOrigin( origin );
+  constantImageSource->SetSpacing( spacing );
+  constantImageSource->SetSize( size );
+
+  using SLPType = rtk::SheppLoganPhantomFilter<ImageType, ImageType>;
+  SLPType::Pointer slp = SLPType::New();
+  slp->SetInput(constantImageSource->GetOutput());
+  slp->SetGeometry(geometry);
+  SLPType::VectorType scale(0.5 * args_info.size_arg * args_info.voxelsize_arg);
+  slp->SetPhantomScale(scale);
+  if(args_info.verbose_flag)
+    std::cout << "Projecting Shepp & Logan phantom..." << std::endl;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() )
+
+  // RabbitCT global data
+  RabbitCtGlobalData rcgd;
+  rcgd.L = args_info.size_arg;
+  rcgd.S_x = args_info.dimu_arg;
+  rcgd.S_y = args_info.dimv_arg;
+  rcgd.R_L = args_info.voxelsize_arg;
+  rcgd.O_L = -0.5 * (rcgd.L-1) * rcgd.R_L;
+  rcgd.f_L = nullptr;
+  rcgd.adv_numProjBuffers = 0;
+  rcgd.adv_pProjBuffers = nullptr;
+
+  // Detector physical point to RabbitCT pixel index
+  GeometryType::TwoDHomogeneousMatrixType detPPToIndex;
+  detPPToIndex.SetIdentity();
+  for(unsigned int i=0; i<2; i++)
+    {
+    detPPToIndex[i][i] = 1. / spacing[i];
+    detPPToIndex[i][2] = -origin[i] / spacing[i];
+    }
+
+  itk::TimeProbe loadProbe, bpProbe, finishProbe;
+  loadProbe.Start();
+  if( !RCTLoadAlgorithm(&rcgd) )
+    {
+    std::cerr << "RCTLoadAlgorithm failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  loadProbe.Stop();
+
+  const unsigned int nPixels = rcgd.S_x * rcgd.S_y;
+  double A_n[12];
+  for(int k=0; k<args_info.nproj_arg; k++)
+    {
+    // RabbitCT projection matrices are stored column by column
+    GeometryType::HomogeneousProjectionMatrixType matrix;
+    matrix = detPPToIndex.GetVnlMatrix() * geometry->GetMatrix(k).GetVnlMatrix();
+    for (unsigned int j=0; j<3; j++)
+      for (unsigned int i=0; i<4; i++)
+        A_n[i*3+j] = matrix[j][i];
+    rcgd.A_n = A_n;
+    rcgd.I_n = slp->GetOutput()->GetBufferPointer() + k * nPixels;
+
+    bpProbe.Start();
+    if( !RCTAlgorithmBackprojection(&rcgd) )
+      {
+      std::cerr << "RCTAlgorithmBackprojection failed for projection " << k << std::endl;
+      return EXIT_FAILURE;
+      }
+    bpProbe.Stop();
+    }
+
+  finishProbe.Start();
+  if( !RCTFinishAlgorithm(&rcgd) )
+    {
+    std::cerr << "RCTFinishAlgorithm failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  finishProbe.Stop();
+
+  std::cout << "Problem size L=" << rcgd.L
+            << ", " << args_info.nproj_arg << " projections of "
+            << rcgd.S_x << "x" << rcgd.S_y << " pixels" << std::endl
+            << "Load: " << loadProbe.GetTotal() << ' ' << loadProbe.GetUnit() << std::endl
+            << "Backprojection: " << bpProbe.GetTotal() << ' ' << bpProbe.GetUnit()
+            << " (" << bpProbe.GetMean() << ' ' << bpProbe.GetUnit() << " per projection)" << std::endl
+            << "Finish: " << finishProbe.GetTotal() << ' ' << finishProbe.GetUnit() << std::endl;
+
+  if(args_info.output_given)
+    {
+    using ImportType = itk::ImportImageFilter<float, Dimension>;
+    ImportType::Pointer import = ImportType::New();
+    ImportType::RegionType region;
+    ImportType::SizeType volSize;
+    volSize.Fill(rcgd.L);
+    region.SetSize(volSize);
+    import->SetRegion(region);
+    import->SetSpacing(itk::Vector<double, Dimension>(rcgd.R_L));
+    ImportType::OriginType volOrigin;
+    volOrigin.Fill(rcgd.O_L);
+    import->SetOrigin(volOrigin);
+    import->SetImportPointer(rcgd.f_L, rcgd.L * rcgd.L * rcgd.L, false);
+
+    using WriterType = itk::ImageFileWriter< ImageType >;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName( args_info.output_arg );
+    writer->SetInput( import->GetOutput() );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() )
+    }
+
+  if( !RCTUnloadAlgorithm(&rcgd) )
+    {
+    std::cerr << "RCTUnloadAlgorithm failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/** RabbitCT - Version 1.0
+
+  RabbitCT enables easy benchmarking of backprojection algorithms.
+  This module runs the multithreaded CPU voxel-based backprojector of RTK,
+  rtk::FDKBackProjectionImageFilter.
+*/
+
+// include the required header files
+#include <iostream>
+#include <cmath>
+
+#include "rabbitct.h"
+
+#include "rtkFDKBackProjectionImageFilter.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+
+//#define WRITE_OUTPUT
+#ifdef WRITE_OUTPUT
+#  include <itkImageFileWriter.h>
+#endif //WRITE_OUTPUT
+
+using ImageType = itk::Image<float, 3>;
+using BackProjectionType = rtk::FDKBackProjectionImageFilter<ImageType, ImageType>;
+using GeometryType = rtk::ThreeDCircularProjectionGeometry;
+
+ImageType::Pointer          volume;
+ImageType::Pointer          projection;
+GeometryType::Pointer       geometry;
+BackProjectionType::Pointer bp;
+
+/** \brief Initialization routine.
+
+  This method is required for initializing the data required for
+  backprojection. It is called right before the first iteration.
+  Here any time intensive preliminary computations and
+  initializations should be performed.
+*/
+FNCSIGN bool RCTLoadAlgorithm(RabbitCtGlobalData* rcgd)
+{
+  // Volume, world coordinate of voxel i is O_L + i * R_L
+  ImageType::RegionType region;
+  ImageType::SizeType size;
+  size.Fill(rcgd->L);
+  region.SetSize(size);
+  volume = ImageType::New();
+  volume->SetRegions(region);
+  volume->SetSpacing(itk::Vector<double, 3>(rcgd->R_L));
+  ImageType::PointType origin;
+  origin.Fill(rcgd->O_L);
+  volume->SetOrigin(origin);
+  volume->Allocate();
+  volume->FillBuffer(0.);
+
+  // One projection, physical coordinates are RabbitCT pixel coordinates
+  size[0] = rcgd->S_x;
+  size[1] = rcgd->S_y;
+  size[2] = 1;
+  region.SetSize(size);
+  projection = ImageType::New();
+  projection->SetRegions(region);
+  projection->Allocate();
+
+  geometry = GeometryType::New();
+
+  bp = BackProjectionType::New();
+  bp->InPlaceOn();
+  bp->SetGeometry(geometry);
+
+  rcgd->f_L = volume->GetBufferPointer();
+
+  return true;
+}
+
+/** \brief Finish routine.
+
+  This method is called after the last projection image. Here
+  it should be made sure the the rcgd->out_volume pointer
+  is set correctly.
+*/
+FNCSIGN bool RCTFinishAlgorithm(RabbitCtGlobalData* rcgd)
+{
+  rcgd->f_L = volume->GetBufferPointer();
+  return true;
+}
+
+/** \brief Cleanup routine.
+
+  This method can be used to clean up the allocated
+  data required for backprojection. It is called just before
+  the benchmark finishes.
+*/
+FNCSIGN bool RCTUnloadAlgorithm(RabbitCtGlobalData* rcgd)
+{
+#ifdef WRITE_OUTPUT
+  using WriterType = itk::ImageFileWriter< ImageType >;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( "rtkrabbitctcpu.mhd" );
+  writer->SetInput( volume );
+  writer->Update();
+#endif //WRITE_OUTPUT
+
+  // release the volume, it is owned by the module
+  bp = nullptr;
+  geometry = nullptr;
+  projection = nullptr;
+  volume = nullptr;
+  rcgd->f_L = nullptr;
+  return true;
+}
+
+/** \brief Backprojection iteration.
+
+  This function is the C++ implementation of the pseudo-code
+  in the technical note.
+*/
+FNCSIGN bool RCTAlgorithmBackprojection(RabbitCtGlobalData* rcgd)
+{
+  // A_n is stored column by column. It is normalized for RTK so that the
+  // third row of its 3x3 part has unit norm.
+  GeometryType::HomogeneousProjectionMatrixType matrix;
+  for (unsigned int j=0; j<3; j++)
+    for (unsigned int i=0; i<4; i++)
+      matrix[j][i] = rcgd->A_n[i*3+j];
+  const double norm = std::sqrt(matrix[2][0]*matrix[2][0] +
+                                matrix[2][1]*matrix[2][1] +
+                                matrix[2][2]*matrix[2][2]);
+  matrix /= norm;
+
+  geometry->Clear();
+  if( !geometry->AddProjection(matrix) )
+    {
+    std::cerr << "Could not convert the RabbitCT matrix to an RTK geometry" << std::endl;
+    return false;
+    }
+
+  // RTK weights the backprojection with (w0/w)^2 where w0 is the homogeneous
+  // coordinate of the isocenter. RabbitCT uses 1/w^2 with the input scaling
+  // of A_n: the projection is divided by w0^2 while it is copied.
+  const double w0 = rcgd->A_n[11];
+  const float weight = 1. / (w0 * w0);
+  const unsigned int nPixels = rcgd->S_x * rcgd->S_y;
+  float *p = projection->GetBufferPointer();
+  for(unsigned int i=0; i<nPixels; i++)
+    p[i] = weight * rcgd->I_n[i];
+  projection->Modified();
+
+  bp->SetInput(0, volume);
+  bp->SetInput(1, projection);
+  try
+    {
+    bp->Update();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    return false;
+    }
+
+  // The backprojection is in place, the buffer is kept from one call to the next
+  volume = bp->GetOutput();
+  volume->DisconnectPipeline();
+
+  return true;
+}
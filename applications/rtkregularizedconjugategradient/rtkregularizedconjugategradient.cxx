@@ -136,6 +136,7 @@ int main(int argc, char * argv[])
     regularizedConjugateGradient->SetGamma(args_info.gammalaplacian_arg);
   if (args_info.tikhonov_given)
     regularizedConjugateGradient->SetTikhonov(args_info.tikhonov_arg);
+  regularizedConjugateGradient->SetNumberOfProjectionsPerBatch(args_info.batch_arg);
 
   // Spatial TV
   if (args_info.gammatv_given)
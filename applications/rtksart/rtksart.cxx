@@ -112,9 +112,24 @@ int main(int argc, char * argv[])
     }
   sart->SetNumberOfIterations( args_info.niterations_arg );
   sart->SetNumberOfProjectionsPerSubset( args_info.nprojpersubset_arg );
+  sart->SetBatchSubsets( args_info.batch_flag );
+  sart->SetConcurrentBranches( args_info.concurrent_flag );
+  sart->SetInitialNumberOfProjections( args_info.progressive_arg );
+  sart->SetProjectionsCacheMemoryBudget( itk::SizeValueType(args_info.cache_arg) * 1024 * 1024 );
+  if(args_info.store_given)
+    sart->SetProjectionsStoreFileName( args_info.store_arg );
   sart->SetLambda( args_info.lambda_arg );
   sart->SetDisableDisplacedDetectorFilter(args_info.nodisplaced_flag);
 
+  // Coarse full field-of-view volume for region-of-interest reconstruction
+  using BackgroundReaderType = itk::ImageFileReader< OutputImageType >;
+  BackgroundReaderType::Pointer backgroundReader = BackgroundReaderType::New();
+  if(args_info.background_given)
+    {
+    backgroundReader->SetFileName( args_info.background_arg );
+    sart->SetBackgroundVolume( backgroundReader->GetOutput() );
+    }
+
   if(args_info.positivity_flag)
     {
     sart->SetEnforcePositivity(true);
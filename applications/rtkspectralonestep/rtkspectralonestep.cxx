@@ -204,6 +204,7 @@ void rtkspectralonestep(const args_info_rtkspectralonestep &args_info)
   mechlemOneStep->SetRegularizationWeights( regulWeights );
   if(args_info.reset_nesterov_given)
     mechlemOneStep->SetResetNesterovEvery( args_info.reset_nesterov_arg );
+  mechlemOneStep->SetConcurrentBranches( args_info.concurrent_flag );
   if(args_info.mask_given)
     mechlemOneStep->SetSupportMask( supportmaskReader->GetOutput() );
   if(args_info.regul_spatial_weights_given)
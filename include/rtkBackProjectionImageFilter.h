@@ -91,6 +91,22 @@ protected:
   /** Apply changes to the input image requested region. */
   void GenerateInputRequestedRegion() override;
 
+  /** Input 0 may be the output of a rtk::ConstantImageSource, e.g., the
+   * zero image in which one backprojects. If SupportsImplicitConstantInput
+   * returns true, only one pixel of input 0 is then requested and
+   * subclasses use the value given by GetImplicitConstantInput instead of
+   * reading input 0. The default is false, subclasses which only read the
+   * pixels of input 0 through InitializeOutputRegion may return true. */
+  virtual bool SupportsImplicitConstantInput() const { return false; }
+  bool GetImplicitConstantInput(typename TInputImage::PixelType &value) const;
+
+  /** The output cannot be grafted on an implicit constant input. */
+  bool CanRunInPlace() const override;
+
+  /** Initializes region of the output with input 0, or with its implicit
+   * constant value. Does nothing if the filter runs in place. */
+  void InitializeOutputRegion(const OutputImageRegionType &region);
+
   void BeforeThreadedGenerateData() override;
 
 #if ITK_VERSION_MAJOR<5
@@ -138,6 +154,21 @@ protected:
 
   itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> GetProjectionPhysicalPointToProjectionIndexMatrix(const unsigned int iProj);
 
+  /** Matrix from projection coordinates, i.e., physical points of the
+   * projection stack, to the index of the projection given by GetProjection,
+   * accounting for the transposition. */
+  itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> GetProjectionCoordinatesToProjectionIndexMatrix();
+
+  /** Moves the continuous index pointProj of a projection given by
+   * GetProjection from the position where the backprojected point is
+   * measured to the corresponding nominal pixel position with the inverse of
+   * the detector displacement field of the geometry. projCoordToIndex and
+   * projIndexToCoord are GetProjectionCoordinatesToProjectionIndexMatrix and
+   * its inverse. */
+  void ApplyInverseDetectorDisplacement(itk::ContinuousIndex<double, TInputImage::ImageDimension-1> &pointProj,
+                                        const itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> &projCoordToIndex,
+                                        const itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> &projIndexToCoord) const;
+
   /** RTK geometry object */
   GeometryConstPointer m_Geometry;
 
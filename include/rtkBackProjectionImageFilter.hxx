@@ -22,8 +22,10 @@
 #include "rtkBackProjectionImageFilter.h"
 
 #include "rtkHomogeneousMatrix.h"
+#include "rtkConstantImageSource.h"
 
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkLinearInterpolateImageFunction.h>
 #include <itkPixelTraits.h>
@@ -41,7 +43,16 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
     const_cast< TInputImage * >( this->GetInput(0) );
   if ( !inputPtr0 )
     return;
-  inputPtr0->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+  typename TInputImage::RegionType reqRegion0 = this->GetOutput()->GetRequestedRegion();
+  typename TInputImage::PixelType constant;
+  if( this->GetImplicitConstantInput(constant) )
+    {
+    // Only one pixel of an implicit constant input is requested
+    typename TInputImage::SizeType onePixel;
+    onePixel.Fill(1);
+    reqRegion0.SetSize(onePixel);
+    }
+  inputPtr0->SetRequestedRegion( reqRegion0 );
 
   // Input 1 is the stack of projections to backproject
   typename Superclass::InputImagePointer  inputPtr1 =
@@ -61,7 +72,9 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
     }
 
   typename TInputImage::RegionType reqRegion = inputPtr1->GetLargestPossibleRegion();
-  if(m_Geometry.GetPointer() == nullptr || m_Geometry->GetRadiusCylindricalDetector() != 0 )
+  if(m_Geometry.GetPointer() == nullptr ||
+     m_Geometry->GetRadiusCylindricalDetector() != 0 ||
+     m_Geometry->GetDetectorDisplacementField() != nullptr )
     {
     inputPtr1->SetRequestedRegion( inputPtr1->GetLargestPossibleRegion() );
     return;
@@ -93,10 +106,10 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
         for(int cx=0; cx<2; cx++)
           {
           // Compute projection index
-          typename TInputImage::IndexType index = this->GetInput()->GetRequestedRegion().GetIndex();
-          index[0] += cx*this->GetInput()->GetRequestedRegion().GetSize(0);
-          index[1] += cy*this->GetInput()->GetRequestedRegion().GetSize(1);
-          index[2] += cz*this->GetInput()->GetRequestedRegion().GetSize(2);
+          typename TInputImage::IndexType index = this->GetOutput()->GetRequestedRegion().GetIndex();
+          index[0] += cx*this->GetOutput()->GetRequestedRegion().GetSize(0);
+          index[1] += cy*this->GetOutput()->GetRequestedRegion().GetSize(1);
+          index[2] += cz*this->GetOutput()->GetRequestedRegion().GetSize(2);
 
           itk::ContinuousIndex<double, Dimension-1> point;
           for(unsigned int i=0; i<Dimension-1; i++)
@@ -146,6 +159,47 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
     }
 }
 
+template <class TInputImage, class  TOutputImage>
+bool
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::GetImplicitConstantInput(typename TInputImage::PixelType &value) const
+{
+  return this->SupportsImplicitConstantInput() && GetConstantImageValue(this->GetInput(0), value);
+}
+
+template <class TInputImage, class  TOutputImage>
+bool
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::CanRunInPlace() const
+{
+  typename TInputImage::PixelType constant;
+  return itk::InPlaceImageFilter<TInputImage,TOutputImage>::CanRunInPlace() &&
+         !this->GetImplicitConstantInput(constant);
+}
+
+template <class TInputImage, class  TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::InitializeOutputRegion(const OutputImageRegionType &region)
+{
+  using OutputRegionIterator = itk::ImageRegionIterator<TOutputImage>;
+  OutputRegionIterator itOut(this->GetOutput(), region);
+
+  typename TInputImage::PixelType constant;
+  if( this->GetImplicitConstantInput(constant) )
+    {
+    for(; !itOut.IsAtEnd(); ++itOut)
+      itOut.Set(constant);
+    }
+  else if(this->GetInput() != this->GetOutput() )
+    {
+    using InputRegionIterator = itk::ImageRegionConstIterator<TInputImage>;
+    InputRegionIterator itIn(this->GetInput(), region);
+    for(; !itIn.IsAtEnd(); ++itIn, ++itOut)
+      itOut.Set(itIn.Get());
+    }
+}
+
 template <class TInputImage, class TOutputImage>
 void
 BackProjectionImageFilter<TInputImage,TOutputImage>
@@ -184,28 +238,23 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
   using InterpolatorType = itk::LinearInterpolateImageFunction< ProjectionImageType, double >;
   typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
 
-  // Iterators on volume input and output
-  using InputRegionIterator = itk::ImageRegionConstIterator<TInputImage>;
-  InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
+  // Iterator on volume output
   using OutputRegionIterator = itk::ImageRegionIteratorWithIndex<TOutputImage>;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
   // Initialize output region with input region in case the filter is not in
   // place
-  if(this->GetInput() != this->GetOutput() )
-    {
-    itIn.GoToBegin();
-    while(!itIn.IsAtEnd() )
-      {
-      itOut.Set(itIn.Get() );
-      ++itIn;
-      ++itOut;
-      }
-    }
+  this->InitializeOutputRegion(outputRegionForThread);
 
   // Continuous index at which we interpolate
   itk::ContinuousIndex<double, Dimension-1> pointProj;
 
+  // Conversion between projection coordinates and projection indices for the
+  // detector displacement field
+  const bool distorted = (m_Geometry->GetDetectorDisplacementField() != nullptr);
+  const itk::Matrix<double, Dimension, Dimension> projCoordToIndex = GetProjectionCoordinatesToProjectionIndexMatrix();
+  const itk::Matrix<double, Dimension, Dimension> projIndexToCoord( projCoordToIndex.GetInverse() );
+
   // Go over each projection
   for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
     {
@@ -225,12 +274,12 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
       }
 
     // Optimized version
-    if (fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
+    if (!distorted && fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
       {
       OptimizedBackprojectionX( outputRegionForThread, matrix, projection);
       continue;
       }
-    if (fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
+    if (!distorted && fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
       {
       OptimizedBackprojectionY( outputRegionForThread, matrix, projection);
       continue;
@@ -256,6 +305,10 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
       for(unsigned int i=0; i<Dimension-1; i++)
         pointProj[i] = pointProj[i]*perspFactor;
 
+      // Nominal position of the pixels measured at this position
+      if(distorted)
+        ApplyInverseDetectorDisplacement(pointProj, projCoordToIndex, projIndexToCoord);
+
       // Interpolate if in projection
       if( interpolator->IsInsideBuffer(pointProj) )
         {
@@ -292,6 +345,12 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
   // Continuous index at which we interpolate
   itk::ContinuousIndex<double, Dimension-1> pointProj, pointProjIdx;
 
+  // Conversion between projection coordinates and projection indices for the
+  // detector displacement field
+  const bool distorted = (m_Geometry->GetDetectorDisplacementField() != nullptr);
+  const itk::Matrix<double, Dimension, Dimension> projCoordToIndex = GetProjectionCoordinatesToProjectionIndexMatrix();
+  const itk::Matrix<double, Dimension, Dimension> projIndexToCoord( projCoordToIndex.GetInverse() );
+
   // Go over each voxel
   itOut.GoToBegin();
   while(!itOut.IsAtEnd() )
@@ -325,6 +384,10 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
         pointProjIdx[i] += projPPToProjIndex[i][j] * pointProj[j];
       }
 
+    // Nominal position of the pixels measured at this position
+    if(distorted)
+      ApplyInverseDetectorDisplacement(pointProjIdx, projCoordToIndex, projIndexToCoord);
+
     // Interpolate if in projection
     if( interpolator->IsInsideBuffer(pointProjIdx) )
       {
@@ -561,6 +624,18 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
 {
   const unsigned int Dimension = TInputImage::ImageDimension;
 
+  return itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension>
+          (GetProjectionCoordinatesToProjectionIndexMatrix().GetVnlMatrix() *
+           this->m_Geometry->GetProjectionTranslationMatrices()[iProj].GetVnlMatrix());
+}
+
+template <class TInputImage, class TOutputImage>
+itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension>
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::GetProjectionCoordinatesToProjectionIndexMatrix()
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+
   itk::Matrix<double, Dimension+1, Dimension+1> matrixStackProj =
     GetPhysicalPointToIndexMatrix< TOutputImage >( this->GetInput(1) );
 
@@ -583,9 +658,21 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
     }
 
   return itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension>
-          (matrixFlip.GetVnlMatrix() *
-           matrixProj.GetVnlMatrix() *
-           this->m_Geometry->GetProjectionTranslationMatrices()[iProj].GetVnlMatrix());
+          (matrixFlip.GetVnlMatrix() * matrixProj.GetVnlMatrix());
+}
+
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::ApplyInverseDetectorDisplacement(itk::ContinuousIndex<double, TInputImage::ImageDimension-1> &pointProj,
+                                   const itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> &projCoordToIndex,
+                                   const itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> &projIndexToCoord) const
+{
+  double u = projIndexToCoord[0][0] * pointProj[0] + projIndexToCoord[0][1] * pointProj[1] + projIndexToCoord[0][2];
+  double v = projIndexToCoord[1][0] * pointProj[0] + projIndexToCoord[1][1] * pointProj[1] + projIndexToCoord[1][2];
+  m_Geometry->ApplyInverseDetectorDisplacement(u, v);
+  pointProj[0] = projCoordToIndex[0][0] * u + projCoordToIndex[0][1] * v + projCoordToIndex[0][2];
+  pointProj[1] = projCoordToIndex[1][0] * u + projCoordToIndex[1][1] * v + projCoordToIndex[1][2];
 }
 
 
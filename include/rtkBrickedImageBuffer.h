@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkBrickedImageBuffer_h
+#define rtkBrickedImageBuffer_h
+
+#include <itkImage.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkNumericTraits.h>
+
+#include <vector>
+
+namespace rtk
+{
+
+/** \class BrickedImageBuffer
+ * \brief Read-only view of the buffer of a 3D image with a separable layout.
+ *
+ * The memory offset of the voxel with index (x,y,z) is the sum of three
+ * per-axis offsets, GetOffsets(0)[x] + GetOffsets(1)[y] + GetOffsets(2)[z],
+ * relative to GetBeginBuffer(). With a brick size of 0, the view points to
+ * the buffer of the image in its usual row-major layout. Otherwise, the
+ * buffered region is copied in cubic bricks of BrickSize^3 voxels which are
+ * contiguous in memory, so that neighbor voxels along any direction are close
+ * in memory. This benefits the projectors which step along y or z.
+ *
+ * The copy is only updated if the image, its buffered region, its update
+ * time or the brick size have changed since the last call to SetImage.
+ *
+ * \ingroup RTK
+ */
+template <class TImage>
+class BrickedImageBuffer
+{
+public:
+  using PixelType = typename TImage::PixelType;
+  using RegionType = typename TImage::RegionType;
+  static constexpr unsigned int Dimension = TImage::ImageDimension;
+
+  /** Set the image and the brick size (0 for the row-major buffer of the
+   * image, without copy). */
+  void SetImage(const TImage *img, unsigned int brickSize)
+  {
+    const RegionType region = img->GetBufferedRegion();
+    if(brickSize == 0)
+      {
+      m_Bricks.clear();
+      m_BeginBuffer = img->GetBufferPointer();
+      int stride = 1;
+      for(unsigned int d=0; d<Dimension; d++)
+        {
+        m_Tables[d].resize(region.GetSize()[d]);
+        for(unsigned int i=0; i<region.GetSize()[d]; i++)
+          m_Tables[d][i] = i * stride;
+        stride *= region.GetSize()[d];
+        m_Offsets[d] = m_Tables[d].data() - region.GetIndex()[d];
+        }
+      m_Image = nullptr;
+      return;
+      }
+
+    if(m_Image == img &&
+       m_BrickSize == brickSize &&
+       m_Region == region &&
+       m_UpdateMTime == img->GetUpdateMTime() &&
+       !m_Bricks.empty())
+      return;
+    m_Image = img;
+    m_BrickSize = brickSize;
+    m_Region = region;
+    m_UpdateMTime = img->GetUpdateMTime();
+
+    // Per-axis offsets: brick offset plus offset within the brick
+    unsigned int numberOfBricks[Dimension];
+    int brickStride = 1;
+    int localStride = 1;
+    for(unsigned int d=0; d<Dimension; d++)
+      brickStride *= brickSize;
+    for(unsigned int d=0; d<Dimension; d++)
+      {
+      numberOfBricks[d] = (region.GetSize()[d] + brickSize - 1) / brickSize;
+      m_Tables[d].resize(region.GetSize()[d]);
+      for(unsigned int i=0; i<region.GetSize()[d]; i++)
+        m_Tables[d][i] = (i/brickSize) * brickStride + (i%brickSize) * localStride;
+      brickStride *= numberOfBricks[d];
+      localStride *= brickSize;
+      m_Offsets[d] = m_Tables[d].data() - region.GetIndex()[d];
+      }
+
+    // Copy the buffered region, the padding of the last bricks is set to zero
+    m_Bricks.assign(brickStride, itk::NumericTraits<PixelType>::ZeroValue());
+    itk::ImageRegionConstIteratorWithIndex<TImage> it(img, region);
+    for(; !it.IsAtEnd(); ++it)
+      {
+      int offset = 0;
+      for(unsigned int d=0; d<Dimension; d++)
+        offset += m_Offsets[d][it.GetIndex()[d]];
+      m_Bricks[offset] = it.Get();
+      }
+    m_BeginBuffer = m_Bricks.data();
+  }
+
+  /** Pointer to the voxel at the index of the buffered region. */
+  const PixelType *GetBeginBuffer() const { return m_BeginBuffer; }
+
+  /** Offsets along axis d, to be indexed with the image index along d. */
+  const int *GetOffsets(unsigned int d) const { return m_Offsets[d]; }
+
+private:
+  const TImage *           m_Image{nullptr};
+  unsigned int             m_BrickSize{0};
+  RegionType               m_Region;
+  itk::ModifiedTimeType    m_UpdateMTime{0};
+  std::vector<PixelType>   m_Bricks;
+  std::vector<int>         m_Tables[Dimension];
+  const int *              m_Offsets[Dimension];
+  const PixelType *        m_BeginBuffer{nullptr};
+};
+
+} // end namespace rtk
+
+#endif // rtkBrickedImageBuffer_h
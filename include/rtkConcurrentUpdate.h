@@ -0,0 +1,57 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkConcurrentUpdate_h
+#define rtkConcurrentUpdate_h
+
+#include <itkDataObject.h>
+#include "RTKExport.h"
+
+#include <vector>
+
+namespace rtk
+{
+
+/** Updates the data objects of independent branches of a pipeline
+ * concurrently, e.g., the outputs of two backprojection filters of a
+ * composite filter. The output information and the requested regions are
+ * computed branch after branch as itk::DataObject::Update does, and the
+ * filters which are upstream of several branches are updated first.
+ * Each branch is then updated by its own thread. With ITK 5, the filters
+ * of all branches share the global thread pool of itk::PoolMultiThreader, so
+ * that small filters of one branch do not leave cores idle. The data of the
+ * common inputs is not released before all branches have been updated.
+ *
+ * The branches must not modify their common inputs, i.e., a filter running
+ * in place must not take as input a data object used by another branch, and
+ * they must not share any filter downstream of their common inputs since the
+ * update of an itk::ProcessObject is not thread safe. If the data generated
+ * for the common inputs does not cover the requested regions of all
+ * branches, the branches are updated one after the other. The first
+ * exception thrown by a branch is rethrown.
+ *
+ * It is not used by default, see the ConcurrentBranches option of the filters
+ * calling it.
+ *
+ * \ingroup RTK
+ */
+void RTK_EXPORT UpdateConcurrently(const std::vector<itk::DataObject *> &outputs);
+
+} //namespace rtk
+
+#endif
@@ -197,6 +197,12 @@ public:
     itkSetMacro(Gamma, float)
     itkGetMacro(Gamma, float)
 
+    /** Number of projections forward projected, weighted and backprojected
+     *  together by the conjugate gradient operator. Default is 0, all
+     *  projections at once. */
+    itkSetMacro(NumberOfProjectionsPerBatch, unsigned int)
+    itkGetMacro(NumberOfProjectionsPerBatch, unsigned int)
+
     /** Get / Set whether conjugate gradient should be performed on GPU */
     itkGetMacro(CudaConjugateGradient, bool)
     itkSetMacro(CudaConjugateGradient, bool)
@@ -258,6 +264,7 @@ private:
     bool                         m_IterationCosts;
     bool                         m_CudaConjugateGradient;
     bool                         m_DisableDisplacedDetectorFilter;
+    unsigned int                 m_NumberOfProjectionsPerBatch;
 };
 } //namespace RTK
 
@@ -42,6 +42,7 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage,
   m_Tikhonov = 0;
   m_CudaConjugateGradient = true;
   m_DisableDisplacedDetectorFilter = false;
+  m_NumberOfProjectionsPerBatch = 0;
 
   // Create the filters
   m_DisplacedDetectorFilter = DisplacedDetectorFilterType::New();
@@ -242,6 +243,14 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage,
         return;
     inputSupportMaskPtr->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
     }
+
+  // Input "BackgroundVolume" is the coarse full field-of-view volume in ROI mode, if any
+  if (this->GetBackgroundVolume().IsNotNull())
+    {
+    typename TOutputImage::Pointer inputBackgroundPtr =
+            const_cast< TOutputImage * >( this->GetBackgroundVolume().GetPointer() );
+    inputBackgroundPtr->SetRequestedRegion( inputBackgroundPtr->GetLargestPossibleRegion() );
+    }
 }
 
 template< typename TOutputImage,
@@ -276,7 +285,9 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage,
   m_ConjugateGradientFilter->SetB(m_BackProjectionFilterForB->GetOutput());
 
   // Multiply the projections by the weights map
-  m_MultiplyWithWeightsFilter->SetInput1(this->GetInputProjectionStack());
+  m_MultiplyWithWeightsFilter->SetInput1(this->GetROIProjections(this->GetInputProjectionStack(),
+                                                                  this->GetInputVolume(),
+                                                                  m_Geometry));
   m_MultiplyWithWeightsFilter->SetInput2(m_DisplacedDetectorFilter->GetOutput());
   m_CGOperator->SetInputWeights(m_DisplacedDetectorFilter->GetOutput());
   m_BackProjectionFilterForB->SetInput(1, m_MultiplyWithWeightsFilter->GetOutput());
@@ -304,6 +315,7 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage,
   m_ConjugateGradientFilter->SetNumberOfIterations(this->m_NumberOfIterations);
   m_CGOperator->SetGamma(m_Gamma);
   m_CGOperator->SetTikhonov(m_Tikhonov);
+  m_CGOperator->SetNumberOfProjectionsPerBatch(m_NumberOfProjectionsPerBatch);
 
   // Set memory management parameters
   m_MultiplyProjectionsFilter->ReleaseDataFlagOn();
@@ -180,8 +180,8 @@ void ConjugateGradientImageFilter<OutputImageType>
     ++itX;
     }
 #else
-  // Instantiate the multithreader
-  itk::MultiThreaderBase::Pointer mt = itk::MultiThreaderBase::New();
+  // Use the multithreader of the filter, i.e., the global thread pool by default
+  itk::MultiThreaderBase *mt = this->GetMultiThreader();
   std::mutex accumulationLock;
 
   // Compute Xk+1
@@ -23,6 +23,7 @@
 #include "rtkMacro.h"
 
 #include <itkImageSource.h>
+#include <itkExtractImageFilter.h>
 #include <itkNumericTraits.h>
 #include <itkVariableLengthVector.h>
 #include <itkVectorImage.h>
@@ -138,6 +139,38 @@ protected:
   OutputImagePixelType  m_Constant;
 };
 
+/** \brief Returns true if image is the output of a rtk::ConstantImageSource,
+ * possibly through itk::ExtractImageFilter, and sets value to the constant.
+ *
+ * Filters can then use the constant without reading the image and request a
+ * single pixel of it, which avoids allocating and filling the whole image.
+ *
+ * \author Simon Rit
+ *
+ * \ingroup RTK
+ */
+template <class TImage>
+bool
+GetConstantImageValue(const TImage *image, typename TImage::PixelType &value)
+{
+  if(image == nullptr)
+    return false;
+
+  const itk::ProcessObject::Pointer source = image->GetSource();
+  const auto *constantSource = dynamic_cast<const ConstantImageSource<TImage> *>(source.GetPointer());
+  if(constantSource != nullptr)
+    {
+    value = constantSource->GetConstant();
+    return true;
+    }
+
+  const auto *extract = dynamic_cast<const itk::ExtractImageFilter<TImage, TImage> *>(source.GetPointer());
+  if(extract != nullptr)
+    return GetConstantImageValue(extract->GetInput(), value);
+
+  return false;
+}
+
 } // end namespace rtk
 
 #ifndef ITK_MANUAL_INSTANTIATION
@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkConvexFieldOfViewImageFilter_h
+#define rtkConvexFieldOfViewImageFilter_h
+
+#include <itkInPlaceImageFilter.h>
+
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkConfiguration.h"
+
+#include <vector>
+#include <utility>
+
+namespace rtk
+{
+
+/** \class ConvexFieldOfViewImageFilter
+ * \brief Computes the exact field of view mask of any trajectory.
+ *
+ * A voxel is in the field of view if it projects between the first and the
+ * last pixel centers of the detector in all projections, i.e., it is in the
+ * intersection of the frusta of all projections. Each frustum is the
+ * intersection of half-spaces delimited by planes containing the source: the
+ * four detector edges, the collimation jaws (if any) and the plane of the
+ * source parallel to the detector. The field of view is therefore the convex
+ * polyhedron defined by the intersection of all these half-spaces.
+ *
+ * The mask is computed slice by slice: the rectangle of a slice in continuous
+ * index coordinates is clipped by the half-planes which are the intersection
+ * of the half-spaces with the slice. The clipped convex polygon gives one
+ * span of voxels per row of the slice. Unlike rtk::FieldOfViewImageFilter,
+ * there is no assumption on the shape of the field of view and on the
+ * trajectory. The result is the same as backprojecting projections filled
+ * with ones and thresholding at the number of projections, without
+ * backprojection.
+ *
+ * With DisplacedDetector, the detector of each projection is assumed to be
+ * symmetrized around the projection of the isocenter, as done by
+ * rtk::DisplacedDetectorImageFilter.
+ *
+ * The row spans can be obtained without running the filter with
+ * ComputeRowSpans, e.g., to skip the voxels outside the field of view in
+ * rtk::FDKBackProjectionImageFilter. Cylindrical detectors are not handled.
+ *
+ * \test rtkfovtest.cxx
+ *
+ * \ingroup RTK InPlaceImageFilter
+ */
+template <class TInputImage, class TOutputImage=TInputImage>
+class ITK_EXPORT ConvexFieldOfViewImageFilter:
+  public itk::InPlaceImageFilter<TInputImage,TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ConvexFieldOfViewImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ConvexFieldOfViewImageFilter;
+  using Superclass = itk::InPlaceImageFilter<TInputImage,TOutputImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using ProjectionsStackType = typename TInputImage::Superclass;
+  using ProjectionsStackPointer = typename ProjectionsStackType::Pointer;
+  using GeometryType = rtk::ThreeDCircularProjectionGeometry;
+  using GeometryConstPointer = typename GeometryType::ConstPointer;
+  using ImageBaseType = itk::ImageBase<TInputImage::ImageDimension>;
+  using HalfSpaceType = itk::Vector<double, 4>;
+
+  /** Span [first, last] of voxel indices along the first dimension. The span
+   * is empty if first > last. */
+  using RowSpanType = std::pair<itk::IndexValueType, itk::IndexValueType>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ConvexFieldOfViewImageFilter, InPlaceImageFilter);
+
+  /** Get / Set the object pointer to projection geometry */
+  itkGetConstObjectMacro(Geometry, GeometryType);
+  itkSetConstObjectMacro(Geometry, GeometryType);
+
+  /** Get / Set of the member Mask. If set, all the pixels in the field of view
+   * are set to 1. The data value is kept otherwise. Pixels outside the mask
+   * are set to 0 in any case. */
+  itkGetMacro(Mask, bool);
+  itkSetMacro(Mask, bool);
+
+  /** Get / Set the projection images, only the geometric information is
+   * required and the data are therefore not updated. */
+  itkGetMacro(ProjectionsStack, ProjectionsStackPointer);
+  itkSetObjectMacro(ProjectionsStack, ProjectionsStackType);
+
+  /** Assume that a displaced detector image filter, e.g.,
+   * rtk::DisplacedDetectorImageFilter, has been used. */
+  itkGetMacro(DisplacedDetector, bool);
+  itkSetMacro(DisplacedDetector, bool);
+
+  /** Computes the half-spaces a.x+b.y+c.z+d >= 0 in physical coordinates
+   * whose intersection is the field of view. m_Geometry and
+   * ProjectionsStack must be set. */
+  virtual void ComputeHalfSpaces(std::vector<HalfSpaceType> &halfSpaces);
+
+  /** Computes the span of voxels in the field of view of each row of region
+   * of volume. spans[j + k*region.GetSize(1)] is the span of row (j,k) in
+   * region index coordinates. m_Geometry and ProjectionsStack must be set. */
+  void ComputeRowSpans(const ImageBaseType *volume,
+                       const OutputImageRegionType &region,
+                       std::vector<RowSpanType> &spans);
+
+protected:
+  ConvexFieldOfViewImageFilter() = default;
+  ~ConvexFieldOfViewImageFilter() override = default;
+
+  void BeforeThreadedGenerateData() override;
+
+#if ITK_VERSION_MAJOR<5
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) override;
+#else
+  void DynamicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread) override;
+#endif
+
+  /** Converts half-spaces from physical to continuous index coordinates */
+  static void HalfSpacesToIndexCoordinates(const ImageBaseType *volume,
+                                           const std::vector<HalfSpaceType> &physical,
+                                           std::vector<HalfSpaceType> &index);
+
+  /** Computes the spans of the rows of slice k of region with half-spaces
+   * in index coordinates. */
+  static void ComputeSliceRowSpans(const std::vector<HalfSpaceType> &halfSpaces,
+                                   const OutputImageRegionType &region,
+                                   const itk::IndexValueType k,
+                                   std::vector<RowSpanType> &spans);
+
+private:
+  GeometryConstPointer       m_Geometry{nullptr};
+  bool                       m_Mask{false};
+  ProjectionsStackPointer    m_ProjectionsStack;
+  bool                       m_DisplacedDetector{false};
+  std::vector<HalfSpaceType> m_IndexHalfSpaces;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkConvexFieldOfViewImageFilter.hxx"
+#endif
+
+#endif
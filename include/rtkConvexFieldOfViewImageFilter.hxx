@@ -0,0 +1,311 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkConvexFieldOfViewImageFilter_hxx
+#define rtkConvexFieldOfViewImageFilter_hxx
+
+#include "rtkConvexFieldOfViewImageFilter.h"
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+ConvexFieldOfViewImageFilter<TInputImage, TOutputImage>
+::ComputeHalfSpaces(std::vector<HalfSpaceType> &halfSpaces)
+{
+  if(m_Geometry->GetRadiusCylindricalDetector() != 0)
+    {
+    itkExceptionMacro(<< "Cylindrical detectors are not handled.");
+    }
+
+  // Physical coordinates of the first and last pixel centers of the detector
+  m_ProjectionsStack->UpdateOutputInformation();
+  typename ProjectionsStackType::IndexType indexCorner1, indexCorner2;
+  indexCorner1 = m_ProjectionsStack->GetLargestPossibleRegion().GetIndex();
+  indexCorner2 = indexCorner1 + m_ProjectionsStack->GetLargestPossibleRegion().GetSize();
+  for(unsigned int i=0; i<TInputImage::GetImageDimension(); i++)
+    indexCorner2[i] --;
+  typename ProjectionsStackType::PointType corner1, corner2;
+  m_ProjectionsStack->TransformIndexToPhysicalPoint(indexCorner1, corner1);
+  m_ProjectionsStack->TransformIndexToPhysicalPoint(indexCorner2, corner2);
+  for(unsigned int i=0; i<TInputImage::GetImageDimension(); i++)
+    if(corner1[i]>corner2[i])
+      std::swap(corner1[i], corner2[i]);
+
+  halfSpaces.clear();
+  HalfSpaceType r[3];
+  for(unsigned int iProj=0; iProj<m_Geometry->GetGantryAngles().size(); iProj++)
+    {
+    // Rows of the projection matrix oriented so that the third homogeneous
+    // coordinate is positive in front of the source
+    const GeometryType::MatrixType matrix = m_Geometry->GetMatrix(iProj);
+    const double s = (matrix[2][3]<0.)?-1.:1.;
+    for(unsigned int i=0; i<3; i++)
+      for(unsigned int j=0; j<4; j++)
+        r[i][j] = s * matrix[i][j];
+    halfSpaces.push_back(r[2]);
+
+    // Detector edges, u/w >= uinf is (u-uinf*w) >= 0 if w>0
+    double uinf = corner1[0];
+    double usup = corner2[0];
+    if(m_DisplacedDetector)
+      {
+      const double u0 = matrix[0][3] / matrix[2][3];
+      const double halfWidth = std::max(u0 - uinf, usup - u0);
+      uinf = u0 - halfWidth;
+      usup = u0 + halfWidth;
+      }
+    halfSpaces.push_back(r[0] - r[2] * uinf);
+    halfSpaces.push_back(r[2] * usup - r[0]);
+    halfSpaces.push_back(r[1] - r[2] * corner1[1]);
+    halfSpaces.push_back(r[2] * corner2[1] - r[1]);
+
+    // Collimation jaws, see rtk::MaskCollimationImageFilter for their
+    // definition. The coordinates in the plane of the jaws multiplied by q
+    // are linear in x.
+    const double X1 = m_Geometry->GetCollimationUInf()[iProj];
+    const double X2 = m_Geometry->GetCollimationUSup()[iProj];
+    const double Y1 = m_Geometry->GetCollimationVInf()[iProj];
+    const double Y2 = m_Geometry->GetCollimationVSup()[iProj];
+    const double dmax = std::numeric_limits<double>::max();
+    if(X1 == dmax && X2 == dmax && Y1 == dmax && Y2 == dmax)
+      continue;
+
+    const typename GeometryType::HomogeneousVectorType source = m_Geometry->GetSourcePosition(iProj);
+    const double sourceNorm = std::sqrt(source[0]*source[0] + source[1]*source[1] + source[2]*source[2]);
+    const double dx = source[0]/sourceNorm;
+    const double dz = source[2]/sourceNorm;
+    HalfSpaceType q, uq, vq;
+    q[0] = -dx;
+    q[1] = 0.;
+    q[2] = -dz;
+    q[3] = source[0]*dx + source[2]*dz;
+    uq[0] = sourceNorm * dz;
+    uq[1] = 0.;
+    uq[2] = -sourceNorm * dx;
+    uq[3] = 0.;
+    vq[0] = 0.;
+    vq[1] = sourceNorm;
+    vq[2] = 0.;
+    vq[3] = -sourceNorm * source[1];
+    if(X1 != dmax)
+      halfSpaces.push_back(uq + q * X1);
+    if(X2 != dmax)
+      halfSpaces.push_back(q * X2 - uq);
+    if(Y1 != dmax)
+      halfSpaces.push_back(vq + q * Y1);
+    if(Y2 != dmax)
+      halfSpaces.push_back(q * Y2 - vq);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConvexFieldOfViewImageFilter<TInputImage, TOutputImage>
+::HalfSpacesToIndexCoordinates(const ImageBaseType *volume,
+                               const std::vector<HalfSpaceType> &physical,
+                               std::vector<HalfSpaceType> &index)
+{
+  // x = origin + direction * spacing * i
+  itk::Matrix<double, 3, 3> indexToPhysical = volume->GetDirection();
+  for(unsigned int i=0; i<3; i++)
+    for(unsigned int j=0; j<3; j++)
+      indexToPhysical[i][j] *= volume->GetSpacing()[j];
+
+  index.clear();
+  for(const HalfSpaceType &p : physical)
+    {
+    HalfSpaceType h;
+    h.Fill(0.);
+    h[3] = p[3];
+    for(unsigned int i=0; i<3; i++)
+      {
+      h[3] += p[i] * volume->GetOrigin()[i];
+      for(unsigned int j=0; j<3; j++)
+        h[j] += p[i] * indexToPhysical[i][j];
+      }
+
+    // Normalize so that the tolerance is in voxels
+    const double norm = std::sqrt(h[0]*h[0] + h[1]*h[1] + h[2]*h[2]);
+    if(norm>0.)
+      h /= norm;
+    index.push_back(h);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConvexFieldOfViewImageFilter<TInputImage, TOutputImage>
+::ComputeSliceRowSpans(const std::vector<HalfSpaceType> &halfSpaces,
+                       const OutputImageRegionType &region,
+                       const itk::IndexValueType k,
+                       std::vector<RowSpanType> &spans)
+{
+  const double eps = 1e-6;
+  const itk::IndexValueType i0 = region.GetIndex(0);
+  const itk::IndexValueType i1 = i0 + region.GetSize(0) - 1;
+  const itk::IndexValueType j0 = region.GetIndex(1);
+  const itk::IndexValueType j1 = j0 + region.GetSize(1) - 1;
+  spans.assign(region.GetSize(1), RowSpanType(i0, i0-1));
+
+  // Convex polygon in the (i,j) plane, initialized with the slice rectangle
+  using VertexType = std::pair<double, double>;
+  std::vector<VertexType> polygon, clipped;
+  polygon.push_back(VertexType(i0-0.5, j0-0.5));
+  polygon.push_back(VertexType(i1+0.5, j0-0.5));
+  polygon.push_back(VertexType(i1+0.5, j1+0.5));
+  polygon.push_back(VertexType(i0-0.5, j1+0.5));
+
+  // Sutherland-Hodgman clipping with each half-plane a.i+b.j+c >= 0
+  for(const HalfSpaceType &h : halfSpaces)
+    {
+    const double a = h[0];
+    const double b = h[1];
+    const double c = h[2] * k + h[3];
+    clipped.clear();
+    for(size_t n=0; n<polygon.size(); n++)
+      {
+      const VertexType &p = polygon[n];
+      const VertexType &q = polygon[(n+1)%polygon.size()];
+      const double fp = a * p.first + b * p.second + c;
+      const double fq = a * q.first + b * q.second + c;
+      if(fp >= -eps)
+        clipped.push_back(p);
+      if( (fp >= -eps) != (fq >= -eps) )
+        {
+        const double t = fp / (fp - fq);
+        clipped.push_back(VertexType(p.first + t * (q.first - p.first),
+                                     p.second + t * (q.second - p.second)));
+        }
+      }
+    polygon.swap(clipped);
+    if(polygon.empty())
+      return;
+    }
+
+  // Intersect each row with the polygon
+  for(itk::IndexValueType j=j0; j<=j1; j++)
+    {
+    double xmin = std::numeric_limits<double>::max();
+    double xmax = std::numeric_limits<double>::lowest();
+    for(size_t n=0; n<polygon.size(); n++)
+      {
+      const VertexType &p = polygon[n];
+      const VertexType &q = polygon[(n+1)%polygon.size()];
+      if(std::abs(p.second - j) <= eps)
+        {
+        xmin = std::min(xmin, p.first);
+        xmax = std::max(xmax, p.first);
+        }
+      if( (p.second - j) * (q.second - j) < 0. )
+        {
+        const double x = p.first + (j - p.second) * (q.first - p.first) / (q.second - p.second);
+        xmin = std::min(xmin, x);
+        xmax = std::max(xmax, x);
+        }
+      }
+    if(xmin <= xmax)
+      {
+      spans[j-j0].first = std::max(i0, static_cast<itk::IndexValueType>(std::ceil(xmin - eps)));
+      spans[j-j0].second = std::min(i1, static_cast<itk::IndexValueType>(std::floor(xmax + eps)));
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConvexFieldOfViewImageFilter<TInputImage, TOutputImage>
+::ComputeRowSpans(const ImageBaseType *volume,
+                  const OutputImageRegionType &region,
+                  std::vector<RowSpanType> &spans)
+{
+  std::vector<HalfSpaceType> physical, index;
+  this->ComputeHalfSpaces(physical);
+  HalfSpacesToIndexCoordinates(volume, physical, index);
+
+  spans.clear();
+  std::vector<RowSpanType> sliceSpans;
+  for(itk::IndexValueType k=region.GetIndex(2); k<region.GetIndex(2)+(itk::IndexValueType)region.GetSize(2); k++)
+    {
+    ComputeSliceRowSpans(index, region, k, sliceSpans);
+    spans.insert(spans.end(), sliceSpans.begin(), sliceSpans.end());
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConvexFieldOfViewImageFilter<TInputImage, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  std::vector<HalfSpaceType> physical;
+  this->ComputeHalfSpaces(physical);
+  HalfSpacesToIndexCoordinates(this->GetInput(), physical, m_IndexHalfSpaces);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConvexFieldOfViewImageFilter<TInputImage, TOutputImage>
+#if ITK_VERSION_MAJOR<5
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+#else
+::DynamicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread)
+#endif
+{
+  using InputConstIterator = itk::ImageRegionConstIterator<TInputImage>;
+  InputConstIterator itIn(this->GetInput(0), outputRegionForThread);
+  using OutputIterator = itk::ImageRegionIterator<TOutputImage>;
+  OutputIterator itOut(this->GetOutput(), outputRegionForThread);
+
+  const itk::IndexValueType i0 = outputRegionForThread.GetIndex(0);
+  const itk::IndexValueType i1 = i0 + outputRegionForThread.GetSize(0);
+  std::vector<RowSpanType> spans;
+  for(itk::IndexValueType k=outputRegionForThread.GetIndex(2);
+                          k<outputRegionForThread.GetIndex(2)+(itk::IndexValueType)outputRegionForThread.GetSize(2);
+                          k++)
+    {
+    ComputeSliceRowSpans(m_IndexHalfSpaces, outputRegionForThread, k, spans);
+    for(const RowSpanType &span : spans)
+      {
+      for(itk::IndexValueType i=i0; i<i1; i++, ++itIn, ++itOut)
+        {
+        if(i>=span.first && i<=span.second)
+          {
+          if(m_Mask)
+            itOut.Set(1.0);
+          else
+            itOut.Set(itIn.Get());
+          }
+        else
+          itOut.Set(0.);
+        }
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif
@@ -46,6 +46,9 @@ void
 CudaBackProjectionImageFilter<ImageType>
 ::GPUGenerateData()
 {
+  if (this->GetGeometry()->GetDetectorDisplacementField() != nullptr)
+    itkGenericExceptionMacro(<< "Detector displacement fields are not handled by CUDA projectors");
+
   const unsigned int Dimension = ImageType::ImageDimension;
   const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
   const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
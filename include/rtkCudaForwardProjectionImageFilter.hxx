@@ -53,6 +53,9 @@ CudaForwardProjectionImageFilter<TInputImage,
                                  TOutputImage>
 ::GPUGenerateData()
 {
+  if (this->GetGeometry()->GetDetectorDisplacementField() != nullptr)
+    itkGenericExceptionMacro(<< "Detector displacement fields are not handled by CUDA projectors");
+
   if (this->GetGeometry()->GetSourceToDetectorDistances().size() &&
       this->GetGeometry()->GetSourceToDetectorDistances()[0] == 0)
     {
@@ -88,6 +88,9 @@ protected:
 
   virtual void GPUGenerateData();
 
+  /** The GPU kernel reads the input volume buffer. */
+  virtual bool SupportsImplicitConstantInput() const { return false; }
+
 private:
   double             m_StepSize;
   bool               m_Normalize;
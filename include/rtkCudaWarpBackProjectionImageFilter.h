@@ -91,6 +91,9 @@ protected:
 
   virtual void GPUGenerateData();
 
+  /** The GPU kernel reads the input volume buffer. */
+  virtual bool SupportsImplicitConstantInput() const { return false; }
+
 };
 
 } // end namespace rtk
@@ -0,0 +1,229 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkDRRGenerator_h
+#define rtkDRRGenerator_h
+
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkBrickedImageBuffer.h"
+#include "rtkBoxShape.h"
+#include "rtkEmptySpaceSkippingGrid.h"
+#include "rtkNestedVolumesRaySegments.h"
+
+#include <itkMatrixOffsetTransformBase.h>
+#if ITK_VERSION_MAJOR<5
+  #include <itkMultiThreader.h>
+#else
+  #include <itkMultiThreaderBase.h>
+#endif
+
+#include <vector>
+
+namespace rtk
+{
+
+/** \class DRRGenerator
+ * \brief Computes digitally reconstructed radiographs (DRRs) of a volume
+ * for many rigid transforms, e.g., in a 2D/3D registration loop.
+ *
+ * The line integrals are computed as in
+ * rtk::JosephForwardProjectionImageFilter, with the same functors, but
+ * without the ITK pipeline. The projected value accumulation functor starts
+ * from 0 for each pixel. The
+ * volume is kept in memory with the layout of rtk::BrickedImageBuffer,
+ * which is only copied again if the volume has been modified. Each rigid
+ * transform is applied to the rays of the geometry, not to the volume:
+ * the DRR of a transform is the one of the volume resampled with this
+ * transform by itk::ResampleImageFilter, i.e., the transform maps the
+ * physical points of the projection geometry to the physical points of the
+ * volume.
+ *
+ * Only a subset of the pixels of the projections can be computed, e.g., a
+ * sparse grid or the pixels on edges, given by their index in the stack of
+ * projections described by SetProjectionsInformation: the first two
+ * components are the pixel indices in the projection and the third one is
+ * the projection index in the geometry. By default, all pixels of the
+ * largest possible region of the projections are computed. Compute
+ * evaluates all pixels for all transforms in one multithreaded call.
+ *
+ * The empty parts of the volume can be skipped with an
+ * rtk::EmptySpaceSkippingGrid, see EmptySpaceCellSize, like in
+ * rtk::JosephForwardProjectionImageFilter. The grid is only computed again
+ * if the volume has been modified.
+ *
+ * Only cone-beam geometries with flat panels, e.g.,
+ * rtk::Reg23ProjectionGeometry, are supported.
+ *
+ * \test rtkdrrgeneratortest.cxx
+ *
+ * \ingroup RTK Projector
+ */
+template <class TVolumeImage,
+          class TInterpolationWeightMultiplication = Functor::InterpolationWeightMultiplication<typename TVolumeImage::PixelType, typename itk::PixelTraits<typename TVolumeImage::PixelType>::ValueType, float>,
+          class TProjectedValueAccumulation        = Functor::ProjectedValueAccumulation<float, float>,
+          class TSumAlongRay                       = Functor::SumAlongRay<typename TVolumeImage::PixelType, float>
+          >
+class ITK_EXPORT DRRGenerator : public itk::Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(DRRGenerator);
+
+  /** Standard class type alias. */
+  using Self = DRRGenerator;
+  using Superclass = itk::Object;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  using VolumeImageType = TVolumeImage;
+  using VolumePixelType = typename VolumeImageType::PixelType;
+  using OutputPixelType = float;
+  using GeometryType = ThreeDCircularProjectionGeometry;
+  using ProjectionsInformationType = itk::ImageBase<3>;
+  using TransformType = itk::MatrixOffsetTransformBase<double, 3, 3>;
+  using TransformConstPointer = typename TransformType::ConstPointer;
+  using TransformsType = std::vector<TransformConstPointer>;
+  using PixelIndexType = itk::Index<3>;
+  using PixelIndicesType = std::vector<PixelIndexType>;
+  using VectorType = BoxShape::VectorType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DRRGenerator, itk::Object);
+
+  /** Get / Set the volume, whose buffered region is projected. */
+  itkGetConstObjectMacro(Volume, VolumeImageType);
+  itkSetConstObjectMacro(Volume, VolumeImageType);
+
+  /** Get / Set the projection geometry. */
+  itkGetConstObjectMacro(Geometry, GeometryType);
+  itkSetConstObjectMacro(Geometry, GeometryType);
+
+  /** Set the origin, spacing, direction and largest possible region of the
+   * stack of projections, the pixel data is not used. */
+  void SetProjectionsInformation(const ProjectionsInformationType *projections);
+
+  /** Get / Set the size of the bricks of the copy of the volume, see
+   * rtk::BrickedImageBuffer. Default is 8, 0 uses the buffer of the volume. */
+  itkGetMacro(BrickSize, unsigned int);
+  itkSetMacro(BrickSize, unsigned int);
+
+  /** Get / Set the size of the cells of the empty space skipping grid, see
+   * rtk::JosephForwardProjectionImageFilter. Default is 0, i.e., no empty
+   * space skipping. */
+  itkGetMacro(EmptySpaceCellSize, unsigned int);
+  itkSetMacro(EmptySpaceCellSize, unsigned int);
+
+  /** Get / Set the threshold of empty voxels, see EmptySpaceCellSize.
+   * Default is 0. */
+  itkGetMacro(EmptySpaceThreshold, double);
+  itkSetMacro(EmptySpaceThreshold, double);
+
+  /** Get/Set the functors, see rtk::JosephForwardProjectionImageFilter. */
+  TInterpolationWeightMultiplication &       GetInterpolationWeightMultiplication() { return m_InterpolationWeightMultiplication; }
+  const TInterpolationWeightMultiplication & GetInterpolationWeightMultiplication() const { return m_InterpolationWeightMultiplication; }
+  void SetInterpolationWeightMultiplication(const TInterpolationWeightMultiplication & _arg)
+    {
+    if ( m_InterpolationWeightMultiplication != _arg )
+      {
+      m_InterpolationWeightMultiplication = _arg;
+      this->Modified();
+      }
+    }
+  TProjectedValueAccumulation &       GetProjectedValueAccumulation() { return m_ProjectedValueAccumulation; }
+  const TProjectedValueAccumulation & GetProjectedValueAccumulation() const { return m_ProjectedValueAccumulation; }
+  void SetProjectedValueAccumulation(const TProjectedValueAccumulation & _arg)
+    {
+    if ( m_ProjectedValueAccumulation != _arg )
+      {
+      m_ProjectedValueAccumulation = _arg;
+      this->Modified();
+      }
+    }
+  TSumAlongRay &       GetSumAlongRay() { return m_SumAlongRay; }
+  const TSumAlongRay & GetSumAlongRay() const { return m_SumAlongRay; }
+  void SetSumAlongRay(const TSumAlongRay & _arg)
+    {
+    if ( m_SumAlongRay != _arg )
+      {
+      m_SumAlongRay = _arg;
+      this->Modified();
+      }
+    }
+
+  /** Get / Set the indices of the pixels to compute. An empty list, the
+   * default, selects all pixels of the projections. */
+  const PixelIndicesType &GetPixels() const { return m_Pixels; }
+  void SetPixels(const PixelIndicesType &pixels);
+
+  /** Number of pixels computed for each transform. */
+  unsigned int GetNumberOfPixels() const;
+
+  /** Computes the DRR pixels for each transform. On return, values has
+   * transforms.size() times GetNumberOfPixels() elements and the value of
+   * pixel p for transform t is values[t*GetNumberOfPixels()+p]. */
+  void Compute(const TransformsType &transforms, std::vector<float> &values);
+
+protected:
+  DRRGenerator() = default;
+  ~DRRGenerator() override = default;
+
+  /** Line integral, in mm times the volume values, between a pixel and the
+   * source, both given in voxel coordinates. threadId is passed to the
+   * functors. segments, nonEmptySegments and holes are buffers of the thread
+   * to avoid allocations for each ray. */
+  OutputPixelType IntegrateRay(const ThreadIdType threadId,
+                               const VectorType &pixelPosition,
+                               const VectorType &pixelToSource,
+                               RaySegmentsType &segments,
+                               RaySegmentsType &nonEmptySegments,
+                               RaySegmentsType &holes);
+
+#if ITK_VERSION_MAJOR<5
+  /** Calls the worker function given as user data of the multithreader with
+   * the thread id. */
+  static ITK_THREAD_RETURN_TYPE WorkerCallback(void *arg);
+#endif
+
+private:
+  // Functors
+  TInterpolationWeightMultiplication m_InterpolationWeightMultiplication;
+  TProjectedValueAccumulation        m_ProjectedValueAccumulation;
+  TSumAlongRay                       m_SumAlongRay;
+
+  typename VolumeImageType::ConstPointer        m_Volume;
+  GeometryType::ConstPointer                    m_Geometry;
+  ProjectionsInformationType::Pointer           m_ProjectionsInformation;
+  PixelIndicesType                              m_Pixels;
+  unsigned int                                  m_BrickSize{8};
+  BrickedImageBuffer<VolumeImageType>           m_BrickedVolume;
+  unsigned int                                  m_EmptySpaceCellSize{0};
+  double                                        m_EmptySpaceThreshold{0.};
+  EmptySpaceSkippingGrid<VolumeImageType>       m_EmptySpaceGrid;
+  BoxShape::Pointer                             m_Box;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkDRRGenerator.hxx"
+#endif
+
+#endif
@@ -0,0 +1,413 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkDRRGenerator_hxx
+#define rtkDRRGenerator_hxx
+
+#include "rtkDRRGenerator.h"
+#include "rtkHomogeneousMatrix.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+namespace rtk
+{
+
+template <class TVolumeImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+void
+DRRGenerator<TVolumeImage,
+             TInterpolationWeightMultiplication,
+             TProjectedValueAccumulation,
+             TSumAlongRay>
+::SetProjectionsInformation(const ProjectionsInformationType *projections)
+{
+  m_ProjectionsInformation = ProjectionsInformationType::New();
+  m_ProjectionsInformation->CopyInformation(projections);
+  this->Modified();
+}
+
+template <class TVolumeImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+void
+DRRGenerator<TVolumeImage,
+             TInterpolationWeightMultiplication,
+             TProjectedValueAccumulation,
+             TSumAlongRay>
+::SetPixels(const PixelIndicesType &pixels)
+{
+  m_Pixels = pixels;
+  this->Modified();
+}
+
+template <class TVolumeImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+unsigned int
+DRRGenerator<TVolumeImage,
+             TInterpolationWeightMultiplication,
+             TProjectedValueAccumulation,
+             TSumAlongRay>
+::GetNumberOfPixels() const
+{
+  if(!m_Pixels.empty())
+    return m_Pixels.size();
+  if(m_ProjectionsInformation.GetPointer() == nullptr)
+    return 0;
+  return m_ProjectionsInformation->GetLargestPossibleRegion().GetNumberOfPixels();
+}
+
+template <class TVolumeImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+void
+DRRGenerator<TVolumeImage,
+             TInterpolationWeightMultiplication,
+             TProjectedValueAccumulation,
+             TSumAlongRay>
+::Compute(const TransformsType &transforms, std::vector<float> &values)
+{
+  if(m_Volume.GetPointer() == nullptr ||
+     m_Geometry.GetPointer() == nullptr ||
+     m_ProjectionsInformation.GetPointer() == nullptr)
+    {
+    itkExceptionMacro(<< "The volume, the geometry and the projections information must be set.");
+    }
+  const unsigned int nProj = m_Geometry->GetGantryAngles().size();
+  if(nProj == 0 ||
+     m_Geometry->GetSourceToDetectorDistances()[0] == 0. ||
+     m_Geometry->GetRadiusCylindricalDetector() != 0.)
+    {
+    itkExceptionMacro(<< "Only cone-beam geometries with flat panels are supported.");
+    }
+
+  // Pixels to compute
+  PixelIndicesType allPixels;
+  if(m_Pixels.empty())
+    {
+    const typename ProjectionsInformationType::RegionType region = m_ProjectionsInformation->GetLargestPossibleRegion();
+    allPixels.reserve(region.GetNumberOfPixels());
+    PixelIndexType index;
+    for(unsigned int k=0; k<region.GetSize(2); k++)
+      for(unsigned int j=0; j<region.GetSize(1); j++)
+        for(unsigned int i=0; i<region.GetSize(0); i++)
+          {
+          index[0] = region.GetIndex(0) + i;
+          index[1] = region.GetIndex(1) + j;
+          index[2] = region.GetIndex(2) + k;
+          allPixels.push_back(index);
+          }
+    }
+  const PixelIndicesType &pixels = (m_Pixels.empty())?allPixels:m_Pixels;
+  for(const PixelIndexType &index : pixels)
+    {
+    if(index[2] < 0 || index[2] >= (itk::IndexValueType)nProj)
+      itkExceptionMacro(<< "Pixel " << index << " refers to a projection which is not in the geometry.");
+    }
+  const size_t nPixels = pixels.size();
+  values.resize(transforms.size() * nPixels);
+  if(values.empty())
+    return;
+
+  // Copy of the volume and grid of its empty cells, only redone if the
+  // volume has changed, and its box in voxel coordinates
+  m_BrickedVolume.SetImage(m_Volume, m_BrickSize);
+  if(m_EmptySpaceCellSize == 1)
+    {
+    itkExceptionMacro(<< "The cells of the empty space skipping grid must be larger than one voxel");
+    }
+  if(m_EmptySpaceCellSize != 0)
+    m_EmptySpaceGrid.SetImage(m_Volume, m_EmptySpaceCellSize, m_EmptySpaceThreshold);
+  m_Box = BoxShape::New();
+  VectorType boxMin, boxMax;
+  for(unsigned int i=0; i<3; i++)
+    {
+    boxMin[i] = m_Volume->GetBufferedRegion().GetIndex()[i];
+    boxMax[i] = m_Volume->GetBufferedRegion().GetIndex()[i] +
+                m_Volume->GetBufferedRegion().GetSize()[i] - 1;
+    boxMax[i] *= 1.-itk::NumericTraits<BoxShape::ScalarType>::epsilon();
+    }
+  m_Box->SetBoxMin(boxMin);
+  m_Box->SetBoxMax(boxMax);
+
+  // Projection coordinates of the pixels, moved to the positions where their
+  // values have been measured if the detector has a displacement field
+  const GeometryType::ThreeDHomogeneousMatrixType projIndexToPP = GetIndexToPhysicalPointMatrix(m_ProjectionsInformation.GetPointer());
+  std::vector<VectorType> pixelCoordinates(nPixels);
+  for(size_t p=0; p<nPixels; p++)
+    {
+    for(unsigned int i=0; i<3; i++)
+      {
+      pixelCoordinates[p][i] = projIndexToPP[i][3];
+      for(unsigned int j=0; j<3; j++)
+        pixelCoordinates[p][i] += projIndexToPP[i][j] * pixels[p][j];
+      }
+    m_Geometry->ApplyDetectorDisplacement(pixelCoordinates[p][0], pixelCoordinates[p][1]);
+    }
+
+  // For each transform and projection, source position and matrix from the
+  // projection coordinates of a pixel to its position, in voxel coordinates.
+  // The transform maps the points of the geometry to the points of the
+  // volume.
+  using MatrixType = itk::Matrix<double, 3, 4>;
+  std::vector<MatrixType> pixelMatrices(transforms.size() * nProj);
+  std::vector<VectorType> sources(transforms.size() * nProj);
+  const GeometryType::ThreeDHomogeneousMatrixType volPPToIndex = GetPhysicalPointToIndexMatrix(m_Volume.GetPointer());
+  for(unsigned int t=0; t<transforms.size(); t++)
+    {
+    GeometryType::ThreeDHomogeneousMatrixType transformMatrix;
+    transformMatrix.SetIdentity();
+    for(unsigned int i=0; i<3; i++)
+      {
+      for(unsigned int j=0; j<3; j++)
+        transformMatrix[i][j] = transforms[t]->GetMatrix()[i][j];
+      transformMatrix[i][3] = transforms[t]->GetOffset()[i];
+      }
+    const GeometryType::ThreeDHomogeneousMatrixType postMat4 = volPPToIndex * transformMatrix;
+    MatrixType postMat;
+    for(unsigned int i=0; i<3; i++)
+      for(unsigned int j=0; j<4; j++)
+        postMat[i][j] = postMat4[i][j];
+
+    for(unsigned int p=0; p<nProj; p++)
+      {
+      sources[t*nProj+p] = postMat * m_Geometry->GetSourcePosition(p);
+      pixelMatrices[t*nProj+p] = MatrixType( postMat.GetVnlMatrix() *
+                                             m_Geometry->GetProjectionCoordinatesToFixedSystemMatrix(p).GetVnlMatrix() );
+      }
+    }
+
+  // The work units of the ITK multithreader take chunks of rays, ordered by
+  // transform, until all have been computed. The index of the work unit is
+  // the thread id of the functors.
+  const size_t nRays = values.size();
+  const size_t chunkSize = 256;
+  std::atomic<size_t> next(0);
+  std::function<void(ThreadIdType)> worker = [&](ThreadIdType threadId)
+    {
+    RaySegmentsType segments, nonEmptySegments, holes;
+    for(size_t begin = next.fetch_add(chunkSize); begin < nRays; begin = next.fetch_add(chunkSize))
+      {
+      const size_t end = std::min(begin + chunkSize, nRays);
+      for(size_t r=begin; r<end; r++)
+        {
+        const size_t p = r % nPixels;
+        const size_t m = (r / nPixels) * nProj + pixels[p][2];
+        const MatrixType &matrix = pixelMatrices[m];
+        VectorType pixelPosition;
+        for(unsigned int i=0; i<3; i++)
+          {
+          pixelPosition[i] = matrix[i][3];
+          for(unsigned int j=0; j<3; j++)
+            pixelPosition[i] += matrix[i][j] * pixelCoordinates[p][j];
+          }
+        values[r] = this->IntegrateRay(threadId, pixelPosition, sources[m] - pixelPosition,
+                                       segments, nonEmptySegments, holes);
+        }
+      }
+    };
+#if ITK_VERSION_MAJOR<5
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( ThreadIdType(std::min(size_t(threader->GetNumberOfThreads()),
+                                                      (nRays + chunkSize - 1) / chunkSize)) );
+  threader->SetSingleMethod(&Self::WorkerCallback, &worker);
+  threader->SingleMethodExecute();
+#else
+  itk::MultiThreaderBase::Pointer threader = itk::MultiThreaderBase::New();
+  const itk::SizeValueType nWorkUnits = std::min(size_t(threader->GetNumberOfWorkUnits()),
+                                                 (nRays + chunkSize - 1) / chunkSize);
+  threader->ParallelizeArray(0, nWorkUnits,
+                             [&worker](itk::SizeValueType workUnit) { worker(ThreadIdType(workUnit)); },
+                             nullptr);
+#endif
+}
+
+#if ITK_VERSION_MAJOR<5
+template <class TVolumeImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+ITK_THREAD_RETURN_TYPE
+DRRGenerator<TVolumeImage,
+             TInterpolationWeightMultiplication,
+             TProjectedValueAccumulation,
+             TSumAlongRay>
+::WorkerCallback(void *arg)
+{
+  auto *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  (*static_cast<std::function<void(ThreadIdType)> *>(info->UserData))(info->ThreadID);
+  return ITK_THREAD_RETURN_VALUE;
+}
+#endif
+
+template <class TVolumeImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+typename DRRGenerator<TVolumeImage,
+             TInterpolationWeightMultiplication,
+             TProjectedValueAccumulation,
+             TSumAlongRay>::OutputPixelType
+DRRGenerator<TVolumeImage,
+             TInterpolationWeightMultiplication,
+             TProjectedValueAccumulation,
+             TSumAlongRay>
+::IntegrateRay(const ThreadIdType threadId,
+               const VectorType &pixelPosition,
+               const VectorType &dirVox,
+               RaySegmentsType &segments,
+               RaySegmentsType &nonEmptySegments,
+               RaySegmentsType &holes)
+{
+  // Select main direction and the other two directions
+  unsigned int mainDir = 0;
+  for(unsigned int i=1; i<3; i++)
+    if(itk::Math::abs(dirVox[i]) > itk::Math::abs(dirVox[mainDir]))
+      mainDir = i;
+  unsigned int notMainDirInf = (mainDir+1)%3;
+  unsigned int notMainDirSup = (mainDir+2)%3;
+  if(notMainDirInf>notMainDirSup)
+    std::swap(notMainDirInf, notMainDirSup);
+
+  // Compute step size and its length in mm
+  const double norm = 1/dirVox[mainDir];
+  const double stepx = dirVox[notMainDirInf] * norm;
+  const double stepy = dirVox[notMainDirSup] * norm;
+  VectorType stepMM;
+  stepMM[notMainDirInf] = m_Volume->GetSpacing()[notMainDirInf] * stepx;
+  stepMM[notMainDirSup] = m_Volume->GetSpacing()[notMainDirSup] * stepy;
+  stepMM[mainDir]       = m_Volume->GetSpacing()[mainDir];
+
+  // Test if there is an intersection between the source and the pixel
+  const OutputPixelType input = itk::NumericTraits<OutputPixelType>::ZeroValue();
+  OutputPixelType output = input;
+  double nearDist, farDist;
+  if( !m_Box->IsIntersectedByRay(pixelPosition, dirVox, nearDist, farDist) ||
+      farDist<0. ||
+      nearDist>1.)
+    {
+    m_ProjectedValueAccumulation(threadId, input, output, 0., stepMM,
+                                 pixelPosition, dirVox, pixelPosition, pixelPosition);
+    return output;
+    }
+  nearDist = std::max(nearDist, 0.);
+  farDist = std::min(farDist, 1.);
+
+  const double minx = m_Box->GetBoxMin()[notMainDirInf];
+  const double miny = m_Box->GetBoxMin()[notMainDirSup];
+  const double maxx = m_Box->GetBoxMax()[notMainDirInf];
+  const double maxy = m_Box->GetBoxMax()[notMainDirSup];
+
+  const VolumePixelType *beginBuffer = m_BrickedVolume.GetBeginBuffer();
+  const int *offsetx = m_BrickedVolume.GetOffsets(notMainDirInf);
+  const int *offsety = m_BrickedVolume.GetOffsets(notMainDirSup);
+  const int *offsetz = m_BrickedVolume.GetOffsets(mainDir);
+
+  // Skip the slices of the ray in empty cells
+  segments.clear();
+  segments.push_back(std::make_pair(nearDist, farDist));
+  if(m_EmptySpaceCellSize != 0)
+    {
+    m_EmptySpaceGrid.RemoveEmptySpace(pixelPosition, dirVox, mainDir, segments, nonEmptySegments, holes);
+    segments.swap(nonEmptySegments);
+    }
+
+  // Go over the segments in the order of increasing main direction slices
+  using InterpolationType = TInterpolationWeightMultiplication;
+  OutputPixelType sum = itk::NumericTraits<OutputPixelType>::ZeroValue();
+  VectorType np, fp;
+  for(unsigned int s=0; s<segments.size(); s++)
+    {
+    const unsigned int seg = (dirVox[mainDir]<0.)?segments.size()-1-s:s;
+
+    // Nearest and farthest points of the segment along the main direction
+    np = pixelPosition + segments[seg].first * dirVox;
+    fp = pixelPosition + segments[seg].second * dirVox;
+    if(np[mainDir]>fp[mainDir])
+      std::swap(np, fp);
+    const int ns = itk::Math::rnd( np[mainDir]);
+    const int fs = itk::Math::rnd( fp[mainDir]);
+
+    // Go to first voxel
+    const double residual = ns - np[mainDir];
+    double currentx = np[notMainDirInf] + residual * stepx;
+    double currenty = np[notMainDirSup] + residual * stepy;
+
+    if (fs == ns) //If the voxel is a corner, we can skip most steps
+      {
+      sum += m_SumAlongRay(threadId,
+                           Functor::JosephBilinearInterpolationOnBorders<InterpolationType, VolumePixelType, OutputPixelType>
+                             (m_InterpolationWeightMultiplication, threadId, fp[mainDir] - np[mainDir],
+                              beginBuffer + offsetz[ns], currentx, currenty, offsetx, offsety,
+                              minx, miny, maxx, maxy),
+                           stepMM);
+      }
+    else
+      {
+      // First step
+      sum += m_SumAlongRay(threadId,
+                           Functor::JosephBilinearInterpolationOnBorders<InterpolationType, VolumePixelType, OutputPixelType>
+                             (m_InterpolationWeightMultiplication, threadId, residual + 0.5,
+                              beginBuffer + offsetz[ns], currentx, currenty, offsetx, offsety,
+                              minx, miny, maxx, maxy),
+                           stepMM);
+      currentx += stepx;
+      currenty += stepy;
+
+      // Middle steps
+      for(int i=ns+1; i<fs; i++)
+        {
+        sum += m_SumAlongRay(threadId,
+                             Functor::JosephBilinearInterpolation<InterpolationType, VolumePixelType, OutputPixelType>
+                               (m_InterpolationWeightMultiplication, threadId, 1.0,
+                                beginBuffer + offsetz[i], currentx, currenty, offsetx, offsety),
+                             stepMM);
+        currentx += stepx;
+        currenty += stepy;
+        }
+
+      // Last step
+      sum += m_SumAlongRay(threadId,
+                           Functor::JosephBilinearInterpolationOnBorders<InterpolationType, VolumePixelType, OutputPixelType>
+                             (m_InterpolationWeightMultiplication, threadId, fp[mainDir] - fs + 0.5,
+                              beginBuffer + offsetz[fs], currentx, currenty, offsetx, offsety,
+                              minx, miny, maxx, maxy),
+                           stepMM);
+      }
+    }
+
+  // Nearest and farthest points of the whole ray for the accumulation
+  np = pixelPosition + nearDist * dirVox;
+  fp = pixelPosition + farDist * dirVox;
+  if(np[mainDir]>fp[mainDir])
+    std::swap(np, fp);
+
+  m_ProjectedValueAccumulation(threadId, input, output, sum, stepMM, pixelPosition, dirVox, np, fp);
+  return output;
+}
+
+} // end namespace rtk
+
+#endif
@@ -55,6 +55,7 @@ DrawBoxImageFilter<TInputImage, TOutputImage>
   qo->SetClipPlanes( this->GetPlaneDirections(), this->GetPlanePositions() );
   qo->SetBoxMin(this->GetBoxMin());
   qo->SetBoxMax(this->GetBoxMax());
+  qo->SetDirection(this->GetDirection());
 }
 
 template <class TInputImage, class TOutputImage>
@@ -79,8 +80,8 @@ DrawBoxImageFilter<TInputImage,TOutputImage>
     itkExceptionMacro("This is not a BoxShape!");
     }
   qo->SetBoxFromImage(_arg, bWithExternalHalfPixelBorder);
-  SetBoxMin(qo->GetBoxMin());
-  SetBoxMax(qo->GetBoxMin());
+  SetBoxMin(qo->GetBoxMin().GetVectorFromOrigin());
+  SetBoxMax(qo->GetBoxMax().GetVectorFromOrigin());
   SetDirection(qo->GetDirection());
 }
 
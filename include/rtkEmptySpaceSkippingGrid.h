@@ -0,0 +1,268 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkEmptySpaceSkippingGrid_h
+#define rtkEmptySpaceSkippingGrid_h
+
+#include "rtkNestedVolumesRaySegments.h"
+
+#include <itkImage.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class EmptySpaceSkippingGrid
+ * \brief Grid of macro-cells of a 3D image flagging the empty parts of space
+ * for the Joseph forward projector.
+ *
+ * The buffered region of the image is divided in cubic cells of CellSize^3
+ * voxels. A cell is empty if all the voxels of the cell and of its
+ * neighbors in the positive direction of each axis have an absolute value
+ * lower than or equal to the threshold, i.e., if the bilinear
+ * interpolations in the main direction slices crossing the cell only read
+ * such voxels.
+ *
+ * RemoveEmptySpace traverses the cells along a ray and removes from its
+ * segments the main direction slices whose sample is in a run of empty
+ * cells. Only whole slices are removed so that, with a threshold of 0, the
+ * Joseph projection of the remaining segments is exactly the one of the
+ * input segments if the projection of zero-valued voxels is zero, e.g., with
+ * Functor::InterpolationWeightMultiplication and Functor::SumAlongRay.
+ *
+ * The grid is only updated if the image, its buffered region, its update
+ * time, the cell size or the threshold have changed since the last call to
+ * SetImage. Only scalar pixel types are supported, no cell is empty
+ * otherwise.
+ *
+ * \ingroup RTK
+ */
+template <class TImage>
+class EmptySpaceSkippingGrid
+{
+public:
+  using PixelType = typename TImage::PixelType;
+  using RegionType = typename TImage::RegionType;
+  using PointType = BoxShape::PointType;
+  using VectorType = BoxShape::VectorType;
+  static constexpr unsigned int Dimension = TImage::ImageDimension;
+
+  /** Set the image, the size of the cells and the threshold below which
+   * voxels are considered as empty. */
+  void SetImage(const TImage *img, unsigned int cellSize, double threshold)
+  {
+    const RegionType region = img->GetBufferedRegion();
+    if(m_Image == img &&
+       m_CellSize == cellSize &&
+       m_Threshold == threshold &&
+       m_Region == region &&
+       m_UpdateMTime == img->GetUpdateMTime())
+      return;
+    m_Image = img;
+    m_CellSize = cellSize;
+    m_Threshold = threshold;
+    m_Region = region;
+    m_UpdateMTime = img->GetUpdateMTime();
+
+    for(unsigned int d=0; d<Dimension; d++)
+      {
+      m_RegionIndex[d] = region.GetIndex()[d];
+      m_NumberOfCells[d] = (region.GetSize()[d] + cellSize - 1) / cellSize;
+      }
+    const unsigned int nCells = m_NumberOfCells[0] * m_NumberOfCells[1] * m_NumberOfCells[2];
+
+    // Cells whose voxels are all below the threshold
+    std::vector<bool> belowThreshold(nCells, std::is_arithmetic<PixelType>::value);
+    if(std::is_arithmetic<PixelType>::value)
+      {
+      itk::ImageRegionConstIteratorWithIndex<TImage> it(img, region);
+      for(; !it.IsAtEnd(); ++it)
+        {
+        if(GetMagnitude(it.Get()) > threshold)
+          {
+          unsigned int c[Dimension];
+          for(unsigned int d=0; d<Dimension; d++)
+            c[d] = (it.GetIndex()[d] - m_RegionIndex[d]) / cellSize;
+          belowThreshold[this->GetCellOffset(c)] = false;
+          }
+        }
+      }
+
+    // Dilation with the neighbors in the positive directions which are read
+    // by the bilinear interpolation at the upper borders of the cell
+    m_Empty.assign(nCells, false);
+    unsigned int c[Dimension];
+    for(c[2]=0; c[2]<m_NumberOfCells[2]; c[2]++)
+      for(c[1]=0; c[1]<m_NumberOfCells[1]; c[1]++)
+        for(c[0]=0; c[0]<m_NumberOfCells[0]; c[0]++)
+          {
+          bool empty = true;
+          unsigned int n[Dimension];
+          for(unsigned int k=0; k<(1u<<Dimension) && empty; k++)
+            {
+            for(unsigned int d=0; d<Dimension; d++)
+              n[d] = std::min(c[d] + ((k>>d)&1), m_NumberOfCells[d]-1);
+            empty = belowThreshold[this->GetCellOffset(n)];
+            }
+          m_Empty[this->GetCellOffset(c)] = empty;
+          }
+  }
+
+  /** Remove from the segments of the ray origin+t*direction, in continuous
+   * index coordinates and sorted by increasing t, the main direction slices
+   * which are in empty cells. The output segments are sorted by increasing
+   * t. holes is a buffer provided by the caller to avoid one allocation per
+   * ray. */
+  void RemoveEmptySpace(const PointType &origin,
+                        const VectorType &direction,
+                        const unsigned int mainDir,
+                        const RaySegmentsType &inputSegments,
+                        RaySegmentsType &outputSegments,
+                        RaySegmentsType &holes) const
+  {
+    outputSegments.clear();
+    for(const std::pair<double, double> &segment : inputSegments)
+      {
+      this->ComputeEmptyRuns(origin, direction, segment.first, segment.second, holes);
+
+      // Keep the gaps between the whole slices of the empty runs
+      double current = segment.first;
+      for(const std::pair<double, double> &run : holes)
+        {
+        double z1 = origin[mainDir] + run.first * direction[mainDir];
+        double z2 = origin[mainDir] + run.second * direction[mainDir];
+        if(z1>z2)
+          std::swap(z1, z2);
+        const double firstSlice = std::ceil(z1 + 0.5);
+        const double lastSlice = std::floor(z2 - 0.5);
+        if(firstSlice > lastSlice)
+          continue;
+        double holeNear = (firstSlice - 0.5 - origin[mainDir]) / direction[mainDir];
+        double holeFar = (lastSlice + 0.5 - origin[mainDir]) / direction[mainDir];
+        if(holeNear>holeFar)
+          std::swap(holeNear, holeFar);
+        if(holeNear>current)
+          outputSegments.push_back(std::make_pair(current, holeNear));
+        current = std::max(current, holeFar);
+        }
+      if(current<segment.second)
+        outputSegments.push_back(std::make_pair(current, segment.second));
+      }
+  }
+
+private:
+  template <class T>
+  static typename std::enable_if<std::is_arithmetic<T>::value, double>::type
+  GetMagnitude(const T &v) { return itk::Math::abs(static_cast<double>(v)); }
+
+  template <class T>
+  static typename std::enable_if<!std::is_arithmetic<T>::value, double>::type
+  GetMagnitude(const T &) { return std::numeric_limits<double>::infinity(); }
+
+  unsigned int GetCellOffset(const unsigned int *c) const
+  {
+    return c[0] + m_NumberOfCells[0] * (c[1] + m_NumberOfCells[1] * c[2]);
+  }
+
+  /** Traverse the cells between t=nearDist and t=farDist with a 3D DDA and
+   * collect the runs of consecutive empty cells. */
+  void ComputeEmptyRuns(const PointType &origin,
+                        const VectorType &direction,
+                        const double nearDist,
+                        const double farDist,
+                        RaySegmentsType &runs) const
+  {
+    runs.clear();
+    if(!(nearDist<farDist))
+      return;
+
+    int cell[Dimension], step[Dimension];
+    double tNext[Dimension], tDelta[Dimension];
+    for(unsigned int d=0; d<Dimension; d++)
+      {
+      const double g = (origin[d] + nearDist * direction[d] - m_RegionIndex[d]) / m_CellSize;
+      cell[d] = std::max(0, std::min(int(m_NumberOfCells[d])-1, int(itk::Math::floor(g))));
+      if(direction[d] > 0.)
+        {
+        step[d] = 1;
+        tNext[d] = (m_RegionIndex[d] + (cell[d]+1.) * m_CellSize - origin[d]) / direction[d];
+        tDelta[d] = m_CellSize / direction[d];
+        }
+      else if(direction[d] < 0.)
+        {
+        step[d] = -1;
+        tNext[d] = (m_RegionIndex[d] + cell[d] * double(m_CellSize) - origin[d]) / direction[d];
+        tDelta[d] = -(m_CellSize / direction[d]);
+        }
+      else
+        {
+        step[d] = 0;
+        tNext[d] = std::numeric_limits<double>::infinity();
+        tDelta[d] = std::numeric_limits<double>::infinity();
+        }
+      }
+
+    double t = nearDist;
+    bool inRun = false;
+    while(t < farDist)
+      {
+      unsigned int d = 0;
+      for(unsigned int i=1; i<Dimension; i++)
+        if(tNext[i]<tNext[d])
+          d = i;
+      const double tExit = std::min(tNext[d], farDist);
+
+      const unsigned int c[Dimension] = {unsigned(cell[0]), unsigned(cell[1]), unsigned(cell[2])};
+      if(m_Empty[this->GetCellOffset(c)])
+        {
+        if(inRun)
+          runs.back().second = tExit;
+        else
+          runs.push_back(std::make_pair(t, tExit));
+        inRun = true;
+        }
+      else
+        inRun = false;
+
+      t = tExit;
+      cell[d] += step[d];
+      if(cell[d] < 0 || cell[d] >= int(m_NumberOfCells[d]))
+        break;
+      tNext[d] += tDelta[d];
+      }
+  }
+
+  const TImage *         m_Image{nullptr};
+  unsigned int           m_CellSize{0};
+  double                 m_Threshold{0.};
+  RegionType             m_Region;
+  itk::ModifiedTimeType  m_UpdateMTime{0};
+  unsigned int           m_NumberOfCells[Dimension];
+  double                 m_RegionIndex[Dimension];
+  std::vector<bool>      m_Empty;
+};
+
+} // end namespace rtk
+
+#endif // rtkEmptySpaceSkippingGrid_h
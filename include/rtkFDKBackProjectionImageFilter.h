@@ -20,6 +20,9 @@
 #define rtkFDKBackProjectionImageFilter_h
 
 #include "rtkBackProjectionImageFilter.h"
+#include "rtkConvexFieldOfViewImageFilter.h"
+
+#include <limits>
 
 namespace rtk
 {
@@ -31,6 +34,13 @@ namespace rtk
  * [Feldkamp, Davis, Kress, 1984] algorithm for filtered backprojection
  * reconstruction of cone-beam CT images with a circular source trajectory.
  *
+ * With SkipOutsideFieldOfView, the voxels outside the field of view of all
+ * the projections of the geometry, computed with
+ * rtk::ConvexFieldOfViewImageFilter::ComputeRowSpans, are not backprojected
+ * and keep the value of input 0. This is only valid if these voxels are
+ * discarded after the reconstruction, e.g., with a field of view mask, and
+ * not with a displaced detector.
+ *
  * \author Simon Rit
  *
  * \ingroup RTK Projector
@@ -52,6 +62,8 @@ public:
   using OutputImageRegionType = typename TOutputImage::RegionType;
   using ProjectionImageType = typename Superclass::ProjectionImageType;
   using ProjectionImagePointer = typename ProjectionImageType::Pointer;
+  using FieldOfViewFilterType = ConvexFieldOfViewImageFilter<TOutputImage, TOutputImage>;
+  using RowSpanType = typename FieldOfViewFilterType::RowSpanType;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -59,12 +71,25 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(FDKBackProjectionImageFilter, ImageToImageFilter);
 
+  /** Get / Set if the voxels outside the field of view are skipped. Default
+   * is false. */
+  itkGetMacro(SkipOutsideFieldOfView, bool);
+  itkSetMacro(SkipOutsideFieldOfView, bool);
+  itkBooleanMacro(SkipOutsideFieldOfView);
+
 protected:
   FDKBackProjectionImageFilter() = default;
   ~FDKBackProjectionImageFilter() override = default;
 
+  /** Input 0 is only read by InitializeOutputRegion, also in the subclasses. */
+  bool SupportsImplicitConstantInput() const override { return true; }
+
   void GenerateOutputInformation() override;
 
+  /** Computes the spans of the rows of the requested region in the field of
+   * view if SkipOutsideFieldOfView is set. */
+  void BeforeThreadedGenerateData() override;
+
 #if ITK_VERSION_MAJOR<5
   void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) override;
 #else
@@ -81,6 +106,20 @@ protected:
   void OptimizedBackprojectionY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
                                         const ProjectionImagePointer projection) override;
 
+  /** Span of voxels of row (j,k) of the requested region which are
+   * backprojected. */
+  RowSpanType GetRowSpan(const itk::IndexValueType j, const itk::IndexValueType k) const
+    {
+    if(!m_SkipOutsideFieldOfView)
+      return RowSpanType(std::numeric_limits<itk::IndexValueType>::min(),
+                         std::numeric_limits<itk::IndexValueType>::max());
+    return m_RowSpans[(j - m_RowSpansRegion.GetIndex(1)) + (k - m_RowSpansRegion.GetIndex(2)) * m_RowSpansRegion.GetSize(1)];
+    }
+
+private:
+  bool                     m_SkipOutsideFieldOfView{false};
+  std::vector<RowSpanType> m_RowSpans;
+  OutputImageRegionType    m_RowSpansRegion;
 };
 
 } // end namespace rtk
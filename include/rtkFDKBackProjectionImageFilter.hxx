@@ -44,6 +44,24 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
   Superclass::GenerateOutputInformation();
 }
 
+template <class TInputImage, class TOutputImage>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  m_RowSpans.clear();
+  if(!m_SkipOutsideFieldOfView)
+    return;
+
+  typename FieldOfViewFilterType::Pointer fov = FieldOfViewFilterType::New();
+  fov->SetGeometry(this->m_Geometry);
+  fov->SetProjectionsStack(const_cast<TInputImage *>(this->GetInput(1)));
+  m_RowSpansRegion = this->GetOutput()->GetRequestedRegion();
+  fov->ComputeRowSpans(this->GetOutput(), m_RowSpansRegion, m_RowSpans);
+}
+
 /**
  * GenerateData performs the accumulation
  */
@@ -65,24 +83,13 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
   using InterpolatorType = itk::LinearInterpolateImageFunction< ProjectionImageType, double >;
   typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
 
-  // Iterators on volume input and output
-  using InputRegionIterator = itk::ImageRegionConstIterator<TInputImage>;
-  InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
+  // Iterator on volume output
   using OutputRegionIterator = itk::ImageRegionIteratorWithIndex<TOutputImage>;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
   // Initialize output region with input region in case the filter is not in
   // place
-  if(this->GetInput() != this->GetOutput() )
-    {
-    itIn.GoToBegin();
-    while(!itIn.IsAtEnd() )
-      {
-      itOut.Set(itIn.Get() );
-      ++itIn;
-      ++itOut;
-      }
-    }
+  this->InitializeOutputRegion(outputRegionForThread);
 
   // Rotation center (assumed to be at 0 yet)
   typename TInputImage::PointType rotCenterPoint;
@@ -93,6 +100,12 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
   // Continuous index at which we interpolate
   itk::ContinuousIndex<double, Dimension-1> pointProj;
 
+  // Conversion between projection coordinates and projection indices for the
+  // detector displacement field
+  const bool distorted = (this->m_Geometry->GetDetectorDisplacementField() != nullptr);
+  const itk::Matrix<double, Dimension, Dimension> projCoordToIndex = this->GetProjectionCoordinatesToProjectionIndexMatrix();
+  const itk::Matrix<double, Dimension, Dimension> projIndexToCoord( projCoordToIndex.GetInverse() );
+
   // Go over each projection
   for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
     {
@@ -110,12 +123,12 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
     matrix /= perspFactor;
 
     // Optimized version
-    if (fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
+    if (!distorted && fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
       {
       OptimizedBackprojectionX( outputRegionForThread, matrix, projection);
       continue;
       }
-    if (fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
+    if (!distorted && fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
       {
       OptimizedBackprojectionY( outputRegionForThread, matrix, projection);
       continue;
@@ -125,6 +138,14 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
     itOut.GoToBegin();
     while(!itOut.IsAtEnd() )
       {
+      // Skip the voxels outside the field of view
+      const RowSpanType span = GetRowSpan(itOut.GetIndex()[1], itOut.GetIndex()[2]);
+      if(itOut.GetIndex()[0] < span.first || itOut.GetIndex()[0] > span.second)
+        {
+        ++itOut;
+        continue;
+        }
+
       // Compute projection index
       for(unsigned int i=0; i<Dimension-1; i++)
         {
@@ -141,6 +162,10 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
       for(unsigned int i=0; i<Dimension-1; i++)
         pointProj[i] = pointProj[i]*perspFactor_local;
 
+      // Nominal position of the pixels measured at this position
+      if(distorted)
+        this->ApplyInverseDetectorDisplacement(pointProj, projCoordToIndex, projIndexToCoord);
+
       // Interpolate if in projection
       if( interpolator->IsInsideBuffer(pointProj) )
         {
@@ -178,7 +203,12 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
     {
     for(int j=region.GetIndex(1); j<region.GetIndex(1)+(int)region.GetSize(1); j++)
       {
-      int i = region.GetIndex(0);
+      // Voxels of the row in the field of view, [i, iEnd)
+      const RowSpanType span = GetRowSpan(j, k);
+      int i = std::max<itk::IndexValueType>(region.GetIndex(0), span.first);
+      const int iEnd = std::min<itk::IndexValueType>(region.GetIndex(0) + (int)region.GetSize(0) - 1, span.second) + 1;
+      if(i >= iEnd)
+        continue;
       u = matrix[0][0] * i + matrix[0][1] * j + matrix[0][2] * k + matrix[0][3];
       v =                    matrix[1][1] * j + matrix[1][2] * k + matrix[1][3];
       w =                    matrix[2][1] * j + matrix[2][2] * k + matrix[2][3];
@@ -207,7 +237,7 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
         pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
 
         // Innermost loop
-        for(; i<(region.GetIndex(0) + (int)region.GetSize(0)); i++, u += du, pVol++)
+        for(; i<iEnd; i++, u += du, pVol++)
           {
 #ifdef BILINEAR_BACKPROJECTION
           ui = itk::Math::floor(u);
@@ -281,6 +311,10 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
         pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
         for(; j<(region.GetIndex(1) + (int)region.GetSize(1)); j++, pVol += vBufferSize[0], u += du)
           {
+          // Skip the voxels outside the field of view
+          const RowSpanType span = GetRowSpan(j, k);
+          if(i < span.first || i > span.second)
+            continue;
 #ifdef BILINEAR_BACKPROJECTION
           ui = itk::Math::floor(u);
           if(ui>=0 && ui<(int)pSize[0]-1)
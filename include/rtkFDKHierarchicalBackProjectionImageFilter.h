@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkFDKHierarchicalBackProjectionImageFilter_h
+#define rtkFDKHierarchicalBackProjectionImageFilter_h
+
+#include "rtkFDKBackProjectionImageFilter.h"
+
+#include <itkImageRegion.h>
+
+#include <memory>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class FDKHierarchicalBackProjectionImageFilter
+ * \brief Hierarchical fast backprojection of the FDK algorithm.
+ *
+ * The volume is recursively split in octants down to sub-volumes of
+ * LeafSize voxels which are backprojected voxel by voxel as in
+ * rtk::FDKBackProjectionImageFilter. A sub-volume of D voxels only requires
+ * a number of views proportional to D. When the number of views of its
+ * parent is larger than 2 x AngularOversampling x D, pairs of neighbor views
+ * (in gantry angle) are merged in a single view for the sub-volume: each
+ * pixel of the merged view is the weighted sum of the two parent views at the
+ * point where its ray intersects the plane through the center of the
+ * sub-volume parallel to the detector. The merged view has the projection
+ * matrix of the central projection of the merged ones and only covers the
+ * footprint of the sub-volume. With P projections of N^2 pixels and a N^3
+ * volume, the complexity is O(N^3 log N) instead of O(N^3 P).
+ *
+ * The approximation error grows with the product of the size of the
+ * sub-volumes and of the angular range of the merged views. It is controlled
+ * with AngularOversampling: the merging starts at smaller sub-volumes, i.e.,
+ * later and more accurately, when it is increased. Only the projections of
+ * the same input stack are merged so the ProjectionSubsetSize of
+ * rtk::FDKConeBeamReconstructionFilter must be large, ideally the number of
+ * projections, to benefit from the hierarchy. Cylindrical detectors are not
+ * handled.
+ *
+ * The hierarchy is built from the whole requested region of the output,
+ * its first levels once in BeforeThreadedGenerateData, and each thread only
+ * evaluates the sub-volumes which intersect its region. The merged views of
+ * a voxel, and therefore the result, do not depend on the number of threads.
+ *
+ * \test rtkfdktest.cxx
+ *
+ * \ingroup RTK Projector
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT FDKHierarchicalBackProjectionImageFilter :
+  public FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(FDKHierarchicalBackProjectionImageFilter);
+
+  /** Standard class type alias. */
+  using Self = FDKHierarchicalBackProjectionImageFilter;
+  using Superclass = FDKBackProjectionImageFilter<TInputImage,TOutputImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  using ProjectionMatrixType = typename Superclass::ProjectionMatrixType;
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using InternalPixelType = typename TInputImage::InternalPixelType;
+  using DetectorRegionType = itk::ImageRegion<2>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(FDKHierarchicalBackProjectionImageFilter, FDKBackProjectionImageFilter);
+
+  /** Get / Set the size in voxels under which sub-volumes are not split
+   * anymore and backprojected voxel by voxel. Default is 8. */
+  itkGetMacro(LeafSize, unsigned int);
+  itkSetMacro(LeafSize, unsigned int);
+
+  /** Get / Set the ratio between the number of views of a sub-volume and its
+   * size in voxels under which views are not merged anymore. Larger values
+   * are more accurate and slower. Default is 2. */
+  itkGetMacro(AngularOversampling, double);
+  itkSetMacro(AngularOversampling, double);
+
+protected:
+  FDKHierarchicalBackProjectionImageFilter() = default;
+  ~FDKHierarchicalBackProjectionImageFilter() override = default;
+
+  void BeforeThreadedGenerateData() override;
+
+  void AfterThreadedGenerateData() override;
+
+#if ITK_VERSION_MAJOR<5
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) override;
+#else
+  void DynamicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread) override;
+#endif
+
+  /** A projection or a merged view. Matrix maps the volume index to the
+   * detector index and is normalized to have a backprojection weight of 1 at
+   * the isocenter. Pixel (u,v) of Region is stored at
+   * Buffer[u-Region.GetIndex(0) + (v-Region.GetIndex(1))*Region.GetSize(0)].
+   * First and Last are the range of sorted projections merged in the view. */
+  struct ViewType
+  {
+    ProjectionMatrixType                              Matrix;
+    const InternalPixelType *                         Buffer{nullptr};
+    DetectorRegionType                                Region;
+    std::shared_ptr< std::vector<InternalPixelType> > Data;
+    unsigned int                                      First{0};
+    unsigned int                                      Last{0};
+  };
+  using ViewSetType = std::vector<ViewType>;
+
+  /** A sub-volume of the hierarchy and its views. */
+  struct BoxViewsType
+  {
+    OutputImageRegionType Box;
+    ViewSetType           Views;
+  };
+
+  /** Recursively splits box and merges views before backprojecting the part
+   * of box in region. */
+  void BackProjectBox(const OutputImageRegionType &box,
+                      const ViewSetType &views,
+                      const OutputImageRegionType &region);
+
+  /** Splits box in halves along the dimensions larger than the leaf size,
+   * children is empty if box is a leaf. */
+  void SplitBox(const OutputImageRegionType &box, std::vector<OutputImageRegionType> &children) const;
+
+  /** Merges views for child if there are more than enough for its size.
+   * Returns false if views must be used unchanged for child. */
+  bool MergeChildViews(const OutputImageRegionType &child, const ViewSetType &views, ViewSetType &merged) const;
+
+  /** Voxel-based backprojection of views in box. */
+  void BackProjectViews(const OutputImageRegionType &box, const ViewSetType &views);
+
+  /** Merges pairs of consecutive views for box. Returns false if the
+   * footprint of box cannot be computed, e.g., if the source is inside. */
+  bool MergeViews(const OutputImageRegionType &box, const ViewSetType &views, ViewSetType &merged) const;
+
+  /** Computes the region of the detector covered by box with matrix. */
+  bool GetFootprint(const ProjectionMatrixType &matrix,
+                    const OutputImageRegionType &box,
+                    DetectorRegionType &footprint) const;
+
+  /** Bilinear interpolation in view, 0 outside. */
+  static double Interpolate(const ViewType &view, double u, double v);
+
+private:
+  unsigned int       m_LeafSize{8};
+  double             m_AngularOversampling{2.};
+
+  /** Projections of the input stack sorted by gantry angle */
+  ViewSetType        m_Views;
+  DetectorRegionType m_DetectorRegion;
+
+  /** First levels of the hierarchy of the requested region */
+  std::vector<BoxViewsType> m_Boxes;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkFDKHierarchicalBackProjectionImageFilter.hxx"
+#endif
+
+#endif
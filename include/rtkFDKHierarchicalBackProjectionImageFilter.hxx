@@ -0,0 +1,469 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkFDKHierarchicalBackProjectionImageFilter_hxx
+#define rtkFDKHierarchicalBackProjectionImageFilter_hxx
+
+#include "rtkFDKHierarchicalBackProjectionImageFilter.h"
+
+#include <itkMath.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+  if(this->m_Geometry->GetDetectorDisplacementField() != nullptr)
+    {
+    itkExceptionMacro(<< "The hierarchical backprojector does not handle detector displacement fields");
+    }
+
+  // Projections are read in the buffer of the stack, they are not transposed
+  this->SetTranspose(false);
+
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const TInputImage *stack = this->GetInput(1);
+  const unsigned int nProj = stack->GetLargestPossibleRegion().GetSize(Dimension-1);
+  const unsigned int iFirstProj = stack->GetLargestPossibleRegion().GetIndex(Dimension-1);
+  const unsigned int iFirstProjBuff = stack->GetBufferedRegion().GetIndex(Dimension-1);
+  for(unsigned int i=0; i<2; i++)
+    {
+    m_DetectorRegion.SetIndex(i, stack->GetBufferedRegion().GetIndex(i));
+    m_DetectorRegion.SetSize(i, stack->GetBufferedRegion().GetSize(i));
+    }
+  const size_t npixels = m_DetectorRegion.GetNumberOfPixels();
+
+  // Rotation center (assumed to be at 0 yet)
+  typename TInputImage::PointType rotCenterPoint;
+  rotCenterPoint.Fill(0.0);
+  itk::ContinuousIndex<double, Dimension> rotCenterIndex;
+  this->GetOutput()->TransformPhysicalPointToContinuousIndex(rotCenterPoint, rotCenterIndex);
+
+  // Neighbor views are merged, the projections are therefore sorted by angle
+  std::vector<unsigned int> order(nProj);
+  std::iota(order.begin(), order.end(), iFirstProj);
+  const std::vector<double> &angles = this->m_Geometry->GetGantryAngles();
+  std::stable_sort(order.begin(), order.end(),
+                   [&angles](unsigned int a, unsigned int b) { return angles[a] < angles[b]; });
+
+  m_Views.clear();
+  for(unsigned int iProj : order)
+    {
+    ViewType view;
+
+    // Index to index matrix normalized to have a correct backprojection weight
+    // (1 at the isocenter)
+    view.Matrix = this->GetIndexToIndexProjectionMatrix(iProj);
+    double perspFactor = view.Matrix[Dimension-1][Dimension];
+    for(unsigned int j=0; j<Dimension; j++)
+      perspFactor += view.Matrix[Dimension-1][j] * rotCenterIndex[j];
+    view.Matrix /= perspFactor;
+
+    view.Buffer = stack->GetBufferPointer() + (iProj-iFirstProjBuff) * npixels;
+    view.Region = m_DetectorRegion;
+    view.First = m_Views.size();
+    view.Last = m_Views.size();
+    m_Views.push_back(view);
+    }
+
+  // Expand the first levels of the hierarchy of the whole requested region
+  // until there are enough sub-volumes to balance the threads. The merged
+  // views only depend on the ancestors of each sub-volume.
+#if ITK_VERSION_MAJOR<5
+  const size_t minNumberOfBoxes = 8 * this->GetNumberOfThreads();
+#else
+  const size_t minNumberOfBoxes = 8 * this->GetNumberOfWorkUnits();
+#endif
+  m_Boxes.clear();
+  m_Boxes.push_back( BoxViewsType{this->GetOutput()->GetRequestedRegion(), m_Views} );
+  bool split = true;
+  while(split && m_Boxes.size() < minNumberOfBoxes)
+    {
+    split = false;
+    std::vector<BoxViewsType> next;
+    for(const BoxViewsType &parent : m_Boxes)
+      {
+      std::vector<OutputImageRegionType> children;
+      this->SplitBox(parent.Box, children);
+      if(children.empty())
+        {
+        next.push_back(parent);
+        continue;
+        }
+      split = true;
+      for(const OutputImageRegionType &child : children)
+        {
+        BoxViewsType boxViews;
+        boxViews.Box = child;
+        if( !this->MergeChildViews(child, parent.Views, boxViews.Views) )
+          boxViews.Views = parent.Views;
+        next.push_back(boxViews);
+        }
+      }
+    m_Boxes.swap(next);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::AfterThreadedGenerateData()
+{
+  Superclass::AfterThreadedGenerateData();
+
+  // Release the merged views
+  m_Boxes.clear();
+  m_Views.clear();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+#if ITK_VERSION_MAJOR<5
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+#else
+::DynamicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread)
+#endif
+{
+  // Initialize output region with input region in case the filter is not in
+  // place
+  this->InitializeOutputRegion(outputRegionForThread);
+
+  for(const BoxViewsType &boxViews : m_Boxes)
+    {
+    OutputImageRegionType part = boxViews.Box;
+    if( part.Crop(outputRegionForThread) )
+      this->BackProjectBox(boxViews.Box, boxViews.Views, outputRegionForThread);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::BackProjectBox(const OutputImageRegionType &box,
+                 const ViewSetType &views,
+                 const OutputImageRegionType &region)
+{
+  std::vector<OutputImageRegionType> children;
+  this->SplitBox(box, children);
+  if(children.empty())
+    {
+    OutputImageRegionType part = box;
+    if( part.Crop(region) )
+      this->BackProjectViews(part, views);
+    return;
+    }
+
+  for(const OutputImageRegionType &child : children)
+    {
+    OutputImageRegionType part = child;
+    if( !part.Crop(region) )
+      continue;
+
+    // Merge pairs of views if there are more than enough for the sub-volume
+    ViewSetType merged;
+    if( this->MergeChildViews(child, views, merged) )
+      this->BackProjectBox(child, merged, region);
+    else
+      this->BackProjectBox(child, views, region);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::SplitBox(const OutputImageRegionType &box, std::vector<OutputImageRegionType> &children) const
+{
+  const unsigned int Dimension = TOutputImage::ImageDimension;
+  const unsigned int leafSize = std::max(m_LeafSize, 1u);
+
+  children.clear();
+  unsigned int maxSize = 0;
+  for(unsigned int i=0; i<Dimension; i++)
+    maxSize = std::max(maxSize, static_cast<unsigned int>(box.GetSize(i)));
+  if(maxSize <= leafSize)
+    return;
+
+  // Split in two halves the dimensions larger than the leaf size
+  unsigned int nHalves[Dimension];
+  for(unsigned int i=0; i<Dimension; i++)
+    nHalves[i] = (box.GetSize(i) > leafSize)?2:1;
+
+  itk::Index<Dimension> half;
+  for(half.Fill(0); half[Dimension-1]<(int)nHalves[Dimension-1];)
+    {
+    OutputImageRegionType child = box;
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      if(nHalves[i] == 2)
+        {
+        const typename OutputImageRegionType::SizeValueType firstHalf = box.GetSize(i) / 2;
+        child.SetIndex(i, box.GetIndex(i) + half[i] * firstHalf);
+        child.SetSize(i, (half[i])?box.GetSize(i)-firstHalf:firstHalf);
+        }
+      }
+    children.push_back(child);
+
+    // Next half
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      if(++half[i] < (int)nHalves[i] || i == Dimension-1)
+        break;
+      half[i] = 0;
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::MergeChildViews(const OutputImageRegionType &child, const ViewSetType &views, ViewSetType &merged) const
+{
+  unsigned int childMaxSize = 0;
+  for(unsigned int i=0; i<TOutputImage::ImageDimension; i++)
+    childMaxSize = std::max(childMaxSize, static_cast<unsigned int>(child.GetSize(i)));
+  return views.size() >= 2. * m_AngularOversampling * childMaxSize &&
+         this->MergeViews(child, views, merged);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::BackProjectViews(const OutputImageRegionType &box, const ViewSetType &views)
+{
+  typename TOutputImage::SizeType vBufferSize = this->GetOutput()->GetBufferedRegion().GetSize();
+  typename TOutputImage::IndexType vBufferIndex = this->GetOutput()->GetBufferedRegion().GetIndex();
+
+  // Pointer in memory to index (0,0,0) which does not necessarily exist
+  typename TOutputImage::PixelType *pVolZeroPointer = this->GetOutput()->GetBufferPointer();
+  pVolZeroPointer -= vBufferIndex[0] + vBufferSize[0] * (vBufferIndex[1] + vBufferSize[1] * vBufferIndex[2]);
+
+  for(const ViewType &view : views)
+    {
+    const ProjectionMatrixType &matrix = view.Matrix;
+    for(int k=box.GetIndex(2); k<box.GetIndex(2)+(int)box.GetSize(2); k++)
+      {
+      for(int j=box.GetIndex(1); j<box.GetIndex(1)+(int)box.GetSize(1); j++)
+        {
+        int i = box.GetIndex(0);
+        double u = matrix[0][0] * i + matrix[0][1] * j + matrix[0][2] * k + matrix[0][3];
+        double v = matrix[1][0] * i + matrix[1][1] * j + matrix[1][2] * k + matrix[1][3];
+        double w = matrix[2][0] * i + matrix[2][1] * j + matrix[2][2] * k + matrix[2][3];
+        typename TOutputImage::PixelType *pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+        for(; i<box.GetIndex(0)+(int)box.GetSize(0); i++, pVol++)
+          {
+          const double invw = 1./w;
+          *pVol += invw * invw * Interpolate(view, u*invw, v*invw);
+          u += matrix[0][0];
+          v += matrix[1][0];
+          w += matrix[2][0];
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::MergeViews(const OutputImageRegionType &box, const ViewSetType &views, ViewSetType &merged) const
+{
+  const unsigned int Dimension = TOutputImage::ImageDimension;
+  using MatrixType = itk::Matrix<double, Dimension, Dimension>;
+  using VectorType = itk::Vector<double, Dimension>;
+
+  // Center of box in index coordinates
+  VectorType center;
+  for(unsigned int i=0; i<Dimension; i++)
+    center[i] = box.GetIndex(i) + 0.5 * (box.GetSize(i) - 1.);
+
+  merged.clear();
+  for(size_t p=0; p<views.size(); p+=2)
+    {
+    // The last view is kept as is if the number of views is odd
+    if(p+1 == views.size())
+      {
+      merged.push_back(views[p]);
+      continue;
+      }
+
+    ViewType view;
+    view.First = views[p].First;
+    view.Last = views[p+1].Last;
+    view.Matrix = m_Views[(view.First + view.Last) / 2].Matrix;
+    if( !this->GetFootprint(view.Matrix, box, view.Region) )
+      return false;
+    if( view.Region.GetNumberOfPixels() == 0 )
+      continue;
+
+    // The ray of pixel (u,v) intersects the plane through the center of box
+    // parallel to the detector, i.e., with w equal to wc, at
+    // x = u * dxu + v * dxv + x0.
+    MatrixType a;
+    VectorType t;
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      t[i] = view.Matrix[i][Dimension];
+      for(unsigned int j=0; j<Dimension; j++)
+        a[i][j] = view.Matrix[i][j];
+      }
+    const double wc = (a * center)[Dimension-1] + t[Dimension-1];
+    const MatrixType aInv( a.GetInverse() );
+    VectorType dxu, dxv, x0;
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      dxu[i] = wc * aInv[i][0];
+      dxv[i] = wc * aInv[i][1];
+      x0[i] = wc * aInv[i][2];
+      }
+    x0 -= aInv * t;
+
+    view.Data = std::make_shared< std::vector<InternalPixelType> >(view.Region.GetNumberOfPixels(), 0.);
+    view.Buffer = view.Data->data();
+    for(size_t q=p; q<p+2; q++)
+      {
+      // Homography from the pixels of the merged view to the pixels of view q
+      const ProjectionMatrixType &m = views[q].Matrix;
+      double h[Dimension][Dimension];
+      for(unsigned int i=0; i<Dimension; i++)
+        {
+        h[i][0] = 0.;
+        h[i][1] = 0.;
+        h[i][2] = m[i][Dimension];
+        for(unsigned int j=0; j<Dimension; j++)
+          {
+          h[i][0] += m[i][j] * dxu[j];
+          h[i][1] += m[i][j] * dxv[j];
+          h[i][2] += m[i][j] * x0[j];
+          }
+        }
+
+      // Accumulate view q weighted by the ratio of the squared perspective
+      // factors of the merged view and of view q at x
+      InternalPixelType *pOut = view.Data->data();
+      const int u0 = view.Region.GetIndex(0);
+      const int v0 = view.Region.GetIndex(1);
+      for(int v=v0; v<v0+(int)view.Region.GetSize(1); v++)
+        {
+        double hu = h[0][0] * u0 + h[0][1] * v + h[0][2];
+        double hv = h[1][0] * u0 + h[1][1] * v + h[1][2];
+        double hw = h[2][0] * u0 + h[2][1] * v + h[2][2];
+        for(int u=u0; u<u0+(int)view.Region.GetSize(0); u++, pOut++)
+          {
+          if(hw > 0.)
+            {
+            const double invw = 1./hw;
+            const double weight = wc * wc * invw * invw;
+            *pOut += weight * Interpolate(views[q], hu*invw, hv*invw);
+            }
+          hu += h[0][0];
+          hv += h[1][0];
+          hw += h[2][0];
+          }
+        }
+      }
+    merged.push_back(view);
+    }
+  return true;
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::GetFootprint(const ProjectionMatrixType &matrix,
+               const OutputImageRegionType &box,
+               DetectorRegionType &footprint) const
+{
+  const unsigned int Dimension = TOutputImage::ImageDimension;
+  double inf[2] = { std::numeric_limits<double>::max(),  std::numeric_limits<double>::max()};
+  double sup[2] = {-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()};
+  for(unsigned int c=0; c<(1u<<Dimension); c++)
+    {
+    // Corner c of box, including the half voxel around the centers
+    double x[Dimension];
+    for(unsigned int i=0; i<Dimension; i++)
+      x[i] = box.GetIndex(i) - 0.5 + ((c>>i)&1) * box.GetSize(i);
+
+    double p[Dimension];
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      p[i] = matrix[i][Dimension];
+      for(unsigned int j=0; j<Dimension; j++)
+        p[i] += matrix[i][j] * x[j];
+      }
+    if(p[Dimension-1] <= 0.)
+      return false;
+    for(unsigned int i=0; i<2; i++)
+      {
+      inf[i] = std::min(inf[i], p[i] / p[Dimension-1]);
+      sup[i] = std::max(sup[i], p[i] / p[Dimension-1]);
+      }
+    }
+
+  // One pixel margin for the bilinear interpolation and two pixels beyond the
+  // projections for the neighbor views
+  DetectorRegionType detector = m_DetectorRegion;
+  detector.PadByRadius(2);
+  for(unsigned int i=0; i<2; i++)
+    {
+    const itk::IndexValueType first = itk::Math::Floor<itk::IndexValueType>(inf[i]) - 1;
+    const itk::IndexValueType last = itk::Math::Ceil<itk::IndexValueType>(sup[i]) + 1;
+    footprint.SetIndex(i, first);
+    footprint.SetSize(i, last-first+1);
+    }
+  if( !footprint.Crop(detector) )
+    {
+    footprint.SetSize(0, 0);
+    footprint.SetSize(1, 0);
+    }
+  return true;
+}
+
+template <class TInputImage, class TOutputImage>
+double
+FDKHierarchicalBackProjectionImageFilter<TInputImage,TOutputImage>
+::Interpolate(const ViewType &view, double u, double v)
+{
+  u -= view.Region.GetIndex(0);
+  v -= view.Region.GetIndex(1);
+  const int ui = itk::Math::Floor<int>(u);
+  const int vi = itk::Math::Floor<int>(v);
+  if(ui<0 || vi<0 || ui>=(int)view.Region.GetSize(0)-1 || vi>=(int)view.Region.GetSize(1)-1)
+    return 0.;
+
+  const double u1 = u-ui;
+  const double u2 = 1.0-u1;
+  const double v1 = v-vi;
+  const double v2 = 1.0-v1;
+  const InternalPixelType *p = view.Buffer + ui + vi * view.Region.GetSize(0);
+  return v2 * (u2 * p[0]                      + u1 * p[1]) +
+         v1 * (u2 * p[view.Region.GetSize(0)] + u1 * p[view.Region.GetSize(0)+1]);
+}
+
+} // end namespace rtk
+
+#endif
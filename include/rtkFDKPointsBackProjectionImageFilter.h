@@ -0,0 +1,103 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkFDKPointsBackProjectionImageFilter_h
+#define rtkFDKPointsBackProjectionImageFilter_h
+
+#include "rtkFDKBackProjectionImageFilter.h"
+
+#include <itkVector.h>
+
+namespace rtk
+{
+
+/** \class FDKPointsBackProjectionImageFilter
+ * \brief FDK backprojection at arbitrary points, e.g., on curved surfaces.
+ *
+ * Same backprojection as rtk::FDKBackProjectionImageFilter but each pixel
+ * of the output is backprojected at the physical point given by the
+ * corresponding pixel of the points image (third input), not at its
+ * position in the output grid. The output grid is therefore only a storage
+ * of the samples, e.g., a 2D grid with one slice for a curved panoramic
+ * reformat or a list of points with a grid of size Nx1x1. The cost is
+ * proportional to the number of samples. The filter can be set as the
+ * backprojection filter of rtk::FDKConeBeamReconstructionFilter, whose
+ * first input then gives the grid of the samples, to reconstruct the
+ * samples directly with the usual weighting and ramp filtering.
+ *
+ * Plane reformats, including oblique ones, do not need this filter: they
+ * can be reconstructed with rtk::FDKBackProjectionImageFilter on a grid of
+ * one slice with the adequate direction.
+ *
+ * \test rtkfdktest.cxx
+ *
+ * \ingroup RTK Projector
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT FDKPointsBackProjectionImageFilter :
+  public FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(FDKPointsBackProjectionImageFilter);
+
+  /** Standard class type alias. */
+  using Self = FDKPointsBackProjectionImageFilter;
+  using Superclass = FDKBackProjectionImageFilter<TInputImage,TOutputImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  using ProjectionMatrixType = typename Superclass::ProjectionMatrixType;
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using ProjectionImageType = typename Superclass::ProjectionImageType;
+  using ProjectionImagePointer = typename ProjectionImageType::Pointer;
+  using PointsImageType = itk::Image< itk::Vector<double, TOutputImage::ImageDimension>,
+                                      TOutputImage::ImageDimension >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(FDKPointsBackProjectionImageFilter, FDKBackProjectionImageFilter);
+
+  /** Set / Get the image of the physical coordinates of the samples. Its
+   * largest possible region must be the one of the first input. */
+  void SetPoints(const PointsImageType *points);
+  typename PointsImageType::ConstPointer GetPoints();
+
+protected:
+  FDKPointsBackProjectionImageFilter();
+  ~FDKPointsBackProjectionImageFilter() override = default;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateInputRequestedRegion() override;
+
+#if ITK_VERSION_MAJOR<5
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) override;
+#else
+  void DynamicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread) override;
+#endif
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkFDKPointsBackProjectionImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkFDKPointsBackProjectionImageFilter_hxx
+#define rtkFDKPointsBackProjectionImageFilter_hxx
+
+#include "rtkFDKPointsBackProjectionImageFilter.h"
+
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkLinearInterpolateImageFunction.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+FDKPointsBackProjectionImageFilter<TInputImage,TOutputImage>
+::FDKPointsBackProjectionImageFilter()
+{
+  this->SetNumberOfRequiredInputs(3);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKPointsBackProjectionImageFilter<TInputImage,TOutputImage>
+::SetPoints(const PointsImageType *points)
+{
+  this->SetNthInput(2, const_cast<PointsImageType*>(points));
+}
+
+template <class TInputImage, class TOutputImage>
+typename FDKPointsBackProjectionImageFilter<TInputImage,TOutputImage>::PointsImageType::ConstPointer
+FDKPointsBackProjectionImageFilter<TInputImage,TOutputImage>
+::GetPoints()
+{
+  return static_cast< const PointsImageType * >( this->itk::ProcessObject::GetInput(2) );
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKPointsBackProjectionImageFilter<TInputImage,TOutputImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if( this->GetPoints()->GetLargestPossibleRegion() != this->GetInput(0)->GetLargestPossibleRegion() )
+    {
+    itkExceptionMacro(<< "The largest possible region of the points, "
+                      << this->GetPoints()->GetLargestPossibleRegion()
+                      << ", differs from the one of the first input, "
+                      << this->GetInput(0)->GetLargestPossibleRegion());
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKPointsBackProjectionImageFilter<TInputImage,TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  // The part of the projections which is backprojected depends on the
+  // points, the whole projections are requested
+  typename Superclass::InputImagePointer inputPtr1 =
+    const_cast< TInputImage * >( this->GetInput(1) );
+  if ( !inputPtr1 )
+    return;
+  inputPtr1->SetRequestedRegionToLargestPossibleRegion();
+
+  typename PointsImageType::Pointer points =
+    const_cast< PointsImageType * >( this->GetPoints().GetPointer() );
+  if ( !points )
+    return;
+  points->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKPointsBackProjectionImageFilter<TInputImage,TOutputImage>
+#if ITK_VERSION_MAJOR<5
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+#else
+::DynamicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread)
+#endif
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
+  const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
+
+  // Create interpolator, could be any interpolation
+  using InterpolatorType = itk::LinearInterpolateImageFunction< ProjectionImageType, double >;
+  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  // Iterators on output samples and their physical coordinates
+  itk::ImageRegionIterator<TOutputImage> itOut(this->GetOutput(), outputRegionForThread);
+  itk::ImageRegionConstIterator<PointsImageType> itPoints(this->GetPoints(), outputRegionForThread);
+
+  // Initialize output region with input region in case the filter is not in
+  // place
+  this->InitializeOutputRegion(outputRegionForThread);
+
+  // Continuous index at which we interpolate
+  itk::ContinuousIndex<double, Dimension-1> pointProj;
+
+  // Conversion between projection coordinates and projection indices for the
+  // detector displacement field
+  const bool distorted = (this->m_Geometry->GetDetectorDisplacementField() != nullptr);
+  const itk::Matrix<double, Dimension, Dimension> projCoordToIndex = this->GetProjectionCoordinatesToProjectionIndexMatrix();
+  const itk::Matrix<double, Dimension, Dimension> projIndexToCoord( projCoordToIndex.GetInverse() );
+
+  // Go over each projection
+  for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
+    {
+    // Extract the current slice
+    ProjectionImagePointer projection;
+    projection = this->template GetProjection< ProjectionImageType >(iProj);
+    interpolator->SetInputImage(projection);
+
+    // Physical point to projection index matrix normalized to have a correct
+    // backprojection weight (1 at the isocenter)
+    ProjectionMatrixType matrix( this->GetProjectionPhysicalPointToProjectionIndexMatrix(iProj).GetVnlMatrix() *
+                                 this->m_Geometry->GetMagnificationMatrices()[iProj].GetVnlMatrix() *
+                                 this->m_Geometry->GetSourceTranslationMatrices()[iProj].GetVnlMatrix() *
+                                 this->m_Geometry->GetRotationMatrices()[iProj].GetVnlMatrix() );
+    matrix /= matrix[Dimension-1][Dimension];
+
+    // Go over each sample
+    for(itOut.GoToBegin(), itPoints.GoToBegin(); !itOut.IsAtEnd(); ++itOut, ++itPoints)
+      {
+      const typename PointsImageType::PixelType &point = itPoints.Get();
+
+      // Compute projection index with perspective
+      double perspFactor = matrix[Dimension-1][Dimension];
+      for(unsigned int j=0; j<Dimension; j++)
+        perspFactor += matrix[Dimension-1][j] * point[j];
+      perspFactor = 1/perspFactor;
+      for(unsigned int i=0; i<Dimension-1; i++)
+        {
+        pointProj[i] = matrix[i][Dimension];
+        for(unsigned int j=0; j<Dimension; j++)
+          pointProj[i] += matrix[i][j] * point[j];
+        pointProj[i] *= perspFactor;
+        }
+
+      // Nominal position of the pixels measured at this position
+      if(distorted)
+        this->ApplyInverseDetectorDisplacement(pointProj, projCoordToIndex, projIndexToCoord);
+
+      // Interpolate if in projection
+      if( interpolator->IsInsideBuffer(pointProj) )
+        {
+        itOut.Set( itOut.Get() + perspFactor*perspFactor*interpolator->EvaluateAtContinuousIndex(pointProj) );
+        }
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif
@@ -66,19 +66,7 @@ FDKWarpBackProjectionImageFilter<TInputImage,TOutputImage,TDeformation>
         typename TOutputImage::RegionType outputRegionForThread;
         outputRegionForThread = this->GetOutput()->GetRequestedRegion();
 #endif
-        // Iterators on volume input and output
-        using InputRegionIterator = itk::ImageRegionConstIterator<TInputImage>;
-        InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
-        using OutputRegionIterator = itk::ImageRegionIteratorWithIndex<TOutputImage>;
-        OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
-
-          itIn.GoToBegin();
-          while(!itIn.IsAtEnd() )
-            {
-            itOut.Set(itIn.Get() );
-            ++itIn;
-            ++itOut;
-            }
+        this->InitializeOutputRegion(outputRegionForThread);
 #if ITK_VERSION_MAJOR>4
         },
       nullptr
@@ -98,6 +86,12 @@ FDKWarpBackProjectionImageFilter<TInputImage,TOutputImage,TDeformation>
   itk::Matrix<double, Dimension+1, Dimension+1> matrixVol =
     GetPhysicalPointToIndexMatrix< TOutputImage >( this->GetOutput() );
 
+  // Conversion between projection coordinates and projection indices for the
+  // detector displacement field
+  const bool distorted = (this->m_Geometry->GetDetectorDisplacementField() != nullptr);
+  const itk::Matrix<double, Dimension, Dimension> projCoordToIndex = this->GetProjectionCoordinatesToProjectionIndexMatrix();
+  const itk::Matrix<double, Dimension, Dimension> projIndexToCoord( projCoordToIndex.GetInverse() );
+
   // Go over each projection
   for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
     {
@@ -124,7 +118,7 @@ FDKWarpBackProjectionImageFilter<TInputImage,TOutputImage,TDeformation>
     this->GetMultiThreader()->template ParallelizeImageRegion<TOutputImage::ImageDimension>
       (
       this->GetOutput()->GetRequestedRegion(),
-      [this, warpInterpolator, interpolator, matrix](const typename TOutputImage::RegionType & outputRegionForThread)
+      [this, warpInterpolator, interpolator, matrix, distorted, projCoordToIndex, projIndexToCoord](const typename TOutputImage::RegionType & outputRegionForThread)
         {
 #else
         {
@@ -161,6 +155,10 @@ FDKWarpBackProjectionImageFilter<TInputImage,TOutputImage,TDeformation>
           for(unsigned int i=0; i<TOutputImage::ImageDimension-1; i++)
             pointProj[i] = pointProj[i]*perspFactor_local;
 
+          // Nominal position of the pixels measured at this position
+          if(distorted)
+            this->ApplyInverseDetectorDisplacement(pointProj, projCoordToIndex, projIndexToCoord);
+
           // Interpolate if in projection
           if( interpolator->IsInsideBuffer(pointProj) )
             {
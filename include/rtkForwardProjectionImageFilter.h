@@ -66,6 +66,18 @@ protected:
   /** Apply changes to the input image requested region. */
   void GenerateInputRequestedRegion() override;
 
+  /** Input 0 may be the output of a rtk::ConstantImageSource, e.g., the
+   * zero image in which one forward projects. If SupportsImplicitConstantInput
+   * returns true, only one pixel of input 0 is then requested and
+   * subclasses use the value given by GetImplicitConstantInput instead of
+   * reading input 0. Subclasses which read input 0 directly must return
+   * false. */
+  virtual bool SupportsImplicitConstantInput() const { return false; }
+  bool GetImplicitConstantInput(typename TInputImage::PixelType &value) const;
+
+  /** The output cannot be grafted on an implicit constant input. */
+  bool CanRunInPlace() const override;
+
   /** The two inputs should not be in the same space so there is nothing
    * to verify. */
 #if ITK_VERSION_MAJOR<5
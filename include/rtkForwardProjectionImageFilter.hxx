@@ -22,6 +22,7 @@
 #include "rtkForwardProjectionImageFilter.h"
 
 #include "rtkHomogeneousMatrix.h"
+#include "rtkConstantImageSource.h"
 
 #include <itkImageRegionConstIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
@@ -40,7 +41,16 @@ ForwardProjectionImageFilter<TInputImage,TOutputImage>
     const_cast< TInputImage * >( this->GetInput(0) );
   if ( !inputPtr0 )
     return;
-  inputPtr0->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+  typename TInputImage::RegionType reqRegion0 = this->GetOutput()->GetRequestedRegion();
+  typename TInputImage::PixelType constant;
+  if( this->GetImplicitConstantInput(constant) )
+    {
+    // Only one pixel of an implicit constant input is requested
+    typename TInputImage::SizeType onePixel;
+    onePixel.Fill(1);
+    reqRegion0.SetSize(onePixel);
+    }
+  inputPtr0->SetRequestedRegion( reqRegion0 );
 
   // Input 1 is the volume to forward project
   typename Superclass::InputImagePointer  inputPtr1 =
@@ -61,6 +71,24 @@ ForwardProjectionImageFilter<TInputImage,TOutputImage>
   inputPtr2->SetRequestedRegion( reqRegion2 );
 }
 
+template <class TInputImage, class  TOutputImage>
+bool
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::GetImplicitConstantInput(typename TInputImage::PixelType &value) const
+{
+  return this->SupportsImplicitConstantInput() && GetConstantImageValue(this->GetInput(0), value);
+}
+
+template <class TInputImage, class  TOutputImage>
+bool
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::CanRunInPlace() const
+{
+  typename TInputImage::PixelType constant;
+  return itk::InPlaceImageFilter<TInputImage,TOutputImage>::CanRunInPlace() &&
+         !this->GetImplicitConstantInput(constant);
+}
+
 } // end namespace rtk
 
 #endif
@@ -249,6 +249,22 @@ SetProjectionsReaderFromGgo(typename TProjectionsReaderType::Pointer reader,
   if(args_info.airthres_given)
     reader->SetAirThreshold(args_info.airthres_arg);
 
+  // Scatter kernel superposition
+  if(args_info.sksampl_given)
+    {
+    typename TProjectionsReaderType::ScatterKernelVectorType thicknesses, widths, amplitudes;
+    for(unsigned int i=0; i<args_info.sksthick_given; i++)
+      thicknesses.push_back(args_info.sksthick_arg[i]);
+    for(unsigned int i=0; i<args_info.skswidth_given; i++)
+      widths.push_back(args_info.skswidth_arg[i]);
+    for(unsigned int i=0; i<args_info.sksampl_given; i++)
+      amplitudes.push_back(args_info.sksampl_arg[i]);
+    reader->SetScatterKernelThicknesses(thicknesses);
+    reader->SetScatterKernelWidths(widths);
+    reader->SetScatterKernelAmplitudes(amplitudes);
+    reader->SetScatterDownsamplingFactor(args_info.sksdown_arg);
+    }
+
   // I0 and IDark
   if(args_info.i0_given)
     reader->SetI0(args_info.i0_arg);
@@ -303,6 +319,9 @@ SetBackProjectionFromGgo(const TArgsInfo &args_info, TIterativeReconstructionFil
     case(4): //bp_arg_JosephAttenuated
       recon->SetBackProjectionFilter(TIterativeReconstructionFilter::BP_JOSEPHATTENUATED);
       break;
+    case(5): //bp_arg_NUFFT
+      recon->SetBackProjectionFilter(TIterativeReconstructionFilter::BP_NUFFT);
+      break;
     }
 }
 
@@ -332,6 +351,9 @@ SetForwardProjectionFromGgo(const TArgsInfo &args_info, TIterativeReconstruction
     case(2): //fp_arg_JosephAttenuated
       recon->SetForwardProjectionFilter(TIterativeReconstructionFilter::FP_JOSEPHATTENUATED);
       break;
+    case(3): //fp_arg_NUFFT
+      recon->SetForwardProjectionFilter(TIterativeReconstructionFilter::FP_NUFFT);
+      break;
     }
 }
 
@@ -26,6 +26,8 @@
 #include <itkDOMNodeXMLReader.h>
 #include <itkImageFileReader.h>
 #include <itkGDCMImageIO.h>
+#include "rtkDCMImagXImageIO.h"
+#include "rtkProjectionsHeaderCache.h"
 
 #include <string>
 #include <istream>
@@ -515,22 +517,22 @@ void ImagXGeometryReader<TInputImage>::GenerateData()
   // Create new RTK geometry object
   m_Geometry = GeometryType::New();
 
+  // Headers of the projections (for gantry angle), read in parallel
+  ProjectionsHeaderCache::Scan(m_ProjectionsFileNames,
+                               []() -> ProjectionsHeaderCache::ImageIOPointer
+                                 { return DCMImagXImageIO::New().GetPointer(); });
+
   // Projection matrices
   for (unsigned int noProj = 0; noProj < m_ProjectionsFileNames.size(); noProj++)
     {
-    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(
-        m_ProjectionsFileNames[0].c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
-    using ReaderType = itk::ImageFileReader< TInputImage >;
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName(m_ProjectionsFileNames[noProj]);
-    imageIO = itk::GDCMImageIO::New();
-
-    reader->SetImageIO(imageIO);
-    reader->UpdateOutputInformation();
-
     // Reading Gantry Angle
-    std::string labelId, value;
-    itk::GDCMImageIO::GetLabelFromTag(gantryAngleTag, labelId);
+    itk::ImageIOBase::Pointer imageIO = ProjectionsHeaderCache::GetImageIO(m_ProjectionsFileNames[noProj],
+                                                                           "DCMImagXImageIO");
+    if(imageIO.IsNull())
+      {
+      itkGenericExceptionMacro(<< m_ProjectionsFileNames[noProj] << " has been modified while reading the geometry");
+      }
+    std::string value;
     dynamic_cast<itk::GDCMImageIO*>(imageIO.GetPointer() )->GetValueFromTag(gantryAngleTag, value);
 
     if (isImagX1p5 || isImagX1p2) // Using CalibModel
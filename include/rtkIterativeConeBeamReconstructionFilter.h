@@ -24,8 +24,12 @@
 // Forward projection filters
 #include "rtkConfiguration.h"
 #include "rtkJosephForwardAttenuatedProjectionImageFilter.h"
+#include "rtkNUFFTForwardProjectionImageFilter.h"
 // Back projection filters
 #include "rtkJosephBackAttenuatedProjectionImageFilter.h"
+#include "rtkNUFFTBackProjectionImageFilter.h"
+// Region-of-interest reconstruction
+#include "rtkROIProjectionsImageFilter.h"
 
 #ifdef RTK_USE_CUDA
 # include "rtkCudaForwardProjectionImageFilter.h"
@@ -47,6 +51,13 @@ namespace rtk
  * and/or back projection filter(s) of a IterativeConeBeamReconstructionFilter
  * at runtime
  *
+ * A coarse volume of the full field-of-view can be set with
+ * SetBackgroundVolume to reconstruct only a region of interest (ROI), the
+ * volume passed as input 0. The reconstruction then uses the projections of
+ * the ROI computed with rtk::ROIProjectionsImageFilter instead of the input
+ * projections, which keeps data consistency outside the ROI while only the
+ * voxels of the ROI are unknowns.
+ *
  * \author Cyril Mory
  *
  * \ingroup RTK ReconstructionAlgorithm
@@ -70,19 +81,22 @@ public:
   typedef enum {FP_UNKNOWN=-1,
                 FP_JOSEPH=0,
                 FP_CUDARAYCAST=2,
-                FP_JOSEPHATTENUATED=3} ForwardProjectionType;
+                FP_JOSEPHATTENUATED=3,
+                FP_NUFFT=4} ForwardProjectionType;
   typedef enum {BP_UNKNOWN=-1,
                 BP_VOXELBASED=0,
                 BP_JOSEPH=1,
                 BP_CUDAVOXELBASED=2,
                 BP_CUDARAYCAST=4,
-                BP_JOSEPHATTENUATED=5} BackProjectionType;
+                BP_JOSEPHATTENUATED=5,
+                BP_NUFFT=6} BackProjectionType;
 
   /** Typedefs of each subfilter of this composite filter */
   using ForwardProjectionFilterType = rtk::ForwardProjectionImageFilter< VolumeType, ProjectionStackType >;
   using BackProjectionFilterType = rtk::BackProjectionImageFilter< ProjectionStackType, VolumeType >;
   using ForwardProjectionPointerType = typename ForwardProjectionFilterType::Pointer;
   using BackProjectionPointerType = typename BackProjectionFilterType::Pointer;
+  using ROIProjectionsFilterType = rtk::ROIProjectionsImageFilter< ProjectionStackType, VolumeType >;
 
   /** Standard New method. */
   itkNewMacro(Self)
@@ -96,6 +110,11 @@ public:
   virtual void SetBackProjectionFilter (BackProjectionType bptype);
   BackProjectionType GetBackProjectionFilter () { return m_CurrentBackProjectionConfiguration; }
 
+  /** Set / Get the coarse volume of the full field-of-view used in ROI mode.
+   * It is optional, the full input projections are used if it is not set. */
+  void SetBackgroundVolume(const VolumeType *background);
+  typename VolumeType::ConstPointer GetBackgroundVolume();
+
 protected:
   IterativeConeBeamReconstructionFilter();
   ~IterativeConeBeamReconstructionFilter() override = default;
@@ -108,6 +127,27 @@ protected:
    * To be used in SetForwardProjectionFilter. */
   virtual ForwardProjectionPointerType InstantiateForwardProjectionFilter (int fwtype);
 
+  /** Returns the projections to reconstruct from. These are the input
+   * projections, or their ROI part computed by m_ROIProjectionsFilter if a
+   * background volume has been set. To be used in GenerateOutputInformation. */
+  const ProjectionStackType * GetROIProjections(const ProjectionStackType *projections,
+                                                const itk::ImageBase<VolumeType::ImageDimension> *roi,
+                                                const ThreeDCircularProjectionGeometry *geometry);
+
+  /** Returns a copy of the projections and of their geometry where the
+   * projection k is the projection order[k] of the input, e.g., to make the
+   * projections of each subset contiguous and process each subset with a
+   * single forward and back projection. The projections must be buffered. */
+  typename ProjectionStackType::Pointer GetReorderedProjections(const ProjectionStackType *projections,
+                                                                const std::vector<unsigned int> &order);
+  static ThreeDCircularProjectionGeometry::Pointer GetReorderedGeometry(const ThreeDCircularProjectionGeometry *geometry,
+                                                                        const std::vector<unsigned int> &order);
+
+  /** Filter computing the ROI projections in ROI mode and the configuration
+   * of its forward projector, -1 if it has not been created yet. */
+  typename ROIProjectionsFilterType::Pointer m_ROIProjectionsFilter;
+  int                                        m_ROIForwardProjectionConfiguration{-1};
+
   /** Internal variables storing the current forward
     and back projection methods */
   ForwardProjectionType m_CurrentForwardProjectionConfiguration;
@@ -180,6 +220,23 @@ protected:
     }
 
 
+  template < typename ImageType, EnableVectorType<ImageType>* = nullptr >
+  ForwardProjectionPointerType InstantiateNUFFTForwardProjection()
+    {
+    itkGenericExceptionMacro(<< "NUFFTForwardProjectionImageFilter only available with scalar pixel types.");
+    return nullptr;
+    }
+
+
+  template < typename ImageType, DisableVectorType<ImageType>* = nullptr >
+  ForwardProjectionPointerType InstantiateNUFFTForwardProjection()
+    {
+    ForwardProjectionPointerType fw;
+    fw = NUFFTForwardProjectionImageFilter<VolumeType, ProjectionStackType>::New();
+    return fw;
+    }
+
+
   template < typename ImageType, EnableCudaScalarAndVectorType<ImageType>* = nullptr >
   BackProjectionPointerType InstantiateCudaBackProjection()
     {
@@ -234,6 +291,23 @@ protected:
     return bp;
     }
 
+
+  template < typename ImageType, EnableVectorType<ImageType>* = nullptr >
+  BackProjectionPointerType InstantiateNUFFTBackProjection()
+    {
+    itkGenericExceptionMacro(<< "NUFFTBackProjectionImageFilter only available with scalar pixel types.");
+    return nullptr;
+    }
+
+
+  template < typename ImageType, DisableVectorType<ImageType>* = nullptr >
+  BackProjectionPointerType InstantiateNUFFTBackProjection()
+    {
+    BackProjectionPointerType bp;
+    bp = NUFFTBackProjectionImageFilter<ProjectionStackType, VolumeType>::New();
+    return bp;
+    }
+
 }; // end of class
 
 } // end namespace rtk
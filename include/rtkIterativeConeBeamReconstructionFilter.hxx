@@ -21,6 +21,9 @@
 
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
 namespace rtk
 {
 
@@ -49,6 +52,9 @@ IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>
     case(FP_JOSEPHATTENUATED):
       fw = InstantiateJosephForwardAttenuatedProjection<ProjectionStackType>();
     break;
+    case(FP_NUFFT):
+      fw = InstantiateNUFFTForwardProjection<ProjectionStackType>();
+    break;
     default:
       itkGenericExceptionMacro(<< "Unhandled --fp value.");
     }
@@ -77,6 +83,9 @@ IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>::Instan
     case(BP_JOSEPHATTENUATED):
       bp = InstantiateJosephBackAttenuatedProjection<ProjectionStackType>();
       break;
+    case(BP_NUFFT):
+      bp = InstantiateNUFFTBackProjection<ProjectionStackType>();
+      break;
     default:
       itkGenericExceptionMacro(<< "Unhandled --bp value.");
     }
@@ -107,6 +116,112 @@ IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>
     }
 }
 
+template<class TOutputImage, class ProjectionStackType>
+void
+IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>
+::SetBackgroundVolume(const VolumeType *background)
+{
+  this->SetInput("BackgroundVolume", const_cast<VolumeType*>(background));
+}
+
+template<class TOutputImage, class ProjectionStackType>
+typename IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>::VolumeType::ConstPointer
+IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>
+::GetBackgroundVolume()
+{
+  return static_cast< const VolumeType * >
+         ( this->itk::ProcessObject::GetInput("BackgroundVolume") );
+}
+
+template<class TOutputImage, class ProjectionStackType>
+const ProjectionStackType *
+IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>
+::GetROIProjections(const ProjectionStackType *projections,
+                    const itk::ImageBase<VolumeType::ImageDimension> *roi,
+                    const ThreeDCircularProjectionGeometry *geometry)
+{
+  if( this->GetBackgroundVolume().IsNull() )
+    return projections;
+
+  if( m_ROIProjectionsFilter.IsNull() )
+    m_ROIProjectionsFilter = ROIProjectionsFilterType::New();
+
+  // The attenuation map, if any, only covers the ROI so the background is
+  // projected without attenuation. The projector is only created if the
+  // configuration has changed, a new one would project the background again.
+  int fwtype = m_CurrentForwardProjectionConfiguration;
+  if( fwtype == FP_JOSEPHATTENUATED )
+    fwtype = FP_JOSEPH;
+  if( fwtype != m_ROIForwardProjectionConfiguration )
+    {
+    m_ROIProjectionsFilter->SetForwardProjectionFilter( this->InstantiateForwardProjectionFilter(fwtype) );
+    m_ROIForwardProjectionConfiguration = fwtype;
+    }
+
+  m_ROIProjectionsFilter->SetInputProjectionStack(projections);
+  m_ROIProjectionsFilter->SetInputBackgroundVolume(this->GetBackgroundVolume());
+  m_ROIProjectionsFilter->SetROIFromImage(roi);
+  m_ROIProjectionsFilter->SetGeometry(geometry);
+  return m_ROIProjectionsFilter->GetOutput();
+}
+
+template<class TOutputImage, class ProjectionStackType>
+typename ProjectionStackType::Pointer
+IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>
+::GetReorderedProjections(const ProjectionStackType *projections,
+                          const std::vector<unsigned int> &order)
+{
+  const unsigned int Dimension = ProjectionStackType::ImageDimension;
+
+  typename ProjectionStackType::Pointer reordered = ProjectionStackType::New();
+  reordered->CopyInformation(projections);
+  reordered->SetRegions(projections->GetLargestPossibleRegion());
+  reordered->Allocate();
+
+  typename ProjectionStackType::RegionType inRegion = projections->GetLargestPossibleRegion();
+  typename ProjectionStackType::RegionType outRegion = inRegion;
+  inRegion.SetSize(Dimension-1, 1);
+  outRegion.SetSize(Dimension-1, 1);
+  for(unsigned int k=0; k<order.size(); k++)
+    {
+    inRegion.SetIndex(Dimension-1, projections->GetLargestPossibleRegion().GetIndex(Dimension-1) + order[k]);
+    outRegion.SetIndex(Dimension-1, projections->GetLargestPossibleRegion().GetIndex(Dimension-1) + k);
+    itk::ImageRegionConstIterator<ProjectionStackType> itIn(projections, inRegion);
+    itk::ImageRegionIterator<ProjectionStackType> itOut(reordered, outRegion);
+    for(; !itIn.IsAtEnd(); ++itIn, ++itOut)
+      itOut.Set(itIn.Get());
+    }
+  return reordered;
+}
+
+template<class TOutputImage, class ProjectionStackType>
+ThreeDCircularProjectionGeometry::Pointer
+IterativeConeBeamReconstructionFilter<TOutputImage, ProjectionStackType>
+::GetReorderedGeometry(const ThreeDCircularProjectionGeometry *geometry,
+                       const std::vector<unsigned int> &order)
+{
+  ThreeDCircularProjectionGeometry::Pointer reordered = ThreeDCircularProjectionGeometry::New();
+  reordered->SetRadiusCylindricalDetector(geometry->GetRadiusCylindricalDetector());
+  reordered->SetDetectorDisplacementField(geometry->GetDetectorDisplacementField());
+  for(unsigned int i : order)
+    {
+    reordered->AddProjectionInRadians( geometry->GetSourceToIsocenterDistances()[i],
+                                       geometry->GetSourceToDetectorDistances()[i],
+                                       geometry->GetGantryAngles()[i],
+                                       geometry->GetProjectionOffsetsX()[i],
+                                       geometry->GetProjectionOffsetsY()[i],
+                                       geometry->GetOutOfPlaneAngles()[i],
+                                       geometry->GetInPlaneAngles()[i],
+                                       geometry->GetSourceOffsetsX()[i],
+                                       geometry->GetSourceOffsetsY()[i]);
+    reordered->SetCollimationOfLastProjection(geometry->GetCollimationUInf()[i],
+                                              geometry->GetCollimationUSup()[i],
+                                              geometry->GetCollimationVInf()[i],
+                                              geometry->GetCollimationVSup()[i]);
+    }
+  return reordered;
+}
+
 } // end namespace rtk
 
 #endif // rtkIterativeConeBeamReconstructionFilter_hxx
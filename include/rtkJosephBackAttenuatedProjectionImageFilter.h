@@ -224,6 +224,9 @@ protected:
   /** Apply changes to the input image requested region. */
   void GenerateInputRequestedRegion() override;
 
+  /** The attenuation map is accessed with the pixel offsets of input 0. */
+  bool SupportsImplicitConstantInput() const override { return false; }
+
   /** Only the last two inputs should be in the same space so we need
    * to overwrite the method. */
 #if ITK_VERSION_MAJOR<5
@@ -22,6 +22,7 @@
 #include "rtkConfiguration.h"
 #include "rtkBackProjectionImageFilter.h"
 #include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkNestedVolumesRaySegments.h"
 
 #include <itkVectorImage.h>
 
@@ -135,7 +136,11 @@ public:
  * using [Joseph, IEEE TMI, 1982]. The back projector is the adjoint operator of the
  * forward projector
  *
- * \test rtkbackprojectiontest.cxx
+ * Finer volumes may be nested in the volume with AddNestedVolume to describe
+ * a multi-resolution volume, see JosephForwardProjectionImageFilter. The parts
+ * of the rays inside the nested volumes are then not backprojected.
+ *
+ * \test rtkbackprojectiontest.cxx, rtkadjointoperatorstest.cxx
  *
  * \author Cyril Mory
  *
@@ -166,6 +171,7 @@ public:
   using VectorType = itk::Vector<CoordRepType, TInputImage::ImageDimension>;
   using GeometryType = rtk::ThreeDCircularProjectionGeometry;
   using GeometryPointer = typename GeometryType::Pointer;
+  using ImageBaseType = itk::ImageBase<3>;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -217,12 +223,22 @@ public:
   itkGetMacro(SuperiorClip, double)
   itkSetMacro(SuperiorClip, double)
 
+  /** Add / clear volumes nested in the volume. Only their footprint is used:
+   * the rays are not backprojected in the volume between the centers of the
+   * first and last voxels of each nested volume. Nested volumes must have
+   * the same direction as the volume. */
+  void AddNestedVolume(const ImageBaseType *nested);
+  void ClearNestedVolumes();
+
 protected:
   JosephBackProjectionImageFilter();
   ~JosephBackProjectionImageFilter() override = default;
 
   void GenerateData() override;
 
+  /** Input 0 is only read by InitializeOutputRegion. */
+  bool SupportsImplicitConstantInput() const override { return true; }
+
   /** The two inputs should not be in the same space so there is nothing
    * to verify. */
 #if ITK_VERSION_MAJOR<5
@@ -289,7 +305,7 @@ protected:
   TSumAlongRay                       m_SumAlongRay;
   double                             m_InferiorClip{0.};
   double                             m_SuperiorClip{1.};
-
+  NestedBoxesType                    m_NestedBoxes;
 };
 
 } // end namespace rtk
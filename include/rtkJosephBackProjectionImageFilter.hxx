@@ -24,6 +24,7 @@
 #include "rtkHomogeneousMatrix.h"
 #include "rtkBoxShape.h"
 #include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkNestedVolumesRaySegments.h"
 
 #include <itkImageRegionConstIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
@@ -46,6 +47,42 @@ JosephBackProjectionImageFilter<TInputImage,
 {
 }
 
+template <class TInputImage,
+          class TOutputImage,
+          class TInterpolationWeightMultiplication,
+          class TSplatWeightMultiplication,
+          class TSumAlongRay>
+void JosephBackProjectionImageFilter<TInputImage,
+                                TOutputImage,
+                                TInterpolationWeightMultiplication,
+                                TSplatWeightMultiplication,
+                                TSumAlongRay >
+::AddNestedVolume(const ImageBaseType *nested)
+{
+  BoxShape::Pointer box = GetNestedVolumeBox(nested);
+  m_NestedBoxes.push_back(box.GetPointer());
+  this->Modified();
+}
+
+template <class TInputImage,
+          class TOutputImage,
+          class TInterpolationWeightMultiplication,
+          class TSplatWeightMultiplication,
+          class TSumAlongRay>
+void JosephBackProjectionImageFilter<TInputImage,
+                                TOutputImage,
+                                TInterpolationWeightMultiplication,
+                                TSplatWeightMultiplication,
+                                TSumAlongRay >
+::ClearNestedVolumes()
+{
+  if(!m_NestedBoxes.empty())
+    {
+    m_NestedBoxes.clear();
+    this->Modified();
+    }
+}
+
 template <class TInputImage,
           class TOutputImage,
           class TInterpolationWeightMultiplication,
@@ -65,8 +102,8 @@ void JosephBackProjectionImageFilter<TInputImage,
   typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
   int offsets[3];
   offsets[0] = 1;
-  offsets[1] = this->GetInput(0)->GetBufferedRegion().GetSize()[0];
-  offsets[2] = this->GetInput(0)->GetBufferedRegion().GetSize()[0] * this->GetInput(0)->GetBufferedRegion().GetSize()[1];
+  offsets[1] = this->GetOutput()->GetBufferedRegion().GetSize()[0];
+  offsets[2] = this->GetOutput()->GetBufferedRegion().GetSize()[0] * this->GetOutput()->GetBufferedRegion().GetSize()[1];
 
   const GeometryType *geometry = dynamic_cast<const GeometryType*>(this->GetGeometry());
   if( !geometry )
@@ -89,22 +126,7 @@ void JosephBackProjectionImageFilter<TInputImage,
 
   // Initialize output region with input region in case the filter is not in
   // place
-  if(this->GetInput() != this->GetOutput() )
-    {
-    // Iterators on volume input and output
-    using InputRegionIterator = itk::ImageRegionConstIterator<TInputImage>;
-    InputRegionIterator itVolIn(this->GetInput(0), this->GetInput()->GetBufferedRegion());
-
-    using OutputRegionIterator = itk::ImageRegionIteratorWithIndex<TOutputImage>;
-    OutputRegionIterator itVolOut(this->GetOutput(), this->GetInput()->GetBufferedRegion());
-
-    while(!itVolIn.IsAtEnd() )
-      {
-      itVolOut.Set(itVolIn.Get() );
-      ++itVolIn;
-      ++itVolOut;
-      }
-    }
+  this->InitializeOutputRegion(this->GetOutput()->GetBufferedRegion());
 
   // Iterators on projections input
   using InputRegionIterator = ProjectionsRegionConstIteratorRayBased<TInputImage>;
@@ -127,6 +149,11 @@ void JosephBackProjectionImageFilter<TInputImage,
   box->SetBoxMin(boxMin);
   box->SetBoxMax(boxMax);
 
+  // Boxes of the nested volumes in the index coordinates of the volume
+  std::vector<BoxShape::Pointer> nestedBoxes;
+  GetNestedBoxesInIndexCoordinates(m_NestedBoxes, this->GetInput(0), volPPToIndex, nestedBoxes);
+  RaySegmentsType segments, holes;
+
   // m_InferiorClip and m_SuperiorClip are understood in the sense of a
   // source-to-pixel vector. Since we go from pixel-to-source, we invert them.
   double inferiorClip = 1.-m_SuperiorClip;
@@ -159,15 +186,8 @@ void JosephBackProjectionImageFilter<TInputImage,
       nearDist = std::max(nearDist, inferiorClip);
       farDist = std::min(farDist, superiorClip);
 
-      // Compute and sort intersections: (n)earest and (f)arthest (p)points
-      np = sourcePosition + nearDist * dirVox;
-      fp = sourcePosition + farDist * dirVox;
-      if(np[mainDir]>fp[mainDir])
-        std::swap(np, fp);
-
-      // Compute main nearest and farthest slice indices
-      const int ns = itk::Math::rnd( np[mainDir]);
-      const int fs = itk::Math::rnd( fp[mainDir]);
+      // Skip the parts of the ray inside nested volumes
+      ComputeRaySegmentsOutsideBoxes(sourcePosition, dirVox, nearDist, farDist, nestedBoxes, segments, holes);
 
       // Determine the other two directions
       unsigned int notMainDirInf = (mainDir+1)%Dimension;
@@ -180,24 +200,14 @@ void JosephBackProjectionImageFilter<TInputImage,
       const CoordRepType maxx = box->GetBoxMax()[notMainDirInf];
       const CoordRepType maxy = box->GetBoxMax()[notMainDirSup];
 
-      // Init data pointers to first pixel of slice ns (i)nferior and (s)uperior (x|y) corner
       const int offsetx = offsets[notMainDirInf];
       const int offsety = offsets[notMainDirSup];
       const int offsetz = offsets[mainDir];
-      OutputPixelType *pxiyi, *pxsyi, *pxiys, *pxsys;
-
-      pxiyi = beginBuffer + ns * offsetz;
-      pxsyi = pxiyi + offsetx;
-      pxiys = pxiyi + offsety;
-      pxsys = pxsyi + offsety;
 
-      // Compute step size and go to first voxel
-      const CoordRepType residual = ns - np[mainDir];
+      // Compute step size
       const CoordRepType norm = 1/dirVox[mainDir];
       const CoordRepType stepx = dirVox[notMainDirInf] * norm;
       const CoordRepType stepy = dirVox[notMainDirSup] * norm;
-      CoordRepType currentx = np[notMainDirInf] + residual * stepx;
-      CoordRepType currenty = np[notMainDirSup] + residual * stepy;
 
       // Compute voxel to millimeters conversion
       stepMM[notMainDirInf] = this->GetInput(0)->GetSpacing()[notMainDirInf] * stepx;
@@ -206,8 +216,37 @@ void JosephBackProjectionImageFilter<TInputImage,
 
       typename TOutputImage::PixelType attenuationRay = itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue();
       bool isNewRay = true;
-      if (fs == ns) //If the voxel is a corner, we can skip most steps
+
+      // Go over the segments in the order of increasing main direction slices
+      for(unsigned int s=0; s<segments.size(); s++)
         {
+        const unsigned int seg = (dirVox[mainDir]<0.)?segments.size()-1-s:s;
+
+        // Compute and sort intersections: (n)earest and (f)arthest (p)points
+        np = sourcePosition + segments[seg].first * dirVox;
+        fp = sourcePosition + segments[seg].second * dirVox;
+        if(np[mainDir]>fp[mainDir])
+          std::swap(np, fp);
+
+        // Compute main nearest and farthest slice indices
+        const int ns = itk::Math::rnd( np[mainDir]);
+        const int fs = itk::Math::rnd( fp[mainDir]);
+
+        // Init data pointers to first pixel of slice ns (i)nferior and (s)uperior (x|y) corner
+        OutputPixelType *pxiyi, *pxsyi, *pxiys, *pxsys;
+
+        pxiyi = beginBuffer + ns * offsetz;
+        pxsyi = pxiyi + offsetx;
+        pxiys = pxiyi + offsety;
+        pxsys = pxsyi + offsety;
+
+        // Go to first voxel
+        const CoordRepType residual = ns - np[mainDir];
+        CoordRepType currentx = np[notMainDirInf] + residual * stepx;
+        CoordRepType currenty = np[notMainDirSup] + residual * stepy;
+
+        if (fs == ns) //If the voxel is a corner, we can skip most steps
+          {
           attenuationRay += BilinearInterpolationOnBorders(fp[mainDir] - np[mainDir],
                                               pxiyi, pxsyi, pxiys, pxsys,
                                               currentx, currenty, offsetx, offsety,
@@ -216,39 +255,20 @@ void JosephBackProjectionImageFilter<TInputImage,
           BilinearSplatOnBorders(rayValue, fp[mainDir] - np[mainDir], stepMM.GetNorm(),
                                  pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
                                  offsetx, offsety, minx, miny, maxx, maxy);
-        }
-      else
-        {
-        // First step
-        attenuationRay += BilinearInterpolationOnBorders(residual + 0.5,
-                                              pxiyi, pxsyi, pxiys, pxsys,
-                                              currentx, currenty, offsetx, offsety,
-                                              minx, miny, maxx, maxy);
-
-        const typename TInputImage::PixelType &rayValueF = m_SumAlongRay(itIn->Value(), attenuationRay, stepMM, isNewRay);
-
-        BilinearSplatOnBorders(rayValueF, residual + 0.5, stepMM.GetNorm(),
-                               pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
-                               offsetx, offsety, minx, miny, maxx, maxy);
-
-        // Move to next main direction slice
-        pxiyi += offsetz;
-        pxsyi += offsetz;
-        pxiys += offsetz;
-        pxsys += offsetz;
-        currentx += stepx;
-        currenty += stepy;
-
-        // Middle steps
-        for(int i=ns+1; i<fs; i++)
+          }
+        else
           {
-          attenuationRay += BilinearInterpolation( 1.0,
-                                       pxiyi, pxsyi, pxiys, pxsys,
-                                       currentx, currenty, offsetx, offsety);
+          // First step
+          attenuationRay += BilinearInterpolationOnBorders(residual + 0.5,
+                                                pxiyi, pxsyi, pxiys, pxsys,
+                                                currentx, currenty, offsetx, offsety,
+                                                minx, miny, maxx, maxy);
 
-          const typename TInputImage::PixelType &rayValueM = m_SumAlongRay(itIn->Value(), attenuationRay, stepMM,isNewRay);
+          const typename TInputImage::PixelType &rayValueF = m_SumAlongRay(itIn->Value(), attenuationRay, stepMM, isNewRay);
 
-          BilinearSplat(rayValueM, 1.0, stepMM.GetNorm(), pxiyi, pxsyi, pxiys, pxsys, currentx, currenty, offsetx, offsety);
+          BilinearSplatOnBorders(rayValueF, residual + 0.5, stepMM.GetNorm(),
+                                 pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
+                                 offsetx, offsety, minx, miny, maxx, maxy);
 
           // Move to next main direction slice
           pxiyi += offsetz;
@@ -257,19 +277,39 @@ void JosephBackProjectionImageFilter<TInputImage,
           pxsys += offsetz;
           currentx += stepx;
           currenty += stepy;
-          }
 
-        // Last step
-        attenuationRay += BilinearInterpolationOnBorders(fp[mainDir] - fs + 0.5,
-                                              pxiyi, pxsyi, pxiys, pxsys,
-                                              currentx, currenty, offsetx, offsety,
-                                              minx, miny, maxx, maxy);
+          // Middle steps
+          for(int i=ns+1; i<fs; i++)
+            {
+            attenuationRay += BilinearInterpolation( 1.0,
+                                         pxiyi, pxsyi, pxiys, pxsys,
+                                         currentx, currenty, offsetx, offsety);
+
+            const typename TInputImage::PixelType &rayValueM = m_SumAlongRay(itIn->Value(), attenuationRay, stepMM,isNewRay);
+
+            BilinearSplat(rayValueM, 1.0, stepMM.GetNorm(), pxiyi, pxsyi, pxiys, pxsys, currentx, currenty, offsetx, offsety);
+
+            // Move to next main direction slice
+            pxiyi += offsetz;
+            pxsyi += offsetz;
+            pxiys += offsetz;
+            pxsys += offsetz;
+            currentx += stepx;
+            currenty += stepy;
+            }
 
-        const typename TInputImage::PixelType &rayValueE = m_SumAlongRay(itIn->Value(), attenuationRay, stepMM, isNewRay);
+          // Last step
+          attenuationRay += BilinearInterpolationOnBorders(fp[mainDir] - fs + 0.5,
+                                                pxiyi, pxsyi, pxiys, pxsys,
+                                                currentx, currenty, offsetx, offsety,
+                                                minx, miny, maxx, maxy);
 
-        BilinearSplatOnBorders(rayValueE, fp[mainDir] - fs + 0.5, stepMM.GetNorm(),
-                               pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
-                               offsetx, offsety, minx, miny, maxx, maxy);
+          const typename TInputImage::PixelType &rayValueE = m_SumAlongRay(itIn->Value(), attenuationRay, stepMM, isNewRay);
+
+          BilinearSplatOnBorders(rayValueE, fp[mainDir] - fs + 0.5, stepMM.GetNorm(),
+                                 pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
+                                 offsetx, offsety, minx, miny, maxx, maxy);
+          }
         }
       }
     }
@@ -251,6 +251,9 @@ protected:
   /** Apply changes to the input image requested region. */
   void GenerateInputRequestedRegion() override;
 
+  /** The whole input projections are requested by GenerateInputRequestedRegion. */
+  bool SupportsImplicitConstantInput() const override { return false; }
+
   void BeforeThreadedGenerateData() override;
 
   /** Only the last two inputs should be in the same space so we need
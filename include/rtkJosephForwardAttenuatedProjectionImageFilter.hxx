@@ -197,6 +197,17 @@ JosephForwardAttenuatedProjectionImageFilter<TInputImage,
   TComputeAttenuationCorrection>
 ::BeforeThreadedGenerateData()
 {
+  // The attenuation map is read with the memory offsets of the emission map
+  if(this->GetBrickSize() != 0)
+    {
+    itkExceptionMacro(<< "Bricks are not supported by the attenuated projector");
+    }
+  if(this->GetEmptySpaceCellSize() != 0)
+    {
+    itkExceptionMacro(<< "Empty space skipping is not supported by the attenuated projector");
+    }
+  Superclass::BeforeThreadedGenerateData();
+
   this->GetInterpolationWeightMultiplication().SetAttenuationMinusEmissionMapsPtrDiff(this->GetInput(2)->GetBufferPointer()-this->GetInput(1)->GetBufferPointer() );
   this->GetProjectedValueAccumulation().SetAttenuationVector(this->GetInterpolationWeightMultiplication().GetAttenuationRay() );
   this->GetSumAlongRay().SetAttenuationRayVector(this->GetInterpolationWeightMultiplication().GetAttenuationRay() );
@@ -25,8 +25,15 @@
 #include <itkPixelTraits.h>
 
 #include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkNestedVolumesRaySegments.h"
+#include "rtkBrickedImageBuffer.h"
+#include "rtkEmptySpaceSkippingGrid.h"
+#include "rtkProjectionTilesScheduler.h"
 
 #include <itkVectorImage.h>
+
+#include <type_traits>
+
 namespace rtk
 {
 namespace Functor
@@ -133,6 +140,78 @@ public:
     }
 };
 
+/** Bilinear interpolation in the slice of a volume pointed by slice with the
+ * interpolation weight multiplication functor of the Joseph projector. ox
+ * and oy are the per-axis memory offsets of the two in-slice directions, see
+ * BrickedImageBuffer. It is shared by rtk::JosephForwardProjectionImageFilter
+ * and rtk::DRRGenerator. */
+template< class TInterpolationWeightMultiplication, class TInput, class TOutput >
+inline TOutput
+JosephBilinearInterpolation(TInterpolationWeightMultiplication &interpolationWeightMultiplication,
+                            const ThreadIdType threadId,
+                            const double stepLengthInVoxel,
+                            const TInput *slice,
+                            const double x,
+                            const double y,
+                            const int *ox,
+                            const int *oy)
+{
+  int ix = itk::Math::floor(x);
+  int iy = itk::Math::floor(y);
+  double lx = x - ix;
+  double ly = y - iy;
+  double lxc = 1.-lx;
+  double lyc = 1.-ly;
+  return ( interpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * lyc, slice, ox[ix  ] + oy[iy  ]) +
+           interpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * lyc, slice, ox[ix+1] + oy[iy  ]) +
+           interpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * ly , slice, ox[ix  ] + oy[iy+1]) +
+           interpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * ly , slice, ox[ix+1] + oy[iy+1]) );
+}
+
+/** Same as JosephBilinearInterpolation for the first and last slices of a
+ * ray, the indices are clamped to [min, max] and the result is weighted by
+ * the length of the step in the slice. */
+template< class TInterpolationWeightMultiplication, class TInput, class TOutput >
+inline TOutput
+JosephBilinearInterpolationOnBorders(TInterpolationWeightMultiplication &interpolationWeightMultiplication,
+                                     const ThreadIdType threadId,
+                                     const double stepLengthInVoxel,
+                                     const TInput *slice,
+                                     const double x,
+                                     const double y,
+                                     const int *ox,
+                                     const int *oy,
+                                     const double minx,
+                                     const double miny,
+                                     const double maxx,
+                                     const double maxy)
+{
+  int ix = itk::Math::floor(x);
+  int iy = itk::Math::floor(y);
+  double lx = x - ix;
+  double ly = y - iy;
+  double lxc = 1.-lx;
+  double lyc = 1.-ly;
+
+  // (i)nferior and (s)uperior indices, clamped to the borders of the volume
+  int xi = ix;
+  int yi = iy;
+  int xs = ix+1;
+  int ys = iy+1;
+  if(ix < minx) xi++;
+  if(iy < miny) yi++;
+  if(ix >= maxx) xs--;
+  if(iy >= maxy) ys--;
+
+  TOutput result = itk::NumericTraits<TOutput>::ZeroValue();
+  result += interpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * lyc, slice, ox[xi] + oy[yi]);
+  result += interpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * ly , slice, ox[xi] + oy[ys]);
+  result += interpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * lyc, slice, ox[xs] + oy[yi]);
+  result += interpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * ly , slice, ox[xs] + oy[ys]);
+  result *= stepLengthInVoxel;
+  return result;
+}
+
 } // end namespace Functor
 
 
@@ -144,7 +223,18 @@ public:
  * has been placed after the source and the volume. If the detector is in the volume
  * the ray tracing is performed only until that point.
  *
- * \test rtkforwardprojectiontest.cxx
+ * Finer volumes may be nested in the input volume with AddNestedVolume to
+ * describe a multi-resolution volume, e.g., a fine region of interest in a
+ * coarse field-of-view. The parts of the rays inside the nested volumes are
+ * then skipped and the nested volumes must be projected by other projectors
+ * which accumulate in the output of this one. The result is the exact
+ * adjoint of JosephBackProjectionImageFilter with the same nested volumes.
+ *
+ * The slices of the rays crossing empty parts of the input volume can be
+ * skipped with an EmptySpaceSkippingGrid, see EmptySpaceCellSize. This is
+ * exact with the default functors if EmptySpaceThreshold is 0.
+ *
+ * \test rtkforwardprojectiontest.cxx, rtkadjointoperatorstest.cxx
  *
  * \author Simon Rit
  *
@@ -173,6 +263,7 @@ public:
   using OutputImageRegionType = typename TOutputImage::RegionType;
   using CoordRepType = double;
   using VectorType = itk::Vector<CoordRepType, TInputImage::ImageDimension>;
+  using ImageBaseType = itk::ImageBase<3>;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -225,12 +316,64 @@ public:
   itkGetMacro(SuperiorClip, double)
   itkSetMacro(SuperiorClip, double)
 
+  /** Add / clear volumes nested in the input volume. Only their footprint is
+   * used: the rays are not traced in the input volume between the centers of
+   * the first and last voxels of each nested volume. Nested volumes must have
+   * the same direction as the input volume. */
+  void AddNestedVolume(const ImageBaseType *nested);
+  void ClearNestedVolumes();
+
+  /** Get / Set the size of the cubic bricks in which the input volume is
+   * copied before projection, see BrickedImageBuffer. Bricks reduce cache and
+   * TLB misses for rays whose main direction is not x. The copy is reused
+   * as long as the input volume is not updated, e.g., for all subsets of an
+   * iteration. Default is 0, i.e., no copy. */
+  itkGetMacro(BrickSize, unsigned int)
+  itkSetMacro(BrickSize, unsigned int)
+
+  /** Get / Set the size of the square detector tiles which are dynamically
+   * distributed to the threads, see ProjectionTilesScheduler. 0 falls back
+   * to the region given to each thread by ITK. Default is 0. */
+  itkGetMacro(TileSize, unsigned int)
+  itkSetMacro(TileSize, unsigned int)
+
+  /** Get / Set the size of the cubic cells of the EmptySpaceSkippingGrid of
+   * the input volume. The slices of the rays in cells whose voxels are all
+   * lower than or equal to EmptySpaceThreshold in absolute value are not
+   * interpolated, which is only valid if the functors add nothing for such
+   * voxels. The grid is reused as long as the input volume is not updated.
+   * Default is 0, i.e., no skipping, otherwise it must be at least 2. */
+  itkGetMacro(EmptySpaceCellSize, unsigned int)
+  itkSetMacro(EmptySpaceCellSize, unsigned int)
+
+  /** Get / Set the threshold of empty voxels, see EmptySpaceCellSize.
+   * Default is 0. */
+  itkGetMacro(EmptySpaceThreshold, double)
+  itkSetMacro(EmptySpaceThreshold, double)
+
 protected:
   JosephForwardProjectionImageFilter();
   ~JosephForwardProjectionImageFilter() override = default;
 
+  void BeforeThreadedGenerateData() override;
+
   void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) override;
 
+  /** Forward project the volume in a region of the projections. The ray
+   * iterator of the geometry is instantiated with its concrete type so that
+   * the computation of each ray is inlined in the loop over the pixels. */
+  void ProjectRegion( const OutputImageRegionType& region, ThreadIdType threadId );
+  using ThreeDHomogeneousMatrixType = typename Superclass::GeometryType::ThreeDHomogeneousMatrixType;
+  template <class TRayIterator>
+  void ProjectRegion( TRayIterator &itIn,
+                      const ThreeDHomogeneousMatrixType &volPPToIndex,
+                      const OutputImageRegionType& region,
+                      ThreadIdType threadId );
+
+  /** The input projections are only read pixel by pixel in ProjectRegion. */
+  bool SupportsImplicitConstantInput() const override
+    { return std::is_same<TInputImage, TOutputImage>::value; }
+
   /** The two inputs should not be in the same space so there is nothing
    * to verify. */
 #if ITK_VERSION_MAJOR<5
@@ -239,27 +382,24 @@ protected:
   void VerifyInputInformation() const override {}
 #endif
 
+  /** Bilinear interpolation in the slice of the input volume pointed by
+   * slice. ox and oy are the per-axis memory offsets of the two in-slice
+   * directions, see BrickedImageBuffer. */
   inline OutputPixelType BilinearInterpolation(const ThreadIdType threadId,
                                                const double stepLengthInVoxel,
-                                               const InputPixelType *pxiyi,
-                                               const InputPixelType *pxsyi,
-                                               const InputPixelType *pxiys,
-                                               const InputPixelType *pxsys,
+                                               const InputPixelType *slice,
                                                const double x,
                                                const double y,
-                                               const int ox,
-                                               const int oy);
+                                               const int *ox,
+                                               const int *oy);
 
   inline OutputPixelType BilinearInterpolationOnBorders(const ThreadIdType threadId,
                                                const double stepLengthInVoxel,
-                                               const InputPixelType *pxiyi,
-                                               const InputPixelType *pxsyi,
-                                               const InputPixelType *pxiys,
-                                               const InputPixelType *pxsys,
+                                               const InputPixelType *slice,
                                                const double x,
                                                const double y,
-                                               const int ox,
-                                               const int oy,
+                                               const int *ox,
+                                               const int *oy,
                                                const double minx,
                                                const double miny,
                                                const double maxx,
@@ -272,6 +412,14 @@ private:
   TSumAlongRay                       m_SumAlongRay;
   double                             m_InferiorClip{0.};
   double                             m_SuperiorClip{1.};
+  NestedBoxesType                    m_NestedBoxes;
+  unsigned int                       m_BrickSize{0};
+  BrickedImageBuffer<TInputImage>    m_BrickedVolume;
+  unsigned int                       m_TileSize{0};
+  ProjectionTilesScheduler<TOutputImage::ImageDimension> m_TilesScheduler;
+  unsigned int                       m_EmptySpaceCellSize{0};
+  double                             m_EmptySpaceThreshold{0.};
+  EmptySpaceSkippingGrid<TInputImage> m_EmptySpaceGrid;
 };
 
 } // end namespace rtk
@@ -24,6 +24,10 @@
 #include "rtkHomogeneousMatrix.h"
 #include "rtkBoxShape.h"
 #include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkProjectionsRegionConstIteratorRayBasedParallel.h"
+#include "rtkProjectionsRegionConstIteratorRayBasedWithFlatPanel.h"
+#include "rtkProjectionsRegionConstIteratorRayBasedWithCylindricalPanel.h"
+#include "rtkNestedVolumesRaySegments.h"
 
 #include <itkImageRegionIteratorWithIndex.h>
 
@@ -47,6 +51,65 @@ TSumAlongRay>
 #endif
 }
 
+template <class TInputImage,
+          class TOutputImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+void JosephForwardProjectionImageFilter<TInputImage,
+TOutputImage,
+TInterpolationWeightMultiplication,
+TProjectedValueAccumulation,
+TSumAlongRay>
+::AddNestedVolume(const ImageBaseType *nested)
+{
+  BoxShape::Pointer box = GetNestedVolumeBox(nested);
+  m_NestedBoxes.push_back(box.GetPointer());
+  this->Modified();
+}
+
+template <class TInputImage,
+          class TOutputImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+void JosephForwardProjectionImageFilter<TInputImage,
+TOutputImage,
+TInterpolationWeightMultiplication,
+TProjectedValueAccumulation,
+TSumAlongRay>
+::ClearNestedVolumes()
+{
+  if(!m_NestedBoxes.empty())
+    {
+    m_NestedBoxes.clear();
+    this->Modified();
+    }
+}
+
+template <class TInputImage,
+          class TOutputImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+void JosephForwardProjectionImageFilter<TInputImage,
+TOutputImage,
+TInterpolationWeightMultiplication,
+TProjectedValueAccumulation,
+TSumAlongRay>
+::BeforeThreadedGenerateData()
+{
+  m_BrickedVolume.SetImage(this->GetInput(1), m_BrickSize);
+  if(m_EmptySpaceCellSize == 1)
+    {
+    itkExceptionMacro(<< "The cells of the empty space skipping grid must be larger than one voxel");
+    }
+  if(m_EmptySpaceCellSize != 0)
+    m_EmptySpaceGrid.SetImage(this->GetInput(1), m_EmptySpaceCellSize, m_EmptySpaceThreshold);
+  if(m_TileSize != 0)
+    m_TilesScheduler.Initialize(this->GetOutput()->GetRequestedRegion(), m_TileSize);
+}
+
 template <class TInputImage,
           class TOutputImage,
           class TInterpolationWeightMultiplication,
@@ -60,33 +123,97 @@ TSumAlongRay>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType threadId )
 {
-  const unsigned int Dimension = TInputImage::ImageDimension;
-  int offsets[3];
-  offsets[0] = 1;
-  offsets[1] = this->GetInput(1)->GetBufferedRegion().GetSize()[0];
-  offsets[2] = this->GetInput(1)->GetBufferedRegion().GetSize()[0] * this->GetInput(1)->GetBufferedRegion().GetSize()[1];
-  const typename Superclass::GeometryType::ConstPointer geometry = this->GetGeometry();
-
-  // beginBuffer is pointing at point with index (0,0,0) in memory, even if
-  // it is not in the allocated memory
-  const typename TInputImage::PixelType *beginBuffer =
-      this->GetInput(1)->GetBufferPointer() -
-      offsets[0] * this->GetInput(1)->GetBufferedRegion().GetIndex()[0] -
-      offsets[1] * this->GetInput(1)->GetBufferedRegion().GetIndex()[1] -
-      offsets[2] * this->GetInput(1)->GetBufferedRegion().GetIndex()[2];
+  if(m_TileSize == 0)
+    {
+    this->ProjectRegion(outputRegionForThread, threadId);
+    return;
+    }
 
+  // Process tiles until all tiles have been processed by this or other threads
+  OutputImageRegionType tile;
+  while( m_TilesScheduler.GetNextTile(tile) )
+    this->ProjectRegion(tile, threadId);
+}
+
+template <class TInputImage,
+          class TOutputImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+void JosephForwardProjectionImageFilter<TInputImage,
+TOutputImage,
+TInterpolationWeightMultiplication,
+TProjectedValueAccumulation,
+TSumAlongRay>
+::ProjectRegion(const OutputImageRegionType& outputRegionForThread,
+                ThreadIdType threadId )
+{
   // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
   // corresponding 3D volume index
   typename Superclass::GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
   volPPToIndex = GetPhysicalPointToIndexMatrix( this->GetInput(1) );
 
-  // Iterators on input and output projections
+  // Iterator on input projections. If the input is an implicit constant, its
+  // buffer is not read and the ray iterator is set on the output which has
+  // the same pixel positions.
+  typename TInputImage::PixelType constant;
+  const TInputImage *inputProjections = this->GetInput();
+  if(this->GetImplicitConstantInput(constant))
+    inputProjections = dynamic_cast<const TInputImage *>(static_cast<const itk::DataObject *>(this->GetOutput()));
   using InputRegionIterator = ProjectionsRegionConstIteratorRayBased<TInputImage>;
-  InputRegionIterator *itIn;
-  itIn = InputRegionIterator::New(this->GetInput(),
-                                  outputRegionForThread,
-                                  geometry,
-                                  volPPToIndex);
+  const typename InputRegionIterator::MatrixType postMat = InputRegionIterator::GetPostMultiplyMatrix(volPPToIndex);
+  const typename Superclass::GeometryType *geometry = this->GetGeometry();
+  switch(InputRegionIterator::GetRayGeometryType(geometry))
+    {
+    case InputRegionIterator::PARALLEL:
+      {
+      ProjectionsRegionConstIteratorRayBasedParallel<TInputImage> itIn(inputProjections, outputRegionForThread, geometry, postMat);
+      this->ProjectRegion(itIn, volPPToIndex, outputRegionForThread, threadId);
+      break;
+      }
+    case InputRegionIterator::FLAT_PANEL:
+      {
+      ProjectionsRegionConstIteratorRayBasedWithFlatPanel<TInputImage> itIn(inputProjections, outputRegionForThread, geometry, postMat);
+      this->ProjectRegion(itIn, volPPToIndex, outputRegionForThread, threadId);
+      break;
+      }
+    default:
+      {
+      ProjectionsRegionConstIteratorRayBasedWithCylindricalPanel<TInputImage> itIn(inputProjections, outputRegionForThread, geometry, postMat);
+      this->ProjectRegion(itIn, volPPToIndex, outputRegionForThread, threadId);
+      }
+    }
+}
+
+template <class TInputImage,
+          class TOutputImage,
+          class TInterpolationWeightMultiplication,
+          class TProjectedValueAccumulation,
+          class TSumAlongRay>
+template <class TRayIterator>
+void JosephForwardProjectionImageFilter<TInputImage,
+TOutputImage,
+TInterpolationWeightMultiplication,
+TProjectedValueAccumulation,
+TSumAlongRay>
+::ProjectRegion(TRayIterator &itIn,
+                const ThreeDHomogeneousMatrixType &volPPToIndex,
+                const OutputImageRegionType& outputRegionForThread,
+                ThreadIdType threadId )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+
+  // beginBuffer is pointing at the first voxel of the buffered region and
+  // offsets[i][j] is the memory offset of index j along dimension i
+  const typename TInputImage::PixelType *beginBuffer = m_BrickedVolume.GetBeginBuffer();
+  const int *offsets[3];
+  for(unsigned int i=0; i<Dimension; i++)
+    offsets[i] = m_BrickedVolume.GetOffsets(i);
+
+  // Output iterator. If the input is an implicit constant, itIn is set on
+  // the output and it is not read.
+  typename TInputImage::PixelType constant;
+  const bool implicit = this->GetImplicitConstantInput(constant);
   using OutputRegionIterator = itk::ImageRegionIteratorWithIndex<TOutputImage>;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
@@ -103,6 +230,11 @@ TSumAlongRay>
   box->SetBoxMin(boxMin);
   box->SetBoxMax(boxMax);
 
+  // Boxes of the nested volumes in the index coordinates of the input volume
+  std::vector<BoxShape::Pointer> nestedBoxes;
+  GetNestedBoxesInIndexCoordinates(m_NestedBoxes, this->GetInput(1), volPPToIndex, nestedBoxes);
+  RaySegmentsType segments, holes, nonEmptySegments;
+
   // m_InferiorClip and m_SuperiorClip are understood in the sense of a
   // source-to-pixel vector. Since we go from pixel-to-source, we invert them.
   double inferiorClip = 1.-m_SuperiorClip;
@@ -110,10 +242,10 @@ TSumAlongRay>
 
   // Go over each pixel of the projection
   typename BoxShape::VectorType stepMM, np, fp;
-  for(unsigned int pix=0; pix<outputRegionForThread.GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
+  for(unsigned int pix=0; pix<outputRegionForThread.GetNumberOfPixels(); pix++, itIn.Next(), ++itOut)
   {
-    typename InputRegionIterator::PointType pixelPosition = itIn->GetPixelPosition();
-    typename InputRegionIterator::PointType dirVox = - itIn->GetSourceToPixel();
+    typename TRayIterator::PointType pixelPosition = itIn.GetPixelPosition();
+    typename TRayIterator::PointType dirVox = - itIn.GetSourceToPixel();
 
     // Select main direction
     unsigned int mainDir = 0;
@@ -135,15 +267,15 @@ TSumAlongRay>
       nearDist = std::max(nearDist, inferiorClip);
       farDist = std::min(farDist, superiorClip);
 
-      // Compute and sort intersections: (n)earest and (f)arthest (p)points
-      np = pixelPosition + nearDist * dirVox;
-      fp = pixelPosition + farDist * dirVox;
-      if(np[mainDir]>fp[mainDir])
-        std::swap(np, fp);
+      // Skip the parts of the ray inside nested volumes
+      ComputeRaySegmentsOutsideBoxes(pixelPosition, dirVox, nearDist, farDist, nestedBoxes, segments, holes);
 
-      // Compute main nearest and farthest slice indices
-      const int ns = itk::Math::rnd( np[mainDir]);
-      const int fs = itk::Math::rnd( fp[mainDir]);
+      // Skip the slices of the ray in empty cells
+      if(m_EmptySpaceCellSize != 0)
+        {
+        m_EmptySpaceGrid.RemoveEmptySpace(pixelPosition, dirVox, mainDir, segments, nonEmptySegments, holes);
+        segments.swap(nonEmptySegments);
+        }
 
       // Determine the other two directions
       unsigned int notMainDirInf = (mainDir+1)%Dimension;
@@ -156,24 +288,14 @@ TSumAlongRay>
       const CoordRepType maxx = box->GetBoxMax()[notMainDirInf];
       const CoordRepType maxy = box->GetBoxMax()[notMainDirSup];
 
-      // Init data pointers to first pixel of slice ns (i)nferior and (s)uperior (x|y) corner
-      const int offsetx = offsets[notMainDirInf];
-      const int offsety = offsets[notMainDirSup];
-      const int offsetz = offsets[mainDir];
-      const typename TInputImage::PixelType *pxiyi, *pxsyi, *pxiys, *pxsys;
+      const int *offsetx = offsets[notMainDirInf];
+      const int *offsety = offsets[notMainDirSup];
+      const int *offsetz = offsets[mainDir];
 
-      pxiyi = beginBuffer + ns * offsetz;
-      pxsyi = pxiyi + offsetx;
-      pxiys = pxiyi + offsety;
-      pxsys = pxsyi + offsety;
-
-      // Compute step size and go to first voxel
-      const CoordRepType residual = ns - np[mainDir];
+      // Compute step size
       const CoordRepType norm = 1/dirVox[mainDir];
       const CoordRepType stepx = dirVox[notMainDirInf] * norm;
       const CoordRepType stepy = dirVox[notMainDirSup] * norm;
-      CoordRepType currentx = np[notMainDirInf] + residual * stepx;
-      CoordRepType currenty = np[notMainDirSup] + residual * stepy;
 
       // Compute voxel to millimeters conversion
       stepMM[notMainDirInf] = this->GetInput(1)->GetSpacing()[notMainDirInf] * stepx;
@@ -183,59 +305,79 @@ TSumAlongRay>
       // Initialize the accumulation
       typename TOutputImage::PixelType sum = itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue();
 
-      typename TInputImage::PixelType volumeValue = itk::NumericTraits<typename TInputImage::PixelType>::ZeroValue();
-      if (fs == ns) //If the voxel is a corner, we can skip most steps
-      {
-        volumeValue = BilinearInterpolationOnBorders(threadId, fp[mainDir] - np[mainDir],
-                                              pxiyi, pxsyi, pxiys, pxsys,
-                                              currentx, currenty, offsetx, offsety,
-                                              minx, miny, maxx, maxy);
-        sum += m_SumAlongRay(threadId, volumeValue, stepMM);
-      }
-      else
-      {
-        // First step
-        volumeValue = BilinearInterpolationOnBorders(threadId, residual + 0.5,
-                                              pxiyi, pxsyi, pxiys, pxsys,
-                                              currentx, currenty, offsetx, offsety,
-                                              minx, miny, maxx, maxy);
-        sum += m_SumAlongRay(threadId, volumeValue, stepMM);
-
-        // Move to next main direction slice
-        pxiyi += offsetz;
-        pxsyi += offsetz;
-        pxiys += offsetz;
-        pxsys += offsetz;
-        currentx += stepx;
-        currenty += stepy;
-
-        // Middle steps
-        for(int i=ns+1; i<fs; i++)
+      // Go over the segments in the order of increasing main direction slices
+      for(unsigned int s=0; s<segments.size(); s++)
         {
-          volumeValue = BilinearInterpolation(threadId, 1.0,
-                                       pxiyi, pxsyi, pxiys, pxsys,
-                                       currentx, currenty, offsetx, offsety);
+        const unsigned int seg = (dirVox[mainDir]<0.)?segments.size()-1-s:s;
+
+        // Compute and sort intersections: (n)earest and (f)arthest (p)points
+        np = pixelPosition + segments[seg].first * dirVox;
+        fp = pixelPosition + segments[seg].second * dirVox;
+        if(np[mainDir]>fp[mainDir])
+          std::swap(np, fp);
+
+        // Compute main nearest and farthest slice indices
+        const int ns = itk::Math::rnd( np[mainDir]);
+        const int fs = itk::Math::rnd( fp[mainDir]);
+
+        // Go to first voxel
+        const CoordRepType residual = ns - np[mainDir];
+        CoordRepType currentx = np[notMainDirInf] + residual * stepx;
+        CoordRepType currenty = np[notMainDirSup] + residual * stepy;
+
+        typename TInputImage::PixelType volumeValue = itk::NumericTraits<typename TInputImage::PixelType>::ZeroValue();
+        if (fs == ns) //If the voxel is a corner, we can skip most steps
+          {
+          volumeValue = BilinearInterpolationOnBorders(threadId, fp[mainDir] - np[mainDir],
+                                                beginBuffer + offsetz[ns],
+                                                currentx, currenty, offsetx, offsety,
+                                                minx, miny, maxx, maxy);
+          sum += m_SumAlongRay(threadId, volumeValue, stepMM);
+          }
+        else
+          {
+          // First step
+          volumeValue = BilinearInterpolationOnBorders(threadId, residual + 0.5,
+                                                beginBuffer + offsetz[ns],
+                                                currentx, currenty, offsetx, offsety,
+                                                minx, miny, maxx, maxy);
           sum += m_SumAlongRay(threadId, volumeValue, stepMM);
 
           // Move to next main direction slice
-          pxiyi += offsetz;
-          pxsyi += offsetz;
-          pxiys += offsetz;
-          pxsys += offsetz;
           currentx += stepx;
           currenty += stepy;
+
+          // Middle steps
+          for(int i=ns+1; i<fs; i++)
+            {
+            volumeValue = BilinearInterpolation(threadId, 1.0,
+                                         beginBuffer + offsetz[i],
+                                         currentx, currenty, offsetx, offsety);
+            sum += m_SumAlongRay(threadId, volumeValue, stepMM);
+
+            // Move to next main direction slice
+            currentx += stepx;
+            currenty += stepy;
+            }
+
+          // Last step
+          volumeValue = BilinearInterpolationOnBorders(threadId,fp[mainDir] - fs + 0.5,
+                                                beginBuffer + offsetz[fs],
+                                                currentx, currenty, offsetx, offsety,
+                                                minx, miny, maxx, maxy);
+          sum += m_SumAlongRay(threadId, volumeValue, stepMM);
+          }
         }
 
-        // Last step
-        volumeValue = BilinearInterpolationOnBorders(threadId,fp[mainDir] - fs + 0.5,
-                                              pxiyi, pxsyi, pxiys, pxsys,
-                                              currentx, currenty, offsetx, offsety,
-                                              minx, miny, maxx, maxy);
-        sum += m_SumAlongRay(threadId, volumeValue, stepMM);
-      }
+      // Nearest and farthest points of the whole ray for the accumulation
+      np = pixelPosition + nearDist * dirVox;
+      fp = pixelPosition + farDist * dirVox;
+      if(np[mainDir]>fp[mainDir])
+        std::swap(np, fp);
+
       // Accumulate
       m_ProjectedValueAccumulation(threadId,
-                                   itIn->Get(),
+                                   (implicit)?constant:itIn.Get(),
                                    itOut.Value(),
                                    sum,
                                    stepMM,
@@ -246,7 +388,7 @@ TSumAlongRay>
     }
     else
       m_ProjectedValueAccumulation(threadId,
-                                   itIn->Get(),
+                                   (implicit)?constant:itIn.Get(),
                                    itOut.Value(),
                                    0.,
                                    pixelPosition,
@@ -255,7 +397,6 @@ TSumAlongRay>
                                    pixelPosition,
                                    pixelPosition);
   }
-  delete itIn;
 }
 
 template <class TInputImage,
@@ -275,38 +416,14 @@ TProjectedValueAccumulation,
 TSumAlongRay>
 ::BilinearInterpolation( const ThreadIdType threadId,
                          const double stepLengthInVoxel,
-                         const InputPixelType *pxiyi,
-                         const InputPixelType *pxsyi,
-                         const InputPixelType *pxiys,
-                         const InputPixelType *pxsys,
+                         const InputPixelType *slice,
                          const CoordRepType x,
                          const CoordRepType y,
-                         const int ox,
-                         const int oy )
+                         const int *ox,
+                         const int *oy )
 {
-  int ix = itk::Math::floor(x);
-  int iy = itk::Math::floor(y);
-  int idx = ix*ox + iy*oy;
-  CoordRepType lx = x - ix;
-  CoordRepType ly = y - iy;
-  CoordRepType lxc = 1.-lx;
-  CoordRepType lyc = 1.-ly;
-  return ( m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * lyc, pxiyi, idx) +
-           m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * lyc, pxsyi, idx) +
-           m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * ly , pxiys, idx) +
-           m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * ly , pxsys, idx) );
-  /* Alternative slower solution
-  const unsigned int ix = itk::Math::Floor(x);
-  const unsigned int iy = itk::Math::Floor(y);
-  const unsigned int idx = ix*ox + iy*oy;
-  const CoordRepType a = p1[idx];
-  const CoordRepType b = p2[idx] - a;
-  const CoordRepType c = p3[idx] - a;
-  const CoordRepType lx = x-ix;
-  const CoordRepType ly = y-iy;
-  const CoordRepType d = p4[idx] - a - b - c;
-  return a + b*lx + c*ly + d*lx*ly;
-*/
+  return Functor::JosephBilinearInterpolation<TInterpolationWeightMultiplication, InputPixelType, OutputPixelType>
+           (m_InterpolationWeightMultiplication, threadId, stepLengthInVoxel, slice, x, y, ox, oy);
 }
 
 template <class TInputImage,
@@ -326,46 +443,18 @@ TProjectedValueAccumulation,
 TSumAlongRay>
 ::BilinearInterpolationOnBorders( const ThreadIdType threadId,
                                   const double stepLengthInVoxel,
-                                  const InputPixelType *pxiyi,
-                                  const InputPixelType *pxsyi,
-                                  const InputPixelType *pxiys,
-                                  const InputPixelType *pxsys,
+                                  const InputPixelType *slice,
                                   const CoordRepType x,
                                   const CoordRepType y,
-                                  const int ox,
-                                  const int oy,
+                                  const int *ox,
+                                  const int *oy,
                                   const CoordRepType minx,
                                   const CoordRepType miny,
                                   const CoordRepType maxx,
                                   const CoordRepType maxy)
 {
-  int ix = itk::Math::floor(x);
-  int iy = itk::Math::floor(y);
-  int idx = ix*ox + iy*oy;
-  CoordRepType lx = x - ix;
-  CoordRepType ly = y - iy;
-  CoordRepType lxc = 1.-lx;
-  CoordRepType lyc = 1.-ly;
-
-  int offset_xi = 0;
-  int offset_yi = 0;
-  int offset_xs = 0;
-  int offset_ys = 0;
-
-  OutputPixelType result = itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue();
-  if(ix < minx) offset_xi = ox;
-  if(iy < miny) offset_yi = oy;
-  if(ix >= maxx) offset_xs = -ox;
-  if(iy >= maxy) offset_ys = -oy;
-
-  result += m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * lyc, pxiyi, idx + offset_xi + offset_yi);
-  result += m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lxc * ly , pxiys, idx + offset_xi + offset_ys);
-  result += m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * lyc, pxsyi, idx + offset_xs + offset_yi);
-  result += m_InterpolationWeightMultiplication(threadId, stepLengthInVoxel, lx  * ly , pxsys, idx + offset_xs + offset_ys);
-
-  result *= stepLengthInVoxel;
-
-  return (result);
+  return Functor::JosephBilinearInterpolationOnBorders<TInterpolationWeightMultiplication, InputPixelType, OutputPixelType>
+           (m_InterpolationWeightMultiplication, threadId, stepLengthInVoxel, slice, x, y, ox, oy, minx, miny, maxx, maxy);
 }
 
 } // end namespace rtk
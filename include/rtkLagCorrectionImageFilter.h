@@ -43,6 +43,12 @@ namespace rtk
  *
  * The parameters are typically estimated from either RSRF (Rising Step RF) or FSRF (Falling Step RF) response functions.
  *
+ * The state of the recursion is kept for each pixel of the detector from one
+ * frame to the next, including across calls to Update. The filter only
+ * requires that the frames of each pixel are processed in order: the output
+ * may be streamed in bands of rows or columns, e.g., with
+ * itk::StreamingImageFilter, and the frames may be given in several stacks.
+ *
  * \test rtklagcorrectiontest.cxx
  *
  * \author Sebastien Brousmiche
@@ -115,10 +121,11 @@ protected:
 
 protected:
   FloatVectorType m_S;                      // State variable
+  IndexType       m_StartIdx;               // Detector index of the first state, to account for cropping
+  ImageSizeType   m_StateSize;              // Detector size of the state
 
 private:
   bool            m_NewParamJustReceived;   // For state/correction initialization
-  IndexType       m_StartIdx;               // To account for cropping
 };
 
 }
@@ -39,6 +39,8 @@ LagCorrectionImageFilter<TImage, ModelOrder>::LagCorrectionImageFilter()
   m_A.Fill(0.0f);
   m_B.Fill(0.0f);
   m_ExpmA.Fill(0.0f);
+  m_StartIdx.Fill(0);
+  m_StateSize.Fill(0);
   m_NewParamJustReceived = false;
 }
 
@@ -82,8 +84,8 @@ void LagCorrectionImageFilter<TImage, ModelOrder>
     }
 
     m_StartIdx = this->GetInput()->GetLargestPossibleRegion().GetIndex();
-    ImageSizeType SizeInput = this->GetInput()->GetLargestPossibleRegion().GetSize();
-    m_S.assign(SizeInput[0] * SizeInput[1] * ModelOrder, 0.f);
+    m_StateSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
+    m_S.assign(m_StateSize[0] * m_StateSize[1] * ModelOrder, 0.f);
     m_NewParamJustReceived = false;
   }
 }
@@ -124,7 +126,8 @@ void LagCorrectionImageFilter<TImage, ModelOrder>
     return;
   }
 
-  ImageSizeType SizeInput = this->GetInput()->GetLargestPossibleRegion().GetSize();
+  // The state covers the detector when the parameters were set
+  const ImageSizeType &SizeInput = m_StateSize;
 
   for (unsigned int k = 0; k < thRegion.GetSize(2); ++k)
   {
@@ -239,6 +239,13 @@ public:
     itkSetMacro(ResetNesterovEvery, int)
     itkGetMacro(ResetNesterovEvery, int)
 
+    /** Update the backprojections of the gradients and of the Hessians
+     * concurrently with rtk::UpdateConcurrently instead of one after the
+     * other. Default is false. */
+    itkSetMacro(ConcurrentBranches, bool)
+    itkGetMacro(ConcurrentBranches, bool)
+    itkBooleanMacro(ConcurrentBranches)
+
     /** Set methods for all inputs, since they have different types */
     void SetInputMaterialVolumes(const TOutputImage* materialVolumes);
     void SetInputPhotonCounts(const TPhotonCounts* photonCounts);
@@ -330,6 +337,7 @@ protected:
     std::vector<int>                               m_NumberOfProjectionsInSubset;
     int                                            m_NumberOfProjections;
     int                                            m_ResetNesterovEvery;
+    bool                                           m_ConcurrentBranches;
 
     typename TOutputImage::PixelType               m_RegularizationWeights;
     typename TOutputImage::RegionType::SizeType    m_RegularizationRadius;
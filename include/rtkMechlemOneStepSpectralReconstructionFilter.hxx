@@ -20,6 +20,7 @@
 #define rtkMechlemOneStepSpectralReconstructionFilter_hxx
 
 #include "rtkMechlemOneStepSpectralReconstructionFilter.h"
+#include "rtkConcurrentUpdate.h"
 
 namespace rtk
 {
@@ -34,6 +35,7 @@ MechlemOneStepSpectralReconstructionFilter< TOutputImage, TPhotonCounts, TSpectr
   m_NumberOfProjectionsPerSubset=0;
   m_NumberOfSubsets=1;
   m_ResetNesterovEvery = itk::NumericTraits<int>::max();
+  m_ConcurrentBranches = false;
   m_NumberOfProjections=0;
   m_RegularizationWeights.Fill(0);
   m_RegularizationRadius.Fill(0);
@@ -450,8 +452,13 @@ MechlemOneStepSpectralReconstructionFilter< TOutputImage, TPhotonCounts, TSpectr
         if(i < m_NumberOfProjectionsInSubset[subset]-NProjPerExtract)
           {
           // Backproject gradient and hessian of that projection
-          m_GradientsBackProjectionFilter->Update();
-          m_HessiansBackProjectionFilter->Update();
+          if(m_ConcurrentBranches)
+            UpdateConcurrently({m_GradientsBackProjectionFilter->GetOutput(), m_HessiansBackProjectionFilter->GetOutput()});
+          else
+            {
+            m_GradientsBackProjectionFilter->Update();
+            m_HessiansBackProjectionFilter->Update();
+            }
           typename TGradientsImage::Pointer gBP = m_GradientsBackProjectionFilter->GetOutput();
           typename THessiansImage::Pointer hBP = m_HessiansBackProjectionFilter->GetOutput();
           gBP->DisconnectPipeline();
@@ -0,0 +1,109 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkNUFFTBackProjectionImageFilter_h
+#define rtkNUFFTBackProjectionImageFilter_h
+
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkParallelNUFFTGridding.h"
+
+#include <complex>
+
+namespace rtk
+{
+
+/** \class NUFFTBackProjectionImageFilter
+ * \brief Fourier-based backprojection for parallel geometries.
+ *
+ * Exact adjoint of rtk::NUFFTForwardProjectionImageFilter: the 2D FFT of each
+ * zero-padded projection is spread on the oversampled 3D Fourier grid of the
+ * volume with a Kaiser-Bessel kernel, then a single 3D inverse FFT and the
+ * deapodization give the backprojected volume, see
+ * rtk::ParallelNUFFTGridding. The spreading is multithreaded over slabs of
+ * the grid. The whole stack of projections is requested.
+ *
+ * Only parallel geometries are handled. The FFTs use FFTW when RTK is
+ * compiled with it.
+ *
+ * \test rtknufftprojectorstest.cxx
+ *
+ * \ingroup RTK Projector
+ */
+template <class TInputImage, class TOutputImage=TInputImage, class TFFTPrecision=float>
+class ITK_EXPORT NUFFTBackProjectionImageFilter :
+  public BackProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NUFFTBackProjectionImageFilter);
+
+  /** Standard class type alias. */
+  using Self = NUFFTBackProjectionImageFilter;
+  using Superclass = BackProjectionImageFilter<TInputImage,TOutputImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using ComplexType = std::complex<TFFTPrecision>;
+  using GridImageType = itk::Image<ComplexType, 3>;
+  using DetectorImageType = itk::Image<ComplexType, 2>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(NUFFTBackProjectionImageFilter, BackProjectionImageFilter);
+
+  /** Get / Set the oversampling factor of the Fourier grid of the volume.
+   * Default is 2. */
+  itkGetMacro(Oversampling, double);
+  itkSetMacro(Oversampling, double);
+
+  /** Get / Set the width in grid samples of the Kaiser-Bessel interpolation
+   * kernel. Larger values are more accurate and slower. Default is 4. */
+  itkGetMacro(KernelWidth, unsigned int);
+  itkSetMacro(KernelWidth, unsigned int);
+
+  /** Set/Get the greatest prime factor allowed in the size of the FFTs. With
+   * FFTW, the default is 13, otherwise it is 2. */
+  itkGetConstMacro(GreatestPrimeFactor, int);
+  itkSetMacro(GreatestPrimeFactor, int);
+
+protected:
+  NUFFTBackProjectionImageFilter();
+  ~NUFFTBackProjectionImageFilter() override = default;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+  /** Input 0 is only read by InitializeOutputRegion. */
+  bool SupportsImplicitConstantInput() const override { return true; }
+
+private:
+  double       m_Oversampling{2.};
+  unsigned int m_KernelWidth{4};
+  int          m_GreatestPrimeFactor{2};
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkNUFFTBackProjectionImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,191 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkNUFFTBackProjectionImageFilter_hxx
+#define rtkNUFFTBackProjectionImageFilter_hxx
+
+#include "rtkNUFFTBackProjectionImageFilter.h"
+
+#include <itkComplexToComplexFFTImageFilter.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <vector>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+NUFFTBackProjectionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::NUFFTBackProjectionImageFilter()
+{
+#if defined(USE_FFTWD)
+  if(typeid(TFFTPrecision).name() == typeid(double).name() )
+    m_GreatestPrimeFactor = 13;
+#endif
+#if defined(USE_FFTWF)
+  if(typeid(TFFTPrecision).name() == typeid(float).name() )
+    m_GreatestPrimeFactor = 13;
+#endif
+}
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+NUFFTBackProjectionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  // All projections contribute to all voxels
+  typename Superclass::InputImagePointer inputPtr1 =
+    const_cast< TInputImage * >( this->GetInput(1) );
+  if ( !inputPtr1 )
+    return;
+  inputPtr1->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+NUFFTBackProjectionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::GenerateData()
+{
+  this->AllocateOutputs();
+  TOutputImage *output = this->GetOutput();
+  const OutputImageRegionType outputRegion = output->GetRequestedRegion();
+  this->InitializeOutputRegion(outputRegion);
+
+  ParallelNUFFTGridding gridding;
+  gridding.Configure(output,
+                     this->GetInput(1),
+                     this->m_Geometry,
+                     m_Oversampling,
+                     m_KernelWidth,
+                     m_GreatestPrimeFactor);
+  const unsigned int width = gridding.GetKernelWidth();
+
+  typename GridImageType::Pointer grid = GridImageType::New();
+  grid->SetRegions( gridding.GetGridSize() );
+  grid->Allocate();
+  grid->FillBuffer( ComplexType(0.) );
+  ComplexType *gridBuffer = grid->GetBufferPointer();
+  const typename GridImageType::SizeType gridSize = gridding.GetGridSize();
+  const itk::OffsetValueType gridStride[3] = {1,
+                                              itk::OffsetValueType(gridSize[0]),
+                                              itk::OffsetValueType(gridSize[0] * gridSize[1])};
+
+  // Spread the 2D spectrum of each zero-padded projection on the grid
+  const typename DetectorImageType::SizeType detSize = gridding.GetDetectorSize();
+  const double detectorScale = gridding.GetProjectionScale() / (detSize[0] * detSize[1]);
+  using DetectorFFTType = itk::ComplexToComplexFFTImageFilter<DetectorImageType>;
+  const typename TInputImage::RegionType projRegion = this->GetInput(1)->GetBufferedRegion();
+  const itk::IndexValueType firstProj = projRegion.GetIndex(2);
+  const itk::IndexValueType lastProj = firstProj + projRegion.GetSize(2);
+  for(itk::IndexValueType iProj=firstProj; iProj<lastProj; iProj++)
+    {
+    const ParallelNUFFTGridding::ProjectionFrequenciesType &pf = gridding.GetProjectionFrequencies(iProj);
+    typename DetectorImageType::Pointer detector = DetectorImageType::New();
+    detector->SetRegions(detSize);
+    detector->Allocate();
+    detector->FillBuffer( ComplexType(0.) );
+    ComplexType *detBuffer = detector->GetBufferPointer();
+    typename TInputImage::RegionType sliceRegion = projRegion;
+    sliceRegion.SetIndex(2, iProj);
+    sliceRegion.SetSize(2, 1);
+    itk::ImageRegionConstIteratorWithIndex<TInputImage> itProj(this->GetInput(1), sliceRegion);
+    for(; !itProj.IsAtEnd(); ++itProj)
+      {
+      const itk::IndexValueType u = itProj.GetIndex()[0] - pf.FirstPixel[0];
+      const itk::IndexValueType v = itProj.GetIndex()[1] - pf.FirstPixel[1];
+      detBuffer[u + v*detSize[0]] = ComplexType( itProj.Get() );
+      }
+
+    typename DetectorFFTType::Pointer detectorFFT = DetectorFFTType::New();
+    detectorFFT->SetInput(detector);
+    detectorFFT->SetTransformDirection(DetectorFFTType::FORWARD);
+    detectorFFT->Update();
+    const ComplexType *projection = detectorFFT->GetOutput()->GetBufferPointer();
+
+    // Each thread spreads all samples on its own slab of grid slices
+    ParallelNUFFTGridding::ParallelizeRange(this, gridSize[2],
+      [&](itk::IndexValueType first, itk::IndexValueType last)
+      {
+      std::vector<itk::IndexValueType> indices(3*width);
+      std::vector<double> weights(3*width);
+      for(itk::IndexValueType j=0; j<itk::IndexValueType(detSize[1]); j++)
+        {
+        const itk::IndexValueType av = ParallelNUFFTGridding::GetSignedFrequency(j, detSize[1]);
+        for(itk::IndexValueType i=0; i<itk::IndexValueType(detSize[0]); i++)
+          {
+          const itk::IndexValueType au = ParallelNUFFTGridding::GetSignedFrequency(i, detSize[0]);
+          double g[3];
+          double phase;
+          if( !gridding.GetSample(pf, au, av, g, phase) )
+            continue;
+          gridding.GetKernelWeights(2, g[2], &indices[2*width], &weights[2*width]);
+          bool inSlab = false;
+          for(unsigned int kz=0; kz<width; kz++)
+            inSlab |= (indices[2*width+kz] >= first && indices[2*width+kz] < last);
+          if(!inSlab)
+            continue;
+          gridding.GetKernelWeights(0, g[0], &indices[0], &weights[0]);
+          gridding.GetKernelWeights(1, g[1], &indices[width], &weights[width]);
+
+          const std::complex<double> value = std::complex<double>(projection[i + j*detSize[0]]) *
+                                             std::polar(detectorScale, -phase);
+          for(unsigned int kz=0; kz<width; kz++)
+            {
+            if(indices[2*width+kz] < first || indices[2*width+kz] >= last)
+              continue;
+            ComplexType *pz = gridBuffer + indices[2*width+kz] * gridStride[2];
+            const std::complex<double> valuez = weights[2*width+kz] * value;
+            for(unsigned int ky=0; ky<width; ky++)
+              {
+              ComplexType *py = pz + indices[width+ky] * gridStride[1];
+              const std::complex<double> valuey = weights[width+ky] * valuez;
+              for(unsigned int kx=0; kx<width; kx++)
+                py[indices[kx]] += ComplexType( weights[kx] * valuey );
+              }
+            }
+          }
+        }
+      });
+    }
+
+  // Back to the volume. The adjoint of the forward FFT is the unnormalized
+  // inverse FFT while ITK normalizes it by the number of samples.
+  using GridFFTType = itk::ComplexToComplexFFTImageFilter<GridImageType>;
+  typename GridFFTType::Pointer gridFFT = GridFFTType::New();
+  gridFFT->SetInput(grid);
+  gridFFT->SetTransformDirection(GridFFTType::INVERSE);
+  gridFFT->Update();
+  grid = nullptr;
+  const ComplexType *volume = gridFFT->GetOutput()->GetBufferPointer();
+  const double gridScale = double(gridSize[0]) * gridSize[1] * gridSize[2];
+
+  itk::ImageRegionIteratorWithIndex<TOutputImage> itOut(output, outputRegion);
+  for(; !itOut.IsAtEnd(); ++itOut)
+    {
+    const typename TOutputImage::IndexType idx = itOut.GetIndex();
+    itOut.Set( itOut.Get() + gridScale * gridding.GetDeapodization(idx) *
+                             volume[gridding.GetGridOffset(idx)].real() );
+    }
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,124 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkNUFFTForwardProjectionImageFilter_h
+#define rtkNUFFTForwardProjectionImageFilter_h
+
+#include "rtkForwardProjectionImageFilter.h"
+#include "rtkParallelNUFFTGridding.h"
+
+#include <complex>
+
+namespace rtk
+{
+
+/** \class NUFFTForwardProjectionImageFilter
+ * \brief Fourier-based forward projection for parallel geometries.
+ *
+ * The volume is forward projected with the Fourier slice theorem: its 3D
+ * spectrum is computed once with a 3D FFT on an oversampled grid and the 2D
+ * spectrum of each projection is interpolated in it with a Kaiser-Bessel
+ * kernel before a 2D inverse FFT, see rtk::ParallelNUFFTGridding. The cost is
+ * O(N^3 log N + P N^2 W^3) for P projections of N^2 pixels of a N^3 volume
+ * instead of O(P N^3) for ray-driven projectors, which pays off for many
+ * projections. The volume is modeled as a band-limited function so the
+ * projections are not exactly those of rtk::JosephForwardProjectionImageFilter.
+ * The memory footprint is that of the grid, Oversampling^3 N^3 complex values.
+ * The spectrum is kept between updates and only recomputed if the volume or
+ * the gridding parameters have changed, e.g., when the projections are
+ * streamed.
+ *
+ * Only parallel geometries are handled, with any gantry, in-plane and
+ * out-of-plane angles. rtk::NUFFTBackProjectionImageFilter is the exact
+ * adjoint of this filter. The FFTs use FFTW when RTK is compiled with it.
+ *
+ * \test rtknufftprojectorstest.cxx
+ *
+ * \ingroup RTK Projector
+ */
+template <class TInputImage, class TOutputImage=TInputImage, class TFFTPrecision=float>
+class ITK_EXPORT NUFFTForwardProjectionImageFilter :
+  public ForwardProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NUFFTForwardProjectionImageFilter);
+
+  /** Standard class type alias. */
+  using Self = NUFFTForwardProjectionImageFilter;
+  using Superclass = ForwardProjectionImageFilter<TInputImage,TOutputImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using ComplexType = std::complex<TFFTPrecision>;
+  using GridImageType = itk::Image<ComplexType, 3>;
+  using DetectorImageType = itk::Image<ComplexType, 2>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(NUFFTForwardProjectionImageFilter, ForwardProjectionImageFilter);
+
+  /** Get / Set the oversampling factor of the Fourier grid of the volume.
+   * Default is 2. */
+  itkGetMacro(Oversampling, double);
+  itkSetMacro(Oversampling, double);
+
+  /** Get / Set the width in grid samples of the Kaiser-Bessel interpolation
+   * kernel. Larger values are more accurate and slower. Default is 4. */
+  itkGetMacro(KernelWidth, unsigned int);
+  itkSetMacro(KernelWidth, unsigned int);
+
+  /** Set/Get the greatest prime factor allowed in the size of the FFTs. With
+   * FFTW, the default is 13, otherwise it is 2. */
+  itkGetConstMacro(GreatestPrimeFactor, int);
+  itkSetMacro(GreatestPrimeFactor, int);
+
+protected:
+  NUFFTForwardProjectionImageFilter();
+  ~NUFFTForwardProjectionImageFilter() override = default;
+
+  bool SupportsImplicitConstantInput() const override { return true; }
+
+  void GenerateData() override;
+
+private:
+  double       m_Oversampling{2.};
+  unsigned int m_KernelWidth{4};
+  int          m_GreatestPrimeFactor{2};
+
+  /** 3D spectrum of the volume and the volume and parameters it was computed
+   * with */
+  typename GridImageType::Pointer  m_VolumeSpectrum;
+  const TInputImage *              m_VolumeSpectrumImage{nullptr};
+  itk::ModifiedTimeType            m_VolumeSpectrumUpdateMTime{0};
+  itk::ModifiedTimeType            m_VolumeSpectrumMTime{0};
+  typename TInputImage::RegionType m_VolumeSpectrumRegion;
+  double                           m_VolumeSpectrumOversampling{0.};
+  unsigned int                     m_VolumeSpectrumKernelWidth{0};
+  int                              m_VolumeSpectrumGreatestPrimeFactor{0};
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkNUFFTForwardProjectionImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkNUFFTForwardProjectionImageFilter_hxx
+#define rtkNUFFTForwardProjectionImageFilter_hxx
+
+#include "rtkNUFFTForwardProjectionImageFilter.h"
+
+#include <itkComplexToComplexFFTImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <vector>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+NUFFTForwardProjectionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::NUFFTForwardProjectionImageFilter()
+{
+#if defined(USE_FFTWD)
+  if(typeid(TFFTPrecision).name() == typeid(double).name() )
+    m_GreatestPrimeFactor = 13;
+#endif
+#if defined(USE_FFTWF)
+  if(typeid(TFFTPrecision).name() == typeid(float).name() )
+    m_GreatestPrimeFactor = 13;
+#endif
+}
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+NUFFTForwardProjectionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::GenerateData()
+{
+  this->AllocateOutputs();
+  TOutputImage *output = this->GetOutput();
+  const OutputImageRegionType outputRegion = output->GetRequestedRegion();
+
+  // Initialize the output with input 0, the projections in which we project
+  typename TInputImage::PixelType constant;
+  if( this->GetImplicitConstantInput(constant) )
+    {
+    itk::ImageRegionIterator<TOutputImage> itOut(output, outputRegion);
+    for(; !itOut.IsAtEnd(); ++itOut)
+      itOut.Set(constant);
+    }
+  else if(this->GetInput() != output)
+    {
+    itk::ImageRegionConstIterator<TInputImage> itIn(this->GetInput(), outputRegion);
+    itk::ImageRegionIterator<TOutputImage> itOut(output, outputRegion);
+    for(; !itIn.IsAtEnd(); ++itIn, ++itOut)
+      itOut.Set(itIn.Get());
+    }
+
+  ParallelNUFFTGridding gridding;
+  gridding.Configure(this->GetInput(1),
+                     output,
+                     this->GetGeometry(),
+                     m_Oversampling,
+                     m_KernelWidth,
+                     m_GreatestPrimeFactor);
+  const unsigned int width = gridding.GetKernelWidth();
+
+  // 3D spectrum of the volume, unless it has been computed by a previous
+  // update with the same volume and parameters
+  const TInputImage *volume = this->GetInput(1);
+  if( m_VolumeSpectrum.IsNull() ||
+      m_VolumeSpectrumImage != volume ||
+      m_VolumeSpectrumUpdateMTime != volume->GetUpdateMTime() ||
+      m_VolumeSpectrumMTime != volume->GetMTime() ||
+      m_VolumeSpectrumRegion != volume->GetLargestPossibleRegion() ||
+      m_VolumeSpectrumOversampling != m_Oversampling ||
+      m_VolumeSpectrumKernelWidth != m_KernelWidth ||
+      m_VolumeSpectrumGreatestPrimeFactor != m_GreatestPrimeFactor )
+    {
+    m_VolumeSpectrum = nullptr;
+
+    // Deapodized volume on the oversampled grid, centered on the origin
+    typename GridImageType::Pointer grid = GridImageType::New();
+    grid->SetRegions( gridding.GetGridSize() );
+    grid->Allocate();
+    grid->FillBuffer( ComplexType(0.) );
+    ComplexType *gridBuffer = grid->GetBufferPointer();
+    itk::ImageRegionConstIteratorWithIndex<TInputImage> itVol(volume, volume->GetLargestPossibleRegion());
+    for(; !itVol.IsAtEnd(); ++itVol)
+      gridBuffer[ gridding.GetGridOffset(itVol.GetIndex()) ] =
+        ComplexType( itVol.Get() * gridding.GetDeapodization(itVol.GetIndex()) );
+
+    using GridFFTType = itk::ComplexToComplexFFTImageFilter<GridImageType>;
+    typename GridFFTType::Pointer gridFFT = GridFFTType::New();
+    gridFFT->SetInput(grid);
+    gridFFT->SetTransformDirection(GridFFTType::FORWARD);
+    gridFFT->Update();
+    m_VolumeSpectrum = gridFFT->GetOutput();
+    m_VolumeSpectrum->DisconnectPipeline();
+
+    m_VolumeSpectrumImage = volume;
+    m_VolumeSpectrumUpdateMTime = volume->GetUpdateMTime();
+    m_VolumeSpectrumMTime = volume->GetMTime();
+    m_VolumeSpectrumRegion = volume->GetLargestPossibleRegion();
+    m_VolumeSpectrumOversampling = m_Oversampling;
+    m_VolumeSpectrumKernelWidth = m_KernelWidth;
+    m_VolumeSpectrumGreatestPrimeFactor = m_GreatestPrimeFactor;
+    }
+  const ComplexType *spectrum = m_VolumeSpectrum->GetBufferPointer();
+  const itk::OffsetValueType gridStride[3] = {1,
+                                              itk::OffsetValueType(gridding.GetGridSize()[0]),
+                                              itk::OffsetValueType(gridding.GetGridSize()[0] *
+                                                                   gridding.GetGridSize()[1])};
+
+  // Interpolation of the 2D spectrum of each projection and inverse FFT
+  const typename DetectorImageType::SizeType detSize = gridding.GetDetectorSize();
+  using DetectorFFTType = itk::ComplexToComplexFFTImageFilter<DetectorImageType>;
+  const itk::IndexValueType firstProj = outputRegion.GetIndex(2);
+  const itk::IndexValueType lastProj = firstProj + outputRegion.GetSize(2);
+  for(itk::IndexValueType iProj=firstProj; iProj<lastProj; iProj++)
+    {
+    const ParallelNUFFTGridding::ProjectionFrequenciesType &pf = gridding.GetProjectionFrequencies(iProj);
+    typename DetectorImageType::Pointer detector = DetectorImageType::New();
+    detector->SetRegions(detSize);
+    detector->Allocate();
+    ComplexType *detBuffer = detector->GetBufferPointer();
+
+    ParallelNUFFTGridding::ParallelizeRange(this, detSize[1],
+      [&](itk::IndexValueType first, itk::IndexValueType last)
+      {
+      std::vector<itk::IndexValueType> indices(3*width);
+      std::vector<double> weights(3*width);
+      for(itk::IndexValueType j=first; j<last; j++)
+        {
+        const itk::IndexValueType av = ParallelNUFFTGridding::GetSignedFrequency(j, detSize[1]);
+        for(itk::IndexValueType i=0; i<itk::IndexValueType(detSize[0]); i++)
+          {
+          ComplexType &value = detBuffer[i + j*detSize[0]];
+          const itk::IndexValueType au = ParallelNUFFTGridding::GetSignedFrequency(i, detSize[0]);
+          double g[3];
+          double phase;
+          if( !gridding.GetSample(pf, au, av, g, phase) )
+            {
+            value = ComplexType(0.);
+            continue;
+            }
+          for(unsigned int d=0; d<3; d++)
+            gridding.GetKernelWeights(d, g[d], &indices[d*width], &weights[d*width]);
+
+          std::complex<double> sum(0.);
+          for(unsigned int kz=0; kz<width; kz++)
+            {
+            const ComplexType *pz = spectrum + indices[2*width+kz] * gridStride[2];
+            std::complex<double> sumy(0.);
+            for(unsigned int ky=0; ky<width; ky++)
+              {
+              const ComplexType *py = pz + indices[width+ky] * gridStride[1];
+              std::complex<double> sumx(0.);
+              for(unsigned int kx=0; kx<width; kx++)
+                sumx += weights[kx] * std::complex<double>(py[indices[kx]]);
+              sumy += weights[width+ky] * sumx;
+              }
+            sum += weights[2*width+kz] * sumy;
+            }
+          value = ComplexType( sum * std::polar(gridding.GetProjectionScale(), phase) );
+          }
+        }
+      });
+
+    typename DetectorFFTType::Pointer detectorFFT = DetectorFFTType::New();
+    detectorFFT->SetInput(detector);
+    detectorFFT->SetTransformDirection(DetectorFFTType::INVERSE);
+    detectorFFT->Update();
+    const ComplexType *projection = detectorFFT->GetOutput()->GetBufferPointer();
+
+    // Accumulate the real part in the output
+    OutputImageRegionType sliceRegion = outputRegion;
+    sliceRegion.SetIndex(2, iProj);
+    sliceRegion.SetSize(2, 1);
+    itk::ImageRegionIteratorWithIndex<TOutputImage> itOut(output, sliceRegion);
+    for(; !itOut.IsAtEnd(); ++itOut)
+      {
+      const itk::IndexValueType u = itOut.GetIndex()[0] - pf.FirstPixel[0];
+      const itk::IndexValueType v = itOut.GetIndex()[1] - pf.FirstPixel[1];
+      itOut.Set( itOut.Get() + projection[u + v*detSize[0]].real() );
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,163 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkNestedVolumesRaySegments_h
+#define rtkNestedVolumesRaySegments_h
+
+#include "rtkBoxShape.h"
+
+#include <itkMatrix.h>
+#include <itkMath.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace rtk
+{
+
+using NestedBoxesType = std::vector<BoxShape::ConstPointer>;
+using RaySegmentsType = std::vector< std::pair<double, double> >;
+
+//--------------------------------------------------------------------
+/** \brief Get the box of a volume nested in a coarser volume.
+ *
+ * The box goes from the center of the first voxel to the center of the last
+ * voxel of the LargestPossibleRegion of the nested volume, i.e., the part of
+ * space which is traced by a Joseph projector. A ray traced through the
+ * coarse volume outside this box and through the nested volume is therefore
+ * traced once and only once.
+ *
+ * \ingroup RTK
+ */
+inline BoxShape::Pointer
+GetNestedVolumeBox(const itk::ImageBase<3> *nested)
+{
+  itk::ImageBase<3>::RegionType region = nested->GetLargestPossibleRegion();
+  itk::ImageBase<3>::IndexType  lastIndex = region.GetUpperIndex();
+  itk::ImageBase<3>::PointType  first, last;
+  nested->TransformIndexToPhysicalPoint(region.GetIndex(), first);
+  nested->TransformIndexToPhysicalPoint(lastIndex, last);
+
+  BoxShape::Pointer box = BoxShape::New();
+  box->SetBoxMin(first.GetVectorFromOrigin());
+  box->SetBoxMax(last.GetVectorFromOrigin());
+  box->SetDirection(nested->GetDirection());
+  return box;
+}
+
+//--------------------------------------------------------------------
+/** \brief Convert nested volume boxes from physical coordinates to the
+ * continuous index coordinates of the volume in which they are nested.
+ *
+ * The nested volumes must have the same direction as the volume, otherwise
+ * their boxes would not be aligned with the voxel grid and an exception is
+ * thrown.
+ *
+ * \ingroup RTK
+ */
+inline void
+GetNestedBoxesInIndexCoordinates(const NestedBoxesType &physicalBoxes,
+                                 const itk::ImageBase<3> *volume,
+                                 const itk::Matrix<double, 4, 4> &volPPToIndex,
+                                 std::vector<BoxShape::Pointer> &indexBoxes)
+{
+  indexBoxes.clear();
+  for(const BoxShape::ConstPointer &physicalBox : physicalBoxes)
+    {
+    for(unsigned int i=0; i<3; i++)
+      for(unsigned int j=0; j<3; j++)
+        if(itk::Math::abs(physicalBox->GetDirection()[i][j] - volume->GetDirection()[i][j]) > 1e-6)
+          itkGenericExceptionMacro(<< "Nested volumes must have the same direction as the volume");
+
+    BoxShape::PointType boxMin, boxMax;
+    for(unsigned int i=0; i<3; i++)
+      {
+      double cmin = volPPToIndex[i][3];
+      double cmax = volPPToIndex[i][3];
+      for(unsigned int j=0; j<3; j++)
+        {
+        cmin += volPPToIndex[i][j] * physicalBox->GetBoxMin()[j];
+        cmax += volPPToIndex[i][j] * physicalBox->GetBoxMax()[j];
+        }
+      boxMin[i] = std::min(cmin, cmax);
+      boxMax[i] = std::max(cmin, cmax);
+      }
+    BoxShape::Pointer indexBox = BoxShape::New();
+    indexBox->SetBoxMin(boxMin);
+    indexBox->SetBoxMax(boxMax);
+    indexBoxes.push_back(indexBox);
+    }
+}
+
+//--------------------------------------------------------------------
+/** \brief Split the ray segment [nearDist, farDist] of origin+t*direction in
+ * the sub-segments which are outside all boxes.
+ *
+ * The sub-segments are sorted by increasing t. Without boxes, the output is
+ * the input segment, whichever its length. holes is a buffer provided by the
+ * caller to avoid one allocation per ray.
+ *
+ * \ingroup RTK
+ */
+inline void
+ComputeRaySegmentsOutsideBoxes(const BoxShape::PointType &origin,
+                               const BoxShape::VectorType &direction,
+                               const double nearDist,
+                               const double farDist,
+                               const std::vector<BoxShape::Pointer> &boxes,
+                               RaySegmentsType &segments,
+                               RaySegmentsType &holes)
+{
+  segments.clear();
+  if(boxes.empty())
+    {
+    segments.push_back(std::make_pair(nearDist, farDist));
+    return;
+    }
+
+  // Collect the parts of [nearDist, farDist] inside each box
+  holes.clear();
+  for(const BoxShape::Pointer &box : boxes)
+    {
+    double holeNear, holeFar;
+    if( box->IsIntersectedByRay(origin, direction, holeNear, holeFar) )
+      {
+      holeNear = std::max(holeNear, nearDist);
+      holeFar = std::min(holeFar, farDist);
+      if(holeNear<holeFar)
+        holes.push_back(std::make_pair(holeNear, holeFar));
+      }
+    }
+  std::sort(holes.begin(), holes.end());
+
+  // Keep the gaps between the (possibly overlapping) holes
+  double current = nearDist;
+  for(const std::pair<double, double> &hole : holes)
+    {
+    if(hole.first>current)
+      segments.push_back(std::make_pair(current, hole.first));
+    current = std::max(current, hole.second);
+    }
+  if(current<farDist)
+    segments.push_back(std::make_pair(current, farDist));
+}
+
+} // end namespace rtk
+
+#endif // rtkNestedVolumesRaySegments_h
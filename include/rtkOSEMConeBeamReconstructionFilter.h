@@ -30,6 +30,7 @@
 
 #include "rtkConstantImageSource.h"
 #include "rtkIterativeConeBeamReconstructionFilter.h"
+#include "rtkProjectionsCacheImageFilter.h"
 
 namespace rtk
 {
@@ -63,6 +64,7 @@ namespace rtk
  *
  *  node [shape=box];
  *  ForwardProject [ label="rtk::ForwardProjectionImageFilter" URL="\ref rtk::ForwardProjectionImageFilter"];
+ *  ProjectionsCache [ label="rtk::ProjectionsCacheImageFilter" URL="\ref rtk::ProjectionsCacheImageFilter", style=dashed];
  *  Extract [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  *  Divide1 [ label="itk::DivideImageFilter" URL="\ref itk::DivideImageFilter"];
  *  Divide [ label="itk::DivideImageFilter" URL="\ref itk::DivideImageFilter"];
@@ -84,7 +86,8 @@ namespace rtk
  *  BeforeMultiply -> Multiply;
  *  Extract -> Divide1;
  *  ProjectionZero -> ForwardProject;
- *  Input1 -> Extract;
+ *  Input1 -> ProjectionsCache;
+ *  ProjectionsCache -> Extract;
  *  ForwardProject -> Divide1;
  *  Divide1 -> BackProjection;
  *  ConstantVolume -> BeforeBP [arrowhead=none];
@@ -134,6 +137,7 @@ public:
   using DivideVolumeFilterType = itk::DivideOrZeroOutImageFilter<VolumeType, VolumeType, VolumeType>;
   using ConstantVolumeSourceType = rtk::ConstantImageSource<VolumeType>;
   using ConstantProjectionSourceType = rtk::ConstantImageSource<ProjectionType>;
+  using ProjectionsCacheFilterType = rtk::ProjectionsCacheImageFilter<ProjectionType>;
 
   using ForwardProjectionType = typename Superclass::ForwardProjectionType;
   using BackProjectionType = typename Superclass::BackProjectionType;
@@ -156,6 +160,43 @@ public:
   itkGetMacro(NumberOfProjectionsPerSubset, unsigned int);
   itkSetMacro(NumberOfProjectionsPerSubset, unsigned int);
 
+  /** Process all projections of a subset with a single forward and back
+   * projection instead of one per projection. The projection stack is then
+   * copied in memory in the shuffled order of the projections at the
+   * beginning of GenerateData, which requires the whole stack and a copy of
+   * it in memory. Default is false, it has no effect with one projection per
+   * subset or if the projections cache is used since subsets are then
+   * always batched. */
+  itkSetMacro(BatchSubsets, bool);
+  itkGetMacro(BatchSubsets, bool);
+  itkBooleanMacro(BatchSubsets);
+
+  /** Update the backprojection of the projections and the backprojection
+   * used for the normalization concurrently with rtk::UpdateConcurrently
+   * instead of one after the other. Default is false. */
+  itkSetMacro(ConcurrentBranches, bool);
+  itkGetMacro(ConcurrentBranches, bool);
+  itkBooleanMacro(ConcurrentBranches);
+
+  /** Set / Get the memory budget in bytes of a cache of the input projections.
+   * If it is not 0, the projections are read from the input on demand, one
+   * subset at a time in the shuffled order with the next subset read in
+   * advance, and the least recently used ones are dropped from the cache
+   * when the budget is exceeded. The subsets are then batched without copying
+   * the projection stack. Default is 0, the projection stack is read at once. */
+  itkSetMacro(ProjectionsCacheMemoryBudget, itk::SizeValueType);
+  itkGetMacro(ProjectionsCacheMemoryBudget, itk::SizeValueType);
+
+  /** Set / Get the name of a file where the projections are stored on disk
+   * to reconstruct stacks which do not fit in memory. The input projections
+   * are then read once and written in this file, and each subset is read from
+   * it while the previous one is processed. The memory budget bounds the
+   * projections kept in memory, only the current and the next subsets are
+   * kept if it is 0. The file must not exist, it is created and deleted by
+   * the filter. Default is empty, no store is used. */
+  itkSetStringMacro(ProjectionsStoreFileName);
+  itkGetStringMacro(ProjectionsStoreFileName);
+
   /** Select the ForwardProjection filter */
   void SetForwardProjectionFilter (ForwardProjectionType _arg) override;
 
@@ -190,11 +231,25 @@ protected:
   typename ConstantProjectionSourceType::Pointer m_ZeroConstantProjectionStackSource;
   typename ConstantProjectionSourceType::Pointer m_OneConstantProjectionStackSource;
   typename ConstantVolumeSourceType::Pointer     m_ConstantVolumeSource;
+  typename ConstantVolumeSourceType::Pointer     m_NormalizationConstantVolumeSource;
+  typename ProjectionsCacheFilterType::Pointer   m_ProjectionsCacheFilter;
 
 private:
   /** Number of projections processed before the volume is updated (several for OS-EM) */
   unsigned int m_NumberOfProjectionsPerSubset;
 
+  /** Process each subset with a single forward and back projection */
+  bool m_BatchSubsets;
+
+  /** Update the two backprojections concurrently */
+  bool m_ConcurrentBranches;
+
+  /** Memory budget of m_ProjectionsCacheFilter, 0 if it is not used */
+  itk::SizeValueType m_ProjectionsCacheMemoryBudget;
+
+  /** File storing the projections on disk, empty if it is not used */
+  std::string m_ProjectionsStoreFileName;
+
   /** Geometry object */
   ThreeDCircularProjectionGeometry::Pointer m_Geometry;
 
@@ -21,6 +21,7 @@
 
 #include "rtkOSEMConeBeamReconstructionFilter.h"
 #include "rtkGeneralPurposeFunctions.h"
+#include "rtkConcurrentUpdate.h"
 
 #include <algorithm>
 #include <itkTimeProbe.h>
@@ -42,8 +43,10 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   m_ExtractFilter = ExtractFilterType::New();
   m_MultiplyFilter = MultiplyFilterType::New();
   m_ConstantVolumeSource = ConstantVolumeSourceType::New();
+  m_NormalizationConstantVolumeSource = ConstantVolumeSourceType::New();
   m_ZeroConstantProjectionStackSource = ConstantProjectionSourceType::New();
   m_DivideProjectionFilter = DivideProjectionFilterType::New();
+  m_ProjectionsCacheFilter = ProjectionsCacheFilterType::New();
 
   // Create the filters required for the normalization of the
   // backprojection
@@ -57,6 +60,9 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   // Default parameters
   m_ExtractFilter->SetDirectionCollapseToSubmatrix();
   m_NumberOfProjectionsPerSubset = 1; //Default is the OSEM behavior
+  m_BatchSubsets = false;
+  m_ConcurrentBranches = false;
+  m_ProjectionsCacheMemoryBudget = 0;
 }
 
 template<class TVolumeImage, class TProjectionImage>
@@ -97,6 +103,16 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
 
   m_BackProjectionFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
   m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
+
+  // The projections are read on demand by m_ProjectionsCacheFilter, only
+  // the first one is requested
+  if(m_ProjectionsCacheMemoryBudget || !m_ProjectionsStoreFileName.empty())
+    {
+    auto *inputPtr1 = const_cast< TProjectionImage * >( this->GetInput(1) );
+    typename TProjectionImage::RegionType reqRegion = inputPtr1->GetLargestPossibleRegion();
+    reqRegion.SetSize(TProjectionImage::ImageDimension-1, 1);
+    inputPtr1->SetRequestedRegion(reqRegion);
+    }
 }
 
 template<class TVolumeImage, class TProjectionImage>
@@ -112,13 +128,24 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   projRegion = this->GetInput(1)->GetLargestPossibleRegion();
   m_ExtractFilter->SetExtractionRegion(projRegion);
 
-  m_ExtractFilter->SetInput( this->GetInput(1) );
+  if(m_ProjectionsCacheMemoryBudget || !m_ProjectionsStoreFileName.empty())
+    {
+    m_ProjectionsCacheFilter->SetInput( this->GetROIProjections(this->GetInput(1), this->GetInput(0), m_Geometry) );
+    m_ProjectionsCacheFilter->SetMemoryBudget(m_ProjectionsCacheMemoryBudget);
+    m_ProjectionsCacheFilter->SetStoreFileName(m_ProjectionsStoreFileName);
+    m_ProjectionsCacheFilter->SetProjectionOrder( typename ProjectionsCacheFilterType::ProjectionOrderType() );
+    m_ExtractFilter->SetInput( m_ProjectionsCacheFilter->GetOutput() );
+    }
+  else
+    m_ExtractFilter->SetInput( this->GetROIProjections(this->GetInput(1), this->GetInput(0), m_Geometry) );
   m_ExtractFilter->UpdateOutputInformation();
 
   // Links with the forward and back projection filters should be set here
   // and not in the constructor, as these filters are set at runtime
   m_ConstantVolumeSource->SetInformationFromImage(const_cast<TVolumeImage *>(this->GetInput(0)));
   m_ConstantVolumeSource->SetConstant(0);
+  m_NormalizationConstantVolumeSource->SetInformationFromImage(const_cast<TVolumeImage *>(this->GetInput(0)));
+  m_NormalizationConstantVolumeSource->SetConstant(0);
 
   m_OneConstantProjectionStackSource->SetInformationFromImage(const_cast<TProjectionImage *>(m_ExtractFilter->GetOutput()));
   m_OneConstantProjectionStackSource->SetConstant(1);
@@ -139,7 +166,7 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
 
   m_BackProjectionFilter->SetTranspose(false);
 
-  m_BackProjectionNormalizationFilter->SetInput ( 0, m_ConstantVolumeSource->GetOutput() );
+  m_BackProjectionNormalizationFilter->SetInput ( 0, m_NormalizationConstantVolumeSource->GetOutput() );
   m_BackProjectionNormalizationFilter->SetInput(1, m_OneConstantProjectionStackSource->GetOutput() );
   if (this->GetBackProjectionFilter() == this->BP_JOSEPHATTENUATED)
     {
@@ -217,6 +244,37 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
     projOrder[i] = i;
   std::shuffle( projOrder.begin(), projOrder.end(), Superclass::m_DefaultRandomEngine );
 
+  // Process each subset in one pass with contiguous projections if possible
+  unsigned int nProjPerPass = 1;
+  typename TProjectionImage::Pointer reorderedProjections;
+  const bool cache = m_ProjectionsCacheMemoryBudget || !m_ProjectionsStoreFileName.empty();
+  if(cache || (m_BatchSubsets && m_NumberOfProjectionsPerSubset>1))
+    {
+    if(cache)
+      {
+      // The cache reorders the projections on demand and reads the next
+      // subset in advance
+      m_ProjectionsCacheFilter->SetProjectionOrder(projOrder);
+      m_ProjectionsCacheFilter->SetPrefetchSize(m_NumberOfProjectionsPerSubset);
+      }
+    else
+      {
+      auto *projections = const_cast<TProjectionImage *>(m_ExtractFilter->GetInput());
+      projections->SetRequestedRegionToLargestPossibleRegion();
+      projections->Update();
+      reorderedProjections = this->GetReorderedProjections(projections, projOrder);
+      m_ExtractFilter->SetInput(reorderedProjections);
+      }
+    ThreeDCircularProjectionGeometry::Pointer reorderedGeometry = this->GetReorderedGeometry(m_Geometry, projOrder);
+    m_ForwardProjectionFilter->SetGeometry(reorderedGeometry);
+    m_BackProjectionFilter->SetGeometry(reorderedGeometry);
+    m_BackProjectionNormalizationFilter->SetGeometry(reorderedGeometry);
+    for(unsigned int i = 0; i < nProj; i++)
+      projOrder[i] = i;
+    if(m_BatchSubsets)
+      nProjPerPass = m_NumberOfProjectionsPerSubset;
+    }
+
   // Declare the image used in the main loop
   typename TVolumeImage::Pointer pimg;
   typename TVolumeImage::Pointer norm;
@@ -225,10 +283,11 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   for(unsigned int iter = 0; iter < m_NumberOfIterations; iter++)
   {
     unsigned int projectionsProcessedInSubset = 0;
-    for(unsigned int i = 0; i < nProj; i++)
+    for(unsigned int i = 0; i < nProj; i += nProjPerPass)
     {
       // Change projection subset
       subsetRegion.SetIndex( Dimension-1, projOrder[i] );
+      subsetRegion.SetSize( Dimension-1, std::min(nProjPerPass, nProj-i) );
       m_ExtractFilter->SetExtractionRegion(subsetRegion);
       m_ExtractFilter->UpdateOutputInformation();
 
@@ -243,11 +302,16 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
       m_BackProjectionNormalizationFilter->GetOutput()->UpdateOutputInformation();
       m_BackProjectionNormalizationFilter->GetOutput()->PropagateRequestedRegion();
 
-      m_BackProjectionFilter->Update();
-      m_BackProjectionNormalizationFilter->Update();
+      if(m_ConcurrentBranches)
+        UpdateConcurrently({m_BackProjectionFilter->GetOutput(), m_BackProjectionNormalizationFilter->GetOutput()});
+      else
+        {
+        m_BackProjectionFilter->Update();
+        m_BackProjectionNormalizationFilter->Update();
+        }
 
-      projectionsProcessedInSubset++;
-      if ((projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset) || (i == nProj - 1))
+      projectionsProcessedInSubset += subsetRegion.GetSize(Dimension-1);
+      if ((projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset) || (i + nProjPerPass >= nProj))
       {
         m_DivideVolumeFilter->SetInput2(m_BackProjectionNormalizationFilter->GetOutput());
         m_DivideVolumeFilter->SetInput1(m_BackProjectionFilter->GetOutput());
@@ -264,7 +328,7 @@ OSEMConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
         m_ForwardProjectionFilter->SetInput(1, pimg );
         m_MultiplyFilter->SetInput2(pimg);
         m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
-        m_BackProjectionNormalizationFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
+        m_BackProjectionNormalizationFilter->SetInput(0, m_NormalizationConstantVolumeSource->GetOutput());
 
         projectionsProcessedInSubset = 0;
       }
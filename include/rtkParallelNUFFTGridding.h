@@ -0,0 +1,375 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkParallelNUFFTGridding_h
+#define rtkParallelNUFFTGridding_h
+
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkMacro.h"
+
+#include <itkImageBase.h>
+#include <itkImageRegion.h>
+#include <itkMath.h>
+#include <itkProcessObject.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace rtk
+{
+
+/** \class ParallelNUFFTGridding
+ * \brief Kaiser-Bessel gridding between the 3D spectrum of a volume and the
+ * 2D spectra of parallel projections.
+ *
+ * By the Fourier slice theorem, the 2D Fourier transform of a parallel
+ * projection is the central slice of the 3D Fourier transform of the volume
+ * orthogonal to the rays. The volume is modeled as a band-limited function
+ * sampled at the voxel centers. Its spectrum is computed on a Cartesian grid
+ * oversampled by a factor Oversampling with a 3D FFT, after division of the
+ * voxel values by the Fourier transform of the interpolation kernel
+ * (deapodization). The grid is then interpolated at the frequencies of the 2D
+ * FFT of each projection with a separable Kaiser-Bessel kernel of KernelWidth
+ * grid samples [Beatty et al, IEEE TMI, 2005]. Frequencies beyond the Nyquist
+ * frequency of the volume are set to 0. The 2D FFT of the projections is
+ * zero-padded to cover the footprint of the volume on the detector, which
+ * avoids wrap-around.
+ *
+ * This class computes the grid and detector FFT sizes, the kernel weights,
+ * the deapodization factors and, for each projection, the linear mapping from
+ * the detector frequency indices to the grid coordinates and to the phase
+ * shift accounting for the positions of the volume and of the detector. It is
+ * shared by rtk::NUFFTForwardProjectionImageFilter and
+ * rtk::NUFFTBackProjectionImageFilter. Only parallel geometries, i.e., with a
+ * source to detector distance of 0, are handled.
+ *
+ * \ingroup RTK
+ */
+class ParallelNUFFTGridding
+{
+public:
+  using GeometryType = ThreeDCircularProjectionGeometry;
+  using ImageBaseType = itk::ImageBase<3>;
+  using IndexType = itk::Index<3>;
+  using GridSizeType = itk::Size<3>;
+  using DetectorSizeType = itk::Size<2>;
+
+  /** Frequency sampling of the zero-padded 2D FFT of one projection. The
+   * frequency index (au,av), in [-M/2,M/2), has the grid coordinates
+   * au*GridStep[0]+av*GridStep[1] and the phase au*PhaseStep[0]+av*PhaseStep[1].
+   * The first pixel of the FFT is at detector index FirstPixel. */
+  struct ProjectionFrequenciesType
+  {
+    double              GridStep[2][3];
+    double              PhaseStep[2];
+    itk::IndexValueType FirstPixel[2];
+  };
+
+  /** Computes all sizes and tables for volume and the stack projections with
+   * geometry. Only the meta data of the two images are used. */
+  void Configure(const ImageBaseType *volume,
+                 const ImageBaseType *projections,
+                 const GeometryType *geometry,
+                 double oversampling,
+                 unsigned int kernelWidth,
+                 int greatestPrimeFactor)
+  {
+    if(oversampling < 1.)
+      itkGenericExceptionMacro(<< "Oversampling must be greater than 1, got " << oversampling);
+    if(kernelWidth < 2)
+      itkGenericExceptionMacro(<< "KernelWidth must be at least 2, got " << kernelWidth);
+    if(geometry->GetDetectorDisplacementField() != nullptr)
+      itkGenericExceptionMacro(<< "The NUFFT projectors do not handle a detector displacement field, "
+                               << "use the Joseph projectors to correct detector distortion.");
+    m_Width = kernelWidth;
+
+    // Kaiser-Bessel shape parameter [Beatty et al, IEEE TMI, 2005]
+    const double wOverS = m_Width / oversampling;
+    m_Beta = itk::Math::pi * std::sqrt( std::max(0., wOverS*wOverS*(oversampling-0.5)*(oversampling-0.5)-0.8) );
+    const unsigned int tableSize = m_Width * KernelTableSamplesPerUnit / 2 + 2;
+    m_KernelTable.resize(tableSize);
+    for(unsigned int i=0; i<tableSize; i++)
+      m_KernelTable[i] = Kernel( double(i) / KernelTableSamplesPerUnit );
+
+    // Oversampled grid and deapodization
+    const ImageBaseType::RegionType volRegion = volume->GetLargestPossibleRegion();
+    itk::Matrix<double, 3, 3> dirSpacing = volume->GetDirection();
+    itk::Vector<double, 3> centerOffset;
+    for(unsigned int d=0; d<3; d++)
+      {
+      const itk::SizeValueType n = volRegion.GetSize(d);
+      m_GridSize[d] = GetFFTSize( std::max(itk::SizeValueType(std::ceil(oversampling*n)),
+                                           itk::SizeValueType(2*m_Width)),
+                                  greatestPrimeFactor );
+      m_Deapodization[d].resize(n);
+      for(itk::SizeValueType i=0; i<n; i++)
+        {
+        const double xi = (double(i) - double(n/2)) / m_GridSize[d];
+        m_Deapodization[d][i] = 1. / KernelFourierTransform(xi);
+        }
+      m_VolumeFirstIndex[d] = volRegion.GetIndex(d);
+      centerOffset[d] = volRegion.GetIndex(d) + double(n/2);
+      for(unsigned int j=0; j<3; j++)
+        dirSpacing[j][d] *= volume->GetSpacing()[d];
+      }
+    const itk::Vector<double, 3> center = volume->GetOrigin().GetVectorFromOrigin() + dirSpacing * centerOffset;
+
+    // Detector and its padding
+    const ImageBaseType::RegionType projRegion = projections->GetLargestPossibleRegion();
+    for(unsigned int i=0; i<2; i++)
+      for(unsigned int j=0; j<2; j++)
+        if( std::abs( projections->GetDirection()[i][j] - double(i==j) ) > 1e-6 )
+          itkGenericExceptionMacro(<< "The NUFFT projectors require projections with an identity direction.");
+    const double du = projections->GetSpacing()[0];
+    const double dv = projections->GetSpacing()[1];
+    const double originU = projections->GetOrigin()[0];
+    const double originV = projections->GetOrigin()[1];
+    m_ProjectionScale = volume->GetSpacing()[0] * volume->GetSpacing()[1] * volume->GetSpacing()[2] / (du * dv);
+
+    const unsigned int nProj = geometry->GetMatrices().size();
+    m_Frequencies.resize(nProj);
+    std::vector< itk::Vector<double,3> > axes(2*nProj);
+    std::vector<double> offsets(2*nProj);
+    m_DetectorSize.Fill(1);
+    for(unsigned int iProj=0; iProj<nProj; iProj++)
+      {
+      if(geometry->GetSourceToDetectorDistances()[iProj] != 0.)
+        itkGenericExceptionMacro(<< "The NUFFT projectors only handle parallel geometries, projection "
+                                 << iProj << " has a source to detector distance of "
+                                 << geometry->GetSourceToDetectorDistances()[iProj]);
+      const GeometryType::MatrixType &matrix = geometry->GetMatrices()[iProj];
+      for(unsigned int k=0; k<2; k++)
+        {
+        for(unsigned int j=0; j<3; j++)
+          axes[2*iProj+k][j] = matrix[k][j];
+        offsets[2*iProj+k] = matrix[k][3];
+
+        // Footprint of the volume corners united with the detector
+        const double origin = (k==0)?originU:originV;
+        const double spacing = (k==0)?du:dv;
+        double lo = origin + spacing * projRegion.GetIndex(k);
+        double hi = lo + spacing * (projRegion.GetSize(k) - 1);
+        for(unsigned int c=0; c<8; c++)
+          {
+          itk::Vector<double, 3> corner;
+          for(unsigned int d=0; d<3; d++)
+            corner[d] = volRegion.GetIndex(d) - 0.5 + ((c>>d)&1) * volRegion.GetSize(d);
+          const double u = axes[2*iProj+k] * (volume->GetOrigin().GetVectorFromOrigin() + dirSpacing * corner) +
+                           offsets[2*iProj+k];
+          lo = std::min(lo, u);
+          hi = std::max(hi, u);
+          }
+        m_Frequencies[iProj].FirstPixel[k] = itk::Math::Floor<itk::IndexValueType>( (lo - origin) / spacing );
+        const itk::SizeValueType extent = itk::Math::Ceil<itk::IndexValueType>( (hi - origin) / spacing ) -
+                                          m_Frequencies[iProj].FirstPixel[k] + 1;
+        m_DetectorSize[k] = std::max(m_DetectorSize[k], extent);
+        }
+      }
+    for(unsigned int k=0; k<2; k++)
+      m_DetectorSize[k] = GetFFTSize(m_DetectorSize[k], greatestPrimeFactor);
+
+    // Linear maps from detector frequency indices to grid coordinates and phases
+    for(unsigned int iProj=0; iProj<nProj; iProj++)
+      {
+      ProjectionFrequenciesType &pf = m_Frequencies[iProj];
+      for(unsigned int k=0; k<2; k++)
+        {
+        const double origin = (k==0)?originU:originV;
+        const double spacing = (k==0)?du:dv;
+        const double frequencyStep = 1. / (m_DetectorSize[k] * spacing);
+        for(unsigned int d=0; d<3; d++)
+          {
+          // Frequency in cycles per voxel along the volume axis d
+          double t = 0.;
+          for(unsigned int j=0; j<3; j++)
+            t += dirSpacing[j][d] * axes[2*iProj+k][j];
+          pf.GridStep[k][d] = t * frequencyStep * m_GridSize[d];
+          }
+        const double firstPixelPosition = origin + pf.FirstPixel[k] * spacing;
+        pf.PhaseStep[k] = -2. * itk::Math::pi * frequencyStep *
+                          ( axes[2*iProj+k] * center + offsets[2*iProj+k] - firstPixelPosition );
+        }
+      }
+  }
+
+  const GridSizeType & GetGridSize() const { return m_GridSize; }
+  const DetectorSizeType & GetDetectorSize() const { return m_DetectorSize; }
+  unsigned int GetKernelWidth() const { return m_Width; }
+
+  /** Scaling factor between the volume and its projections, i.e., the voxel
+   * volume over the pixel area. */
+  double GetProjectionScale() const { return m_ProjectionScale; }
+
+  const ProjectionFrequenciesType & GetProjectionFrequencies(unsigned int iProj) const
+  {
+    return m_Frequencies[iProj];
+  }
+
+  /** Signed frequency index of index i of a FFT of size n. */
+  static itk::IndexValueType GetSignedFrequency(itk::IndexValueType i, itk::SizeValueType n)
+  {
+    return (2*i >= itk::IndexValueType(n))?i-itk::IndexValueType(n):i;
+  }
+
+  /** Grid coordinates and phase of frequency (au,av). Returns false if the
+   * frequency is beyond the Nyquist frequency of the volume. */
+  bool GetSample(const ProjectionFrequenciesType &pf,
+                 itk::IndexValueType au,
+                 itk::IndexValueType av,
+                 double g[3],
+                 double &phase) const
+  {
+    for(unsigned int d=0; d<3; d++)
+      {
+      g[d] = au * pf.GridStep[0][d] + av * pf.GridStep[1][d];
+      if( 2. * std::abs(g[d]) > m_GridSize[d] )
+        return false;
+      }
+    phase = au * pf.PhaseStep[0] + av * pf.PhaseStep[1];
+    return true;
+  }
+
+  /** Indices (modulo the grid size) and weights of the KernelWidth grid
+   * samples along dimension d around grid coordinate g. */
+  void GetKernelWeights(unsigned int d, double g, itk::IndexValueType *indices, double *weights) const
+  {
+    const itk::IndexValueType first = itk::Math::Ceil<itk::IndexValueType>(g - 0.5*m_Width);
+    const itk::IndexValueType n = m_GridSize[d];
+    for(unsigned int i=0; i<m_Width; i++)
+      {
+      const itk::IndexValueType l = first + i;
+      indices[i] = ((l % n) + n) % n;
+      const double t = std::abs(g - l) * KernelTableSamplesPerUnit;
+      const unsigned int it = std::min( (unsigned int)(t), (unsigned int)m_KernelTable.size()-2 );
+      const double w = t - it;
+      weights[i] = (1.-w) * m_KernelTable[it] + w * m_KernelTable[it+1];
+      }
+  }
+
+  /** Offset in the grid buffer of the voxel of index idx of the volume. */
+  itk::OffsetValueType GetGridOffset(const IndexType &idx) const
+  {
+    itk::OffsetValueType offset = 0;
+    for(int d=2; d>=0; d--)
+      {
+      const itk::IndexValueType n = m_GridSize[d];
+      const itk::IndexValueType c = idx[d] - m_VolumeFirstIndex[d] - itk::IndexValueType(m_Deapodization[d].size()/2);
+      offset = offset * n + ((c % n) + n) % n;
+      }
+    return offset;
+  }
+
+  /** Deapodization factor of the voxel of index idx of the volume. */
+  double GetDeapodization(const IndexType &idx) const
+  {
+    return m_Deapodization[0][idx[0]-m_VolumeFirstIndex[0]] *
+           m_Deapodization[1][idx[1]-m_VolumeFirstIndex[1]] *
+           m_Deapodization[2][idx[2]-m_VolumeFirstIndex[2]];
+  }
+
+  /** Calls f(first, last) on sub-ranges of [0,n) with the multithreader of
+   * filter. */
+  template <class TFunction>
+  static void ParallelizeRange(itk::ProcessObject *filter, itk::SizeValueType n, TFunction f)
+  {
+#if ITK_VERSION_MAJOR>4
+    itk::ImageRegion<1> region;
+    region.SetSize(0, n);
+    filter->GetMultiThreader()->template ParallelizeImageRegion<1>
+      (
+      region,
+      [&f](const itk::ImageRegion<1> & r)
+        {
+        f(r.GetIndex(0), r.GetIndex(0) + itk::IndexValueType(r.GetSize(0)));
+        },
+      nullptr
+      );
+#else
+    (void)filter;
+    f(0, itk::IndexValueType(n));
+#endif
+  }
+
+  /** Modified Bessel function of the first kind of order 0 */
+  static double BesselI0(double x)
+  {
+    double sum = 1.;
+    double term = 1.;
+    const double q = 0.25 * x * x;
+    for(unsigned int k=1; k<200 && term > 1e-17 * sum; k++)
+      {
+      term *= q / (double(k) * k);
+      sum += term;
+      }
+    return sum;
+  }
+
+protected:
+  static constexpr unsigned int KernelTableSamplesPerUnit = 1000;
+
+  /** Kaiser-Bessel kernel at distance t of its center. */
+  double Kernel(double t) const
+  {
+    const double r = 2. * t / m_Width;
+    if(r >= 1.)
+      return 0.;
+    return BesselI0( m_Beta * std::sqrt(1. - r*r) );
+  }
+
+  /** Continuous Fourier transform of Kernel at frequency xi. */
+  double KernelFourierTransform(double xi) const
+  {
+    const double a = itk::Math::pi * m_Width * xi;
+    const double s = m_Beta * m_Beta - a * a;
+    if(s > 1e-12)
+      return m_Width * std::sinh(std::sqrt(s)) / std::sqrt(s);
+    else if(s < -1e-12)
+      return m_Width * std::sin(std::sqrt(-s)) / std::sqrt(-s);
+    return m_Width;
+  }
+
+  /** Smallest size larger than or equal to n whose greatest prime factor is
+   * lower than or equal to greatestPrimeFactor. */
+  static itk::SizeValueType GetFFTSize(itk::SizeValueType n, int greatestPrimeFactor)
+  {
+    for(;; n++)
+      {
+      itk::SizeValueType m = n;
+      for(itk::SizeValueType p=2; p<=itk::SizeValueType(greatestPrimeFactor) && m>1; p++)
+        while(m%p == 0)
+          m /= p;
+      if(m == 1)
+        return n;
+      }
+  }
+
+  unsigned int                           m_Width{4};
+  double                                 m_Beta{0.};
+  std::vector<double>                    m_KernelTable;
+  GridSizeType                           m_GridSize;
+  DetectorSizeType                       m_DetectorSize;
+  IndexType                              m_VolumeFirstIndex;
+  std::vector<double>                    m_Deapodization[3];
+  double                                 m_ProjectionScale{1.};
+  std::vector<ProjectionFrequenciesType> m_Frequencies;
+};
+
+} // end namespace rtk
+
+#endif
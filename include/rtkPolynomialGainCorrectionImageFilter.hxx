@@ -113,9 +113,28 @@ PolynomialGainCorrectionImageFilter<TInputImage, TOutputImage>
   if (!inputPtr || !outputPtr)
     return;
 
-  InputImageRegionType inputRequestedRegion = outputPtr->GetLargestPossibleRegion();
-  inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion());     // Because Largest region has been updated
-  inputPtr->SetRegions(inputRequestedRegion);
+  // Each pixel only depends on the same pixel of the input, the dark image
+  // and the gain maps so any region, e.g., a band of rows, can be streamed.
+  InputImageRegionType inputRequestedRegion = outputPtr->GetRequestedRegion();
+  inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion());
+  inputPtr->SetRequestedRegion(inputRequestedRegion);
+
+  if (m_K == 0.)
+    return;
+
+  // The dark image and the gain maps must cover the requested detector region
+  const InputImageRegionType darkRegion = m_DarkImage->GetLargestPossibleRegion();
+  const OutputImageRegionType gainRegion = m_GainImage->GetLargestPossibleRegion();
+  for (unsigned int i = 0; i < 2; i++)
+    {
+    const itk::IndexValueType first = inputRequestedRegion.GetIndex(i);
+    const itk::IndexValueType last = first + inputRequestedRegion.GetSize(i);
+    if (first < darkRegion.GetIndex(i) || last > darkRegion.GetIndex(i) + (itk::IndexValueType)darkRegion.GetSize(i) ||
+        first < gainRegion.GetIndex(i) || last > gainRegion.GetIndex(i) + (itk::IndexValueType)gainRegion.GetSize(i))
+      {
+      itkExceptionMacro(<< "The dark image and the gain maps do not cover the requested region " << inputRequestedRegion);
+      }
+    }
 }
 
 template<class TInputImage, class TOutputImage>
@@ -146,11 +165,12 @@ PolynomialGainCorrectionImageFilter<TInputImage, TOutputImage>
 
   InputImageRegionType darkRegion = outputRegionForThread;
   darkRegion.SetSize(2, 1);
-  darkRegion.SetIndex(2, 0);
+  darkRegion.SetIndex(2, m_DarkImage->GetLargestPossibleRegion().GetIndex(2));
   itk::ImageRegionConstIterator<InputImageType> itDark(m_DarkImage, darkRegion);
 
-  // Get gain map buffer
+  // Get gain map buffer, the maps are indexed like the detector
   const typename OutputImageType::PixelType *gainBuffer = m_GainImage->GetBufferPointer();
+  const typename OutputImageType::IndexType gainIndex = m_GainImage->GetLargestPossibleRegion().GetIndex();
 
   int startk = static_cast<int>(outputRegionForThread.GetIndex(2));
   for (int k = startk; k < startk + static_cast<int>(outputRegionForThread.GetSize(2)); k++)
@@ -171,7 +191,7 @@ PolynomialGainCorrectionImageFilter<TInputImage, TOutputImage>
         int lutidx = px*m_ModelOrder;
         for (int m = 0; m < m_ModelOrder; ++m)
           {
-          int gainidx = m*m_GainSize[1]*m_GainSize[0]+j*m_GainSize[0] + i;
+          int gainidx = m*m_GainSize[1]*m_GainSize[0] + (j-gainIndex[1])*m_GainSize[0] + i-gainIndex[0];
           float gainM = gainBuffer[gainidx];
           correctedValue += gainM *m_PowerLut[lutidx + m];
           }
@@ -0,0 +1,174 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkProgressiveFDKConeBeamReconstructionFilter_h
+#define rtkProgressiveFDKConeBeamReconstructionFilter_h
+
+#include "rtkFDKConeBeamReconstructionFilter.h"
+#include "rtkSubSelectFromListImageFilter.h"
+#include "rtkConstantImageSource.h"
+
+#include <itkBinShrinkImageFilter.h>
+
+namespace rtk
+{
+
+/** \class ProgressiveFDKConeBeamReconstructionFilter
+ * \brief FDK reconstruction producing previews of increasing quality
+ *
+ * The reconstruction is performed in NumberOfLevels steps with the same
+ * rtk::FDKConeBeamReconstructionFilter, whose ramp and backprojection
+ * filters can be set beforehand:
+ * - for each level l from NumberOfLevels-1 down to 1, a coarse
+ *   reconstruction using one projection out of 2^l, binned by 2^l along
+ *   both detector axes, on a volume grid with voxels 2^l times larger,
+ * - at full resolution, 2^(NumberOfLevels-1) passes, each backprojecting
+ *   an interleaved subset of the projections, in bit-reversed order so that
+ *   the projections processed after each pass are evenly spread.
+ * The full resolution passes are accumulated in the same volume, i.e.,
+ * no projection is filtered or backprojected twice at full resolution: each
+ * projection is weighted with its angular gap in the full geometry and the
+ * last pass gives the same volume as rtk::FDKConeBeamReconstructionFilter.
+ * The coarse reconstructions are only previews and they are discarded. Level
+ * l backprojects 2^l times fewer projections with 4^l times fewer pixels in
+ * 8^l times fewer voxels, so all coarse levels together add less than 7% to
+ * the backprojection time of the full resolution.
+ *
+ * After each step, an itk::IterationEvent is invoked and the current
+ * preview can be accessed with GetPreview. Its grid is the coarse one for
+ * levels l>0. At full resolution, the sum of the passes is scaled by the
+ * inverse of the fraction of the angular weights already processed. The
+ * output is only generated once all steps are done and it always covers
+ * the largest possible region of the volume.
+ *
+ * \dot
+ * digraph ProgressiveFDKConeBeamReconstructionFilter {
+ * node [shape=box];
+ * 1 [ label="rtk::SubSelectFromListImageFilter" URL="\ref rtk::SubSelectFromListImageFilter"];
+ * 2 [ label="itk::BinShrinkImageFilter" URL="\ref itk::BinShrinkImageFilter"];
+ * 3 [ label="rtk::FDKConeBeamReconstructionFilter" URL="\ref rtk::FDKConeBeamReconstructionFilter"];
+ * 1 -> 2;
+ * 2 -> 3;
+ * }
+ * \enddot
+ *
+ * \test rtkfdktest.cxx
+ *
+ * \ingroup RTK ReconstructionAlgorithm
+ */
+template<class TInputImage, class TOutputImage=TInputImage, class TFFTPrecision=double>
+class ITK_EXPORT ProgressiveFDKConeBeamReconstructionFilter :
+  public itk::ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ProgressiveFDKConeBeamReconstructionFilter);
+
+  /** Standard class type alias. */
+  using Self = ProgressiveFDKConeBeamReconstructionFilter;
+  using Superclass = itk::ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  /** Some convenient type alias. */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using OutputImagePointer = typename OutputImageType::Pointer;
+
+  /** Typedefs of each subfilter of this composite filter */
+  using SubSelectFilterType = rtk::SubSelectFromListImageFilter<InputImageType>;
+  using BinShrinkFilterType = itk::BinShrinkImageFilter<InputImageType, InputImageType>;
+  using ConstantImageSourceType = rtk::ConstantImageSource<OutputImageType>;
+  using FDKFilterType = rtk::FDKConeBeamReconstructionFilter<InputImageType, OutputImageType, TFFTPrecision>;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ProgressiveFDKConeBeamReconstructionFilter, itk::ImageToImageFilter);
+
+  /** Get / Set the object pointer to projection geometry */
+  itkGetModifiableObjectMacro(Geometry, ThreeDCircularProjectionGeometry)
+  itkSetObjectMacro(Geometry, ThreeDCircularProjectionGeometry)
+
+  /** Get pointer to the FDK filter used for all steps, e.g., to set its ramp
+   * filter or its backprojection filter. */
+  typename FDKFilterType::Pointer GetFDKFilter() { return m_FDKFilter; }
+
+  /** Get / Set the number of resolution levels, including the full
+   * resolution. It is reduced if there are not enough projections, pixels or
+   * voxels. Default is 3, 1 is a standard FDK reconstruction. */
+  itkGetMacro(NumberOfLevels, unsigned int);
+  itkSetMacro(NumberOfLevels, unsigned int);
+
+  /** Current preview, to be used when an itk::IterationEvent is invoked. */
+  OutputImageType * GetPreview() { return m_Preview.GetPointer(); }
+
+  /** Level of the current preview, 0 at full resolution. */
+  itkGetMacro(PreviewLevel, unsigned int);
+
+  /** Fraction of the angular weights of the projections used in the current
+   * preview. */
+  itkGetMacro(PreviewAngularFraction, double);
+
+protected:
+  ProgressiveFDKConeBeamReconstructionFilter();
+  ~ProgressiveFDKConeBeamReconstructionFilter() override = default;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateOutputInformation() override;
+
+  void EnlargeOutputRequestedRegion(itk::DataObject *output) override;
+
+  void GenerateData() override;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+#if ITK_VERSION_MAJOR<5
+  void VerifyInputInformation() override {}
+#else
+  void VerifyInputInformation() const override {}
+#endif
+
+  /** Number of levels which can be used with the current inputs. */
+  unsigned int GetEffectiveNumberOfLevels();
+
+  /** Pointers to each subfilter of this composite filter */
+  typename SubSelectFilterType::Pointer     m_SubSelectFilter;
+  typename BinShrinkFilterType::Pointer     m_BinShrinkFilter;
+  typename ConstantImageSourceType::Pointer m_CoarseVolumeSource;
+  typename FDKFilterType::Pointer           m_FDKFilter;
+
+private:
+  unsigned int m_NumberOfLevels{3};
+
+  OutputImagePointer m_Preview;
+  unsigned int       m_PreviewLevel{0};
+  double             m_PreviewAngularFraction{0.};
+
+  /** Geometry propagated to subfilters of the mini-pipeline. */
+  ThreeDCircularProjectionGeometry::Pointer m_Geometry;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkProgressiveFDKConeBeamReconstructionFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,272 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkProgressiveFDKConeBeamReconstructionFilter_hxx
+#define rtkProgressiveFDKConeBeamReconstructionFilter_hxx
+
+#include "rtkProgressiveFDKConeBeamReconstructionFilter.h"
+
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionConstIterator.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+ProgressiveFDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::ProgressiveFDKConeBeamReconstructionFilter()
+{
+  this->SetNumberOfRequiredInputs(2);
+
+  // Create each filter of the composite filter
+  m_SubSelectFilter = SubSelectFilterType::New();
+  m_BinShrinkFilter = BinShrinkFilterType::New();
+  m_CoarseVolumeSource = ConstantImageSourceType::New();
+  m_FDKFilter = FDKFilterType::New();
+
+  //Permanent internal connections
+  m_BinShrinkFilter->SetInput( m_SubSelectFilter->GetOutput() );
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+ProgressiveFDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::GenerateInputRequestedRegion()
+{
+  // All steps use the whole volume and all projections
+  for(unsigned int i=0; i<2; i++)
+    {
+    typename Superclass::InputImagePointer inputPtr =
+      const_cast< TInputImage * >( this->GetInput(i) );
+    if ( !inputPtr )
+      return;
+    inputPtr->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+ProgressiveFDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::GenerateOutputInformation()
+{
+  // The output has the information of the first input, the volume
+  Superclass::GenerateOutputInformation();
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+ProgressiveFDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::EnlargeOutputRequestedRegion(itk::DataObject *output)
+{
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+unsigned int
+ProgressiveFDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::GetEffectiveNumberOfLevels()
+{
+  const unsigned int Dimension = this->InputImageDimension;
+
+  // The binning factor 2^l of level l must not be larger than the number of
+  // projections, pixels or voxels
+  unsigned int maxFactor = m_Geometry->GetGantryAngles().size();
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    maxFactor = std::min(maxFactor, (unsigned int)this->GetInput(0)->GetLargestPossibleRegion().GetSize(i));
+    if(i<Dimension-1)
+      maxFactor = std::min(maxFactor, (unsigned int)this->GetInput(1)->GetLargestPossibleRegion().GetSize(i));
+    }
+
+  unsigned int nLevels = 1;
+  while(nLevels < m_NumberOfLevels && (1u<<nLevels) <= maxFactor)
+    nLevels++;
+  return nLevels;
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+ProgressiveFDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::GenerateData()
+{
+  const unsigned int Dimension = this->InputImageDimension;
+  const InputImageType *volume = this->GetInput(0);
+  const unsigned int nProj = m_Geometry->GetGantryAngles().size();
+  const unsigned int nLevels = this->GetEffectiveNumberOfLevels();
+
+  // Angular weights of the projections in the full geometry
+  const std::vector<double> gaps = m_Geometry->GetAngularGaps( m_Geometry->GetSourceAngles() );
+  double totalWeight = 0.;
+  for(double gap : gaps)
+    totalWeight += gap;
+
+  m_SubSelectFilter->SetInputProjectionStack( this->GetInput(1) );
+  m_SubSelectFilter->SetInputGeometry( m_Geometry );
+
+  // The output of the subselection is disconnected by the full resolution
+  // passes of a previous update, reconnect the new one
+  m_BinShrinkFilter->SetInput( m_SubSelectFilter->GetOutput() );
+
+  // Coarse levels, from the coarsest to the finest
+  for(unsigned int l=nLevels-1; l>0; l--)
+    {
+    const unsigned int factor = 1u<<l;
+    std::vector<bool> selected(nProj, false);
+    double selectedWeight = 0.;
+    for(unsigned int i=0; i<nProj; i+=factor)
+      {
+      selected[i] = true;
+      selectedWeight += gaps[i];
+      }
+    m_SubSelectFilter->SetSelectedProjections(selected);
+
+    typename BinShrinkFilterType::ShrinkFactorsType shrinkFactors;
+    shrinkFactors.Fill(factor);
+    shrinkFactors[Dimension-1] = 1;
+    m_BinShrinkFilter->SetShrinkFactors(shrinkFactors);
+
+    // Coarse volume covering the same region, the center of each coarse
+    // voxel is the center of the corresponding block of voxels
+    typename OutputImageType::SizeType size;
+    typename OutputImageType::SpacingType spacing;
+    typename OutputImageType::PointType origin;
+    itk::Vector<double, TOutputImage::ImageDimension> shift;
+    const typename InputImageType::RegionType &region = volume->GetLargestPossibleRegion();
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      size[i] = (region.GetSize(i) + factor - 1) / factor;
+      spacing[i] = volume->GetSpacing()[i] * factor;
+      shift[i] = 0.5 * (factor - 1) * volume->GetSpacing()[i];
+      }
+    volume->TransformIndexToPhysicalPoint(region.GetIndex(), origin);
+    origin += volume->GetDirection() * shift;
+    m_CoarseVolumeSource->SetOrigin( origin );
+    m_CoarseVolumeSource->SetSpacing( spacing );
+    m_CoarseVolumeSource->SetSize( size );
+    m_CoarseVolumeSource->SetDirection( volume->GetDirection() );
+    m_CoarseVolumeSource->SetConstant( 0. );
+
+    m_FDKFilter->SetInput( 0, m_CoarseVolumeSource->GetOutput() );
+    m_FDKFilter->SetInput( 1, m_BinShrinkFilter->GetOutput() );
+    m_FDKFilter->SetGeometry( m_SubSelectFilter->GetOutputGeometry() );
+    m_FDKFilter->InPlaceOff();
+    m_FDKFilter->UpdateLargestPossibleRegion();
+
+    m_Preview = m_FDKFilter->GetOutput();
+    m_Preview->DisconnectPipeline();
+    m_PreviewLevel = l;
+    m_PreviewAngularFraction = selectedWeight / totalWeight;
+    this->InvokeEvent( itk::IterationEvent() );
+    }
+
+  // Full resolution passes over interleaved subsets of projections, in
+  // bit-reversed order
+  const unsigned int nPasses = 1u<<(nLevels-1);
+  double processedWeight = 0.;
+  typename InputImageType::Pointer accumulation;
+  for(unsigned int p=0; p<nPasses; p++)
+    {
+    unsigned int offset = 0;
+    for(unsigned int b=1, r=nPasses>>1; b<nPasses; b<<=1, r>>=1)
+      if(p & b)
+        offset |= r;
+
+    if(nPasses == 1)
+      {
+      m_FDKFilter->SetInput( 1, this->GetInput(1) );
+      m_FDKFilter->SetGeometry( m_Geometry );
+      processedWeight = totalWeight;
+      }
+    else
+      {
+      std::vector<bool> selected(nProj, false);
+      for(unsigned int i=offset; i<nProj; i+=nPasses)
+        selected[i] = true;
+      m_SubSelectFilter->SetSelectedProjections(selected);
+      m_SubSelectFilter->UpdateLargestPossibleRegion();
+      typename InputImageType::Pointer subset = m_SubSelectFilter->GetOutput();
+      subset->DisconnectPipeline();
+
+      // Weight each projection with the ratio of its angular gaps in the full
+      // geometry and in the subset geometry so that the sum of the passes is
+      // the full reconstruction
+      ThreeDCircularProjectionGeometry::Pointer subsetGeometry = m_SubSelectFilter->GetOutputGeometry();
+      const std::vector<double> subsetGaps = subsetGeometry->GetAngularGaps( subsetGeometry->GetSourceAngles() );
+      typename InputImageType::RegionType projRegion = subset->GetLargestPossibleRegion();
+      const itk::IndexValueType firstIndex = projRegion.GetIndex(Dimension-1);
+      projRegion.SetSize(Dimension-1, 1);
+      for(unsigned int i=offset, j=0; i<nProj; i+=nPasses, j++)
+        {
+        projRegion.SetIndex(Dimension-1, firstIndex+j);
+        const typename InputImageType::PixelType weight = gaps[i] / subsetGaps[j];
+        itk::ImageRegionIterator<InputImageType> it(subset, projRegion);
+        for(; !it.IsAtEnd(); ++it)
+          it.Set( it.Get() * weight );
+        processedWeight += gaps[i];
+        }
+
+      m_FDKFilter->SetInput( 1, subset );
+      m_FDKFilter->SetGeometry( subsetGeometry );
+      }
+
+    // The first pass backprojects in the input volume, the next ones in the
+    // accumulated volume which is not needed afterwards
+    if(p==0)
+      {
+      m_FDKFilter->SetInput( 0, volume );
+      m_FDKFilter->InPlaceOff();
+      }
+    else
+      {
+      m_FDKFilter->SetInput( 0, accumulation );
+      m_FDKFilter->InPlaceOn();
+      }
+    m_FDKFilter->UpdateLargestPossibleRegion();
+    accumulation = m_FDKFilter->GetOutput();
+    accumulation->DisconnectPipeline();
+
+    // Preview, the backprojected values are scaled for the missing angular
+    // weights
+    m_PreviewLevel = 0;
+    m_PreviewAngularFraction = processedWeight / totalWeight;
+    if(p+1 == nPasses)
+      m_Preview = accumulation.GetPointer();
+    else
+      {
+      m_Preview = OutputImageType::New();
+      m_Preview->CopyInformation( accumulation );
+      m_Preview->SetRegions( accumulation->GetLargestPossibleRegion() );
+      m_Preview->Allocate();
+      const double scale = totalWeight / processedWeight;
+      itk::ImageRegionConstIterator<InputImageType> itIn(volume, volume->GetLargestPossibleRegion());
+      itk::ImageRegionConstIterator<InputImageType> itAcc(accumulation, accumulation->GetLargestPossibleRegion());
+      itk::ImageRegionIterator<OutputImageType> itOut(m_Preview, m_Preview->GetLargestPossibleRegion());
+      for(; !itOut.IsAtEnd(); ++itIn, ++itAcc, ++itOut)
+        itOut.Set( itIn.Get() + scale * ( itAcc.Get() - itIn.Get() ) );
+      }
+    this->InvokeEvent( itk::IterationEvent() );
+    }
+
+  this->GraftOutput( accumulation );
+}
+
+} // end namespace rtk
+
+#endif // rtkProgressiveFDKConeBeamReconstructionFilter_hxx
@@ -0,0 +1,106 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkProjectionTilesScheduler_h
+#define rtkProjectionTilesScheduler_h
+
+#include <itkImageRegion.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class ProjectionTilesScheduler
+ * \brief Dynamic distribution of detector tiles to the threads of a projector.
+ *
+ * The requested region of a projection stack is cut in tiles of
+ * TileSize x TileSize pixels of a single projection. Each thread requests
+ * tiles with GetNextTile until all tiles have been processed, whatever the
+ * region it has been given by the ITK multithreader. The threads which are
+ * given cheap tiles, e.g., with short paths through the volume or with
+ * collimated pixels, process more tiles. The load is therefore balanced even
+ * when the stack contains few projections, e.g., for the subsets of SART or
+ * OSEM. Neighbor pixels of a tile trace neighbor rays, which benefits the
+ * cache.
+ *
+ * Initialize must be called before the threads are started, e.g., in
+ * BeforeThreadedGenerateData.
+ *
+ * \ingroup RTK
+ */
+template <unsigned int VDimension>
+class ProjectionTilesScheduler
+{
+public:
+  using RegionType = itk::ImageRegion<VDimension>;
+
+  /** Cut region in tiles of tileSize x tileSize pixels of one projection. */
+  void Initialize(const RegionType &region, unsigned int tileSize)
+  {
+    m_Tiles.clear();
+    if(region.GetNumberOfPixels() == 0)
+      {
+      m_NextTile = 0;
+      return;
+      }
+
+    RegionType tile;
+    typename RegionType::IndexType idx;
+    typename RegionType::SizeType  size;
+    size.Fill(1);
+    for(unsigned int p=0; p<region.GetSize()[VDimension-1]; p++)
+      for(unsigned int y=0; y<region.GetSize()[1]; y+=tileSize)
+        for(unsigned int x=0; x<region.GetSize()[0]; x+=tileSize)
+          {
+          idx = region.GetIndex();
+          idx[0] += x;
+          idx[1] += y;
+          idx[VDimension-1] += p;
+          size[0] = std::min(tileSize, static_cast<unsigned int>(region.GetSize()[0]) - x);
+          size[1] = std::min(tileSize, static_cast<unsigned int>(region.GetSize()[1]) - y);
+          for(unsigned int d=2; d<VDimension-1; d++)
+            size[d] = region.GetSize()[d];
+          tile.SetIndex(idx);
+          tile.SetSize(size);
+          m_Tiles.push_back(tile);
+          }
+    m_NextTile = 0;
+  }
+
+  /** Get the next unprocessed tile. Returns false when all tiles have been
+   * given to a thread. Thread safe. */
+  bool GetNextTile(RegionType &tile)
+  {
+    const size_t i = m_NextTile++;
+    if(i >= m_Tiles.size())
+      return false;
+    tile = m_Tiles[i];
+    return true;
+  }
+
+private:
+  std::vector<RegionType> m_Tiles;
+  std::atomic<size_t>     m_NextTile{0};
+};
+
+} // end namespace rtk
+
+#endif // rtkProjectionTilesScheduler_h
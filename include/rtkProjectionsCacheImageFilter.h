@@ -0,0 +1,221 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkProjectionsCacheImageFilter_h
+#define rtkProjectionsCacheImageFilter_h
+
+#include <itkImageToImageFilter.h>
+
+#include <future>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class ProjectionsCacheImageFilter
+ * \brief Lazy access to a projection stack with a cache of projections.
+ *
+ * The filter produces the requested region of its output from projections
+ * kept in a least recently used (LRU) cache. Only the projections which are
+ * not in the cache are requested from the input, e.g., a
+ * rtk::ProjectionsReader which then decodes and preprocesses only these
+ * projections, and they are stored in the cache for the next requests. The
+ * memory of the cache is bounded by MemoryBudget. It allows iterative
+ * reconstruction algorithms with subsets of projections to start without
+ * reading the whole stack and to process stacks larger than the memory.
+ *
+ * The projection k of the output is the projection ProjectionOrder[k] of the
+ * input. On a cache miss, the PrefetchSize projections following the
+ * requested region of the output in this order are read in the same pass,
+ * e.g., the next subset of projections. Without StoreFileName, this prefetch
+ * is synchronous: it saves pipeline updates of the input but it does not
+ * overlap the reading with the processing of the output. The input pipeline
+ * cannot be updated in the background because the requests of the output
+ * pipeline propagate through this filter to the same input pipeline, e.g.,
+ * UpdateOutputInformation, which is not thread safe.
+ *
+ * If StoreFileName is set, the projection stack does not need to fit in
+ * memory. The input is then read once, projection after projection, and
+ * written in this file in raw format. The missing projections are read from
+ * this file instead of the input and, after each request, the next
+ * PrefetchSize projections are read asynchronously in a second buffer while
+ * the requested ones are processed (double buffering). If MemoryBudget is 0,
+ * only the projections of the last request are kept in memory. The file must
+ * not exist, an exception is thrown otherwise so that no user file is
+ * overwritten. It is created by the filter and deleted with it.
+ *
+ * Like itk::StreamingImageFilter, the filter does not propagate the
+ * requested region to its input and updates it itself in UpdateOutputData.
+ * The cache and the store are emptied when the input pipeline is modified.
+ *
+ * \test rtkprojectionscachetest.cxx
+ *
+ * \ingroup RTK ImageToImageFilter
+ */
+template<class TImage>
+class ITK_EXPORT ProjectionsCacheImageFilter :
+  public itk::ImageToImageFilter<TImage, TImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ProjectionsCacheImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ProjectionsCacheImageFilter;
+  using Superclass = itk::ImageToImageFilter<TImage, TImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  /** Some convenient type alias. */
+  using ImageType = TImage;
+  using RegionType = typename ImageType::RegionType;
+  using PixelType = typename ImageType::PixelType;
+  using ProjectionOrderType = std::vector<unsigned int>;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ProjectionsCacheImageFilter, itk::ImageToImageFilter);
+
+  /** Get / Set the maximum memory used by the cached projections in bytes.
+   ** Default is 0 which means no limit. */
+  itkGetMacro(MemoryBudget, itk::SizeValueType);
+  itkSetMacro(MemoryBudget, itk::SizeValueType);
+
+  /** Get / Set the number of projections read in advance, synchronously on a
+   ** cache miss or, with a store, asynchronously after each request. Default
+   ** is 0. */
+  itkGetMacro(PrefetchSize, unsigned int);
+  itkSetMacro(PrefetchSize, unsigned int);
+
+  /** Get / Set the order of the input projections in the output. It must be
+   ** empty (default, same order) or a permutation of the input projection
+   ** indices. */
+  itkGetConstReferenceMacro(ProjectionOrder, ProjectionOrderType);
+  virtual void SetProjectionOrder(const ProjectionOrderType &_arg)
+    {
+    if (this->m_ProjectionOrder != _arg)
+      {
+      this->m_ProjectionOrder = _arg;
+      this->Modified();
+      }
+    }
+
+  /** Get / Set the name of the file storing the projections on disk. It must
+   ** be a new file, it is created and deleted by the filter. Default is empty,
+   ** the projections are read from the input. */
+  itkGetStringMacro(StoreFileName);
+  itkSetStringMacro(StoreFileName);
+
+  /** Number of projections read from the input since the creation of the
+   ** filter, for performance monitoring. */
+  itkGetConstMacro(NumberOfReadProjections, itk::SizeValueType);
+
+  /** Removes all projections from the cache. */
+  void ClearCache();
+
+  /** Reimplemented from itk::ProcessObject to stop the propagation of the
+   ** requested region to the input. */
+  void PropagateRequestedRegion(itk::DataObject *output) override;
+
+  /** Reimplemented from itk::ProcessObject to call GenerateData without
+   ** updating the input first. */
+  void UpdateOutputData(itk::DataObject *output) override;
+
+protected:
+  ProjectionsCacheImageFilter() = default;
+  ~ProjectionsCacheImageFilter() override;
+
+  /** Fills the output from the cache and reads the missing projections. */
+  void GenerateData() override;
+
+  /** Index of the input projection of output projection k. */
+  itk::IndexValueType GetInputProjectionIndex(itk::IndexValueType k) const;
+
+  /** Reads input projections [first, first+n) and stores them in the cache. */
+  void ReadProjections(itk::IndexValueType first, itk::IndexValueType n);
+
+  /** Allocates an image for input projection p. */
+  typename ImageType::Pointer NewProjection(itk::IndexValueType p) const;
+
+  /** Adds a projection to the cache, dropping the least recently used ones
+   ** to stay within the memory budget. */
+  void InsertProjection(itk::IndexValueType p, ImageType *projection);
+
+  /** Writes all input projections in the store file. */
+  void WriteStore();
+
+  /** Reads stored projections in the buffers of the projections. */
+  void ReadStore(const std::vector<itk::IndexValueType> &indices,
+                 const std::vector<typename ImageType::Pointer> &projections);
+
+  /** Reads the projections of the store at positions positions[i] in
+   ** buffers[i]. Static to be run asynchronously without access to the
+   ** filter. */
+  static void ReadStoreBuffers(const std::string fileName,
+                               const itk::SizeValueType projectionSize,
+                               const std::vector<itk::SizeValueType> positions,
+                               const std::vector<PixelType *> buffers);
+
+  /** Waits for the asynchronous reading of the store and moves the read
+   ** projections to the cache. */
+  void WaitForPrefetch();
+
+  /** Moves the projection to the front of the LRU list. */
+  void TouchProjection(itk::IndexValueType p);
+
+private:
+  itk::SizeValueType  m_MemoryBudget{0};
+  unsigned int        m_PrefetchSize{0};
+  ProjectionOrderType m_ProjectionOrder;
+  itk::SizeValueType  m_NumberOfReadProjections{0};
+
+  /** Cached projections and list of their indices from the most to the least
+   ** recently used. */
+  using LRUListType = std::list<itk::IndexValueType>;
+  struct CacheEntry
+    {
+    typename ImageType::Pointer Projection;
+    typename LRUListType::iterator Position;
+    };
+  std::map<itk::IndexValueType, CacheEntry> m_Cache;
+  LRUListType                               m_LRUList;
+  itk::SizeValueType                        m_CacheMemory{0};
+
+  /** Pipeline time of the input when the cached projections have been read. */
+  itk::ModifiedTimeType m_CachePipelineMTime{0};
+
+  /** Store of the projections on disk and asynchronous reading of the
+   ** projections of the next request. */
+  std::string                              m_StoreFileName;
+  std::string                              m_WrittenStoreFileName;
+  std::future<void>                        m_PrefetchFuture;
+  std::vector<itk::IndexValueType>         m_PrefetchIndices;
+  std::vector<typename ImageType::Pointer> m_PrefetchProjections;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkProjectionsCacheImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,474 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkProjectionsCacheImageFilter_hxx
+#define rtkProjectionsCacheImageFilter_hxx
+
+#include "rtkProjectionsCacheImageFilter.h"
+
+#include <itkImageAlgorithm.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace rtk
+{
+
+template<class TImage>
+ProjectionsCacheImageFilter<TImage>
+::~ProjectionsCacheImageFilter()
+{
+  if( m_PrefetchFuture.valid() )
+    m_PrefetchFuture.wait();
+  if( !m_WrittenStoreFileName.empty() )
+    std::remove( m_WrittenStoreFileName.c_str() );
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::ClearCache()
+{
+  m_Cache.clear();
+  m_LRUList.clear();
+  m_CacheMemory = 0;
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::PropagateRequestedRegion(itk::DataObject *output)
+{
+  // The input requested region is set in UpdateOutputData depending on the
+  // content of the cache
+  if ( !this->m_Updating )
+    {
+    this->EnlargeOutputRequestedRegion(output);
+    this->GenerateOutputRequestedRegion(output);
+    }
+}
+
+template<class TImage>
+itk::IndexValueType
+ProjectionsCacheImageFilter<TImage>
+::GetInputProjectionIndex(itk::IndexValueType k) const
+{
+  if( m_ProjectionOrder.empty() )
+    return k;
+  const itk::IndexValueType first = this->GetInput()->GetLargestPossibleRegion().GetIndex(ImageType::ImageDimension-1);
+  return first + m_ProjectionOrder[k-first];
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::TouchProjection(itk::IndexValueType p)
+{
+  CacheEntry &entry = m_Cache[p];
+  m_LRUList.splice(m_LRUList.begin(), m_LRUList, entry.Position);
+}
+
+template<class TImage>
+typename TImage::Pointer
+ProjectionsCacheImageFilter<TImage>
+::NewProjection(itk::IndexValueType p) const
+{
+  RegionType projRegion = this->GetInput()->GetLargestPossibleRegion();
+  projRegion.SetIndex(ImageType::ImageDimension-1, p);
+  projRegion.SetSize(ImageType::ImageDimension-1, 1);
+
+  typename ImageType::Pointer projection = ImageType::New();
+  projection->CopyInformation(this->GetInput());
+  projection->SetRegions(projRegion);
+  projection->Allocate();
+  return projection;
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::InsertProjection(itk::IndexValueType p, ImageType *projection)
+{
+  const itk::SizeValueType projMemory = projection->GetBufferedRegion().GetNumberOfPixels() * sizeof(PixelType);
+  if( m_MemoryBudget && projMemory > m_MemoryBudget )
+    return;
+
+  if( m_Cache.find(p) != m_Cache.end() )
+    {
+    this->TouchProjection(p);
+    return;
+    }
+
+  // Make room for the new projection
+  while( m_MemoryBudget && m_CacheMemory + projMemory > m_MemoryBudget )
+    {
+    m_Cache.erase(m_LRUList.back());
+    m_LRUList.pop_back();
+    m_CacheMemory -= projMemory;
+    }
+
+  m_LRUList.push_front(p);
+  CacheEntry &entry = m_Cache[p];
+  entry.Projection = projection;
+  entry.Position = m_LRUList.begin();
+  m_CacheMemory += projMemory;
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::ReadProjections(itk::IndexValueType first, itk::IndexValueType n)
+{
+  const unsigned int Dimension = ImageType::ImageDimension;
+  auto *input = const_cast<ImageType *>(this->GetInput());
+
+  RegionType readRegion = input->GetLargestPossibleRegion();
+  readRegion.SetIndex(Dimension-1, first);
+  readRegion.SetSize(Dimension-1, n);
+  input->SetRequestedRegion(readRegion);
+  input->PropagateRequestedRegion();
+  input->UpdateOutputData();
+  m_NumberOfReadProjections += n;
+
+  RegionType projRegion = readRegion;
+  projRegion.SetSize(Dimension-1, 1);
+  if( m_MemoryBudget && projRegion.GetNumberOfPixels() * sizeof(PixelType) > m_MemoryBudget )
+    return;
+
+  for(itk::IndexValueType p=first; p<first+n; p++)
+    {
+    typename ImageType::Pointer projection = this->NewProjection(p);
+    itk::ImageAlgorithm::Copy(input, projection.GetPointer(), projection->GetBufferedRegion(), projection->GetBufferedRegion());
+    this->InsertProjection(p, projection);
+    }
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::WriteStore()
+{
+  const unsigned int Dimension = ImageType::ImageDimension;
+  auto *input = const_cast<ImageType *>(this->GetInput());
+  const RegionType largest = input->GetLargestPossibleRegion();
+
+  // Never overwrite an existing file, it is deleted with the filter
+  if( itksys::SystemTools::FileExists(m_StoreFileName) )
+    itkExceptionMacro(<< "The projection store " << m_StoreFileName
+                      << " already exists, please give the name of a new file.");
+  std::ofstream store(m_StoreFileName.c_str(), std::ios::binary);
+  if( !store )
+    itkExceptionMacro(<< "Could not open " << m_StoreFileName << " for writing.");
+  m_WrittenStoreFileName = m_StoreFileName;
+
+  // Read the input by chunks of projections to bound the memory
+  const itk::IndexValueType chunk = std::max(m_PrefetchSize, 1U);
+  const itk::IndexValueType first = largest.GetIndex(Dimension-1);
+  const itk::IndexValueType last = first + largest.GetSize(Dimension-1);
+  RegionType readRegion = largest;
+  RegionType projRegion = largest;
+  projRegion.SetSize(Dimension-1, 1);
+  const itk::SizeValueType projSize = projRegion.GetNumberOfPixels() * sizeof(PixelType);
+  for(itk::IndexValueType p=first; p<last; p+=chunk)
+    {
+    readRegion.SetIndex(Dimension-1, p);
+    readRegion.SetSize(Dimension-1, std::min(chunk, last-p));
+    input->SetRequestedRegion(readRegion);
+    input->PropagateRequestedRegion();
+    input->UpdateOutputData();
+    m_NumberOfReadProjections += readRegion.GetSize(Dimension-1);
+
+    // The buffered region covers whole projections so each one is contiguous
+    for(itk::IndexValueType q=p; q<p+itk::IndexValueType(readRegion.GetSize(Dimension-1)); q++)
+      {
+      projRegion.SetIndex(Dimension-1, q);
+      const PixelType *buffer = input->GetBufferPointer() + input->ComputeOffset(projRegion.GetIndex());
+      store.write(reinterpret_cast<const char *>(buffer), projSize);
+      }
+    if( !store )
+      itkExceptionMacro(<< "Could not write projections in " << m_StoreFileName << ".");
+    this->UpdateProgress( 0.5f * float(p-first) / float(last-first) );
+    }
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::ReadStoreBuffers(const std::string fileName,
+                   const itk::SizeValueType projectionSize,
+                   const std::vector<itk::SizeValueType> positions,
+                   const std::vector<PixelType *> buffers)
+{
+  std::ifstream store(fileName.c_str(), std::ios::binary);
+  for(unsigned int i=0; i<positions.size() && store; i++)
+    {
+    store.seekg(positions[i] * projectionSize);
+    store.read(reinterpret_cast<char *>(buffers[i]), projectionSize);
+    }
+  if( !store )
+    itkGenericExceptionMacro(<< "Could not read projections in " << fileName << ".");
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::ReadStore(const std::vector<itk::IndexValueType> &indices,
+            const std::vector<typename ImageType::Pointer> &projections)
+{
+  if( indices.empty() )
+    return;
+
+  const itk::IndexValueType first = this->GetInput()->GetLargestPossibleRegion().GetIndex(ImageType::ImageDimension-1);
+  std::vector<itk::SizeValueType> positions;
+  std::vector<PixelType *> buffers;
+  for(unsigned int i=0; i<indices.size(); i++)
+    {
+    positions.push_back(indices[i]-first);
+    buffers.push_back(projections[i]->GetBufferPointer());
+    }
+  const itk::SizeValueType projSize = projections[0]->GetBufferedRegion().GetNumberOfPixels() * sizeof(PixelType);
+  ReadStoreBuffers(m_StoreFileName, projSize, positions, buffers);
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::WaitForPrefetch()
+{
+  if( !m_PrefetchFuture.valid() )
+    return;
+
+  try
+    {
+    m_PrefetchFuture.get();
+    }
+  catch( ... )
+    {
+    m_PrefetchIndices.clear();
+    m_PrefetchProjections.clear();
+    throw;
+    }
+  for(unsigned int i=0; i<m_PrefetchIndices.size(); i++)
+    this->InsertProjection(m_PrefetchIndices[i], m_PrefetchProjections[i]);
+  m_PrefetchIndices.clear();
+  m_PrefetchProjections.clear();
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::GenerateData()
+{
+  const unsigned int Dimension = ImageType::ImageDimension;
+  auto *input = const_cast<ImageType *>(this->GetInput());
+  ImageType *output = this->GetOutput();
+  const RegionType outputRegion = output->GetRequestedRegion();
+  output->SetBufferedRegion(outputRegion);
+  output->Allocate();
+
+  const RegionType largest = input->GetLargestPossibleRegion();
+  if( !m_ProjectionOrder.empty() && m_ProjectionOrder.size() != largest.GetSize(Dimension-1) )
+    {
+    itkExceptionMacro(<< "The projection order has " << m_ProjectionOrder.size()
+                      << " projections while the input has " << largest.GetSize(Dimension-1) << ".");
+    }
+
+  // The cached and stored projections are obsolete if the input pipeline has
+  // changed
+  const bool store = !m_StoreFileName.empty();
+  if( input->GetPipelineMTime() != m_CachePipelineMTime || m_StoreFileName != m_WrittenStoreFileName )
+    {
+    if( m_PrefetchFuture.valid() )
+      m_PrefetchFuture.wait();
+    m_PrefetchFuture = std::future<void>();
+    m_PrefetchIndices.clear();
+    m_PrefetchProjections.clear();
+    this->ClearCache();
+    if( !m_WrittenStoreFileName.empty() )
+      std::remove( m_WrittenStoreFileName.c_str() );
+    m_WrittenStoreFileName.clear();
+    m_CachePipelineMTime = input->GetPipelineMTime();
+    if( store )
+      this->WriteStore();
+    }
+  else if( store )
+    {
+    // Without budget, only keep the projections of this request and those
+    // read in advance for it
+    if( !m_MemoryBudget )
+      this->ClearCache();
+    this->WaitForPrefetch();
+    }
+
+  // Copy the cached projections and list the missing ones
+  const itk::IndexValueType firstOut = outputRegion.GetIndex(Dimension-1);
+  const itk::IndexValueType lastOut = firstOut + outputRegion.GetSize(Dimension-1);
+  RegionType inRegion = outputRegion;
+  RegionType outRegion = outputRegion;
+  inRegion.SetSize(Dimension-1, 1);
+  outRegion.SetSize(Dimension-1, 1);
+  std::map<itk::IndexValueType, itk::IndexValueType> missing;
+  for(itk::IndexValueType k=firstOut; k<lastOut; k++)
+    {
+    const itk::IndexValueType p = this->GetInputProjectionIndex(k);
+    if( m_Cache.find(p) == m_Cache.end() )
+      {
+      missing[p] = k;
+      continue;
+      }
+    this->TouchProjection(p);
+    inRegion.SetIndex(Dimension-1, p);
+    outRegion.SetIndex(Dimension-1, k);
+    itk::ImageAlgorithm::Copy(m_Cache[p].Projection.GetPointer(), output, inRegion, outRegion);
+    }
+
+  const itk::IndexValueType lastPrefetch = std::min(lastOut + itk::IndexValueType(m_PrefetchSize),
+                                                    largest.GetIndex(Dimension-1) + itk::IndexValueType(largest.GetSize(Dimension-1)));
+  if( store )
+    {
+    // Read the missing projections from the store
+    std::vector<itk::IndexValueType> indices;
+    std::vector<typename ImageType::Pointer> projections;
+    for(auto it = missing.begin(); it != missing.end(); ++it)
+      {
+      indices.push_back(it->first);
+      projections.push_back(this->NewProjection(it->first));
+      }
+    this->ReadStore(indices, projections);
+    unsigned int i = 0;
+    for(auto it = missing.begin(); it != missing.end(); ++it, i++)
+      {
+      inRegion.SetIndex(Dimension-1, it->first);
+      outRegion.SetIndex(Dimension-1, it->second);
+      itk::ImageAlgorithm::Copy(projections[i].GetPointer(), output, inRegion, outRegion);
+      this->InsertProjection(it->first, projections[i]);
+      }
+
+    // Read the next projections asynchronously in a second buffer
+    std::vector<itk::SizeValueType> positions;
+    std::vector<PixelType *> buffers;
+    for(itk::IndexValueType k=lastOut; k<lastPrefetch; k++)
+      {
+      const itk::IndexValueType p = this->GetInputProjectionIndex(k);
+      if( m_Cache.find(p) != m_Cache.end() )
+        continue;
+      m_PrefetchIndices.push_back(p);
+      m_PrefetchProjections.push_back(this->NewProjection(p));
+      positions.push_back(p - largest.GetIndex(Dimension-1));
+      buffers.push_back(m_PrefetchProjections.back()->GetBufferPointer());
+      }
+    if( !positions.empty() )
+      {
+      const itk::SizeValueType projSize = m_PrefetchProjections[0]->GetBufferedRegion().GetNumberOfPixels() * sizeof(PixelType);
+      m_PrefetchFuture = std::async(std::launch::async, &Self::ReadStoreBuffers,
+                                    m_StoreFileName, projSize, positions, buffers);
+      }
+    }
+  else if( !missing.empty() )
+    {
+    // Prefetch the next projections in the output order, they are read first
+    // to be evicted before the requested ones if the budget is exceeded
+    std::vector<itk::IndexValueType> prefetch;
+    for(itk::IndexValueType k=lastOut; k<lastPrefetch; k++)
+      {
+      const itk::IndexValueType p = this->GetInputProjectionIndex(k);
+      if( m_Cache.find(p) == m_Cache.end() && missing.find(p) == missing.end() )
+        prefetch.push_back(p);
+      }
+    std::sort(prefetch.begin(), prefetch.end());
+    for(size_t i=0; i<prefetch.size();)
+      {
+      size_t j = i+1;
+      while( j<prefetch.size() && prefetch[j] == prefetch[j-1]+1 )
+        j++;
+      this->ReadProjections(prefetch[i], j-i);
+      i = j;
+      }
+
+    // Read contiguous missing projections in one pass and copy them directly
+    // from the input in case they do not fit in the cache
+    auto it = missing.begin();
+    while( it != missing.end() )
+      {
+      auto itEnd = it;
+      itk::IndexValueType n = 1;
+      for(++itEnd; itEnd != missing.end() && itEnd->first == it->first+n; ++itEnd)
+        n++;
+      this->ReadProjections(it->first, n);
+      for(; it != itEnd; ++it)
+        {
+        inRegion.SetIndex(Dimension-1, it->first);
+        outRegion.SetIndex(Dimension-1, it->second);
+        itk::ImageAlgorithm::Copy(input, output, inRegion, outRegion);
+        }
+      }
+    }
+}
+
+template<class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::UpdateOutputData(itk::DataObject *itkNotUsed(output))
+{
+  // Prevent chasing our tail
+  if ( this->m_Updating )
+    return;
+
+  if ( this->GetNumberOfValidRequiredInputs() < this->GetNumberOfRequiredInputs() )
+    {
+    itkExceptionMacro(<< "At least " << this->GetNumberOfRequiredInputs()
+                      << " inputs are required but only " << this->GetNumberOfValidRequiredInputs()
+                      << " are specified.");
+    }
+
+  this->SetAbortGenerateData(false);
+  this->UpdateProgress(0.f);
+  this->m_Updating = true;
+  this->InvokeEvent( itk::StartEvent() );
+
+  try
+    {
+    this->GenerateData();
+    }
+  catch( ... )
+    {
+    this->m_Updating = false;
+    throw;
+    }
+
+  this->UpdateProgress(1.f);
+  this->InvokeEvent( itk::EndEvent() );
+
+  // Mark the data as up-to-date
+  for ( unsigned int idx = 0; idx < this->GetNumberOfIndexedOutputs(); ++idx )
+    {
+    if ( this->GetOutput(idx) )
+      this->GetOutput(idx)->DataHasBeenGenerated();
+    }
+
+  // Release any inputs if marked for release
+  this->ReleaseInputs();
+
+  this->m_Updating = false;
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,95 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkProjectionsHeaderCache_h
+#define rtkProjectionsHeaderCache_h
+
+#include <itkImageIOBase.h>
+#include "RTKExport.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class ProjectionsHeaderCache
+ * \brief Process-wide cache of the headers of projection files.
+ *
+ * The geometry readers of projections which store the acquisition angle in
+ * each file, e.g., rtk::VarianObiGeometryReader, rtk::VarianProBeamGeometryReader
+ * and rtk::ImagXGeometryReader, must read the header of every file before
+ * rtk::ProjectionsReader reads the same files again. Scan reads the headers
+ * of a list of files in one pass with parallel workers, calling only
+ * ReadImageInformation of the image IO given by the caller, i.e., without
+ * probing all registered image IO with the object factory. The image IO of
+ * each file is then kept with its meta data dictionary for the other
+ * consumers. A file is read again if its modification time or its length
+ * has changed since it has been scanned. rtk::ProjectionsHeaderCacheImageIO
+ * gives the cached headers to the readers of the projections.
+ *
+ * The cached image IO are shared and must not be modified, e.g., their file
+ * name must not be changed. The headers are kept until they are removed with
+ * Remove or Clear, which rtk::ProjectionsReader does for its file names when
+ * it is deleted or when its file names are changed.
+ *
+ * \ingroup RTK IOFilters
+ */
+class RTK_EXPORT ProjectionsHeaderCache
+{
+public:
+  using FileNamesContainer = std::vector<std::string>;
+  using ImageIOPointer = itk::ImageIOBase::Pointer;
+
+  /** Function creating a new image IO for reading the header of one file. It
+   * is called by the workers and must not have side effects. */
+  using ImageIOCreatorType = std::function<ImageIOPointer()>;
+
+  /** Reads with image IO created by creator the headers of the files which
+   * are not in the cache with this type of image IO. The first header is read
+   * before starting the workers to let the image IO initialize its global
+   * state, if any. The first exception thrown by a worker is rethrown. */
+  static void Scan(const FileNamesContainer &fileNames, const ImageIOCreatorType &creator);
+
+  /** Image IO which has read the header of fileName, nullptr if the file has
+   * not been scanned or has been modified since. If className is not empty, only an image IO of this
+   * class is returned. */
+  static ImageIOPointer GetImageIO(const std::string &fileName, const std::string &className = "");
+
+  /** Copy of the meta data dictionary of fileName, which must have been
+   * scanned with an image IO of class className. A copy is returned because
+   * the cached header may be replaced or removed by another thread. */
+  static itk::MetaDataDictionary GetMetaDataDictionary(const std::string &fileName,
+                                                       const std::string &className);
+
+  /** Removes the headers of fileNames from the cache, whatever the class of
+   * their image IO. The image IO returned by GetImageIO remain valid. */
+  static void Remove(const FileNamesContainer &fileNames);
+
+  /** Number of headers in the cache. */
+  static unsigned int GetNumberOfHeaders();
+
+  /** Removes all headers from the cache, e.g., to release their memory. The
+   * image IO returned by GetImageIO remain valid. */
+  static void Clear();
+};
+
+} // end namespace rtk
+
+#endif
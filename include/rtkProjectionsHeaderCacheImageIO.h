@@ -0,0 +1,93 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkProjectionsHeaderCacheImageIO_h
+#define rtkProjectionsHeaderCacheImageIO_h
+
+#include <itkImageIOBase.h>
+#include "RTKExport.h"
+
+namespace rtk
+{
+
+/** \class ProjectionsHeaderCacheImageIO
+ * \brief Image IO reading the headers from rtk::ProjectionsHeaderCache
+ *
+ * This image IO is given to the series reader of rtk::ProjectionsReader when
+ * the first projection has been scanned by a geometry reader. The header of
+ * each file is copied from the image IO of rtk::ProjectionsHeaderCache and
+ * the pixels are read by the same image IO, which has kept the information
+ * parsed from the header, e.g., the position of the pixels in XIM files. The
+ * files which are not in the cache, or have been modified since they have
+ * been scanned, are read with the image IO set with SetImageIO.
+ *
+ * The pixels of all files are read one at a time because the cached image IO
+ * are shared.
+ *
+ * \ingroup RTK IOFilters
+ */
+class RTK_EXPORT ProjectionsHeaderCacheImageIO : public itk::ImageIOBase
+{
+public:
+  /** Standard class type alias. */
+  using Self = ProjectionsHeaderCacheImageIO;
+  using Superclass = itk::ImageIOBase;
+  using Pointer = itk::SmartPointer<Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ProjectionsHeaderCacheImageIO, itk::ImageIOBase);
+
+  /** Image IO reading the files which are not in the cache. Only the headers
+   * scanned with an image IO of the same class are used. */
+  void SetImageIO(itk::ImageIOBase *imageIO);
+  itkGetModifiableObjectMacro(ImageIO, itk::ImageIOBase);
+
+  /** Returns true if the image IO read in the cache or the image IO set with
+   * SetImageIO can read the file. */
+  bool CanReadFile(const char* filename) override;
+
+  /*-------- This part of the interface deals with reading data. ------ */
+  void ReadImageInformation() override;
+
+  void Read(void * buffer) override;
+
+  /*-------- This part of the interfaces deals with writing data. ----- */
+  bool CanWriteFile(const char* itkNotUsed(filename)) override { return false; }
+
+  void WriteImageInformation() override {}
+
+  void Write(const void* buffer) override;
+
+protected:
+  ProjectionsHeaderCacheImageIO() = default;
+  ~ProjectionsHeaderCacheImageIO() override = default;
+
+private:
+  itk::ImageIOBase::Pointer m_ImageIO;
+
+  /** Image IO which has read the header of the current file, either from the
+   * cache or m_ImageIO. */
+  itk::ImageIOBase::Pointer m_HeaderImageIO;
+};
+
+} // end namespace rtk
+
+#endif
@@ -58,6 +58,7 @@ namespace rtk
  * Crop [label="itk::CropImageFilter" URL="\ref itk::CropImageFilter" style=dashed];
  * Binning [label="itk::BinShrinkImageFilter" URL="\ref itk::BinShrinkImageFilter" style=dashed];
  * ConditionalMedian [label="rtk::ConditionalMedianImageFilter" URL="\ref rtk::ConditionalMedianImageFilter" style=dashed];
+ * SKS [label="rtk::ScatterKernelSuperpositionImageFilter" URL="\ref rtk::ScatterKernelSuperpositionImageFilter" style=dashed];
  * Scatter [label="rtk::BoellaardScatterCorrectionImageFilter" URL="\ref rtk::BoellaardScatterCorrectionImageFilter" style=dashed];
  * I0est [label="rtk::I0EstimationProjectionFilter" URL="\ref rtk::I0EstimationProjectionFilter" style=dashed];
  * BeforeLUT [label="", fixedsize="false", width=0, height=0, shape=none];
@@ -81,7 +82,8 @@ namespace rtk
  * ElektaRaw->ConditionalMedian
  * Crop->ConditionalMedian[label="Default"]
  * ConditionalMedian->Binning
- * Binning->Scatter [label="Elekta, Varian, IBA, ushort"]
+ * Binning->SKS [label="Elekta, Varian, IBA, ushort"]
+ * SKS->Scatter
  * Scatter->I0est [label="Default"]
  * I0est->BeforeLUT
  * BeforeLUT->LUT [label="ComputeLineIntegral\n(default)"]
@@ -147,6 +149,7 @@ public:
   using ShrinkFactorsType = itk::FixedArray< unsigned int, TOutputImage::ImageDimension >;
   using MedianRadiusType = typename rtk::ConditionalMedianImageFilter<TOutputImage>::MedianRadiusType;
   using WaterPrecorrectionVectorType = std::vector< double >;
+  using ScatterKernelVectorType = std::vector< double >;
 
   /** Typdefs of filters of the mini-pipeline that do not depend on the raw
    * data type. */
@@ -158,15 +161,9 @@ public:
                       TOutputImage::ImageDimension);
 
   /** Set the vector of strings that contains the file names. Files
-   * are processed in sequential order. */
-  void SetFileNames (const FileNamesContainer &name)
-    {
-    if ( m_FileNames != name)
-      {
-      m_FileNames = name;
-      this->Modified();
-      }
-    }
+   * are processed in sequential order. The headers of the previous files
+   * which are not in name are removed from rtk::ProjectionsHeaderCache. */
+  void SetFileNames (const FileNamesContainer &name);
   const FileNamesContainer & GetFileNames() const
     {
     return m_FileNames;
@@ -208,6 +205,39 @@ public:
   itkGetMacro(NonNegativityConstraintThreshold, double);
   itkSetMacro(NonNegativityConstraintThreshold, double);
 
+  /** Set/Get rtk::ScatterKernelSuperpositionImageFilter parameters. The
+   * scatter kernel superposition is applied when kernel amplitudes are set.
+   * The non-negativity threshold and I0 are shared with the other filters. */
+  itkGetMacro(ScatterKernelThicknesses, ScatterKernelVectorType);
+  virtual void SetScatterKernelThicknesses(const ScatterKernelVectorType _arg)
+    {
+    if (this->m_ScatterKernelThicknesses != _arg)
+      {
+      this->m_ScatterKernelThicknesses = _arg;
+      this->Modified();
+      }
+    }
+  itkGetMacro(ScatterKernelWidths, ScatterKernelVectorType);
+  virtual void SetScatterKernelWidths(const ScatterKernelVectorType _arg)
+    {
+    if (this->m_ScatterKernelWidths != _arg)
+      {
+      this->m_ScatterKernelWidths = _arg;
+      this->Modified();
+      }
+    }
+  itkGetMacro(ScatterKernelAmplitudes, ScatterKernelVectorType);
+  virtual void SetScatterKernelAmplitudes(const ScatterKernelVectorType _arg)
+    {
+    if (this->m_ScatterKernelAmplitudes != _arg)
+      {
+      this->m_ScatterKernelAmplitudes = _arg;
+      this->Modified();
+      }
+    }
+  itkGetMacro(ScatterDownsamplingFactor, unsigned int);
+  itkSetMacro(ScatterDownsamplingFactor, unsigned int);
+
   /** Set/Get rtk::LUTbasedVariableI0RawToAttenuationImageFilter. Default is
    * used if not set which depends on the input image type max. If equals 0,
    * automated estimation is activated using rtk::I0EstimationProjectionFilter.
@@ -252,7 +282,8 @@ public:
 
 protected:
   ProjectionsReader();
-  ~ProjectionsReader() override = default;
+  /** Removes the headers of the files from rtk::ProjectionsHeaderCache. */
+  ~ProjectionsReader() override;
   void PrintSelf(std::ostream& os, itk::Indent indent) const override;
 
   /** Does the real work. */
@@ -281,6 +312,7 @@ private:
   itk::ProcessObject::Pointer m_CropFilter;
   itk::ProcessObject::Pointer m_ConditionalMedianFilter;
   itk::ProcessObject::Pointer m_BinningFilter;
+  itk::ProcessObject::Pointer m_ScatterKernelFilter;
   itk::ProcessObject::Pointer m_ScatterFilter;
   itk::ProcessObject::Pointer m_I0EstimationFilter;
 
@@ -299,6 +331,10 @@ private:
   /** Image IO object which is stored to create the pipe only when required */
   itk::ImageIOBase::Pointer m_ImageIO{nullptr};
 
+  /** Image IO of the raw data reader, an rtk::ProjectionsHeaderCacheImageIO
+   * if the first file has been scanned by a geometry reader. */
+  itk::ImageIOBase::Pointer m_RawImageIO{nullptr};
+
   /** Copy of parameters for the mini-pipeline. Parameters are checked and
    * propagated when required in the GenerateOutputInformation. Refer to the
    * documentation of the corresponding filter for more information. */
@@ -312,6 +348,10 @@ private:
   double                       m_AirThreshold{32000};
   double                       m_ScatterToPrimaryRatio{0.};
   double                       m_NonNegativityConstraintThreshold{itk::NumericTraits<double>::NonpositiveMin()};
+  ScatterKernelVectorType      m_ScatterKernelThicknesses;
+  ScatterKernelVectorType      m_ScatterKernelWidths;
+  ScatterKernelVectorType      m_ScatterKernelAmplitudes;
+  unsigned int                 m_ScatterDownsamplingFactor{8};
   double                       m_I0{itk::NumericTraits<double>::NonpositiveMin()};
   double                       m_IDark{0.};
   double                       m_ConditionalMedianThresholdMultiplier{1.};
@@ -31,9 +31,14 @@
 #include <itkCastImageFilter.h>
 #include <itkVectorIndexSelectionCastImageFilter.h>
 
+#include <algorithm>
+
 // RTK
 #include "rtkIOFactories.h"
+#include "rtkProjectionsHeaderCache.h"
+#include "rtkProjectionsHeaderCacheImageIO.h"
 #include "rtkBoellaardScatterCorrectionImageFilter.h"
+#include "rtkScatterKernelSuperpositionImageFilter.h"
 #include "rtkLUTbasedVariableI0RawToAttenuationImageFilter.h"
 #include "rtkConditionalMedianImageFilter.h"
 
@@ -91,7 +96,7 @@ if ( !strcmp(m_ImageIO->GetComponentTypeAsString(m_ImageIO->GetComponentType()).
   RawType *raw = dynamic_cast<RawType*>(m_RawDataReader.GetPointer()); \
   assert(raw != nullptr); \
   raw->SetFileNames( this->GetFileNames() ); \
-  raw->SetImageIO( m_ImageIO ); \
+  raw->SetImageIO( m_RawImageIO ); \
   using VectorComponentSelectionType = itk::VectorIndexSelectionCastImageFilter<InputImageType, OutputImageType>; \
   VectorComponentSelectionType *vectorComponentSelectionFilter = dynamic_cast<VectorComponentSelectionType*>(m_VectorComponentSelectionFilter.GetPointer()); \
   assert(vectorComponentSelectionFilter != nullptr); \
@@ -121,6 +126,32 @@ ProjectionsReader<TOutputImage>
   m_MedianRadius.Fill(0);
 }
 
+//--------------------------------------------------------------------
+template <class TOutputImage>
+ProjectionsReader<TOutputImage>
+::~ProjectionsReader()
+{
+  ProjectionsHeaderCache::Remove(m_FileNames);
+}
+
+//--------------------------------------------------------------------
+template <class TOutputImage>
+void ProjectionsReader<TOutputImage>
+::SetFileNames(const FileNamesContainer &name)
+{
+  if ( m_FileNames != name)
+    {
+    FileNamesContainer removed;
+    for(const std::string &fileName : m_FileNames)
+      if(std::find(name.begin(), name.end(), fileName) == name.end())
+        removed.push_back(fileName);
+    ProjectionsHeaderCache::Remove(removed);
+
+    m_FileNames = name;
+    this->Modified();
+    }
+}
+
 //--------------------------------------------------------------------
 template <class TOutputImage>
 void ProjectionsReader<TOutputImage>
@@ -146,12 +177,22 @@ void ProjectionsReader<TOutputImage>
   if(firstTime)
     rtk::RegisterIOFactories();
 
-  itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO( m_FileNames[0].c_str(), itk::ImageIOFactory::FileModeType::ReadMode );
+  // Image IO of the first file. If its header has already been read by a
+  // geometry reader, the cached image IO is used without probing all image IO
+  // nor reading the header again. The raw data reader then reads the headers
+  // of the other files from the cache as well.
+  itk::ImageIOBase::Pointer imageIO = ProjectionsHeaderCache::GetImageIO( m_FileNames[0] );
+  const bool scanned = imageIO.IsNotNull();
+  if(!scanned)
+    imageIO = itk::ImageIOFactory::CreateImageIO( m_FileNames[0].c_str(), itk::ImageIOFactory::FileModeType::ReadMode );
 
   if(m_ImageIO != imageIO)
     {
-    imageIO->SetFileName( m_FileNames[0].c_str() );
-    imageIO->ReadImageInformation();
+    if(!scanned)
+      {
+      imageIO->SetFileName( m_FileNames[0].c_str() );
+      imageIO->ReadImageInformation();
+      }
 
     // In this block, we create the filters used depending on the input type
 
@@ -163,6 +204,7 @@ void ProjectionsReader<TOutputImage>
     m_CropFilter = nullptr;
     m_ConditionalMedianFilter = nullptr;
     m_BinningFilter = nullptr;
+    m_ScatterKernelFilter = nullptr;
     m_ScatterFilter = nullptr;
     m_I0EstimationFilter = nullptr;
     m_RawToAttenuationFilter = nullptr;
@@ -245,6 +287,11 @@ void ProjectionsReader<TOutputImage>
       typename BinType::Pointer bin = BinType::New();
       m_BinningFilter = bin;
 
+      // Scatter kernel superposition
+      using ScatterKernelFilterType = rtk::ScatterKernelSuperpositionImageFilter<InputImageType, InputImageType>;
+      typename ScatterKernelFilterType::Pointer sks = ScatterKernelFilterType::New();
+      m_ScatterKernelFilter = sks;
+
       // Scatter correction
       using ScatterFilterType = rtk::BoellaardScatterCorrectionImageFilter<InputImageType, InputImageType>;
       typename ScatterFilterType::Pointer scatter = ScatterFilterType::New();
@@ -327,6 +374,11 @@ void ProjectionsReader<TOutputImage>
         }
       else
         {
+        // Scatter kernel superposition
+        using ScatterKernelFilterType = rtk::ScatterKernelSuperpositionImageFilter<InputImageType, InputImageType>;
+        typename ScatterKernelFilterType::Pointer sks = ScatterKernelFilterType::New();
+        m_ScatterKernelFilter = sks;
+
         // Scatter correction
         using ScatterFilterType = rtk::BoellaardScatterCorrectionImageFilter<InputImageType, InputImageType>;
         typename ScatterFilterType::Pointer scatter = ScatterFilterType::New();
@@ -398,6 +450,16 @@ void ProjectionsReader<TOutputImage>
 
     //Store imageIO to avoid creating the pipe more than necessary
     m_ImageIO = imageIO;
+
+    // The cached image IO must not read other files
+    if(scanned)
+      {
+      ProjectionsHeaderCacheImageIO::Pointer cacheImageIO = ProjectionsHeaderCacheImageIO::New();
+      cacheImageIO->SetImageIO( dynamic_cast<itk::ImageIOBase *>( imageIO->CreateAnother().GetPointer() ) );
+      m_RawImageIO = cacheImageIO;
+      }
+    else
+      m_RawImageIO = imageIO;
     }
 
   // Parameter propagation
@@ -462,7 +524,7 @@ void ProjectionsReader<TOutputImage>
     RawType *raw = dynamic_cast<RawType*>(m_RawDataReader.GetPointer());
     assert(raw != nullptr);
     raw->SetFileNames( this->GetFileNames() );
-    raw->SetImageIO( m_ImageIO );
+    raw->SetImageIO( m_RawImageIO );
     nextInput = raw->GetOutput();
 
     // Image information
@@ -572,6 +634,30 @@ void ProjectionsReader<TOutputImage>
         }
       }
 
+    // Scatter kernel superposition
+    if(!m_ScatterKernelAmplitudes.empty())
+      {
+      if(m_ScatterKernelFilter.GetPointer() == nullptr)
+        {
+          itkGenericExceptionMacro(<< "Can not use scatter kernel superposition with this input (not implemented)");
+        }
+      else
+        {
+        using ScatterKernelFilterType = rtk::ScatterKernelSuperpositionImageFilter<TInputImage, TInputImage>;
+        ScatterKernelFilterType *sks = dynamic_cast<ScatterKernelFilterType*>(m_ScatterKernelFilter.GetPointer());
+        assert(sks != nullptr);
+        sks->SetKernelThicknesses(m_ScatterKernelThicknesses);
+        sks->SetKernelWidths(m_ScatterKernelWidths);
+        sks->SetKernelAmplitudes(m_ScatterKernelAmplitudes);
+        sks->SetDownsamplingFactor(m_ScatterDownsamplingFactor);
+        sks->SetI0(std::max(m_I0, 0.));
+        if(m_NonNegativityConstraintThreshold != itk::NumericTraits<double>::NonpositiveMin())
+          sks->SetNonNegativityConstraintThreshold(m_NonNegativityConstraintThreshold);
+        sks->SetInput(nextInput);
+        nextInput = sks->GetOutput();
+        }
+      }
+
     // Boellaard scatter correction
     if(m_NonNegativityConstraintThreshold != itk::NumericTraits<double>::NonpositiveMin() ||
        m_ScatterToPrimaryRatio != 0.)
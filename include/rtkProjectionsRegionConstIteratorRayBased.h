@@ -39,6 +39,9 @@ namespace rtk
  * can handle parallel geometry with flat panels and cone-beam geometries with
  * flat and curved detectors.
  *
+ * If the geometry has a detector displacement field, the pixel positions
+ * are the positions where the pixel values have been measured.
+ *
  * \author Simon Rit
  *
  * \ingroup RTK
@@ -72,6 +75,10 @@ public:
   using MatrixType = itk::Matrix< double, 3, 4 >;
   using HomogeneousMatrixType = itk::Matrix< double, 4, 4 >;
 
+  /** Kind of rays of a geometry, which determines the concrete iterator
+   * created by New. */
+  typedef enum {PARALLEL=0, FLAT_PANEL, CYLINDRICAL_PANEL} RayGeometryType;
+
   /** Constructor establishes an iterator to walk a particular image and a
    * particular region of that image.
    * Set the matrix by which the 3D coordinates of the projection can be
@@ -99,6 +106,16 @@ public:
       const RegionType & region,
       const ThreeDCircularProjectionGeometry *geometry);
 
+  /** Returns the kind of rays of the geometry, i.e., the concrete iterator
+   * which New would create. Filters which instantiate the concrete iterator
+   * themselves know its type at compile time and the computation of the ray
+   * of each pixel is then inlined in their loops, see
+   * rtk::JosephForwardProjectionImageFilter. */
+  static RayGeometryType GetRayGeometryType(const ThreeDCircularProjectionGeometry *geometry);
+
+  /** Converts a homogeneous matrix to the postMat of the constructor. */
+  static MatrixType GetPostMultiplyMatrix(const HomogeneousMatrixType &postMat);
+
   /** Increment (prefix) the fastest moving dimension of the iterator's index.
    * This operator will constrain the iterator within the region (i.e. the
    * iterator will automatically wrap from the end of the row of the region
@@ -139,6 +156,11 @@ public:
     }
 
 protected:
+  /** Increments the index and returns the dimension along which it has been
+   * incremented or TImage::ImageDimension if the end of the region has been
+   * reached. Shared by the operator++ of the concrete iterators. */
+  inline unsigned int IncrementIndex();
+
   /** Init the parameters common to a new 2D projection in the 3D stack. */
   virtual void NewProjection() = 0;
 
@@ -146,8 +168,26 @@ protected:
    * NewProjection method has already been called. */
   virtual void NewPixel() = 0;
 
+  /** Projection coordinates of the current pixel moved to the position where
+   * its value has been measured, to be used by the concrete iterators if
+   * m_HasDetectorDisplacement. */
+  inline PointType GetDisplacedProjectionCoordinates() const
+    {
+    PointType p;
+    for(unsigned int i=0; i<3; i++)
+      {
+      p[i] = m_IndexToProjectionCoordinatesMatrix[i][3];
+      for(unsigned int j=0; j<3; j++)
+        p[i] += m_IndexToProjectionCoordinatesMatrix[i][j] * this->m_PositionIndex[j];
+      }
+    m_Geometry->ApplyDetectorDisplacement(p[0], p[1]);
+    return p;
+    }
+
   ThreeDCircularProjectionGeometry::ConstPointer m_Geometry;
   MatrixType                                     m_PostMultiplyMatrix;
+  bool                                           m_HasDetectorDisplacement;
+  HomogeneousMatrixType                          m_IndexToProjectionCoordinatesMatrix;
   PointType                                      m_SourcePosition;
   PointType                                      m_PixelPosition;
   PointType                                      m_SourceToPixel;
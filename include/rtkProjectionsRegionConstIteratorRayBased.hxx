@@ -35,14 +35,16 @@ ProjectionsRegionConstIteratorRayBased< TImage >
                                          const MatrixType &postMat):
   itk::ImageConstIteratorWithIndex< TImage >(ptr, region),
   m_Geometry(geometry),
-  m_PostMultiplyMatrix(postMat)
+  m_PostMultiplyMatrix(postMat),
+  m_HasDetectorDisplacement(geometry->GetDetectorDisplacementField() != nullptr),
+  m_IndexToProjectionCoordinatesMatrix(GetIndexToPhysicalPointMatrix(ptr))
 {
 }
 
 template< typename TImage >
-ProjectionsRegionConstIteratorRayBased< TImage > &
+unsigned int
 ProjectionsRegionConstIteratorRayBased< TImage >
-::operator++()
+::IncrementIndex()
 {
   // This code is copy pasted from itkProjectionsRegionConstIteratorRayBased since
   // operators are not virtual.
@@ -66,10 +68,19 @@ ProjectionsRegionConstIteratorRayBased< TImage >
     }
 
   if ( !this->m_Remaining ) // It will not advance here otherwise
-    {
     this->m_Position = this->m_End;
+
+  return in;
+}
+
+template< typename TImage >
+ProjectionsRegionConstIteratorRayBased< TImage > &
+ProjectionsRegionConstIteratorRayBased< TImage >
+::operator++()
+{
+  const unsigned int in = IncrementIndex();
+  if ( in == TImage::ImageDimension )
     return *this;
-    }
 
   if(in == 2)
     {
@@ -81,12 +92,9 @@ ProjectionsRegionConstIteratorRayBased< TImage >
 }
 
 template< typename TImage >
-ProjectionsRegionConstIteratorRayBased< TImage > *
+typename ProjectionsRegionConstIteratorRayBased< TImage >::RayGeometryType
 ProjectionsRegionConstIteratorRayBased< TImage >
-::New(const TImage *ptr,
-      const RegionType & region,
-      const ThreeDCircularProjectionGeometry *geometry,
-      const MatrixType &postMat)
+::GetRayGeometryType(const ThreeDCircularProjectionGeometry *geometry)
 {
   if(geometry->GetSourceToDetectorDistances().empty())
     {
@@ -98,18 +106,41 @@ ProjectionsRegionConstIteratorRayBased< TImage >
       {
       itkGenericExceptionMacro(<< "Parallel geometry assumes a flat panel detector.");
       }
-    using IteratorType = ProjectionsRegionConstIteratorRayBasedParallel<TImage>;
-    return new IteratorType(ptr, region, geometry, postMat);
+    return PARALLEL;
     }
   else if(geometry->GetRadiusCylindricalDetector() == 0.)
+    return FLAT_PANEL;
+  return CYLINDRICAL_PANEL;
+}
+
+template< typename TImage >
+typename ProjectionsRegionConstIteratorRayBased< TImage >::MatrixType
+ProjectionsRegionConstIteratorRayBased< TImage >
+::GetPostMultiplyMatrix(const HomogeneousMatrixType &postMat)
+{
+  MatrixType pm;
+  for(unsigned int i=0; i<MatrixType::RowDimensions; i++)
+    for(unsigned int j=0; j<MatrixType::ColumnDimensions; j++)
+        pm[i][j] = postMat[i][j];
+  return pm;
+}
+
+template< typename TImage >
+ProjectionsRegionConstIteratorRayBased< TImage > *
+ProjectionsRegionConstIteratorRayBased< TImage >
+::New(const TImage *ptr,
+      const RegionType & region,
+      const ThreeDCircularProjectionGeometry *geometry,
+      const MatrixType &postMat)
+{
+  switch(GetRayGeometryType(geometry))
     {
-    using IteratorType = ProjectionsRegionConstIteratorRayBasedWithFlatPanel<TImage>;
-    return new IteratorType(ptr, region, geometry, postMat);
-    }
-  else
-    {
-    using IteratorType = ProjectionsRegionConstIteratorRayBasedWithCylindricalPanel<TImage>;
-    return new IteratorType(ptr, region, geometry, postMat);
+    case PARALLEL:
+      return new ProjectionsRegionConstIteratorRayBasedParallel<TImage>(ptr, region, geometry, postMat);
+    case FLAT_PANEL:
+      return new ProjectionsRegionConstIteratorRayBasedWithFlatPanel<TImage>(ptr, region, geometry, postMat);
+    default:
+      return new ProjectionsRegionConstIteratorRayBasedWithCylindricalPanel<TImage>(ptr, region, geometry, postMat);
     }
 }
 
@@ -121,11 +152,7 @@ ProjectionsRegionConstIteratorRayBased< TImage >
       const ThreeDCircularProjectionGeometry *geometry,
       const HomogeneousMatrixType &postMat)
 {
-  MatrixType pm;
-  for(unsigned int i=0; i<MatrixType::RowDimensions; i++)
-    for(unsigned int j=0; j<MatrixType::ColumnDimensions; j++)
-        pm[i][j] = postMat[i][j];
-  return New(ptr, region, geometry, pm);
+  return New(ptr, region, geometry, GetPostMultiplyMatrix(postMat));
 }
 
 template<class TImage>
@@ -62,6 +62,21 @@ public:
                                                  const ThreeDCircularProjectionGeometry *geometry,
                                                  const MatrixType &postMat);
 
+  /** Same as Superclass::operator++ with non-virtual calls to NewProjection
+   * and NewPixel, which are inlined when the iterator type is known at
+   * compile time. */
+  Self & operator++()
+    {
+    const unsigned int in = this->IncrementIndex();
+    if ( in == TImage::ImageDimension )
+      return *this;
+    if(in == 2)
+      Self::NewProjection();
+    Self::NewPixel();
+    return *this;
+    }
+  void Next() {++*this;}
+
 protected:
   /** Init the parameters common to a new 2D projection in the 3D stack. */
   inline void NewProjection() override;
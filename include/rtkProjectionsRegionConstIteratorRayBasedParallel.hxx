@@ -55,10 +55,17 @@ ProjectionsRegionConstIteratorRayBasedParallel< TImage >
   // IndexToPhysicalPointMatrix maps the 2D index of a projection's pixel to its 2D position on the detector (in mm)
   // ProjectionCoordinatesToFixedSystemMatrix maps the 2D position of a pixel on the detector to its 3D coordinates in volume's coordinates (still in mm)
   // volPPToIndex maps 3D volume coordinates to a 3D index
-  m_ProjectionIndexTransformMatrix =
-      this->m_PostMultiplyMatrix.GetVnlMatrix() *
-      this->m_Geometry->GetProjectionCoordinatesToFixedSystemMatrix(this->m_PositionIndex[2]).GetVnlMatrix() *
-      GetIndexToPhysicalPointMatrix( this->m_Image.GetPointer() ).GetVnlMatrix();
+  // With a detector displacement field, the matrix is applied to the
+  // displaced projection coordinates instead of the projection index
+  if(this->m_HasDetectorDisplacement)
+    m_ProjectionIndexTransformMatrix =
+        this->m_PostMultiplyMatrix.GetVnlMatrix() *
+        this->m_Geometry->GetProjectionCoordinatesToFixedSystemMatrix(this->m_PositionIndex[2]).GetVnlMatrix();
+  else
+    m_ProjectionIndexTransformMatrix =
+        this->m_PostMultiplyMatrix.GetVnlMatrix() *
+        this->m_Geometry->GetProjectionCoordinatesToFixedSystemMatrix(this->m_PositionIndex[2]).GetVnlMatrix() *
+        GetIndexToPhysicalPointMatrix( this->m_Image.GetPointer() ).GetVnlMatrix();
 }
 
 template< typename TImage >
@@ -67,11 +74,24 @@ ProjectionsRegionConstIteratorRayBasedParallel< TImage >
 ::NewPixel()
 {
   // Compute point coordinate in volume depending on projection index
-  for(unsigned int i=0; i<this->GetImageDimension(); i++)
+  if(this->m_HasDetectorDisplacement)
     {
-    this->m_PixelPosition[i] = m_ProjectionIndexTransformMatrix[i][this->GetImageDimension()];
-    for(unsigned int j=0; j<this->GetImageDimension(); j++)
-      this->m_PixelPosition[i] += m_ProjectionIndexTransformMatrix[i][j] * this->m_PositionIndex[j];
+    const PointType posProj = this->GetDisplacedProjectionCoordinates();
+    for(unsigned int i=0; i<this->GetImageDimension(); i++)
+      {
+      this->m_PixelPosition[i] = m_ProjectionIndexTransformMatrix[i][this->GetImageDimension()];
+      for(unsigned int j=0; j<this->GetImageDimension(); j++)
+        this->m_PixelPosition[i] += m_ProjectionIndexTransformMatrix[i][j] * posProj[j];
+      }
+    }
+  else
+    {
+    for(unsigned int i=0; i<this->GetImageDimension(); i++)
+      {
+      this->m_PixelPosition[i] = m_ProjectionIndexTransformMatrix[i][this->GetImageDimension()];
+      for(unsigned int j=0; j<this->GetImageDimension(); j++)
+        this->m_PixelPosition[i] += m_ProjectionIndexTransformMatrix[i][j] * this->m_PositionIndex[j];
+      }
     }
 
   this->m_SourcePosition = this->m_PixelPosition - this->m_SourceToPixel;
@@ -54,10 +54,16 @@ ProjectionsRegionConstIteratorRayBasedWithCylindricalPanel< TImage >
   this->m_SourcePosition = this->m_PostMultiplyMatrix * this->m_Geometry->GetSourcePosition(iProj);
 
   // Compute matrix to transform projection index to position on a flat panel
-  // if the panel were flat, before accounting for the curvature
-  m_ProjectionIndexTransformMatrix =
-      this->m_Geometry->GetProjectionCoordinatesToDetectorSystemMatrix(iProj).GetVnlMatrix() *
-      GetIndexToPhysicalPointMatrix( this->m_Image.GetPointer() ).GetVnlMatrix();
+  // if the panel were flat, before accounting for the curvature. With a
+  // detector displacement field, it is applied to the displaced projection
+  // coordinates instead of the projection index
+  if(this->m_HasDetectorDisplacement)
+    m_ProjectionIndexTransformMatrix =
+        this->m_Geometry->GetProjectionCoordinatesToDetectorSystemMatrix(iProj);
+  else
+    m_ProjectionIndexTransformMatrix =
+        this->m_Geometry->GetProjectionCoordinatesToDetectorSystemMatrix(iProj).GetVnlMatrix() *
+        GetIndexToPhysicalPointMatrix( this->m_Image.GetPointer() ).GetVnlMatrix();
 
   // Get transformation from coordinate in the (u,v,u^v) coordinate system to
   // the tomography (fixed) coordinate system
@@ -75,11 +81,17 @@ ProjectionsRegionConstIteratorRayBasedWithCylindricalPanel< TImage >
   PointType posProj;
 
   // Compute point coordinate in volume depending on projection index
+  PointType posIndex;
+  if(this->m_HasDetectorDisplacement)
+    posIndex = this->GetDisplacedProjectionCoordinates();
+  else
+    for(unsigned int i=0; i<this->GetImageDimension(); i++)
+      posIndex[i] = this->m_PositionIndex[i];
   for(unsigned int i=0; i<this->GetImageDimension(); i++)
     {
     posProj[i] = m_ProjectionIndexTransformMatrix[i][this->GetImageDimension()];
     for(unsigned int j=0; j<this->GetImageDimension(); j++)
-      posProj[i] += m_ProjectionIndexTransformMatrix[i][j] * this->m_PositionIndex[j];
+      posProj[i] += m_ProjectionIndexTransformMatrix[i][j] * posIndex[j];
     }
 
   // Convert cylindrical angle to coordinates in the (u,v,u^v) coordinate system
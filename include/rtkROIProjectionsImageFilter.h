@@ -0,0 +1,180 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkROIProjectionsImageFilter_h
+#define rtkROIProjectionsImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkConstantImageSource.h"
+#include "rtkDrawBoxImageFilter.h"
+#include "rtkForwardProjectionImageFilter.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+
+#include <itkMaskImageFilter.h>
+#include <itkSubtractImageFilter.h>
+
+namespace rtk
+{
+
+/** \class ROIProjectionsImageFilter
+ * \brief Computes the projections of a region of interest (ROI) from the full
+ * field-of-view projections and a coarse background volume.
+ *
+ * The background volume (input 1) is a coarse reconstruction of the full
+ * field-of-view, e.g. obtained with FDK on a large grid. Its voxels inside the
+ * ROI box are zeroed and the result is forward projected and subtracted from
+ * the projections (input 0). The output is therefore consistent with the line
+ * integrals of the ROI only and can be reconstructed by any iterative filter on
+ * a fine grid limited to the ROI without truncation artifacts. If the forward
+ * projection filter is a JosephForwardProjectionImageFilter, the ROI is not
+ * masked but declared as a nested volume of the background so that the rays
+ * skip exactly the part of space traced in the ROI reconstruction.
+ *
+ * \dot
+ * digraph ROIProjectionsImageFilter {
+ *
+ * Input0 [ label="Input 0 (Projections)"];
+ * Input0 [shape=Mdiamond];
+ * Input1 [label="Input 1 (Background volume)"];
+ * Input1 [shape=Mdiamond];
+ * Output [label="Output (ROI projections)"];
+ * Output [shape=Mdiamond];
+ *
+ * node [shape=box];
+ * OneVolume [ label="rtk::ConstantImageSource (ones)" URL="\ref rtk::ConstantImageSource"];
+ * DrawROI [ label="rtk::DrawBoxImageFilter (ROI, -1)" URL="\ref rtk::DrawBoxImageFilter"];
+ * Mask [ label="itk::MaskImageFilter" URL="\ref itk::MaskImageFilter"];
+ * ZeroProjections [ label="rtk::ConstantImageSource (zeros)" URL="\ref rtk::ConstantImageSource"];
+ * ForwardProjection [ label="rtk::ForwardProjectionImageFilter" URL="\ref rtk::ForwardProjectionImageFilter"];
+ * Subtract [ label="itk::SubtractImageFilter" URL="\ref itk::SubtractImageFilter"];
+ *
+ * OneVolume -> DrawROI;
+ * DrawROI -> Mask;
+ * Input1 -> Mask;
+ * Mask -> ForwardProjection;
+ * ZeroProjections -> ForwardProjection;
+ * Input0 -> Subtract;
+ * ForwardProjection -> Subtract;
+ * Subtract -> Output;
+ * }
+ * \enddot
+ *
+ * \test rtkroireconstructiontest.cxx
+ *
+ * \ingroup RTK ReconstructionAlgorithm
+ */
+template<class TProjectionImage, class TVolumeImage=TProjectionImage>
+class ITK_EXPORT ROIProjectionsImageFilter :
+  public itk::ImageToImageFilter<TProjectionImage, TProjectionImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ROIProjectionsImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ROIProjectionsImageFilter;
+  using Superclass = itk::ImageToImageFilter<TProjectionImage, TProjectionImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  /** Some convenient type alias. */
+  using ProjectionType = TProjectionImage;
+  using VolumeType = TVolumeImage;
+  using MaskImageType = itk::Image<float, TVolumeImage::ImageDimension>;
+  using ImageBaseType = itk::ImageBase<TVolumeImage::ImageDimension>;
+  using GeometryType = ThreeDCircularProjectionGeometry;
+
+  /** Typedefs of each subfilter of this composite filter */
+  using MaskSourceType = ConstantImageSource<MaskImageType>;
+  using DrawROIFilterType = DrawBoxImageFilter<MaskImageType, MaskImageType>;
+  using MaskFilterType = itk::MaskImageFilter<VolumeType, MaskImageType, VolumeType>;
+  using ConstantProjectionSourceType = ConstantImageSource<ProjectionType>;
+  using ForwardProjectionFilterType = ForwardProjectionImageFilter<ProjectionType, VolumeType>;
+  using ForwardProjectionFilterPointer = typename ForwardProjectionFilterType::Pointer;
+  using JosephForwardProjectionFilterType = JosephForwardProjectionImageFilter<ProjectionType, VolumeType>;
+  using SubtractFilterType = itk::SubtractImageFilter<ProjectionType, ProjectionType>;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ROIProjectionsImageFilter, itk::ImageToImageFilter);
+
+  /** Set / Get the projections, input 0. */
+  void SetInputProjectionStack(const ProjectionType* projections);
+  typename ProjectionType::ConstPointer GetInputProjectionStack();
+
+  /** Set / Get the coarse full field-of-view background volume, input 1. */
+  void SetInputBackgroundVolume(const VolumeType* background);
+  typename VolumeType::ConstPointer GetInputBackgroundVolume();
+
+  /** Set the ROI box from the image which is reconstructed. The box includes
+   * the external half voxel border of the image. The filter is only modified
+   * if the box or the image changes. */
+  void SetROIFromImage(const ImageBaseType *roi);
+
+  /** Get / Set the object pointer to projection geometry */
+  itkGetConstObjectMacro(Geometry, GeometryType);
+  itkSetConstObjectMacro(Geometry, GeometryType);
+
+  /** Get / Set the forward projection filter used to project the background.
+   * It must be set before the filter is updated. */
+  itkGetMacro(ForwardProjectionFilter, ForwardProjectionFilterPointer);
+  virtual void SetForwardProjectionFilter (const ForwardProjectionFilterPointer _arg);
+
+protected:
+  ROIProjectionsImageFilter();
+  ~ROIProjectionsImageFilter() override = default;
+
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateOutputInformation() override;
+
+  void GenerateData() override;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+#if ITK_VERSION_MAJOR<5
+  void VerifyInputInformation() override {}
+#else
+  void VerifyInputInformation() const override {}
+#endif
+
+  /** Pointers to each subfilter of this composite filter */
+  typename MaskSourceType::Pointer               m_MaskSource;
+  typename DrawROIFilterType::Pointer            m_DrawROIFilter;
+  typename MaskFilterType::Pointer               m_MaskFilter;
+  typename ConstantProjectionSourceType::Pointer m_ZeroProjectionsSource;
+  ForwardProjectionFilterPointer                 m_ForwardProjectionFilter;
+  typename SubtractFilterType::Pointer           m_SubtractFilter;
+
+private:
+  GeometryType::ConstPointer           m_Geometry;
+  typename ImageBaseType::ConstPointer m_ROI;
+
+  /** False if the ROI or the forward projector has changed since the ROI
+   * has been nested in the Joseph forward projector. */
+  bool                                 m_NestedROIUpToDate{false};
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkROIProjectionsImageFilter.hxx"
+#endif
+
+#endif
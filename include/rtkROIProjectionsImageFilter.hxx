@@ -0,0 +1,188 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkROIProjectionsImageFilter_hxx
+#define rtkROIProjectionsImageFilter_hxx
+
+#include "rtkROIProjectionsImageFilter.h"
+#include "rtkBoxShape.h"
+
+namespace rtk
+{
+
+template<class TProjectionImage, class TVolumeImage>
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::ROIProjectionsImageFilter()
+{
+  this->SetNumberOfRequiredInputs(2);
+
+  // Create each filter of the composite filter
+  m_MaskSource = MaskSourceType::New();
+  m_DrawROIFilter = DrawROIFilterType::New();
+  m_MaskFilter = MaskFilterType::New();
+  m_ZeroProjectionsSource = ConstantProjectionSourceType::New();
+  m_SubtractFilter = SubtractFilterType::New();
+
+  // Permanent internal connections
+  m_DrawROIFilter->SetInput(m_MaskSource->GetOutput());
+  m_MaskFilter->SetMaskImage(m_DrawROIFilter->GetOutput());
+
+  // Default parameters
+  m_MaskSource->SetConstant(1.);
+  m_DrawROIFilter->SetDensity(-1.);
+  m_DrawROIFilter->InPlaceOn();
+}
+
+template<class TProjectionImage, class TVolumeImage>
+void
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::SetInputProjectionStack(const ProjectionType* projections)
+{
+  this->SetNthInput(0, const_cast<ProjectionType*>(projections));
+}
+
+template<class TProjectionImage, class TVolumeImage>
+typename TProjectionImage::ConstPointer
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::GetInputProjectionStack()
+{
+  return static_cast< const ProjectionType * >
+         ( this->itk::ProcessObject::GetInput(0) );
+}
+
+template<class TProjectionImage, class TVolumeImage>
+void
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::SetInputBackgroundVolume(const VolumeType* background)
+{
+  this->SetNthInput(1, const_cast<VolumeType*>(background));
+}
+
+template<class TProjectionImage, class TVolumeImage>
+typename TVolumeImage::ConstPointer
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::GetInputBackgroundVolume()
+{
+  return static_cast< const VolumeType * >
+         ( this->itk::ProcessObject::GetInput(1) );
+}
+
+template<class TProjectionImage, class TVolumeImage>
+void
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::SetROIFromImage(const ImageBaseType *roi)
+{
+  BoxShape::Pointer box = BoxShape::New();
+  box->SetBoxFromImage(roi, true);
+  if(m_ROI == roi &&
+     m_DrawROIFilter->GetBoxMin() == box->GetBoxMin().GetVectorFromOrigin() &&
+     m_DrawROIFilter->GetBoxMax() == box->GetBoxMax().GetVectorFromOrigin() &&
+     m_DrawROIFilter->GetDirection() == box->GetDirection())
+    return;
+
+  m_DrawROIFilter->SetBoxMin(box->GetBoxMin().GetVectorFromOrigin());
+  m_DrawROIFilter->SetBoxMax(box->GetBoxMax().GetVectorFromOrigin());
+  m_DrawROIFilter->SetDirection(box->GetDirection());
+  m_ROI = roi;
+  m_NestedROIUpToDate = false;
+  this->Modified();
+}
+
+template<class TProjectionImage, class TVolumeImage>
+void
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::SetForwardProjectionFilter (const ForwardProjectionFilterPointer _arg)
+{
+  if (this->m_ForwardProjectionFilter != _arg)
+    {
+    this->m_ForwardProjectionFilter = _arg;
+    m_NestedROIUpToDate = false;
+    this->Modified();
+    }
+}
+
+template<class TProjectionImage, class TVolumeImage>
+void
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::GenerateInputRequestedRegion()
+{
+  m_SubtractFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
+  m_SubtractFilter->GetOutput()->PropagateRequestedRegion();
+}
+
+template<class TProjectionImage, class TVolumeImage>
+void
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::GenerateOutputInformation()
+{
+  if(m_ForwardProjectionFilter.IsNull())
+    {
+    itkExceptionMacro(<< "The forward projection filter has not been set");
+    }
+  if(m_Geometry.IsNull())
+    {
+    itkExceptionMacro(<< "The geometry has not been set");
+    }
+
+  // Runtime connections. The Joseph projector skips the ROI itself, there is
+  // no need to mask the background. The ROI is only nested again if it has
+  // changed to avoid modifying the projector at each update.
+  m_ZeroProjectionsSource->SetInformationFromImage(this->GetInputProjectionStack());
+  m_ForwardProjectionFilter->SetInput(0, m_ZeroProjectionsSource->GetOutput());
+  auto *joseph = dynamic_cast<JosephForwardProjectionFilterType*>(m_ForwardProjectionFilter.GetPointer());
+  if(joseph && m_ROI.IsNotNull())
+    {
+    if(!m_NestedROIUpToDate)
+      {
+      joseph->ClearNestedVolumes();
+      joseph->AddNestedVolume(m_ROI);
+      m_NestedROIUpToDate = true;
+      }
+    m_ForwardProjectionFilter->SetInput(1, const_cast<VolumeType*>(this->GetInputBackgroundVolume().GetPointer()));
+    }
+  else
+    {
+    m_MaskSource->SetInformationFromImage(this->GetInputBackgroundVolume());
+    m_MaskFilter->SetInput(this->GetInputBackgroundVolume());
+    m_ForwardProjectionFilter->SetInput(1, m_MaskFilter->GetOutput());
+    }
+  m_ForwardProjectionFilter->SetGeometry(m_Geometry);
+  m_SubtractFilter->SetInput1(this->GetInputProjectionStack());
+  m_SubtractFilter->SetInput2(m_ForwardProjectionFilter->GetOutput());
+
+  // Memory management
+  m_DrawROIFilter->ReleaseDataFlagOn();
+  m_MaskFilter->ReleaseDataFlagOn();
+  m_ForwardProjectionFilter->ReleaseDataFlagOn();
+
+  m_SubtractFilter->UpdateOutputInformation();
+  this->GetOutput()->CopyInformation( m_SubtractFilter->GetOutput() );
+}
+
+template<class TProjectionImage, class TVolumeImage>
+void
+ROIProjectionsImageFilter<TProjectionImage, TVolumeImage>
+::GenerateData()
+{
+  m_SubtractFilter->Update();
+  this->GraftOutput( m_SubtractFilter->GetOutput() );
+}
+
+} // end namespace rtk
+
+#endif // rtkROIProjectionsImageFilter_hxx
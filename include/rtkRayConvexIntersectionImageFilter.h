@@ -23,6 +23,9 @@
 #include "rtkConfiguration.h"
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkConvexShape.h"
+#include "rtkProjectionTilesScheduler.h"
+
+#include <type_traits>
 
 namespace rtk
 {
@@ -86,6 +89,12 @@ public:
   itkGetMacro(Attenuation, double);
   itkSetMacro(Attenuation, double);
 
+  /** Get / Set the size of the square detector tiles which are dynamically
+   * distributed to the threads, see ProjectionTilesScheduler. 0 falls back
+   * to the region given to each thread by ITK. Default is 0. */
+  itkGetMacro(TileSize, unsigned int);
+  itkSetMacro(TileSize, unsigned int);
+
 protected:
   RayConvexIntersectionImageFilter();
   ~RayConvexIntersectionImageFilter() override = default;
@@ -102,10 +111,24 @@ protected:
   void DynamicThreadedGenerateData( const OutputImageRegionType& outputRegionForThread ) override;
 #endif
 
+  /** Compute the intersections in a region of the projections. */
+  void ProjectRegion( const OutputImageRegionType& region );
+
+  /** If input 0 is the output of a rtk::ConstantImageSource, possibly
+   * extracted, only one pixel is requested and its value is used instead of
+   * reading the input, see GetConstantImageValue. */
+  void GenerateInputRequestedRegion() override;
+  bool GetImplicitConstantInput(typename TInputImage::PixelType &value) const;
+
+  /** The output cannot be grafted on an implicit constant input. */
+  bool CanRunInPlace() const override;
+
 private:
   ConvexShapePointer   m_ConvexShape;
   GeometryConstPointer m_Geometry;
   double               m_Attenuation = 0.;
+  unsigned int         m_TileSize{0};
+  ProjectionTilesScheduler<TOutputImage::ImageDimension> m_TilesScheduler;
 };
 
 } // end namespace rtk
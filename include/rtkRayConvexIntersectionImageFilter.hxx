@@ -21,6 +21,7 @@
 
 #include "rtkRayConvexIntersectionImageFilter.h"
 #include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkConstantImageSource.h"
 
 #include <itkImageRegionConstIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
@@ -35,6 +36,44 @@ RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
 {
 }
 
+template <class TInputImage, class TOutputImage>
+void
+RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  typename TInputImage::PixelType constant;
+  if( this->GetImplicitConstantInput(constant) )
+    {
+    // Only one pixel of an implicit constant input is requested
+    typename TInputImage::Pointer inputPtr = const_cast< TInputImage * >( this->GetInput() );
+    typename TInputImage::RegionType reqRegion = inputPtr->GetRequestedRegion();
+    typename TInputImage::SizeType onePixel;
+    onePixel.Fill(1);
+    reqRegion.SetSize(onePixel);
+    inputPtr->SetRequestedRegion( reqRegion );
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
+::GetImplicitConstantInput(typename TInputImage::PixelType &value) const
+{
+  return std::is_same<TInputImage, TOutputImage>::value &&
+         GetConstantImageValue(this->GetInput(), value);
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
+::CanRunInPlace() const
+{
+  typename TInputImage::PixelType constant;
+  return Superclass::CanRunInPlace() && !this->GetImplicitConstantInput(constant);
+}
+
 template <class TInputImage, class TOutputImage>
 void
 RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
@@ -42,6 +81,8 @@ RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
 {
   if( this->m_ConvexShape.IsNull() )
     itkExceptionMacro(<<"ConvexShape has not been set.")
+  if( m_TileSize != 0 )
+    m_TilesScheduler.Initialize(this->GetOutput()->GetRequestedRegion(), m_TileSize);
 }
 
 template <class TInputImage, class TOutputImage>
@@ -54,10 +95,34 @@ RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
 ::DynamicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread)
 #endif
 {
-  // Iterators on input and output
+  if(m_TileSize == 0)
+    {
+    this->ProjectRegion(outputRegionForThread);
+    return;
+    }
+
+  // Process tiles until all tiles have been processed by this or other threads
+  OutputImageRegionType tile;
+  while( m_TilesScheduler.GetNextTile(tile) )
+    this->ProjectRegion(tile);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
+::ProjectRegion(const OutputImageRegionType& outputRegionForThread)
+{
+  // Iterators on input and output. If the input is an implicit constant, its
+  // buffer is not read and the ray iterator is set on the output which has
+  // the same pixel positions.
+  typename TInputImage::PixelType constant;
+  const bool implicit = this->GetImplicitConstantInput(constant);
+  const TInputImage *input = this->GetInput();
+  if(implicit)
+    input = dynamic_cast<const TInputImage *>(static_cast<const itk::DataObject *>(this->GetOutput()));
   using InputRegionIterator = ProjectionsRegionConstIteratorRayBased<TInputImage>;
   InputRegionIterator *itIn;
-  itIn = InputRegionIterator::New(this->GetInput(),
+  itIn = InputRegionIterator::New(input,
                                   outputRegionForThread,
                                   m_Geometry);
   using OutputRegionIterator = itk::ImageRegionIteratorWithIndex<TOutputImage>;
@@ -67,17 +132,18 @@ RayConvexIntersectionImageFilter<TInputImage,TOutputImage>
   const double r = m_ConvexShape->GetDensity() / m_Attenuation;
   for(unsigned int pix=0; pix<outputRegionForThread.GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
     {
+    const typename TInputImage::PixelType in = (implicit)?constant:itIn->Get();
     // Compute ray intersection length
     ConvexShape::ScalarType nearDist, farDist;
     if( m_ConvexShape->IsIntersectedByRay(itIn->GetSourcePosition(), itIn->GetDirection(), nearDist, farDist) )
       {
       if( m_Attenuation == 0. )
-        itOut.Set( itIn->Get() + m_ConvexShape->GetDensity() * ( farDist - nearDist ) );
+        itOut.Set( in + m_ConvexShape->GetDensity() * ( farDist - nearDist ) );
       else
-        itOut.Set( itIn->Get() + r * ( std::exp( m_Attenuation * farDist ) - std::exp( m_Attenuation * nearDist ) ) );
+        itOut.Set( in + r * ( std::exp( m_Attenuation * farDist ) - std::exp( m_Attenuation * nearDist ) ) );
       }
     else
-      itOut.Set( itIn->Get() );
+      itOut.Set( in );
     }
 
   delete itIn;
@@ -21,6 +21,7 @@
 
 #include <itkMultiplyImageFilter.h>
 #include <itkAddImageFilter.h>
+#include <itkExtractImageFilter.h>
 
 #include "rtkConstantImageSource.h"
 
@@ -58,6 +59,13 @@ namespace rtk
    *
    * This filter takes in input f and outputs R_t D R f + gamma Laplacian f + Tikhonov f
    *
+   * By default, R f is computed for all projections before being weighted and
+   * backprojected, which requires two temporary projection stacks. If
+   * NumberOfProjectionsPerBatch is set, the projections are processed batch
+   * after batch: the forward projections of a batch are weighted and
+   * immediately backprojected in the output volume, so that the temporary
+   * projections are limited to one batch (dashed extract filters below).
+   *
    * \dot
    * digraph ReconstructionConjugateGradientOperator {
    *
@@ -85,15 +93,19 @@ namespace rtk
    * MultiplyTikhonov [ label="itk::MultiplyImageFilter (by Tikhonov parameter)" URL="\ref itk::MultiplyImageFilter"];
    * AddLaplacian [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
    * AddTikhonov [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
+   * ExtractProjections [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter" style=dashed];
+   * ExtractWeights [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter" style=dashed];
    *
    * Input0 -> MultiplyInput;
    * MultiplyInput -> MultiplyTikhonov;
    * Input3 -> MultiplyInput;
    * MultiplyInput -> ForwardProjection;
-   * ConstantProjectionsSource -> ForwardProjection;
+   * ConstantProjectionsSource -> ExtractProjections;
+   * ExtractProjections -> ForwardProjection;
    * ConstantVolumeSource -> BackProjection;
    * ForwardProjection -> Multiply;
-   * Input2 -> Multiply;
+   * Input2 -> ExtractWeights;
+   * ExtractWeights -> Multiply;
    * Multiply -> BackProjection;
    * BackProjection -> AddLaplacian;
    * Input3 -> MultiplyOutput;
@@ -152,6 +164,8 @@ public:
   using ConstantSourceType = rtk::ConstantImageSource<TOutputImage>;
   using MultiplyFilterType = itk::MultiplyImageFilter<TOutputImage, TSingleComponentImage>;
   using AddFilterType = itk::AddImageFilter<TOutputImage>;
+  using ExtractProjectionsFilterType = itk::ExtractImageFilter<TOutputImage, TOutputImage>;
+  using ExtractWeightsFilterType = itk::ExtractImageFilter<TWeightsImage, TWeightsImage>;
 
   // If TOutputImage is an itk::Image of floats or double, so are the weights, and a simple Multiply filter is required
   // If TOutputImage is an itk::Image of itk::Vector<float (or double)>, a BlockDiagonalMatrixVectorMultiply filter
@@ -184,6 +198,11 @@ public:
   itkSetMacro(Tikhonov, float)
   itkGetMacro(Tikhonov, float)
 
+  /** Number of projections forward projected, weighted and backprojected
+  *  together. Default is 0, all projections at once. */
+  itkSetMacro(NumberOfProjectionsPerBatch, unsigned int)
+  itkGetMacro(NumberOfProjectionsPerBatch, unsigned int)
+
 protected:
   ReconstructionConjugateGradientOperator();
   ~ReconstructionConjugateGradientOperator() override = default;
@@ -191,6 +210,9 @@ protected:
   /** Does the real work. */
   void GenerateData() override;
 
+  /** Restricts the extract filters to the projections [first, first+NumberOfProjectionsPerBatch) */
+  void SetProjectionsBatch(itk::IndexValueType first);
+
   template < typename ImageType >
   typename std::enable_if< std::is_same< TSingleComponentImage, ImageType >::value, ImageType >::type::Pointer
   ConnectGradientRegularization();
@@ -213,11 +235,14 @@ protected:
   typename AddFilterType::Pointer                                       m_AddTikhonovFilter;
   typename itk::ImageToImageFilter<TOutputImage, TOutputImage>::Pointer m_LaplacianFilter;
   typename MultiplyWithWeightsFilterType::Pointer                       m_MultiplyWithWeightsFilter;
+  typename ExtractProjectionsFilterType::Pointer                        m_ExtractProjectionsFilter;
+  typename ExtractWeightsFilterType::Pointer                            m_ExtractWeightsFilter;
 
   /** Member attributes */
   rtk::ThreeDCircularProjectionGeometry::ConstPointer    m_Geometry{nullptr};
   float                                                  m_Gamma{0}; //Strength of the laplacian regularization
   float                                                  m_Tikhonov{0}; //Strength of the Tikhonov regularization
+  unsigned int                                           m_NumberOfProjectionsPerBatch{0};
 
   /** Pointers to intermediate images, used to simplify complex branching */
   typename TOutputImage::Pointer m_FloatingInputPointer, m_FloatingOutputPointer;
@@ -49,8 +49,12 @@ ReconstructionConjugateGradientOperator<TOutputImage,
   m_AddTikhonovFilter = AddFilterType::New();
 
   m_MultiplyTikhonovFilter = MultiplyFilterType::New();
+  m_ExtractProjectionsFilter = ExtractProjectionsFilterType::New();
+  m_ExtractWeightsFilter = ExtractWeightsFilterType::New();
 
   // Set permanent parameters
+  m_ExtractProjectionsFilter->SetDirectionCollapseToSubmatrix();
+  m_ExtractWeightsFilter->SetDirectionCollapseToSubmatrix();
   m_ConstantProjectionsSource->SetConstant(itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue());
   m_ConstantVolumeSource->SetConstant(itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue());
 
@@ -249,13 +253,24 @@ ReconstructionConjugateGradientOperator<TOutputImage,
     m_FloatingInputPointer = m_MultiplyInputVolumeFilter->GetOutput();
     }
 
-  // Set the forward projection filter's inputs
-  m_ForwardProjectionFilter->SetInput(0, m_ConstantProjectionsSource->GetOutput());
+  // Set the forward projection filter's inputs and the multiply filter's
+  // inputs for the projection weights (for WLS minimization), restricted to
+  // the first batch of projections if they are processed in batches
   m_ForwardProjectionFilter->SetInput(1, m_FloatingInputPointer);
-
-  // Set the multiply filter's inputs for the projection weights (for WLS minimization)
   m_MultiplyWithWeightsFilter->SetInput1(m_ForwardProjectionFilter->GetOutput());
-  m_MultiplyWithWeightsFilter->SetInput2(this->GetInputWeights());
+  if (m_NumberOfProjectionsPerBatch)
+    {
+    m_ExtractProjectionsFilter->SetInput(m_ConstantProjectionsSource->GetOutput());
+    m_ExtractWeightsFilter->SetInput(this->GetInputWeights());
+    this->SetProjectionsBatch(0);
+    m_ForwardProjectionFilter->SetInput(0, m_ExtractProjectionsFilter->GetOutput());
+    m_MultiplyWithWeightsFilter->SetInput2(m_ExtractWeightsFilter->GetOutput());
+    }
+  else
+    {
+    m_ForwardProjectionFilter->SetInput(0, m_ConstantProjectionsSource->GetOutput());
+    m_MultiplyWithWeightsFilter->SetInput2(this->GetInputWeights());
+    }
 
   // Set the back projection filter's inputs
   m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
@@ -313,11 +328,53 @@ ReconstructionConjugateGradientOperator<TOutputImage,
                                         TWeightsImage>
 ::GenerateData()
 {
+  if (m_NumberOfProjectionsPerBatch)
+    {
+    // Backproject all batches but the last one in the same volume. The
+    // output of the backprojection of a batch is grafted to the volume input
+    // of the next one, which is then backprojected in place.
+    const unsigned int Dimension = TOutputImage::ImageDimension;
+    const itk::IndexValueType nProj =
+      this->GetInputProjectionStack()->GetLargestPossibleRegion().GetSize(Dimension-1);
+    m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
+    itk::IndexValueType first = 0;
+    for (; first + itk::IndexValueType(m_NumberOfProjectionsPerBatch) < nProj; first += m_NumberOfProjectionsPerBatch)
+      {
+      this->SetProjectionsBatch(first);
+      m_BackProjectionFilter->Update();
+
+      typename TOutputImage::Pointer accumulated = TOutputImage::New();
+      accumulated->Graft( m_BackProjectionFilter->GetOutput() );
+      m_BackProjectionFilter->SetInput(0, accumulated);
+      }
+
+    // The last batch is backprojected with the update of the pipeline
+    this->SetProjectionsBatch(first);
+    }
+
   // Execute Pipeline
   m_FloatingOutputPointer->Update();
   this->GraftOutput( m_FloatingOutputPointer );
 }
 
+template< typename TOutputImage,
+          typename TSingleComponentImage,
+          typename TWeightsImage>
+void
+ReconstructionConjugateGradientOperator<TOutputImage,
+                                        TSingleComponentImage,
+                                        TWeightsImage>
+::SetProjectionsBatch(itk::IndexValueType first)
+{
+  const unsigned int Dimension = TOutputImage::ImageDimension;
+  typename TOutputImage::RegionType batchRegion = this->GetInputProjectionStack()->GetLargestPossibleRegion();
+  const itk::IndexValueType nProj = batchRegion.GetSize(Dimension-1);
+  batchRegion.SetIndex(Dimension-1, batchRegion.GetIndex(Dimension-1) + first);
+  batchRegion.SetSize(Dimension-1, std::min(itk::IndexValueType(m_NumberOfProjectionsPerBatch), nProj - first));
+  m_ExtractProjectionsFilter->SetExtractionRegion(batchRegion);
+  m_ExtractWeightsFilter->SetExtractionRegion(batchRegion);
+}
+
 template< typename TOutputImage,
           typename TSingleComponentImage,
           typename TWeightsImage>
@@ -205,6 +205,11 @@ public:
   itkSetMacro(Gamma, float)
   itkGetMacro(Gamma, float)
 
+  /** Number of projections processed together by the conjugate gradient
+   * operator, 0 (default) for all projections at once */
+  itkSetMacro(NumberOfProjectionsPerBatch, unsigned int)
+  itkGetMacro(NumberOfProjectionsPerBatch, unsigned int)
+
   /** Perform CG operations on GPU ? */
   itkSetMacro(CudaConjugateGradient, bool)
   itkGetMacro(CudaConjugateGradient, bool)
@@ -261,6 +266,9 @@ protected:
   unsigned int    m_Order;
   unsigned int    m_NumberOfLevels;
 
+  /** Batches of projections of the conjugate gradient operator */
+  unsigned int    m_NumberOfProjectionsPerBatch;
+
   /** Conjugate gradient parameters */
   bool            m_IterationCosts;
   bool            m_DisableDisplacedDetectorFilter;
@@ -30,6 +30,7 @@ RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>::RegularizedCon
   m_GammaTV = 0.00005;
   m_Gamma = 0; // Laplacian regularization
   m_Tikhonov = 0; // Tikhonov regularization
+  m_NumberOfProjectionsPerBatch = 0;
   m_SoftThresholdWavelets = 0.001;
   m_SoftThresholdOnImage = 0.001;
   m_Preconditioned = false;
@@ -189,6 +190,7 @@ RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>
   m_CGFilter->SetCudaConjugateGradient(this->GetCudaConjugateGradient());
   m_CGFilter->SetGamma(this->m_Gamma);
   m_CGFilter->SetTikhonov(this->m_Tikhonov);
+  m_CGFilter->SetNumberOfProjectionsPerBatch(this->m_NumberOfProjectionsPerBatch);
 //  m_CGFilter->SetIterationCosts(m_IterationCosts);
   m_CGFilter->SetDisableDisplacedDetectorFilter(m_DisableDisplacedDetectorFilter);
 
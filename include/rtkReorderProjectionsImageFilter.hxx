@@ -139,6 +139,7 @@ ReorderProjectionsImageFilter<TInputImage, TOutputImage>
 
     // Copy the geometry
     m_OutputGeometry->SetRadiusCylindricalDetector(m_InputGeometry->GetRadiusCylindricalDetector());
+    m_OutputGeometry->SetDetectorDisplacementField(m_InputGeometry->GetDetectorDisplacementField());
     m_OutputGeometry->AddProjectionInRadians(m_InputGeometry->GetSourceToIsocenterDistances()[permutation[proj]],
                                              m_InputGeometry->GetSourceToDetectorDistances()[permutation[proj]],
                                              m_InputGeometry->GetGantryAngles()[permutation[proj]],
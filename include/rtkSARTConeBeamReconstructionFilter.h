@@ -34,6 +34,7 @@
 #include "rtkConstantImageSource.h"
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkProjectionsCacheImageFilter.h"
 
 namespace rtk
 {
@@ -74,6 +75,7 @@ namespace rtk
  *
  * node [shape=box];
  * ForwardProject [ label="rtk::ForwardProjectionImageFilter" URL="\ref rtk::ForwardProjectionImageFilter"];
+ * ProjectionsCache [ label="rtk::ProjectionsCacheImageFilter" URL="\ref rtk::ProjectionsCacheImageFilter", style=dashed];
  * Extract [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * MultiplyByZero [ label="itk::MultiplyImageFilter (by zero)" URL="\ref itk::MultiplyImageFilter"];
  * AfterExtract [label="", fixedsize="false", width=0, height=0, shape=none];
@@ -104,7 +106,8 @@ namespace rtk
  * AfterExtract -> MultiplyByZero;
  * AfterExtract -> Subtract;
  * MultiplyByZero -> ForwardProject;
- * Input1 -> Extract;
+ * Input1 -> ProjectionsCache;
+ * ProjectionsCache -> Extract;
  * ForwardProject -> Subtract;
  * Subtract -> MultiplyByLambda;
  * MultiplyByLambda -> Divide;
@@ -162,6 +165,7 @@ public:
   using ThresholdFilterType = itk::ThresholdImageFilter<VolumeType>;
   using DisplacedDetectorFilterType = rtk::DisplacedDetectorImageFilter<ProjectionType>;
   using GatingWeightsFilterType = itk::MultiplyImageFilter<ProjectionType,ProjectionType, ProjectionType>;
+  using ProjectionsCacheFilterType = rtk::ProjectionsCacheImageFilter<ProjectionType>;
 
   using ForwardProjectionType = typename Superclass::ForwardProjectionType;
   using BackProjectionType = typename Superclass::BackProjectionType;
@@ -205,6 +209,55 @@ public:
   itkSetMacro(DisableDisplacedDetectorFilter, bool)
   itkGetMacro(DisableDisplacedDetectorFilter, bool)
 
+  /** Process all projections of a subset with a single forward and back
+   * projection instead of one per projection. The projection stack is then
+   * copied in memory in the shuffled order of the projections at the
+   * beginning of GenerateData, which requires the whole stack and a copy of
+   * it in memory. Default is false, it has no effect with one projection per
+   * subset or if the projections cache is used since subsets are then
+   * always batched. */
+  itkSetMacro(BatchSubsets, bool);
+  itkGetMacro(BatchSubsets, bool);
+  itkBooleanMacro(BatchSubsets);
+
+  /** Set / Get the number of projections used in the first iteration for a
+   * fast preview with dense angular samplings. If it is not 0, the
+   * projections are processed in the order given by
+   * ThreeDCircularProjectionGeometry::GetProgressiveProjectionOrder instead
+   * of a random order and iteration i only uses the first
+   * InitialNumberOfProjections*2^i projections of this order, i.e., evenly
+   * spread projections are added at each iteration. The last iteration
+   * always uses all projections. Default is 0, all iterations use all
+   * projections. */
+  itkSetMacro(InitialNumberOfProjections, unsigned int);
+  itkGetMacro(InitialNumberOfProjections, unsigned int);
+
+  /** Update the backprojection of the projections and the backprojection
+   * used for the normalization concurrently with rtk::UpdateConcurrently
+   * instead of one after the other. Default is false. */
+  itkSetMacro(ConcurrentBranches, bool);
+  itkGetMacro(ConcurrentBranches, bool);
+  itkBooleanMacro(ConcurrentBranches);
+
+  /** Set / Get the memory budget in bytes of a cache of the input projections.
+   * If it is not 0, the projections are read from the input on demand, one
+   * subset at a time in the shuffled order with the next subset read in
+   * advance, and the least recently used ones are dropped from the cache
+   * when the budget is exceeded. The subsets are then batched without copying
+   * the projection stack. Default is 0, the projection stack is read at once. */
+  itkSetMacro(ProjectionsCacheMemoryBudget, itk::SizeValueType);
+  itkGetMacro(ProjectionsCacheMemoryBudget, itk::SizeValueType);
+
+  /** Set / Get the name of a file where the projections are stored on disk
+   * to reconstruct stacks which do not fit in memory. The input projections
+   * are then read once and written in this file, and each subset is read from
+   * it while the previous one is processed. The memory budget bounds the
+   * projections kept in memory, only the current and the next subsets are
+   * kept if it is 0. The file must not exist, it is created and deleted by
+   * the filter. Default is empty, no store is used. */
+  itkSetStringMacro(ProjectionsStoreFileName);
+  itkGetStringMacro(ProjectionsStoreFileName);
+
 protected:
   SARTConeBeamReconstructionFilter();
   ~SARTConeBeamReconstructionFilter() override = default;
@@ -239,9 +292,11 @@ protected:
   typename ConstantProjectionSourceType::Pointer m_ConstantProjectionStackSource;
   typename ConstantProjectionSourceType::Pointer m_OneConstantProjectionStackSource;
   typename ConstantVolumeSourceType::Pointer     m_ConstantVolumeSource;
+  typename ConstantVolumeSourceType::Pointer     m_NormalizationConstantVolumeSource;
   typename ThresholdFilterType::Pointer          m_ThresholdFilter;
   typename DisplacedDetectorFilterType::Pointer  m_DisplacedDetectorFilter;
   typename GatingWeightsFilterType::Pointer      m_GatingWeightsFilter;
+  typename ProjectionsCacheFilterType::Pointer   m_ProjectionsCacheFilter;
 
   bool m_EnforcePositivity;
   bool m_DisableDisplacedDetectorFilter;
@@ -251,6 +306,21 @@ private:
    * several for OS-SART, all for SIRT) */
   unsigned int m_NumberOfProjectionsPerSubset;
 
+  /** Process each subset with a single forward and back projection */
+  bool m_BatchSubsets;
+
+  /** Update the two backprojections concurrently */
+  bool m_ConcurrentBranches;
+
+  /** Number of projections of the first iteration, 0 if all are used */
+  unsigned int m_InitialNumberOfProjections;
+
+  /** Memory budget of m_ProjectionsCacheFilter, 0 if it is not used */
+  itk::SizeValueType m_ProjectionsCacheMemoryBudget;
+
+  /** File storing the projections on disk, empty if it is not used */
+  std::string m_ProjectionsStoreFileName;
+
   /** Geometry object */
   ThreeDCircularProjectionGeometry::Pointer m_Geometry;
 
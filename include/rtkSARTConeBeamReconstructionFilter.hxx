@@ -20,8 +20,10 @@
 #define rtkSARTConeBeamReconstructionFilter_hxx
 
 #include "rtkSARTConeBeamReconstructionFilter.h"
+#include "rtkConcurrentUpdate.h"
 
 #include <algorithm>
+#include <cmath>
 
 namespace rtk
 {
@@ -45,7 +47,9 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   m_DisplacedDetectorFilter = DisplacedDetectorFilterType::New();
   m_MultiplyFilter = MultiplyFilterType::New();
   m_GatingWeightsFilter = GatingWeightsFilterType::New();
+  m_ProjectionsCacheFilter = ProjectionsCacheFilterType::New();
   m_ConstantVolumeSource = ConstantVolumeSourceType::New();
+  m_NormalizationConstantVolumeSource = ConstantVolumeSourceType::New();
 
   // Create the filters required for correct weighting of the difference
   // projection
@@ -86,6 +90,10 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   m_NumberOfProjectionsPerSubset = 1; //Default is the SART behavior
   m_DisplacedDetectorFilter->SetPadOnTruncatedSide(false);
   m_DisableDisplacedDetectorFilter = false;
+  m_BatchSubsets = false;
+  m_ConcurrentBranches = false;
+  m_ProjectionsCacheMemoryBudget = 0;
+  m_InitialNumberOfProjections = 0;
 }
 
 template<class TVolumeImage, class TProjectionImage>
@@ -143,6 +151,16 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
     m_BackProjectionFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
     m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
     }
+
+  // The projections are read on demand by m_ProjectionsCacheFilter, only
+  // the first one is requested
+  if(m_ProjectionsCacheMemoryBudget || !m_ProjectionsStoreFileName.empty())
+    {
+    auto *inputPtr1 = const_cast< TProjectionImage * >( this->GetInput(1) );
+    typename TProjectionImage::RegionType reqRegion = inputPtr1->GetLargestPossibleRegion();
+    reqRegion.SetSize(TProjectionImage::ImageDimension-1, 1);
+    inputPtr1->SetRequestedRegion(reqRegion);
+    }
 }
 
 template<class TVolumeImage, class TProjectionImage>
@@ -165,6 +183,9 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   m_ConstantVolumeSource->SetInformationFromImage(const_cast<TVolumeImage *>(this->GetInput(0)));
   m_ConstantVolumeSource->SetConstant(0);
   m_ConstantVolumeSource->UpdateOutputInformation();
+  m_NormalizationConstantVolumeSource->SetInformationFromImage(const_cast<TVolumeImage *>(this->GetInput(0)));
+  m_NormalizationConstantVolumeSource->SetConstant(0);
+  m_NormalizationConstantVolumeSource->UpdateOutputInformation();
 
   m_OneConstantProjectionStackSource->SetInformationFromImage(const_cast<TProjectionImage *>(m_ExtractFilter->GetOutput()));
   m_OneConstantProjectionStackSource->SetConstant(1);
@@ -173,7 +194,7 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   m_BackProjectionFilter->SetInput(1, m_DisplacedDetectorFilter->GetOutput() );
   m_BackProjectionFilter->SetTranspose(false);
 
-  m_BackProjectionNormalizationFilter->SetInput ( 0, m_ConstantVolumeSource->GetOutput() );
+  m_BackProjectionNormalizationFilter->SetInput ( 0, m_NormalizationConstantVolumeSource->GetOutput() );
   m_BackProjectionNormalizationFilter->SetInput(1, m_OneConstantProjectionStackSource->GetOutput() );
   m_BackProjectionNormalizationFilter->SetTranspose(false);
 
@@ -185,7 +206,16 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
 
   m_ForwardProjectionFilter->SetInput( 0, m_ZeroMultiplyFilter->GetOutput() );
   m_ForwardProjectionFilter->SetInput( 1, this->GetInput(0) );
-  m_ExtractFilter->SetInput( this->GetInput(1) );
+  if(m_ProjectionsCacheMemoryBudget || !m_ProjectionsStoreFileName.empty())
+    {
+    m_ProjectionsCacheFilter->SetInput( this->GetROIProjections(this->GetInput(1), this->GetInput(0), m_Geometry) );
+    m_ProjectionsCacheFilter->SetMemoryBudget(m_ProjectionsCacheMemoryBudget);
+    m_ProjectionsCacheFilter->SetStoreFileName(m_ProjectionsStoreFileName);
+    m_ProjectionsCacheFilter->SetProjectionOrder( typename ProjectionsCacheFilterType::ProjectionOrderType() );
+    m_ExtractFilter->SetInput( m_ProjectionsCacheFilter->GetOutput() );
+    }
+  else
+    m_ExtractFilter->SetInput( this->GetROIProjections(this->GetInput(1), this->GetInput(0), m_Geometry) );
   m_SubtractFilter->SetInput(1, m_ForwardProjectionFilter->GetOutput() );
 
   // For the same reason, set geometry now
@@ -267,18 +297,57 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   unsigned int nProj = subsetRegion.GetSize(Dimension-1);
   subsetRegion.SetSize(Dimension-1, 1);
 
-  // Fill and shuffle randomly the projection order.
-  // Should be tunable with other solutions.
+  // Fill and shuffle randomly the projection order or, if the first
+  // iterations use fewer projections, order them so that the projections of
+  // each iteration are evenly spread.
   std::vector< unsigned int > projOrder(nProj);
+  if(m_InitialNumberOfProjections)
+    projOrder = m_Geometry->GetProgressiveProjectionOrder( m_Geometry->GetGantryAngles() );
+  else
+    {
+    for(unsigned int i = 0; i < nProj; i++)
+      projOrder[i] = i;
+    std::shuffle( projOrder.begin(), projOrder.end(), Superclass::m_DefaultRandomEngine );
+    }
 
-  for(unsigned int i = 0; i < nProj; i++)
-    projOrder[i] = i;
-  std::shuffle( projOrder.begin(), projOrder.end(), Superclass::m_DefaultRandomEngine );
+  // Process each subset in one pass with contiguous projections if possible.
+  // Gating weights are per projection and prevent it.
+  unsigned int nProjPerPass = 1;
+  typename TProjectionImage::Pointer reorderedProjections;
+  const bool cache = (m_ProjectionsCacheMemoryBudget || !m_ProjectionsStoreFileName.empty()) && !m_IsGated;
+  if(cache || (m_BatchSubsets && m_NumberOfProjectionsPerSubset>1 && !m_IsGated))
+    {
+    if(cache)
+      {
+      // The cache reorders the projections on demand and reads the next
+      // subset in advance
+      m_ProjectionsCacheFilter->SetProjectionOrder(projOrder);
+      m_ProjectionsCacheFilter->SetPrefetchSize(m_NumberOfProjectionsPerSubset);
+      }
+    else
+      {
+      auto *projections = const_cast<TProjectionImage *>(m_ExtractFilter->GetInput());
+      projections->SetRequestedRegionToLargestPossibleRegion();
+      projections->Update();
+      reorderedProjections = this->GetReorderedProjections(projections, projOrder);
+      m_ExtractFilter->SetInput(reorderedProjections);
+      }
+    ThreeDCircularProjectionGeometry::Pointer reorderedGeometry = this->GetReorderedGeometry(m_Geometry, projOrder);
+    m_ForwardProjectionFilter->SetGeometry(reorderedGeometry);
+    m_BackProjectionFilter->SetGeometry(reorderedGeometry);
+    m_BackProjectionNormalizationFilter->SetGeometry(reorderedGeometry);
+    m_DisplacedDetectorFilter->SetGeometry(reorderedGeometry);
+    m_RayBoxFilter->SetGeometry(reorderedGeometry);
+    for(unsigned int i = 0; i < nProj; i++)
+      projOrder[i] = i;
+    if(m_BatchSubsets)
+      nProjPerPass = m_NumberOfProjectionsPerSubset;
+    }
 
   m_MultiplyFilter->SetInput1( (const float) m_Lambda );
 
-  // Create the zero projection stack used as input by RayBoxIntersectionFilter
-  m_ConstantProjectionStackSource->Update();
+  // The zero projection stack used as input by RayBoxIntersectionFilter is
+  // not computed, RayBoxIntersectionFilter only requests one of its pixels.
 
   // Declare the image used in the main loop
   typename TVolumeImage::Pointer pimg;
@@ -287,11 +356,17 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
   // For each iteration, go over each projection
   for(unsigned int iter = 0; iter < m_NumberOfIterations; iter++)
     {
+    // Number of projections used in this iteration, the first ones of projOrder
+    unsigned int nIterProj = nProj;
+    if(m_InitialNumberOfProjections && iter+1 < m_NumberOfIterations)
+      nIterProj = std::min<double>(nProj, m_InitialNumberOfProjections * std::pow(2., double(iter)));
+
     unsigned int projectionsProcessedInSubset = 0;
-    for(unsigned int i = 0; i < nProj; i++)
+    for(unsigned int i = 0; i < nIterProj; i += nProjPerPass)
       {
       // Change projection subset
       subsetRegion.SetIndex( Dimension-1, projOrder[i] );
+      subsetRegion.SetSize( Dimension-1, std::min(nProjPerPass, nIterProj-i) );
       m_ExtractFilter->SetExtractionRegion(subsetRegion);
       m_ExtractFilterRayBox->SetExtractionRegion(subsetRegion);
       m_ExtractFilter->UpdateOutputInformation();
@@ -310,12 +385,19 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
       m_BackProjectionNormalizationFilter->GetOutput()->UpdateOutputInformation();
       m_BackProjectionNormalizationFilter->GetOutput()->PropagateRequestedRegion();
 
-      projectionsProcessedInSubset++;
-      if ((projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset) || (i == nProj - 1))
+      projectionsProcessedInSubset += subsetRegion.GetSize(Dimension-1);
+      if ((projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset) || (i + nProjPerPass >= nIterProj))
         {
         m_DivideVolumeFilter->SetInput2(m_BackProjectionNormalizationFilter->GetOutput());
         m_DivideVolumeFilter->SetInput1(m_BackProjectionFilter->GetOutput());
         m_AddFilter->SetInput1(m_DivideVolumeFilter->GetOutput());
+        if(m_ConcurrentBranches)
+          UpdateConcurrently({m_BackProjectionFilter->GetOutput(), m_BackProjectionNormalizationFilter->GetOutput()});
+        else
+          {
+          m_BackProjectionFilter->Update();
+          m_BackProjectionNormalizationFilter->Update();
+          }
         m_DivideVolumeFilter->Update();
 
         // To start a new subset:
@@ -331,15 +413,20 @@ SARTConeBeamReconstructionFilter<TVolumeImage, TProjectionImage>
         m_ForwardProjectionFilter->SetInput(1, pimg );
         m_AddFilter->SetInput2(pimg);
         m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
-        m_BackProjectionNormalizationFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
+        m_BackProjectionNormalizationFilter->SetInput(0, m_NormalizationConstantVolumeSource->GetOutput());
 
         projectionsProcessedInSubset = 0;
         }
       // Backproject in the same image otherwise.
       else
         {
-        m_BackProjectionFilter->Update();
-        m_BackProjectionNormalizationFilter->Update();
+        if(m_ConcurrentBranches)
+          UpdateConcurrently({m_BackProjectionFilter->GetOutput(), m_BackProjectionNormalizationFilter->GetOutput()});
+        else
+          {
+          m_BackProjectionFilter->Update();
+          m_BackProjectionNormalizationFilter->Update();
+          }
         pimg = m_BackProjectionFilter->GetOutput();
         pimg->DisconnectPipeline();
         m_BackProjectionFilter->SetInput(0, pimg);
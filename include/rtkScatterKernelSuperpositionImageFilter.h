@@ -0,0 +1,190 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkScatterKernelSuperpositionImageFilter_h
+#define rtkScatterKernelSuperpositionImageFilter_h
+
+#include "rtkBoellaardScatterCorrectionImageFilter.h"
+#include "rtkConfiguration.h"
+
+#include <complex>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class ScatterKernelSuperpositionImageFilter
+ * \brief Scatter correction by kernel superposition at reduced resolution.
+ *
+ * The scatter is estimated with the scatter kernel superposition method
+ * [Sun and Star-Lack, PMB, 2010]: the primary signal P is split in groups of
+ * water-equivalent thicknesses tau = ln(I0/P)/mu, each group is weighted by
+ * its scatter-to-primary amplitude and convolved with a normalized Gaussian
+ * kernel whose width depends on the thickness, and the contributions are
+ * summed. The thickness weights interpolate linearly between the
+ * thicknesses of the kernels, below the first one the weight decreases
+ * linearly to 0 in air. The primary signal is estimated by a few fixed-point
+ * iterations, P = I - S(P).
+ *
+ * Scatter is smooth so all the estimation is done on projections
+ * downsampled by block averaging with DownsamplingFactor. The convolutions
+ * use one forward FFT per kernel and a single inverse FFT on zero-padded
+ * images. The scatter estimate is then bilinearly upsampled and subtracted
+ * from the input. The splitting of the requested region in whole
+ * projections and the non-negativity constraint are inherited from
+ * rtk::BoellaardScatterCorrectionImageFilter, AirThreshold and
+ * ScatterToPrimaryRatio are not used.
+ *
+ * The input is expected to be intensities, raw or normalized, before
+ * conversion to line integrals. With normalized intensities,
+ * NonNegativityConstraintThreshold must be lowered accordingly. Kernel widths
+ * are in the units of the projection spacing.
+ *
+ * \test rtkscatterkernelsuperpositiontest.cxx
+ *
+ * \ingroup RTK InPlaceImageFilter
+ */
+template<class TInputImage, class TOutputImage=TInputImage, class TFFTPrecision=float>
+class ITK_EXPORT ScatterKernelSuperpositionImageFilter :
+  public BoellaardScatterCorrectionImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ScatterKernelSuperpositionImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ScatterKernelSuperpositionImageFilter;
+  using Superclass = BoellaardScatterCorrectionImageFilter<TInputImage, TOutputImage>;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+
+  /** Some convenient type alias. */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+  using VectorType = std::vector<double>;
+
+  using FFTInputImageType = itk::Image<TFFTPrecision, 2>;
+  using FFTInputImagePointer = typename FFTInputImageType::Pointer;
+  using FFTOutputImageType = itk::Image<std::complex<TFFTPrecision>, 2>;
+  using FFTOutputImagePointer = typename FFTOutputImageType::Pointer;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ScatterKernelSuperpositionImageFilter, BoellaardScatterCorrectionImageFilter);
+
+  /** Get / Set the water-equivalent thickness for which each kernel has
+   ** been computed, in strictly increasing order. */
+  itkGetConstReferenceMacro(KernelThicknesses, VectorType);
+  virtual void SetKernelThicknesses(const VectorType &_arg)
+    {
+    if (this->m_KernelThicknesses != _arg)
+      {
+      this->m_KernelThicknesses = _arg;
+      this->Modified();
+      }
+    }
+
+  /** Get / Set the standard deviation of the Gaussian kernel of each
+   ** thickness. */
+  itkGetConstReferenceMacro(KernelWidths, VectorType);
+  virtual void SetKernelWidths(const VectorType &_arg)
+    {
+    if (this->m_KernelWidths != _arg)
+      {
+      this->m_KernelWidths = _arg;
+      this->Modified();
+      }
+    }
+
+  /** Get / Set the scatter-to-primary ratio of each thickness, i.e., the
+   ** amplitude of its normalized kernel. */
+  itkGetConstReferenceMacro(KernelAmplitudes, VectorType);
+  virtual void SetKernelAmplitudes(const VectorType &_arg)
+    {
+    if (this->m_KernelAmplitudes != _arg)
+      {
+      this->m_KernelAmplitudes = _arg;
+      this->Modified();
+      }
+    }
+
+  /** Get / Set the factor used to downsample the projections in each
+   ** direction before the estimation of scatter. Default is 8. */
+  itkGetMacro(DownsamplingFactor, unsigned int);
+  itkSetMacro(DownsamplingFactor, unsigned int);
+
+  /** Get / Set the number of fixed-point iterations for the estimation of
+   ** the primary. Default is 3. */
+  itkGetMacro(NumberOfIterations, unsigned int);
+  itkSetMacro(NumberOfIterations, unsigned int);
+
+  /** Get / Set the intensity without object. If 0 (default), the maximum of
+   ** each downsampled projection is used. */
+  itkGetMacro(I0, double);
+  itkSetMacro(I0, double);
+
+  /** Get / Set the linear attenuation coefficient of water used to convert
+   ** the primary to water-equivalent thicknesses. Default is 0.02, in inverse
+   ** units of the thicknesses. */
+  itkGetMacro(WaterAttenuation, double);
+  itkSetMacro(WaterAttenuation, double);
+
+  /** Set/Get the greatest prime factor allowed in the size of the FFTs. With
+   * FFTW, the default is 13, otherwise it is 2. */
+  itkGetConstMacro(GreatestPrimeFactor, int);
+  itkSetMacro(GreatestPrimeFactor, int);
+
+protected:
+  ScatterKernelSuperpositionImageFilter();
+  ~ScatterKernelSuperpositionImageFilter() override = default;
+
+  /** Checks the parameters and computes the FFT of the kernels */
+  void BeforeThreadedGenerateData() override;
+
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) override;
+
+  /** Estimates the scatter of the downsampled primary image. */
+  void EstimateScatter(const std::vector<double> &primary, const double i0, std::vector<double> &scatter) const;
+
+private:
+  VectorType   m_KernelThicknesses;
+  VectorType   m_KernelWidths;
+  VectorType   m_KernelAmplitudes;
+  unsigned int m_DownsamplingFactor{8};
+  unsigned int m_NumberOfIterations{3};
+  double       m_I0{0.};
+  double       m_WaterAttenuation{0.02};
+  int          m_GreatestPrimeFactor{2};
+
+  /** Size of the downsampled and of the zero-padded projections. */
+  typename FFTInputImageType::SizeType m_LowResolutionSize;
+  typename FFTInputImageType::SizeType m_PaddedSize;
+
+  /** FFT of the kernels, computed in BeforeThreadedGenerateData. */
+  std::vector<FFTOutputImagePointer> m_KernelFFTs;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkScatterKernelSuperpositionImageFilter.hxx"
+#endif
+
+#endif
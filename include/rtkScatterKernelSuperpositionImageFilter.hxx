@@ -0,0 +1,305 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkScatterKernelSuperpositionImageFilter_hxx
+#define rtkScatterKernelSuperpositionImageFilter_hxx
+
+#include "rtkScatterKernelSuperpositionImageFilter.h"
+
+#include <itkRealToHalfHermitianForwardFFTImageFilter.h>
+#include <itkHalfHermitianToRealInverseFFTImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+ScatterKernelSuperpositionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::ScatterKernelSuperpositionImageFilter()
+{
+#if defined(USE_FFTWD)
+  if(typeid(TFFTPrecision).name() == typeid(double).name() )
+    m_GreatestPrimeFactor = 13;
+#endif
+#if defined(USE_FFTWF)
+  if(typeid(TFFTPrecision).name() == typeid(float).name() )
+    m_GreatestPrimeFactor = 13;
+#endif
+  m_LowResolutionSize.Fill(0);
+  m_PaddedSize.Fill(0);
+}
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+ScatterKernelSuperpositionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::BeforeThreadedGenerateData()
+{
+  const unsigned int nKernels = m_KernelThicknesses.size();
+  if(nKernels == 0 ||
+     m_KernelWidths.size() != nKernels ||
+     m_KernelAmplitudes.size() != nKernels)
+    {
+    itkExceptionMacro(<< "Expecting the same non-zero number of kernel thicknesses, widths and amplitudes");
+    }
+  for(unsigned int k=0; k<nKernels; k++)
+    {
+    if(m_KernelThicknesses[k] <= 0. || (k>0 && m_KernelThicknesses[k] <= m_KernelThicknesses[k-1]))
+      itkExceptionMacro(<< "Kernel thicknesses must be positive and strictly increasing");
+    if(m_KernelWidths[k] <= 0.)
+      itkExceptionMacro(<< "Kernel widths must be positive");
+    }
+  if(m_DownsamplingFactor < 1)
+    itkExceptionMacro(<< "Downsampling factor must be at least 1");
+  if(m_WaterAttenuation <= 0.)
+    itkExceptionMacro(<< "Water attenuation must be positive");
+
+  // Downsampled projection size, the FFTs are zero-padded to avoid aliasing
+  // of the convolution
+  const OutputImageRegionType &region = this->GetOutput()->GetRequestedRegion();
+  double lowResolutionSpacing[2];
+  for(unsigned int i=0; i<2; i++)
+    {
+    m_LowResolutionSize[i] = (region.GetSize(i) + m_DownsamplingFactor - 1) / m_DownsamplingFactor;
+    // Smallest size whose prime factors are all lower than or equal to
+    // m_GreatestPrimeFactor
+    for(m_PaddedSize[i] = 2 * m_LowResolutionSize[i];; m_PaddedSize[i]++)
+      {
+      itk::SizeValueType m = m_PaddedSize[i];
+      for(int p=2; p<=m_GreatestPrimeFactor && m>1; p++)
+        while(m%p == 0)
+          m /= p;
+      if(m == 1)
+        break;
+      }
+    lowResolutionSpacing[i] = this->GetInput()->GetSpacing()[i] * m_DownsamplingFactor;
+    }
+
+  // Normalized kernels, centered on the first pixel with periodic boundaries
+  m_KernelFFTs.clear();
+  for(unsigned int k=0; k<nKernels; k++)
+    {
+    FFTInputImagePointer kernel = FFTInputImageType::New();
+    kernel->SetRegions(m_PaddedSize);
+    kernel->Allocate();
+
+    const double invTwoSigmaSq = 0.5 / (m_KernelWidths[k] * m_KernelWidths[k]);
+    double sum = 0.;
+    itk::ImageRegionIteratorWithIndex<FFTInputImageType> itK(kernel, kernel->GetLargestPossibleRegion());
+    for(; !itK.IsAtEnd(); ++itK)
+      {
+      const typename FFTInputImageType::IndexType idx = itK.GetIndex();
+      double rr2 = 0.;
+      for(unsigned int i=0; i<2; i++)
+        {
+        const double d = std::min<double>(idx[i], m_PaddedSize[i] - idx[i]) * lowResolutionSpacing[i];
+        rr2 += d * d;
+        }
+      const double g = std::exp(-rr2 * invTwoSigmaSq);
+      itK.Set(g);
+      sum += g;
+      }
+    for(itK.GoToBegin(); !itK.IsAtEnd(); ++itK)
+      itK.Set(itK.Get() / sum);
+
+    using ForwardFFTType = itk::RealToHalfHermitianForwardFFTImageFilter< FFTInputImageType, FFTOutputImageType >;
+    typename ForwardFFTType::Pointer fftK = ForwardFFTType::New();
+    fftK->SetInput(kernel);
+#if ITK_VERSION_MAJOR<5
+    fftK->SetNumberOfThreads( this->GetNumberOfThreads() );
+#else
+    fftK->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+#endif
+    fftK->Update();
+    m_KernelFFTs.push_back( fftK->GetOutput() );
+    m_KernelFFTs.back()->DisconnectPipeline();
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+ScatterKernelSuperpositionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType itkNotUsed(threadId) )
+{
+  const double threshold = this->GetNonNegativityConstraintThreshold();
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const unsigned int f = m_DownsamplingFactor;
+  const unsigned int nx = outputRegionForThread.GetSize(0);
+  const unsigned int ny = outputRegionForThread.GetSize(1);
+  const unsigned int lx = m_LowResolutionSize[0];
+  const unsigned int ly = m_LowResolutionSize[1];
+
+  // Number of pixels averaged in each downsampled pixel
+  std::vector<double> counts(lx*ly);
+  for(unsigned int b=0; b<ly; b++)
+    for(unsigned int a=0; a<lx; a++)
+      counts[a+b*lx] = std::min(f, nx-a*f) * std::min(f, ny-b*f);
+
+  std::vector<double> measured(lx*ly), primary(lx*ly), scatter(lx*ly);
+  itk::ImageRegionConstIterator<InputImageType> itIn(this->GetInput(), outputRegionForThread);
+  itk::ImageRegionIterator<OutputImageType>     itOut(this->GetOutput(), outputRegionForThread);
+  unsigned int start = outputRegionForThread.GetIndex(Dimension - 1);
+  unsigned int stop = start + outputRegionForThread.GetSize(Dimension - 1);
+  for (unsigned int slice = start; slice<stop; slice++)
+    {
+    // Downsampling by block averaging
+    std::fill(measured.begin(), measured.end(), 0.);
+    itk::ImageRegionConstIterator<InputImageType> itInSlice = itIn;
+    for(unsigned int j=0; j<ny; j++)
+      for(unsigned int i=0; i<nx; i++, ++itInSlice)
+        measured[i/f + (j/f)*lx] += itInSlice.Get();
+    double i0 = m_I0;
+    for(unsigned int p=0; p<lx*ly; p++)
+      {
+      measured[p] /= counts[p];
+      if(m_I0 <= 0.)
+        i0 = std::max(i0, measured[p]);
+      }
+
+    // Fixed-point estimation of the primary and of its scatter
+    primary = measured;
+    for(unsigned int n=0; n<m_NumberOfIterations; n++)
+      {
+      EstimateScatter(primary, i0, scatter);
+      for(unsigned int p=0; p<lx*ly; p++)
+        primary[p] = std::max(measured[p] - scatter[p], threshold);
+      }
+
+    // Bilinear upsampling of the scatter and subtraction
+    for(unsigned int j=0; j<ny; j++)
+      {
+      const double y = std::max(0., std::min(double(ly-1), (j+0.5)/f - 0.5));
+      const unsigned int b0 = std::min((unsigned int)y, ly-1);
+      const unsigned int b1 = std::min(b0+1, ly-1);
+      const double wy = y - b0;
+      for(unsigned int i=0; i<nx; i++, ++itIn, ++itOut)
+        {
+        const double x = std::max(0., std::min(double(lx-1), (i+0.5)/f - 0.5));
+        const unsigned int a0 = std::min((unsigned int)x, lx-1);
+        const unsigned int a1 = std::min(a0+1, lx-1);
+        const double wx = x - a0;
+        const double s = (1.-wy) * ((1.-wx) * scatter[a0+b0*lx] + wx * scatter[a1+b0*lx]) +
+                              wy * ((1.-wx) * scatter[a0+b1*lx] + wx * scatter[a1+b1*lx]);
+        const double in = itIn.Get();
+        double corrected = in - s;
+
+        // Apply non-negativity constraint
+        if(corrected < threshold)
+          corrected = std::min(in, threshold);
+        itOut.Set( static_cast<typename OutputImageType::PixelType>(corrected) );
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+ScatterKernelSuperpositionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
+::EstimateScatter(const std::vector<double> &primary, const double i0, std::vector<double> &scatter) const
+{
+  const unsigned int nKernels = m_KernelThicknesses.size();
+  const unsigned int lx = m_LowResolutionSize[0];
+  const unsigned int ly = m_LowResolutionSize[1];
+  const unsigned int px = m_PaddedSize[0];
+
+  // Weight of each kernel in each pixel from the water-equivalent thickness
+  std::vector<double> weights(nKernels*lx*ly, 0.);
+  for(unsigned int p=0; p<lx*ly; p++)
+    {
+    // The primary is floored relatively to i0 so that normalized intensities
+    // are handled as raw ones
+    double tau = 0.;
+    if(i0 > 0.)
+      tau = std::max(0., std::log(i0 / std::max(primary[p], 1e-6*i0)) / m_WaterAttenuation);
+    if(tau < m_KernelThicknesses[0])
+      weights[p] = tau / m_KernelThicknesses[0];
+    else if(tau >= m_KernelThicknesses[nKernels-1])
+      weights[(nKernels-1)*lx*ly + p] = 1.;
+    else
+      {
+      unsigned int k = 0;
+      while(tau >= m_KernelThicknesses[k+1])
+        k++;
+      const double w = (tau - m_KernelThicknesses[k]) / (m_KernelThicknesses[k+1] - m_KernelThicknesses[k]);
+      weights[k*lx*ly + p] = 1. - w;
+      weights[(k+1)*lx*ly + p] = w;
+      }
+    }
+
+  // Sum of the convolutions in the Fourier domain
+  using ForwardFFTType = itk::RealToHalfHermitianForwardFFTImageFilter< FFTInputImageType, FFTOutputImageType >;
+  FFTOutputImagePointer spectrum;
+  for(unsigned int k=0; k<nKernels; k++)
+    {
+    FFTInputImagePointer padded = FFTInputImageType::New();
+    padded->SetRegions(m_PaddedSize);
+    padded->Allocate();
+    padded->FillBuffer(0.);
+    TFFTPrecision *buffer = padded->GetBufferPointer();
+    for(unsigned int b=0; b<ly; b++)
+      for(unsigned int a=0; a<lx; a++)
+        buffer[a+b*px] = m_KernelAmplitudes[k] * weights[k*lx*ly + a+b*lx] * primary[a+b*lx];
+
+    typename ForwardFFTType::Pointer fft = ForwardFFTType::New();
+    fft->SetInput( padded );
+#if ITK_VERSION_MAJOR<5
+    fft->SetNumberOfThreads( 1 );
+#else
+    fft->SetNumberOfWorkUnits( 1 );
+#endif
+    fft->Update();
+
+    itk::ImageRegionIterator<FFTOutputImageType> itF(fft->GetOutput(), fft->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<FFTOutputImageType> itK(m_KernelFFTs[k], m_KernelFFTs[k]->GetLargestPossibleRegion());
+    if(k==0)
+      {
+      for(; !itF.IsAtEnd(); ++itF, ++itK)
+        itF.Set(itF.Get() * itK.Get());
+      spectrum = fft->GetOutput();
+      spectrum->DisconnectPipeline();
+      }
+    else
+      {
+      itk::ImageRegionIterator<FFTOutputImageType> itS(spectrum, spectrum->GetLargestPossibleRegion());
+      for(; !itF.IsAtEnd(); ++itF, ++itK, ++itS)
+        itS.Set(itS.Get() + itF.Get() * itK.Get());
+      }
+    }
+
+  using IFFTType = itk::HalfHermitianToRealInverseFFTImageFilter< FFTOutputImageType, FFTInputImageType >;
+  typename IFFTType::Pointer ifft = IFFTType::New();
+  ifft->SetInput( spectrum );
+#if ITK_VERSION_MAJOR<5
+  ifft->SetNumberOfThreads( 1 );
+#else
+  ifft->SetNumberOfWorkUnits( 1 );
+#endif
+  ifft->SetActualXDimensionIsOdd( px % 2 );
+  ifft->Update();
+
+  const TFFTPrecision *result = ifft->GetOutput()->GetBufferPointer();
+  for(unsigned int b=0; b<ly; b++)
+    for(unsigned int a=0; a<lx; a++)
+      scatter[a+b*lx] = std::max(0., double(result[a+b*px]));
+}
+
+} // end namespace rtk
+#endif
@@ -102,6 +102,7 @@ void SubSelectImageFilter<ProjectionStackType>
   // to compute their output information and input requested region
   m_OutputGeometry->Clear();
   m_OutputGeometry->SetRadiusCylindricalDetector(m_InputGeometry->GetRadiusCylindricalDetector());
+  m_OutputGeometry->SetDetectorDisplacementField(m_InputGeometry->GetDetectorDisplacementField());
 
   for(unsigned long i=0; i < m_SelectedProjections.size(); i++)
     {
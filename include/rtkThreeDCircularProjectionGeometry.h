@@ -22,6 +22,9 @@
 #include "RTKExport.h"
 #include "rtkProjectionGeometry.h"
 
+#include <itkImage.h>
+#include <itkVector.h>
+
 namespace rtk
 {
 /** \class ThreeDCircularProjectionGeometry
@@ -40,6 +43,9 @@ namespace rtk
  *
  * If SDD equals 0., then one is dealing with a parallel geometry.
  *
+ * The distortion of the detector, e.g., of the image intensifier of a C-arm,
+ * can be described by a DetectorDisplacementField common to all projections.
+ *
  * More information is provided in \ref DocGeo3D.
  *
  * \author Simon Rit
@@ -64,6 +70,7 @@ public:
   using PointType = itk::Point<double, 3>;
   using Matrix3x3Type = itk::Matrix<double, 3, 3>;
   using HomogeneousProjectionMatrixType = Superclass::MatrixType;
+  using DetectorDisplacementFieldType = itk::Image<itk::Vector<float, 2>, 2>;
 
   /** Method for creation through the object factory. */
   itkNewMacro( Self );
@@ -164,6 +171,11 @@ public:
    *  and the next projection in radians. */
   const std::vector<double> GetAngularGaps(const std::vector<double> &angles);
 
+  /** Get the projection indices in an order such that the first projections
+   * of the order, whatever their number, are evenly spread in angle. Each
+   * projection splits the largest angular gap left by the previous ones. */
+  const std::vector<unsigned int> GetProgressiveProjectionOrder(const std::vector<double> &angles) const;
+
   /** Compute rotation matrix in homogeneous coordinates from 3 angles in
    * degrees. The convention is the default in itk, i.e. ZXY of Euler angles.*/
   static ThreeDHomogeneousMatrixType
@@ -276,6 +288,30 @@ public:
   itkGetConstMacro(RadiusCylindricalDetector, double)
   itkSetMacro(RadiusCylindricalDetector, double)
 
+  /** Accessor for the displacement field of the detector. Its points are
+   * projection coordinates, i.e., 2D physical points of the projection
+   * images, and its vectors are the displacements in mm from the nominal
+   * position of each pixel to the position where its value has been
+   * measured. It is typically sampled on a grid much coarser than the
+   * pixels and it is bilinearly interpolated, with constant extrapolation
+   * outside its largest possible region. The default is nullptr, i.e., no
+   * distortion. The inverse displacement is sampled on the same grid when
+   * the field is set, so the field must not be modified afterwards. */
+  itkGetConstObjectMacro(DetectorDisplacementField, DetectorDisplacementFieldType)
+  virtual void SetDetectorDisplacementField(const DetectorDisplacementFieldType *field);
+
+  /** Moves the nominal projection coordinates (u,v) of a pixel to the
+   * position where its value has been measured, i.e., adds the interpolated
+   * DetectorDisplacementField. Nothing is done without displacement field. */
+  void ApplyDetectorDisplacement(double &u, double &v) const;
+
+  /** Inverse of ApplyDetectorDisplacement, i.e., bilinear interpolation of
+   * the inverse displacement. The inverse displacement is computed at the
+   * points of the DetectorDisplacementField with fixed-point iterations which
+   * converge if the displacement is contracting, i.e., if its spatial
+   * derivatives are small compared to 1. */
+  void ApplyInverseDetectorDisplacement(double &u, double &v) const;
+
 protected:
   ThreeDCircularProjectionGeometry();
   ~ThreeDCircularProjectionGeometry() override = default;
@@ -358,6 +394,12 @@ protected:
   /** Radius of curved detector. The default is 0 and it means a flat detector. */
   double m_RadiusCylindricalDetector{0.};
 
+  /** Displacement field of the detector, nullptr if there is no distortion. */
+  DetectorDisplacementFieldType::ConstPointer m_DetectorDisplacementField;
+
+  /** Inverse displacement sampled on the grid of m_DetectorDisplacementField. */
+  DetectorDisplacementFieldType::Pointer m_InverseDetectorDisplacementField;
+
   /** Parameters of the collimation jaws.
    * The collimation position is with respect to the distance of the m_RotationCenter along
    * - the m_RotationAxis for the m_CollimationVInf and m_CollimationVSup,
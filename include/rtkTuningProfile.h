@@ -0,0 +1,79 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkTuningProfile_h
+#define rtkTuningProfile_h
+
+#include "RTKExport.h"
+
+#include <map>
+#include <string>
+
+namespace rtk
+{
+
+/** \class TuningProfile
+ * \brief Machine-specific values of performance parameters.
+ *
+ * A tuning profile is a text file with one parameter per line, its name and
+ * its value separated by a space. Lines starting with # are comments. It is
+ * written by rtkautotune from timings of short reconstructions and
+ * projections on the machine. The filters never read it, it is applied by
+ * rtkfdk and rtkforwardprojections with --profile through the setters of the
+ * filters:
+ * - FDKProjectionSubsetSize: ProjectionSubsetSize of
+ *   rtk::FDKConeBeamReconstructionFilter,
+ * - FFTGreatestPrimeFactor: GreatestPrimeFactor of
+ *   rtk::FFTProjectionsConvolutionImageFilter, e.g., the ramp filter, if
+ *   FFTW is used,
+ * - NumberOfStreamDivisions: number of stream divisions of the volume,
+ * - JosephTileSize and JosephBrickSize: TileSize and BrickSize of
+ *   rtk::JosephForwardProjectionImageFilter,
+ * - NumberOfThreads: global default number of threads of ITK, see
+ *   SetGlobalNumberOfThreads.
+ *
+ * \ingroup RTK
+ */
+class RTK_EXPORT TuningProfile
+{
+public:
+  using ParametersType = std::map<std::string, double>;
+
+  /** Reads the parameters of a profile. Returns false if the file cannot be
+   * opened and throws if a value cannot be read. */
+  static bool Read(const std::string &fileName, ParametersType &parameters);
+
+  /** Writes the parameters in a profile, creating its directory if needed.
+   * The comment is written in the first line. */
+  static void Write(const std::string &fileName,
+                    const ParametersType &parameters,
+                    const std::string &comment = "");
+
+  /** Gets the value of a parameter of a profile. Returns false, and leaves
+   * value unchanged, if the profile does not contain this parameter. */
+  static bool GetValue(const ParametersType &parameters, const std::string &name, double &value);
+
+  /** Sets the global default number of threads of ITK to the NumberOfThreads
+   * of a profile, if any. It only applies to the filters created afterwards.
+   * Returns false if the profile does not contain a valid NumberOfThreads. */
+  static bool SetGlobalNumberOfThreads(const ParametersType &parameters);
+};
+
+} // end namespace rtk
+
+#endif
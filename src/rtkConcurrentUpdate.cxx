@@ -0,0 +1,143 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkConcurrentUpdate.h"
+
+#include <itkProcessObject.h>
+
+#include <future>
+#include <map>
+#include <set>
+
+namespace rtk
+{
+
+namespace
+{
+// Adds to dataObjects and processObjects the data objects and the filters
+// upstream of dataObject, excluding dataObject itself.
+void CollectUpstream(itk::DataObject *dataObject,
+                     std::set<itk::DataObject *> &dataObjects,
+                     std::set<itk::ProcessObject *> &processObjects)
+{
+  itk::ProcessObject *source = dataObject->GetSource();
+  if(source == nullptr || !processObjects.insert(source).second)
+    return;
+  for(itk::DataObject *input : source->GetInputs())
+    {
+    if(input == nullptr)
+      continue;
+    dataObjects.insert(input);
+    CollectUpstream(input, dataObjects, processObjects);
+    }
+}
+} // end anonymous namespace
+
+void UpdateConcurrently(const std::vector<itk::DataObject *> &outputs)
+{
+  if(outputs.size() < 2)
+    {
+    for(itk::DataObject *output : outputs)
+      output->Update();
+    return;
+    }
+
+  // Negotiate the output information and the requested regions
+  for(itk::DataObject *output : outputs)
+    {
+    output->UpdateOutputInformation();
+    output->PropagateRequestedRegion();
+    }
+
+  // Count the branches upstream of which each data object and each filter is
+  std::map<itk::DataObject *, unsigned int>    dataObjectBranches;
+  std::map<itk::ProcessObject *, unsigned int> processObjectBranches;
+  for(itk::DataObject *output : outputs)
+    {
+    std::set<itk::DataObject *>    dataObjects;
+    std::set<itk::ProcessObject *> processObjects;
+    CollectUpstream(output, dataObjects, processObjects);
+    for(itk::DataObject *dataObject : dataObjects)
+      dataObjectBranches[dataObject]++;
+    for(itk::ProcessObject *processObject : processObjects)
+      processObjectBranches[processObject]++;
+    }
+
+  // Update the common filters through one of their outputs used by the
+  // branches, a filter generating all its outputs at once, and keep the
+  // common data
+  for(const std::pair<itk::ProcessObject * const, unsigned int> &po : processObjectBranches)
+    {
+    if(po.second < 2)
+      continue;
+    for(itk::DataObject *dataObject : po.first->GetOutputs())
+      {
+      if(dataObjectBranches.find(dataObject) != dataObjectBranches.end())
+        {
+        dataObject->UpdateOutputData();
+        break;
+        }
+      }
+    }
+
+  // The requested regions of the common data objects are those of the last
+  // branch. Check that the data generated for them also covers the requested
+  // regions of the other branches, otherwise update the branches serially.
+  bool commonDataCoversAllBranches = true;
+  for(itk::DataObject *output : outputs)
+    {
+    output->PropagateRequestedRegion();
+    for(const std::pair<itk::DataObject * const, unsigned int> &dataObject : dataObjectBranches)
+      if(dataObject.second > 1 && dataObject.first->RequestedRegionIsOutsideOfTheBufferedRegion())
+        commonDataCoversAllBranches = false;
+    }
+  if(!commonDataCoversAllBranches)
+    {
+    for(itk::DataObject *output : outputs)
+      output->Update();
+    return;
+    }
+
+  std::vector<itk::DataObject *> releasedDataObjects;
+  for(const std::pair<itk::DataObject * const, unsigned int> &dataObject : dataObjectBranches)
+    {
+    if(dataObject.second > 1 && dataObject.first->GetReleaseDataFlag())
+      {
+      dataObject.first->ReleaseDataFlagOff();
+      releasedDataObjects.push_back(dataObject.first);
+      }
+    }
+
+  // Update each branch in its own thread
+  std::vector< std::future<void> > branches;
+  for(itk::DataObject *output : outputs)
+    branches.push_back(std::async(std::launch::async, [output](){ output->UpdateOutputData(); }));
+
+  // Wait for all branches before rethrowing the first exception, if any
+  for(std::future<void> &branch : branches)
+    branch.wait();
+  for(itk::DataObject *dataObject : releasedDataObjects)
+    {
+    dataObject->ReleaseDataFlagOn();
+    dataObject->ReleaseData();
+    }
+  for(std::future<void> &branch : branches)
+    branch.get();
+}
+
+} //namespace rtk
@@ -32,6 +32,8 @@ int2 proj_size_in_buf,
 int3 proj_idx_out,
 int3 proj_size_out,
 int2 proj_size_out_buf,
+int2 state_idx,
+int state_size_x,
 unsigned short *dev_proj_in,
 unsigned short *dev_proj_out,
 float *state
@@ -57,7 +59,8 @@ float *state
   // combined proj. index -> use thread index in z because accessing memory only with this index
   long int pIdx_comp = (pIdx.x - proj_idx_in.x) + (pIdx.y - proj_idx_in.y) * proj_size_in_buf.x + (pIdx.z - proj_idx_in.z) * proj_size_in_buf.x * proj_size_in_buf.y;
 
-  long int sIdx_comp = tIdx.x + tIdx.y * proj_size_out.x;
+  // The state covers the whole detector so that any band can be corrected
+  long int sIdx_comp = (pIdx.x - state_idx.x) + (pIdx.y - state_idx.y) * state_size_x;
   unsigned idx_s = sIdx_comp*modelOrder;
 
   float yk = static_cast<float>(dev_proj_in[pIdx_comp]);
@@ -97,6 +100,8 @@ int proj_dim_in_buf[2], // input size of buffered region
 int proj_idx_out[3], // output region index
 int proj_dim_out[3], // output region size
 int proj_dim_out_buf[2], // output size of buffered region
+int state_idx[2], // detector index of the first state
+int state_dim_x, // detector size of the state along x
 unsigned short *dev_proj_in,
 unsigned short *dev_proj_out,
 float *h_state,
@@ -132,6 +137,8 @@ int state_size, float *coefficients)
     make_int3(proj_idx_out[0], proj_idx_out[1], proj_idx_out[2]),
     make_int3(proj_dim_out[0], proj_dim_out[1], proj_dim_out[2]),
     make_int2(proj_dim_out_buf[0], proj_dim_out_buf[1]),
+    make_int2(state_idx[0], state_idx[1]),
+    state_dim_x,
     dev_proj_in,
     dev_proj_out,
     d_state
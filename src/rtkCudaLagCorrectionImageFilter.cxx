@@ -74,12 +74,17 @@ CudaLagCorrectionImageFilter
   proj_size_out[1] = this->GetOutput()->GetRequestedRegion().GetSize()[1];
   proj_size_out[2] = this->GetOutput()->GetRequestedRegion().GetSize()[2];
 
+  int state_idx[2];
+  state_idx[0] = m_StartIdx[0];
+  state_idx[1] = m_StartIdx[1];
+  int state_size_x = m_StateSize[0];
+
   float coefficients[9] = { m_B[0], m_B[1], m_B[2], m_B[3], m_ExpmA[0], m_ExpmA[1], m_ExpmA[2], m_ExpmA[3] , m_SumB};
 
   int S_size = sizeof(float)*m_S.size();
   CUDA_lag_correction(
       proj_idx_in, proj_size_in, proj_size_in_buf, proj_idx_out, proj_size_out, proj_size_out_buf,
-      inBuffer, outBuffer, &m_S[0], S_size, coefficients);
+      state_idx, state_size_x, inBuffer, outBuffer, &m_S[0], S_size, coefficients);
 }
 
 }
@@ -32,6 +32,8 @@ int2 proj_size_in_buf,
 int3 proj_idx_out,
 int3 proj_size_out,
 int2 proj_size_out_buf,
+int2 map_idx,
+int2 map_size,
 unsigned short *dev_proj_in,
 float *dev_proj_out,
 unsigned short *dev_dark_in,
@@ -57,7 +59,8 @@ float *powerlut
 
   int modelOrder = static_cast<float>(cst_coef[0]);
 
-  long int sIdx_comp = tIdx.x + tIdx.y * proj_size_out.x; // in-slice index
+  // in-slice index in the dark image and the gain maps
+  long int sIdx_comp = (pIdx.x - map_idx.x) + (pIdx.y - map_idx.y) * map_size.x;
 
   // Correct for dark field
   unsigned short xk = 0;
@@ -66,7 +69,7 @@ float *powerlut
 
   float yk = 0.f;
   int lutidx = xk*modelOrder;    // index to powerlut
-  int projsize = proj_size_in.x * proj_size_in.y;
+  int projsize = map_size.x * map_size.y;
   for (int n = 0; n < modelOrder; n++)
   {
       int gainidx = n*projsize + sIdx_comp;
@@ -91,6 +94,8 @@ int proj_dim_in_buf[2], // input size of buffered region
 int proj_idx_out[3], // output region index
 int proj_dim_out[3], // output region size
 int proj_dim_out_buf[2], // output size of buffered region
+int map_idx[2], // index of the dark image and the gain maps
+int map_dim[2], // size of the dark image and the gain maps
 unsigned short *dev_proj_in,
 float *dev_proj_out,
 unsigned short *dev_dark_in,
@@ -124,6 +129,8 @@ float *h_powerlut, int lut_size, float *coefficients)
     make_int3(proj_idx_out[0], proj_idx_out[1], proj_idx_out[2]),
     make_int3(proj_dim_out[0], proj_dim_out[1], proj_dim_out[2]),
     make_int2(proj_dim_out_buf[0], proj_dim_out_buf[1]),
+    make_int2(map_idx[0], map_idx[1]),
+    make_int2(map_dim[0], map_dim[1]),
     dev_proj_in,
     dev_proj_out,
     dev_dark_in,
@@ -77,12 +77,25 @@ CudaPolynomialGainCorrectionImageFilter
   proj_size_out[1] = this->GetOutput()->GetRequestedRegion().GetSize()[1];
   proj_size_out[2] = this->GetOutput()->GetRequestedRegion().GetSize()[2];
 
+  // The dark image and the gain maps are indexed like the detector so that
+  // any band of the detector can be corrected
+  int map_idx[2];
+  int map_size[2];
+  for(unsigned int i=0; i<2; i++)
+    {
+    map_idx[i] = m_GainImage->GetLargestPossibleRegion().GetIndex()[i];
+    map_size[i] = m_GainImage->GetLargestPossibleRegion().GetSize()[i];
+    if(m_DarkImage->GetLargestPossibleRegion().GetIndex()[i] != map_idx[i] ||
+       (int)m_DarkImage->GetLargestPossibleRegion().GetSize()[i] != map_size[i])
+      itkExceptionMacro(<< "The dark image and the gain maps must have the same detector region.");
+    }
+
   float coefficients[2] = { static_cast<float>(m_ModelOrder), m_K };
 
   int LUT_size = sizeof(float)*m_PowerLut.size();
   CUDA_gain_correction(
       proj_idx_in, proj_size_in, proj_size_in_buf, proj_idx_out, proj_size_out, proj_size_out_buf,
-      inBuffer, outBuffer, darkBuffer, gainBuffer, &m_PowerLut[0], LUT_size, coefficients);
+      map_idx, map_size, inBuffer, outBuffer, darkBuffer, gainBuffer, &m_PowerLut[0], LUT_size, coefficients);
 }
 
 }
@@ -38,6 +38,9 @@ void
 CudaRayCastBackProjectionImageFilter
 ::GPUGenerateData()
 {
+  if (this->GetGeometry()->GetDetectorDisplacementField() != nullptr)
+    itkGenericExceptionMacro(<< "Detector displacement fields are not handled by CUDA projectors");
+
   if (this->GetGeometry()->GetSourceToDetectorDistances().size() &&
       this->GetGeometry()->GetSourceToDetectorDistances()[0] == 0)
     {
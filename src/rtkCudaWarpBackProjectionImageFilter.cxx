@@ -136,6 +136,9 @@ void
 CudaWarpBackProjectionImageFilter
 ::GPUGenerateData()
 {
+  if (this->GetGeometry()->GetDetectorDisplacementField() != nullptr)
+    itkGenericExceptionMacro(<< "Detector displacement fields are not handled by CUDA projectors");
+
   const unsigned int Dimension = ImageType::ImageDimension;
   const unsigned int nProj = this->GetInputProjectionStack()->GetLargestPossibleRegion().GetSize(Dimension-1);
   const unsigned int iFirstProj = this->GetInputProjectionStack()->GetLargestPossibleRegion().GetIndex(Dimension-1);
@@ -142,6 +142,9 @@ void
 CudaWarpForwardProjectionImageFilter
 ::GPUGenerateData()
 {
+  if (this->GetGeometry()->GetDetectorDisplacementField() != nullptr)
+    itkGenericExceptionMacro(<< "Detector displacement fields are not handled by CUDA projectors");
+
   if (this->GetGeometry()->GetSourceToDetectorDistances().size() &&
       this->GetGeometry()->GetSourceToDetectorDistances()[0] == 0)
     {
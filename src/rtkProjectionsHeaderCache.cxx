@@ -0,0 +1,221 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkProjectionsHeaderCache.h"
+
+#include <itkMacro.h>
+#if ITK_VERSION_MAJOR<5
+  #include <itkMultiThreader.h>
+#else
+  #include <itkMultiThreaderBase.h>
+#endif
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+
+namespace rtk
+{
+
+namespace
+{
+struct HeaderEntry
+{
+  ProjectionsHeaderCache::ImageIOPointer ImageIO;
+  long int                               ModifiedTime;
+  unsigned long                          FileLength;
+};
+
+// Headers indexed by class name of the image IO and file name
+using HeaderKey = std::pair<std::string, std::string>;
+using HeaderMap = std::map<HeaderKey, HeaderEntry>;
+
+HeaderMap & GetHeaders()
+{
+  static HeaderMap headers;
+  return headers;
+}
+
+std::mutex & GetHeadersMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+// The length is checked in addition to the modification time which is only
+// known to the second
+bool IsUpToDate(const HeaderEntry &entry, const std::string &fileName)
+{
+  return entry.ModifiedTime == itksys::SystemTools::ModifiedTime(fileName) &&
+         entry.FileLength == itksys::SystemTools::FileLength(fileName);
+}
+} // end anonymous namespace
+
+void
+ProjectionsHeaderCache
+::Scan(const FileNamesContainer &fileNames, const ImageIOCreatorType &creator)
+{
+  if(fileNames.empty())
+    return;
+  const std::string className = creator()->GetNameOfClass();
+
+  // Files which have not been scanned or have been modified since
+  FileNamesContainer missing;
+  {
+  std::lock_guard<std::mutex> lock(GetHeadersMutex());
+  const HeaderMap &headers = GetHeaders();
+  for(const std::string &fileName : fileNames)
+    {
+    HeaderMap::const_iterator it = headers.find(HeaderKey(className, fileName));
+    if(it == headers.end() || !IsUpToDate(it->second, fileName))
+      missing.push_back(fileName);
+    }
+  }
+  if(missing.empty())
+    return;
+
+  // The modification time and the length are taken before reading the header
+  // to read it again if the file is modified in the meantime.
+  std::vector<HeaderEntry> entries(missing.size());
+  auto readHeader = [&](size_t i)
+    {
+    entries[i].ModifiedTime = itksys::SystemTools::ModifiedTime(missing[i]);
+    entries[i].FileLength = itksys::SystemTools::FileLength(missing[i]);
+    ImageIOPointer imageIO = creator();
+    imageIO->SetFileName(missing[i]);
+    imageIO->ReadImageInformation();
+    entries[i].ImageIO = imageIO;
+    };
+  readHeader(0);
+
+  // The workers take the next file to read until all headers have been read
+  // or one of them has failed.
+  std::atomic<size_t> next(1);
+  std::exception_ptr  error;
+  std::mutex          errorMutex;
+  auto worker = [&]()
+    {
+    for(size_t i = next++; i < missing.size(); i = next++)
+      {
+      try
+        {
+        readHeader(i);
+        }
+      catch(...)
+        {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if(!error)
+          error = std::current_exception();
+        next = missing.size();
+        }
+      }
+    };
+#if ITK_VERSION_MAJOR<5
+  const size_t nThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+#else
+  const size_t nThreads = itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+#endif
+  const size_t nWorkers = std::min(nThreads, missing.size()-1);
+  std::vector<std::thread> workers;
+  for(size_t w = 0; w < nWorkers; w++)
+    workers.emplace_back(worker);
+  for(std::thread &t : workers)
+    t.join();
+  if(error)
+    std::rethrow_exception(error);
+
+  std::lock_guard<std::mutex> lock(GetHeadersMutex());
+  HeaderMap &headers = GetHeaders();
+  for(size_t i = 0; i < missing.size(); i++)
+    headers[HeaderKey(className, missing[i])] = entries[i];
+}
+
+ProjectionsHeaderCache::ImageIOPointer
+ProjectionsHeaderCache
+::GetImageIO(const std::string &fileName, const std::string &className)
+{
+  std::lock_guard<std::mutex> lock(GetHeadersMutex());
+  const HeaderMap &headers = GetHeaders();
+  if(!className.empty())
+    {
+    HeaderMap::const_iterator it = headers.find(HeaderKey(className, fileName));
+    if(it != headers.end() && IsUpToDate(it->second, fileName))
+      return it->second.ImageIO;
+    return nullptr;
+    }
+  for(const HeaderMap::value_type &header : headers)
+    {
+    if(header.first.second == fileName && IsUpToDate(header.second, fileName))
+      return header.second.ImageIO;
+    }
+  return nullptr;
+}
+
+itk::MetaDataDictionary
+ProjectionsHeaderCache
+::GetMetaDataDictionary(const std::string &fileName, const std::string &className)
+{
+  std::lock_guard<std::mutex> lock(GetHeadersMutex());
+  HeaderMap::const_iterator it = GetHeaders().find(HeaderKey(className, fileName));
+  if(it == GetHeaders().end())
+    {
+    itkGenericExceptionMacro(<< "The header of " << fileName
+                             << " has not been read with " << className);
+    }
+  return it->second.ImageIO->GetMetaDataDictionary();
+}
+
+void
+ProjectionsHeaderCache
+::Remove(const FileNamesContainer &fileNames)
+{
+  const std::set<std::string> removed(fileNames.begin(), fileNames.end());
+  std::lock_guard<std::mutex> lock(GetHeadersMutex());
+  HeaderMap &headers = GetHeaders();
+  for(HeaderMap::iterator it = headers.begin(); it != headers.end();)
+    {
+    if(removed.count(it->first.second))
+      it = headers.erase(it);
+    else
+      ++it;
+    }
+}
+
+unsigned int
+ProjectionsHeaderCache
+::GetNumberOfHeaders()
+{
+  std::lock_guard<std::mutex> lock(GetHeadersMutex());
+  return GetHeaders().size();
+}
+
+void
+ProjectionsHeaderCache
+::Clear()
+{
+  std::lock_guard<std::mutex> lock(GetHeadersMutex());
+  GetHeaders().clear();
+}
+
+} // end namespace rtk
@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkProjectionsHeaderCacheImageIO.h"
+#include "rtkProjectionsHeaderCache.h"
+
+#include <itkMacro.h>
+
+#include <mutex>
+
+namespace rtk
+{
+
+namespace
+{
+// The IO region and the pixels of the shared image IO of the cache are
+// accessed by one reader at a time
+std::mutex & GetReadMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+} // end anonymous namespace
+
+void
+ProjectionsHeaderCacheImageIO
+::SetImageIO(itk::ImageIOBase *imageIO)
+{
+  if(m_ImageIO != imageIO)
+    {
+    m_ImageIO = imageIO;
+    m_HeaderImageIO = nullptr;
+    this->Modified();
+    }
+}
+
+bool
+ProjectionsHeaderCacheImageIO
+::CanReadFile(const char* filename)
+{
+  if(m_ImageIO.IsNull())
+    return false;
+  if(ProjectionsHeaderCache::GetImageIO(filename, m_ImageIO->GetNameOfClass()))
+    return true;
+  return m_ImageIO->CanReadFile(filename);
+}
+
+void
+ProjectionsHeaderCacheImageIO
+::ReadImageInformation()
+{
+  if(m_ImageIO.IsNull())
+    itkExceptionMacro(<< "The image IO reading the files which are not in the cache has not been set.");
+
+  m_HeaderImageIO = ProjectionsHeaderCache::GetImageIO(m_FileName, m_ImageIO->GetNameOfClass());
+  if(m_HeaderImageIO.IsNull())
+    {
+    m_ImageIO->SetFileName(m_FileName);
+    m_ImageIO->ReadImageInformation();
+    m_HeaderImageIO = m_ImageIO;
+    }
+
+  const unsigned int nDims = m_HeaderImageIO->GetNumberOfDimensions();
+  this->SetNumberOfDimensions(nDims);
+  for(unsigned int i=0; i<nDims; i++)
+    {
+    this->SetDimensions(i, m_HeaderImageIO->GetDimensions(i));
+    this->SetOrigin(i, m_HeaderImageIO->GetOrigin(i));
+    this->SetSpacing(i, m_HeaderImageIO->GetSpacing(i));
+    this->SetDirection(i, m_HeaderImageIO->GetDirection(i));
+    }
+  this->SetPixelType(m_HeaderImageIO->GetPixelType());
+  this->SetComponentType(m_HeaderImageIO->GetComponentType());
+  this->SetNumberOfComponents(m_HeaderImageIO->GetNumberOfComponents());
+  this->SetByteOrder(m_HeaderImageIO->GetByteOrder());
+  this->SetMetaDataDictionary(m_HeaderImageIO->GetMetaDataDictionary());
+  this->ComputeStrides();
+}
+
+void
+ProjectionsHeaderCacheImageIO
+::Read(void * buffer)
+{
+  if(m_HeaderImageIO.IsNull())
+    itkExceptionMacro(<< "ReadImageInformation must be called before Read.");
+
+  std::lock_guard<std::mutex> lock(GetReadMutex());
+  m_HeaderImageIO->SetIORegion(this->GetIORegion());
+  m_HeaderImageIO->Read(buffer);
+}
+
+void
+ProjectionsHeaderCacheImageIO
+::Write(const void* itkNotUsed(buffer))
+{
+  itkExceptionMacro(<< "ProjectionsHeaderCacheImageIO cannot write images.");
+}
+
+} // end namespace rtk
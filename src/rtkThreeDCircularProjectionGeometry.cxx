@@ -21,9 +21,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <queue>
+#include <tuple>
 
 #include <itkCenteredEuler3DTransform.h>
 #include <itkEuler3DTransform.h>
+#include <itkImageRegionIteratorWithIndex.h>
 
 rtk::ThreeDCircularProjectionGeometry::ThreeDCircularProjectionGeometry()
 {
@@ -453,6 +456,55 @@ const std::vector<double> rtk::ThreeDCircularProjectionGeometry::GetAngularGaps(
   return angularGaps;
 }
 
+const std::vector<unsigned int> rtk::ThreeDCircularProjectionGeometry::GetProgressiveProjectionOrder(const std::vector<double> &angles) const
+{
+  std::vector<unsigned int> order;
+  const unsigned int nProj = angles.size();
+  if(nProj==0)
+    return order;
+
+  // Projection indices sorted by angle and cumulated angle from the first one,
+  // the last element being the first projection after a full rotation
+  const std::multimap<double,unsigned int> sangles = this->GetSortedAngles( angles );
+  const std::vector<double> gapsWithNext = this->GetAngularGapsWithNext( angles );
+  std::vector<unsigned int> sortedIndices;
+  std::vector<double> cumulatedAngles(1, 0.);
+  for(const std::pair<const double, unsigned int> &sa : sangles)
+    {
+    sortedIndices.push_back(sa.second);
+    cumulatedAngles.push_back(cumulatedAngles.back() + gapsWithNext[sa.second]);
+    }
+
+  // Angular gaps between two selected projections, given by their positions
+  // in the sorted angles, with the largest gap first
+  using GapType = std::tuple<double, unsigned int, unsigned int>;
+  std::priority_queue<GapType> gaps;
+  order.push_back(sortedIndices[0]);
+  gaps.push( GapType(cumulatedAngles[nProj], 0, nProj) );
+  while(order.size() < nProj)
+    {
+    const unsigned int first = std::get<1>(gaps.top());
+    const unsigned int last = std::get<2>(gaps.top());
+    gaps.pop();
+    if(last-first < 2)
+      continue;
+
+    // Projection closest to the middle of the gap
+    const double middle = 0.5 * (cumulatedAngles[first] + cumulatedAngles[last]);
+    std::vector<double>::const_iterator it = std::lower_bound(cumulatedAngles.begin()+first+1,
+                                                              cumulatedAngles.begin()+last-1,
+                                                              middle);
+    unsigned int split = it - cumulatedAngles.begin();
+    if(split>first+1 && middle-cumulatedAngles[split-1] < cumulatedAngles[split]-middle)
+      split--;
+
+    order.push_back(sortedIndices[split]);
+    gaps.push( GapType(cumulatedAngles[split]-cumulatedAngles[first], first, split) );
+    gaps.push( GapType(cumulatedAngles[last]-cumulatedAngles[split], split, last) );
+    }
+  return order;
+}
+
 rtk::ThreeDCircularProjectionGeometry::ThreeDHomogeneousMatrixType
 rtk::ThreeDCircularProjectionGeometry::
 ComputeRotationHomogeneousMatrix(double angleX,
@@ -725,5 +777,125 @@ rtk::ThreeDCircularProjectionGeometry::InternalClone() const
                                            this->GetCollimationVSup()[iProj]);
     }
   clone->SetRadiusCylindricalDetector( this->GetRadiusCylindricalDetector() );
+  clone->SetDetectorDisplacementField( this->GetDetectorDisplacementField() );
   return loPtr;
 }
+
+namespace
+{
+// Bilinear interpolation of a displacement field at the projection
+// coordinates (u,v), with constant extrapolation outside its largest possible
+// region
+void InterpolateDisplacement(const rtk::ThreeDCircularProjectionGeometry::DetectorDisplacementFieldType *field,
+                             const double u, const double v, double &du, double &dv)
+{
+  using FieldType = rtk::ThreeDCircularProjectionGeometry::DetectorDisplacementFieldType;
+  const FieldType::RegionType &region = field->GetLargestPossibleRegion();
+  FieldType::PointType point;
+  point[0] = u;
+  point[1] = v;
+  itk::ContinuousIndex<double, 2> cindex;
+  field->TransformPhysicalPointToContinuousIndex(point, cindex);
+
+  // Indices of the four neighbors, relative to the buffered region
+  const FieldType::RegionType &buffered = field->GetBufferedRegion();
+  itk::IndexValueType i0[2], i1[2];
+  double w[2];
+  for(unsigned int d=0; d<2; d++)
+    {
+    const double first = region.GetIndex(d);
+    const double last = region.GetIndex(d) + region.GetSize(d) - 1;
+    const double c = std::min(std::max(cindex[d], first), last);
+    i0[d] = itk::Math::Floor<itk::IndexValueType>(c);
+    i1[d] = std::min(i0[d]+1, (itk::IndexValueType)last);
+    w[d] = c - i0[d];
+    i0[d] -= buffered.GetIndex(d);
+    i1[d] -= buffered.GetIndex(d);
+    }
+  const itk::IndexValueType sizeX = buffered.GetSize(0);
+  const FieldType::PixelType *buffer = field->GetBufferPointer();
+  const FieldType::PixelType &p00 = buffer[i0[1] * sizeX + i0[0]];
+  const FieldType::PixelType &p10 = buffer[i0[1] * sizeX + i1[0]];
+  const FieldType::PixelType &p01 = buffer[i1[1] * sizeX + i0[0]];
+  const FieldType::PixelType &p11 = buffer[i1[1] * sizeX + i1[0]];
+  double displacement[2];
+  for(unsigned int d=0; d<2; d++)
+    {
+    displacement[d] = (1.-w[0]) * (1.-w[1]) * p00[d] +
+                      w[0]      * (1.-w[1]) * p10[d] +
+                      (1.-w[0]) * w[1]      * p01[d] +
+                      w[0]      * w[1]      * p11[d];
+    }
+  du = displacement[0];
+  dv = displacement[1];
+}
+} // end anonymous namespace
+
+void
+rtk::ThreeDCircularProjectionGeometry::SetDetectorDisplacementField(const DetectorDisplacementFieldType *field)
+{
+  if(m_DetectorDisplacementField == field)
+    return;
+  m_DetectorDisplacementField = field;
+  m_InverseDetectorDisplacementField = nullptr;
+  this->Modified();
+  if(field == nullptr)
+    return;
+
+  // Inverse displacement on the grid of the field. At each point (u,v) of the
+  // grid, (x,y) such that (x,y)+D(x,y)=(u,v) is found with fixed-point
+  // iterations starting from (u,v).
+  m_InverseDetectorDisplacementField = DetectorDisplacementFieldType::New();
+  m_InverseDetectorDisplacementField->CopyInformation(field);
+  m_InverseDetectorDisplacementField->SetRegions(field->GetLargestPossibleRegion());
+  m_InverseDetectorDisplacementField->Allocate();
+  itk::ImageRegionIteratorWithIndex<DetectorDisplacementFieldType> it(m_InverseDetectorDisplacementField,
+                                                                      field->GetLargestPossibleRegion());
+  for(; !it.IsAtEnd(); ++it)
+    {
+    DetectorDisplacementFieldType::PointType point;
+    field->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    double u = point[0];
+    double v = point[1];
+    for(unsigned int iter=0; iter<100; iter++)
+      {
+      double du, dv;
+      InterpolateDisplacement(field, u, v, du, dv);
+      const double newU = point[0] - du;
+      const double newV = point[1] - dv;
+      const bool converged = itk::Math::abs(newU-u) + itk::Math::abs(newV-v) < 1e-6;
+      u = newU;
+      v = newV;
+      if(converged)
+        break;
+      }
+    DetectorDisplacementFieldType::PixelType inverse;
+    inverse[0] = u - point[0];
+    inverse[1] = v - point[1];
+    it.Set(inverse);
+    }
+}
+
+void
+rtk::ThreeDCircularProjectionGeometry::ApplyDetectorDisplacement(double &u, double &v) const
+{
+  if(m_DetectorDisplacementField.IsNull())
+    return;
+
+  double du, dv;
+  InterpolateDisplacement(m_DetectorDisplacementField, u, v, du, dv);
+  u += du;
+  v += dv;
+}
+
+void
+rtk::ThreeDCircularProjectionGeometry::ApplyInverseDetectorDisplacement(double &u, double &v) const
+{
+  if(m_InverseDetectorDisplacementField.IsNull())
+    return;
+
+  double du, dv;
+  InterpolateDisplacement(m_InverseDetectorDisplacementField, u, v, du, dv);
+  u += du;
+  v += dv;
+}
@@ -0,0 +1,101 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkTuningProfile.h"
+
+#include <itkMacro.h>
+#if ITK_VERSION_MAJOR<5
+  #include <itkMultiThreader.h>
+#else
+  #include <itkMultiThreaderBase.h>
+#endif
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+#include <sstream>
+
+namespace rtk
+{
+
+bool
+TuningProfile
+::Read(const std::string &fileName, ParametersType &parameters)
+{
+  std::ifstream is(fileName.c_str());
+  if(!is.is_open())
+    return false;
+
+  std::string line;
+  while(std::getline(is, line))
+    {
+    std::istringstream iss(line);
+    std::string name;
+    double value;
+    if( !(iss >> name) || name[0] == '#' )
+      continue;
+    if( !(iss >> value) )
+      itkGenericExceptionMacro(<< "Could not read the value of " << name << " in " << fileName);
+    parameters[name] = value;
+    }
+  return true;
+}
+
+void
+TuningProfile
+::Write(const std::string &fileName, const ParametersType &parameters, const std::string &comment)
+{
+  const std::string path = itksys::SystemTools::GetFilenamePath(fileName);
+  if(!path.empty())
+    itksys::SystemTools::MakeDirectory(path);
+
+  std::ofstream os(fileName.c_str());
+  if(!os.is_open())
+    itkGenericExceptionMacro(<< "Could not open " << fileName << " for writing");
+  if(!comment.empty())
+    os << "# " << comment << std::endl;
+  for(const ParametersType::value_type &p : parameters)
+    os << p.first << ' ' << p.second << std::endl;
+}
+
+bool
+TuningProfile
+::GetValue(const ParametersType &parameters, const std::string &name, double &value)
+{
+  ParametersType::const_iterator it = parameters.find(name);
+  if(it == parameters.end())
+    return false;
+  value = it->second;
+  return true;
+}
+
+bool
+TuningProfile
+::SetGlobalNumberOfThreads(const ParametersType &parameters)
+{
+  double nThreads = 0.;
+  if(!GetValue(parameters, "NumberOfThreads", nThreads) || nThreads < 1.)
+    return false;
+#if ITK_VERSION_MAJOR<5
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads( itk::ThreadIdType(nThreads) );
+#else
+  itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads( itk::ThreadIdType(nThreads) );
+#endif
+  return true;
+}
+
+} // end namespace rtk
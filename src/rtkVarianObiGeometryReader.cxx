@@ -19,9 +19,9 @@
 
 #include "rtkVarianObiGeometryReader.h"
 #include "rtkVarianObiXMLFileReader.h"
-#include "rtkHndImageIOFactory.h"
+#include "rtkHndImageIO.h"
+#include "rtkProjectionsHeaderCache.h"
 
-#include <itkImageFileReader.h>
 #include <itksys/SystemTools.hxx>
 
 rtk::VarianObiGeometryReader
@@ -68,22 +68,22 @@ rtk::VarianObiGeometryReader
   const double offsety =
     dynamic_cast<MetaDataDoubleType *>(dic["CalibratedDetectorOffsetY"].GetPointer() )->GetMetaDataObjectValue();
 
-  // Projections reader (for angle)
-  rtk::HndImageIOFactory::RegisterOneFactory();
+  // Headers of the projections (for angle), read in parallel
+  ProjectionsHeaderCache::Scan(m_ProjectionsFileNames,
+                               []() -> ProjectionsHeaderCache::ImageIOPointer
+                                 { return HndImageIO::New().GetPointer(); });
 
   // Projection matrices
   for(const std::string & projectionsFileName : m_ProjectionsFileNames)
     {
-    using InputPixelType = unsigned int;
-    using InputImageType = itk::Image< InputPixelType, 2 >;
-
-    using ReaderType = itk::ImageFileReader< InputImageType >;
-    ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( projectionsFileName );
-    reader->UpdateOutputInformation();
-
-    const double angle =
-      dynamic_cast<MetaDataDoubleType *>(reader->GetMetaDataDictionary()["dCTProjectionAngle"].GetPointer())->GetMetaDataObjectValue();
+    const itk::MetaDataDictionary projDic = ProjectionsHeaderCache::GetMetaDataDictionary(projectionsFileName,
+                                                                                         "HndImageIO");
+    double angle;
+    if( !itk::ExposeMetaData<double>(projDic, "dCTProjectionAngle", angle) )
+      {
+      itkGenericExceptionMacro(<< "No projection angle (dCTProjectionAngle) in the header of "
+                               << projectionsFileName);
+      }
 
     m_Geometry->AddProjection(sid, sdd, angle, offsetx, offsety);
     }
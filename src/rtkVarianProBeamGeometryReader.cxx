@@ -19,9 +19,9 @@
 
 #include "rtkVarianProBeamGeometryReader.h"
 #include "rtkVarianProBeamXMLFileReader.h"
-#include "rtkXimImageIOFactory.h"
+#include "rtkXimImageIO.h"
+#include "rtkProjectionsHeaderCache.h"
 
-#include <itkImageFileReader.h>
 #include <itksys/SystemTools.hxx>
 
 rtk::VarianProBeamGeometryReader
@@ -49,29 +49,29 @@ rtk::VarianProBeamGeometryReader
   const double sdd = dynamic_cast<MetaDataDoubleType *>(dic["SID"].GetPointer() )->GetMetaDataObjectValue();
   const double sid = dynamic_cast<MetaDataDoubleType *>(dic["SAD"].GetPointer() )->GetMetaDataObjectValue();
 
-  // Projections reader (for angle)
-  rtk::XimImageIOFactory::RegisterOneFactory();
+  // Headers of the projections (for angle and offsets), read in parallel
+  ProjectionsHeaderCache::Scan(m_ProjectionsFileNames,
+                               []() -> ProjectionsHeaderCache::ImageIOPointer
+                                 { return XimImageIO::New().GetPointer(); });
+
   // Projection matrices
   for(const std::string & projectionsFileName : m_ProjectionsFileNames)
     {
-    using InputPixelType = unsigned int;
-    using InputImageType = itk::Image< InputPixelType, 2 >;
-
-    using ReaderType = itk::ImageFileReader< InputImageType >;
-    ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( projectionsFileName );
-    reader->UpdateOutputInformation();
-
-    const double angle =
-      dynamic_cast<MetaDataDoubleType *>(reader->GetMetaDataDictionary()["dCTProjectionAngle"].GetPointer())->GetMetaDataObjectValue();
+    const itk::MetaDataDictionary projDic = ProjectionsHeaderCache::GetMetaDataDictionary(projectionsFileName,
+                                                                                         "XimImageIO");
+    double angle;
+    if( !itk::ExposeMetaData<double>(projDic, "dCTProjectionAngle", angle) )
+      {
+      itkGenericExceptionMacro(<< "No projection angle (dCTProjectionAngle) in the header of "
+                               << projectionsFileName);
+      }
     if (angle != 6000)
       {
       /* Warning: The offsets in the test scans were very small,
       however this configuration improved reconstruction quality slightly.*/
-      const double offsetx =
-        dynamic_cast<MetaDataDoubleType *>(reader->GetMetaDataDictionary()["dDetectorOffsetX"].GetPointer())->GetMetaDataObjectValue();
-      const double offsety =
-        dynamic_cast<MetaDataDoubleType *>(reader->GetMetaDataDictionary()["dDetectorOffsetY"].GetPointer())->GetMetaDataObjectValue();
+      double offsetx, offsety;
+      itk::ExposeMetaData<double>(projDic, "dDetectorOffsetX", offsetx);
+      itk::ExposeMetaData<double>(projDic, "dDetectorOffsetY", offsety);
       /*The angle-direction of RTK is opposite of the Xim properties
       (There doesn't seem to be a flag for direction in neither the xml nor xim file) */
       m_Geometry->AddProjection(sid, sdd, 180.0 - angle, offsetx, offsety);
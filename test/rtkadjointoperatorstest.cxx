@@ -178,6 +178,28 @@ int main(int, char** )
       CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(), bp->GetOutput(), randomProjectionsSource->GetOutput(), fw->GetOutput());
       std::cout << "\n\nTest PASSED! " << std::endl;
 
+      std::cout << "\n\n****** Joseph Forward and Back projectors with a nested volume ******" << std::endl;
+
+      // Only the footprint of the nested volume is used, no need to allocate it
+      OutputImageType::Pointer nested = OutputImageType::New();
+      OutputImageType::PointType nestedOrigin;
+      OutputImageType::SpacingType nestedSpacing;
+      OutputImageType::SizeType nestedSize;
+      nestedOrigin.Fill(-31.);
+      nestedSpacing.Fill(2.);
+      nestedSize.Fill(32);
+      nested->SetOrigin(nestedOrigin);
+      nested->SetSpacing(nestedSpacing);
+      nested->SetRegions(nestedSize);
+
+      fw->AddNestedVolume(nested);
+      bp->AddNestedVolume(nested);
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( fw->Update() );
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( bp->Update() );
+
+      CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(), bp->GetOutput(), randomProjectionsSource->GetOutput(), fw->GetOutput());
+      std::cout << "\n\nTest PASSED! " << std::endl;
+
       using VectorImageType = itk::Image<itk::Vector<OutputPixelType, 3>, Dimension>;
       VectorImageType::Pointer vectorRandomProjections = VectorImageType::New();
       VectorImageType::Pointer vectorConstantProjections = VectorImageType::New();
@@ -180,5 +180,13 @@ int main(int, char** )
   CheckImageQuality<OutputImageType>(conjugategradient->GetOutput(), dsl->GetOutput(), 0.08, 23, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 5: Joseph Backprojector, weighted least squares, batches of projections  ******" << std::endl;
+
+  conjugategradient->SetNumberOfProjectionsPerBatch(7);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() );
+
+  CheckImageQuality<OutputImageType>(conjugategradient->GetOutput(), dsl->GetOutput(), 0.08, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,175 @@
+#include "rtkTest.h"
+#include "rtkDRRGenerator.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkDrawSheppLoganFilter.h"
+#include "rtkConstantImageSource.h"
+
+#include <itkEuler3DTransform.h>
+
+/**
+ * \file rtkdrrgeneratortest.cxx
+ *
+ * \brief Functional test for the computation of DRRs of transformed volumes
+ *
+ * The test computes the DRRs of a sparse grid of pixels of a Shepp-Logan
+ * phantom for the identity transform and for a translation. They are
+ * compared with the projections computed by the Joseph forward projector
+ * of the phantom and of the phantom translated by the inverse translation.
+ * The DRRs computed with empty space skipping must be the same.
+ */
+
+int main(int , char** )
+{
+  constexpr unsigned int Dimension = 3;
+  using OutputPixelType = float;
+  using OutputImageType = itk::Image< OutputPixelType, Dimension >;
+#if FAST_TESTS_NO_CHECKS
+  constexpr unsigned int NumberOfProjectionImages = 2;
+#else
+  constexpr unsigned int NumberOfProjectionImages = 8;
+#endif
+
+  // Constant image sources
+  using ConstantImageSourceType = rtk::ConstantImageSource< OutputImageType >;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource = ConstantImageSourceType::New();
+  origin.Fill(-126.);
+#if FAST_TESTS_NO_CHECKS
+  size.Fill(8);
+  spacing.Fill(32.);
+#else
+  size.Fill(64);
+  spacing.Fill(4.);
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin.Fill(-189.);
+#if FAST_TESTS_NO_CHECKS
+  size.Fill(8);
+  spacing.Fill(48.);
+#else
+  size.Fill(64);
+  spacing.Fill(6.);
+#endif
+  size[2] = NumberOfProjectionImages;
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( projectionsSource->Update() );
+
+  // Geometry object
+  using GeometryType = rtk::ThreeDCircularProjectionGeometry;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(1000., 1500., noProj*360./NumberOfProjectionImages, 3., -2.);
+
+  // Phantom
+  using DSLType = rtk::DrawSheppLoganFilter<OutputImageType, OutputImageType>;
+  DSLType::Pointer dsl = DSLType::New();
+  dsl->SetInput( tomographySource->GetOutput() );
+  dsl->SetPhantomScale(100.);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() );
+
+  // Reference projections
+  using JFPType = rtk::JosephForwardProjectionImageFilter<OutputImageType, OutputImageType>;
+  JFPType::Pointer jfp = JFPType::New();
+  jfp->InPlaceOff();
+  jfp->SetInput( projectionsSource->GetOutput() );
+  jfp->SetInput( 1, dsl->GetOutput() );
+  jfp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( jfp->Update() );
+
+  // Sparse grid of pixels
+  using DRRGeneratorType = rtk::DRRGenerator<OutputImageType>;
+  DRRGeneratorType::PixelIndicesType pixels;
+  DRRGeneratorType::PixelIndexType index;
+  for(index[2]=0; index[2]<(int)size[2]; index[2]++)
+    for(index[1]=0; index[1]<(int)size[1]; index[1]+=3)
+      for(index[0]=0; index[0]<(int)size[0]; index[0]+=3)
+        pixels.push_back(index);
+
+  DRRGeneratorType::Pointer drr = DRRGeneratorType::New();
+  drr->SetVolume( dsl->GetOutput() );
+  drr->SetGeometry( geometry );
+  drr->SetProjectionsInformation( projectionsSource->GetOutput() );
+  drr->SetPixels( pixels );
+
+  // Identity and translation in the same call
+  using TransformType = itk::Euler3DTransform<double>;
+  TransformType::Pointer identity = TransformType::New();
+  TransformType::Pointer translation = TransformType::New();
+  TransformType::OutputVectorType t;
+  t[0] = 10.;
+  t[1] = -5.;
+  t[2] = 3.;
+  translation->SetTranslation(t);
+  DRRGeneratorType::TransformsType transforms;
+  transforms.push_back(identity.GetPointer());
+  transforms.push_back(translation.GetPointer());
+  std::vector<float> values;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( drr->Compute(transforms, values) );
+
+  std::cout << "\n\n****** Case 1: identity ******" << std::endl;
+  for(unsigned int p=0; p<pixels.size(); p++)
+    {
+    const double ref = jfp->GetOutput()->GetPixel(pixels[p]);
+    if( itk::Math::abs(values[p] - ref) > 1e-3 * (1.+itk::Math::abs(ref)) )
+      {
+      std::cerr << "Test Failed, pixel " << pixels[p] << " is " << values[p]
+                << " instead of " << ref << std::endl;
+      exit( EXIT_FAILURE);
+      }
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: empty space skipping ******" << std::endl;
+  std::vector<float> emptySpaceValues;
+  drr->SetEmptySpaceCellSize(4);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( drr->Compute(transforms, emptySpaceValues) );
+  drr->SetEmptySpaceCellSize(0);
+  for(unsigned int p=0; p<values.size(); p++)
+    {
+    if( itk::Math::abs(emptySpaceValues[p] - values[p]) > 1e-5 * (1.+itk::Math::abs(values[p])) )
+      {
+      std::cerr << "Test Failed, value " << p << " is " << emptySpaceValues[p]
+                << " with empty space skipping instead of " << values[p] << std::endl;
+      exit( EXIT_FAILURE);
+      }
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3: translation ******" << std::endl;
+
+  // The transform maps the points of the geometry to the points of the
+  // volume, the DRR is the projection of the volume translated by -t
+  OutputImageType::Pointer translated = dsl->GetOutput();
+  translated->DisconnectPipeline();
+  OutputImageType::PointType translatedOrigin = translated->GetOrigin();
+  for(unsigned int i=0; i<Dimension; i++)
+    translatedOrigin[i] -= t[i];
+  translated->SetOrigin(translatedOrigin);
+  jfp->SetInput( 1, translated );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( jfp->Update() );
+  for(unsigned int p=0; p<pixels.size(); p++)
+    {
+    const double ref = jfp->GetOutput()->GetPixel(pixels[p]);
+    const float value = values[pixels.size() + p];
+    if( itk::Math::abs(value - ref) > 1e-3 * (1.+itk::Math::abs(ref)) )
+      {
+      std::cerr << "Test Failed, pixel " << pixels[p] << " is " << value
+                << " instead of " << ref << std::endl;
+      exit( EXIT_FAILURE);
+      }
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
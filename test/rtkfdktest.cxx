@@ -1,6 +1,8 @@
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
 #include <itkStreamingImageFilter.h>
 #include <itkImageRegionSplitterDirection.h>
+#include <itkCommand.h>
 
 #include "rtkTest.h"
 #include "rtkSheppLoganPhantomFilter.h"
@@ -12,6 +14,9 @@
 #  include "rtkCudaFDKConeBeamReconstructionFilter.h"
 #else
 #  include "rtkFDKConeBeamReconstructionFilter.h"
+#  include "rtkFDKHierarchicalBackProjectionImageFilter.h"
+#  include "rtkProgressiveFDKConeBeamReconstructionFilter.h"
+#  include "rtkFDKPointsBackProjectionImageFilter.h"
 #endif
 
 /**
@@ -27,6 +32,42 @@
  * \author Simon Rit and Marc Vila
  */
 
+#ifndef USE_CUDA
+/** Records the sum of the coarse previews of a progressive reconstruction */
+template<class TFilter>
+class PreviewSumCommand : public itk::Command
+{
+public:
+  using Self = PreviewSumCommand;
+  using Superclass = itk::Command;
+  using Pointer = itk::SmartPointer<Self>;
+  itkNewMacro(Self);
+
+  void Execute(const itk::Object *caller, const itk::EventObject &event) override
+    {
+    Execute( const_cast<itk::Object *>(caller), event);
+    }
+
+  void Execute(itk::Object *caller, const itk::EventObject &event) override
+    {
+    auto *filter = dynamic_cast<TFilter *>(caller);
+    if( !filter || !itk::IterationEvent().CheckEvent(&event) || filter->GetPreviewLevel() == 0 )
+      return;
+    const typename TFilter::OutputImageType *preview = filter->GetPreview();
+    double sum = 0.;
+    itk::ImageRegionConstIterator<typename TFilter::OutputImageType> it(preview, preview->GetLargestPossibleRegion());
+    for(; !it.IsAtEnd(); ++it)
+      sum += it.Get();
+    m_Sums.push_back(sum);
+    }
+
+  std::vector<double> m_Sums;
+
+protected:
+  PreviewSumCommand() = default;
+};
+#endif
+
 int main(int, char** )
 {
   constexpr unsigned int Dimension = 3;
@@ -220,5 +261,157 @@ int main(int, char** )
   TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->UpdateLargestPossibleRegion() )
   CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
   std::cout << "Test PASSED! " << std::endl;
+
+#ifndef USE_CUDA
+  std::cout << "\n\n****** Case 6: hierarchical backprojection ******" << std::endl;
+
+  using HierarchicalBPType = rtk::FDKHierarchicalBackProjectionImageFilter<OutputImageType, OutputImageType>;
+  HierarchicalBPType::Pointer hbp = HierarchicalBPType::New();
+  feldkamp->SetBackProjectionFilter( hbp.GetPointer() );
+  feldkamp->SetProjectionSubsetSize( NumberOfProjectionImages );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.035, 25, 2.0);
+
+  // The result must not depend on the split of the volume between threads
+  OutputImageType::Pointer hbpMultiThreaded = fov->GetOutput();
+  hbpMultiThreaded->DisconnectPipeline();
+#if ITK_VERSION_MAJOR<5
+  hbp->SetNumberOfThreads(1);
+#else
+  hbp->SetNumberOfWorkUnits(1);
+#endif
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), hbpMultiThreaded, 1e-6, 100, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 7: progressive reconstruction ******" << std::endl;
+
+  using ProgressiveFDKType = rtk::ProgressiveFDKConeBeamReconstructionFilter< OutputImageType >;
+  ProgressiveFDKType::Pointer progressive = ProgressiveFDKType::New();
+  progressive->SetInput( 0, tomographySource->GetOutput() );
+  progressive->SetInput( 1, slp->GetOutput() );
+  progressive->SetGeometry( geometry );
+  progressive->SetNumberOfLevels( 3 );
+  using PreviewSumCommandType = PreviewSumCommand<ProgressiveFDKType>;
+  PreviewSumCommandType::Pointer previewSums = PreviewSumCommandType::New();
+  progressive->AddObserver( itk::IterationEvent(), previewSums );
+  fov->SetInput( 0, progressive->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+
+  // A second update must give the same coarse previews and reconstruction
+  progressive->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  const size_t nPreviews = previewSums->m_Sums.size() / 2;
+  if( nPreviews == 0 || previewSums->m_Sums.size() != 2 * nPreviews )
+    {
+    std::cerr << "Unexpected number of coarse previews: " << previewSums->m_Sums.size() << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  for(size_t i=0; i<nPreviews; i++)
+    {
+    const double first = previewSums->m_Sums[i];
+    const double second = previewSums->m_Sums[i+nPreviews];
+    if( std::abs(first - second) > 1e-5 * std::max(1., std::abs(first)) )
+      {
+      std::cerr << "Coarse preview " << i << " differs between two updates: "
+                << first << " and " << second << std::endl;
+      exit(EXIT_FAILURE);
+      }
+    }
+
+  // The final volume must be the one of a single FDK reconstruction
+  FDKType::Pointer singleFDK = FDKType::New();
+  singleFDK->SetInput( 0, tomographySource->GetOutput() );
+  singleFDK->SetInput( 1, slp->GetOutput() );
+  singleFDK->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( singleFDK->Update() );
+  progressive->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( progressive->Update() );
+  CheckImageQuality<OutputImageType>(progressive->GetOutput(), singleFDK->GetOutput(), 1e-5, 90, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 8: backprojection at points ******" << std::endl;
+
+  // Physical coordinates of the voxels of the ROI
+  using PointsBPType = rtk::FDKPointsBackProjectionImageFilter<OutputImageType, OutputImageType>;
+  using PointsImageType = PointsBPType::PointsImageType;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( tomographySource->Update() );
+  PointsImageType::Pointer points = PointsImageType::New();
+  points->CopyInformation( tomographySource->GetOutput() );
+  points->SetRegions( tomographySource->GetOutput()->GetLargestPossibleRegion() );
+  points->Allocate();
+  itk::ImageRegionIteratorWithIndex<PointsImageType> itPoints(points, points->GetLargestPossibleRegion());
+  for(; !itPoints.IsAtEnd(); ++itPoints)
+    {
+    PointsImageType::PointType point;
+    points->TransformIndexToPhysicalPoint(itPoints.GetIndex(), point);
+    itPoints.Set( point.GetVectorFromOrigin() );
+    }
+
+  PointsBPType::Pointer pbp = PointsBPType::New();
+  pbp->SetPoints( points );
+  feldkamp->SetBackProjectionFilter( pbp.GetPointer() );
+  feldkamp->SetProjectionSubsetSize( 16 );
+  fov->SetInput( 0, feldkamp->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 9: detector displacement field ******" << std::endl;
+
+  // Coarse field with a magnification and a shift of the pixels, the
+  // projections are simulated and reconstructed with the same field
+  using FieldType = GeometryType::DetectorDisplacementFieldType;
+  FieldType::Pointer field = FieldType::New();
+  FieldType::SizeType fieldSize;
+  fieldSize.Fill(9);
+  FieldType::SpacingType fieldSpacing;
+  fieldSpacing.Fill(75.);
+  FieldType::PointType fieldOrigin;
+  fieldOrigin.Fill(-300.);
+  field->SetRegions(fieldSize);
+  field->SetSpacing(fieldSpacing);
+  field->SetOrigin(fieldOrigin);
+  field->Allocate();
+  itk::ImageRegionIteratorWithIndex<FieldType> itField(field, field->GetLargestPossibleRegion());
+  for(; !itField.IsAtEnd(); ++itField)
+    {
+    FieldType::PointType point;
+    field->TransformIndexToPhysicalPoint(itField.GetIndex(), point);
+    FieldType::PixelType displacement;
+    displacement[0] = 3. + 0.01 * point[0];
+    displacement[1] = -2. + 0.01 * point[1];
+    itField.Set(displacement);
+    }
+  geometry->SetDetectorDisplacementField(field);
+
+  // The inverse displacement sampled on the grid of the field must undo the
+  // displacement
+  for(double u=-200.; u<=200.; u+=37.)
+    {
+    for(double v=-200.; v<=200.; v+=41.)
+      {
+      double du = u;
+      double dv = v;
+      geometry->ApplyDetectorDisplacement(du, dv);
+      geometry->ApplyInverseDetectorDisplacement(du, dv);
+      if(itk::Math::abs(du-u) > 1e-3 || itk::Math::abs(dv-v) > 1e-3)
+        {
+        std::cerr << "Test Failed, inverse displacement of (" << u << "," << v
+                  << ") gives (" << du << "," << dv << ")" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  slp->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() );
+
+  feldkamp->SetBackProjectionFilter( rtk::FDKBackProjectionImageFilter<OutputImageType, OutputImageType>::New().GetPointer() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+#endif
   return EXIT_SUCCESS;
 }
@@ -230,5 +230,74 @@ int main(int , char** )
   CheckImageQuality<OutputImageType>(stream->GetOutput(), slp->GetOutput(), 1.28, 44, 255.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+#ifndef USE_CUDA
+  std::cout << "\n\n****** Case 6: Shepp-Logan, inner ray source, bricked volume ******" << std::endl;
+
+  // 5 does not divide the volume size and tests the padding of the last bricks
+  const unsigned int brickSizes[2] = {8, 5};
+  for(unsigned int brickSize : brickSizes)
+    {
+    jfp->SetBrickSize(brickSize);
+    stream->Update();
+
+    CheckImageQuality<OutputImageType>(stream->GetOutput(), slp->GetOutput(), 1.28, 44, 255.0);
+    std::cout << "\n\nTest with bricks of " << brickSize << " voxels PASSED! " << std::endl;
+    }
+
+  std::cout << "\n\n****** Case 7: Shepp-Logan, explicit non-zero input projections ******" << std::endl;
+
+  // The projections of both filters are otherwise implicit constant inputs
+  projInput->SetConstant( 1. );
+  projInput->Update();
+  OutputImageType::Pointer ones = OutputImageType::New();
+  ones->CopyInformation( projInput->GetOutput() );
+  ones->SetRegions( projInput->GetOutput()->GetLargestPossibleRegion() );
+  ones->Allocate();
+  ones->FillBuffer( 1. );
+  jfp->SetInput( ones );
+  slp->Update();
+  stream->Update();
+
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), slp->GetOutput(), 1.28, 44, 255.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 8: Shepp-Logan, empty space skipping ******" << std::endl;
+
+  // Skipping the zero voxels outside the phantom must not change the
+  // projections, 5 does not divide the volume size
+  OutputImageType::Pointer reference = stream->GetOutput();
+  reference->DisconnectPipeline();
+  const unsigned int cellSizes[2] = {8, 5};
+  for(unsigned int cellSize : cellSizes)
+    {
+    jfp->SetEmptySpaceCellSize(cellSize);
+    stream->Update();
+
+    CheckImageQuality<OutputImageType>(stream->GetOutput(), reference, 1e-3, 100., 255.0);
+    std::cout << "\n\nTest with cells of " << cellSize << " voxels PASSED! " << std::endl;
+    }
+
+  std::cout << "\n\n****** Case 9: detector tiles ******" << std::endl;
+
+  // The tiles only change the distribution of the rays to the threads, 7
+  // does not divide the projection size
+  jfp->SetEmptySpaceCellSize(0);
+  rbi->Update();
+  OutputImageType::Pointer rbiReference = rbi->GetOutput();
+  rbiReference->DisconnectPipeline();
+  const unsigned int tileSizes[2] = {32, 7};
+  for(unsigned int tileSize : tileSizes)
+    {
+    jfp->SetTileSize(tileSize);
+    stream->Update();
+    CheckImageQuality<OutputImageType>(stream->GetOutput(), reference, 1e-6, 150., 255.0);
+
+    rbi->SetTileSize(tileSize);
+    rbi->Update();
+    CheckImageQuality<OutputImageType>(rbi->GetOutput(), rbiReference, 1e-6, 150., 255.0);
+    std::cout << "\n\nTest with tiles of " << tileSize << " pixels PASSED! " << std::endl;
+    }
+#endif
+
   return EXIT_SUCCESS;
 }
@@ -1,11 +1,15 @@
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
 #include <itkBinaryThresholdImageFilter.h>
 
 #include "rtkTest.h"
 #include "rtkMacro.h"
 #include "rtkFieldOfViewImageFilter.h"
+#include "rtkConvexFieldOfViewImageFilter.h"
 #include "rtkConstantImageSource.h"
 #include "rtkBackProjectionImageFilter.h"
+#include "rtkFDKBackProjectionImageFilter.h"
+#include "rtkMaskCollimationImageFilter.h"
 
 /**
  * \file rtkfovtest.cxx
@@ -145,5 +149,120 @@ int main(int , char** )
   CheckImageQuality<OutputImageType>(fov->GetOutput(), threshold->GetOutput(), 0.02, 23.5, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 3: convex field of view, offset detector ******" << std::endl;
+
+  using ConvexFOVFilterType = rtk::ConvexFieldOfViewImageFilter<OutputImageType, OutputImageType>;
+  ConvexFOVFilterType::Pointer convexFOV = ConvexFOVFilterType::New();
+  convexFOV->SetInput(0, fovInput->GetOutput());
+  convexFOV->SetProjectionsStack(projectionsSource->GetOutput());
+  convexFOV->SetGeometry( geometry );
+  convexFOV->SetDisplacedDetector(true);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( convexFOV->Update() );
+
+  CheckImageQuality<OutputImageType>(convexFOV->GetOutput(), threshold->GetOutput(), 0.02, 23.5, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 4: convex field of view, centered detector, short scan ******" << std::endl;
+
+  origin[0] = -254.;
+  projectionsSource->SetOrigin( origin );
+  size[0] = 128;
+  projectionsSource->SetSize( size );
+  geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600, 1200., noProj*200./NumberOfProjectionImages);
+  bp->SetGeometry( geometry.GetPointer() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( threshold->Update() );
+
+  convexFOV->SetGeometry( geometry );
+  convexFOV->SetDisplacedDetector(false);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( convexFOV->Update() );
+
+  CheckImageQuality<OutputImageType>(convexFOV->GetOutput(), threshold->GetOutput(), 0.02, 23.5, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 5: convex field of view, collimated full scan ******" << std::endl;
+
+  // Asymmetric jaws narrower than the detector in the plane of the isocenter
+  const double uinf = 50.;
+  const double usup = 80.;
+  const double vinf = 40.;
+  const double vsup = 60.;
+  geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    {
+    geometry->AddProjection(600, 1200., noProj*360./NumberOfProjectionImages);
+    geometry->SetCollimationOfLastProjection(uinf, usup, vinf, vsup);
+    }
+
+  // Reference: backprojection of the collimated projections
+  using MaskCollimationType = rtk::MaskCollimationImageFilter<OutputImageType, OutputImageType>;
+  MaskCollimationType::Pointer collimation = MaskCollimationType::New();
+  collimation->SetInput( projectionsSource->GetOutput() );
+  collimation->SetGeometry( geometry );
+  bp->SetInput( 1, collimation->GetOutput() );
+  bp->SetGeometry( geometry.GetPointer() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( threshold->Update() );
+
+  convexFOV->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( convexFOV->Update() );
+
+  CheckImageQuality<OutputImageType>(convexFOV->GetOutput(), threshold->GetOutput(), 0.02, 23.5, 2.0);
+
+  // With a full scan, a voxel in the collimated cone is at most at uinf from
+  // the rotation axis and its height is between -vinf and vsup
+  unsigned int nInside = 0;
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> itFOV(convexFOV->GetOutput(),
+                                                                convexFOV->GetOutput()->GetLargestPossibleRegion());
+  for(; !itFOV.IsAtEnd(); ++itFOV)
+    {
+    if(itFOV.Get() == 0.)
+      continue;
+    nInside++;
+    OutputImageType::PointType point;
+    convexFOV->GetOutput()->TransformIndexToPhysicalPoint(itFOV.GetIndex(), point);
+    if(std::sqrt(point[0]*point[0] + point[2]*point[2]) > uinf ||
+       point[1] < -vinf ||
+       point[1] > vsup)
+      {
+      std::cerr << "Test Failed, voxel " << itFOV.GetIndex() << " at " << point
+                << " is outside the collimated cone but not masked." << std::endl;
+      exit(EXIT_FAILURE);
+      }
+    }
+#if !FAST_TESTS_NO_CHECKS
+  if(nInside == 0)
+    {
+    std::cerr << "Test Failed, the collimated field of view is empty." << std::endl;
+    exit(EXIT_FAILURE);
+    }
+#endif
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 6: FDK backprojection skipping the voxels outside the field of view ******" << std::endl;
+
+  // Reference: backprojection masked by the convex field of view
+  using FDKBPType = rtk::FDKBackProjectionImageFilter<OutputImageType, OutputImageType>;
+  FDKBPType::Pointer fdkbp = FDKBPType::New();
+  fdkbp->InPlaceOff();
+  fdkbp->SetInput( 0, bpInput->GetOutput() );
+  fdkbp->SetInput( 1, projectionsSource->GetOutput() );
+  fdkbp->SetGeometry( geometry );
+  convexFOV->InPlaceOff();
+  convexFOV->SetInput( 0, fdkbp->GetOutput() );
+  convexFOV->SetMask(false);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( convexFOV->Update() );
+
+  FDKBPType::Pointer fdkbpSkip = FDKBPType::New();
+  fdkbpSkip->InPlaceOff();
+  fdkbpSkip->SetInput( 0, bpInput->GetOutput() );
+  fdkbpSkip->SetInput( 1, projectionsSource->GetOutput() );
+  fdkbpSkip->SetGeometry( geometry );
+  fdkbpSkip->SkipOutsideFieldOfViewOn();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fdkbpSkip->Update() );
+
+  CheckImageQuality<OutputImageType>(fdkbpSkip->GetOutput(), convexFOV->GetOutput(), 1e-6, 150., 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
   return EXIT_SUCCESS;
 }
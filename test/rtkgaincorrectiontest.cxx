@@ -23,6 +23,7 @@
 #include <cmath>
 #include <itkImageRegionConstIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
+#include <itkStreamingImageFilter.h>
 
 #ifdef RTK_USE_CUDA
 #include "rtkCudaPolynomialGainCorrectionImageFilter.h"
@@ -37,6 +38,8 @@
  *
  * \brief Functional test for the polynomial gain correction filter
  *
+ * The correction is checked on the whole image and streamed in bands of rows.
+ *
  * \author Sebastien Brousmiche
  */
 
@@ -232,6 +235,28 @@ OutputImageType::Pointer generateExpectedOutput(InputImageType::Pointer inputIma
     return expectedOutput;
 }
 
+void CheckCorrectedImage(OutputImageType::Pointer outputImage, OutputImageType::Pointer expectedOutput)
+{
+  itk::ImageRegionConstIterator<OutputImageType>  itExp(expectedOutput, expectedOutput->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<OutputImageType>  itOut(outputImage, outputImage->GetLargestPossibleRegion());
+
+  itExp.GoToBegin();
+  itOut.GoToBegin();
+  float diffValue = 0.f;
+  while (!itExp.IsAtEnd())
+  {
+      diffValue += itk::Math::abs(itExp.Get() - itOut.Get());
+      ++itExp;
+      ++itOut;
+  }
+  diffValue /= static_cast<float>(sizeI*sizeI);
+  std::cout << diffValue << std::endl;
+  if (!(diffValue< 1.f))
+  {
+    std::cerr << "Test Failed! "<< std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
 
 int main(int , char** )
 {
@@ -263,25 +288,21 @@ int main(int , char** )
   OutputImageType::Pointer expectedOutput = generateExpectedOutput(testImage, K, darkImage, gainImage);
 
   // Compare
-  itk::ImageRegionConstIterator<OutputImageType>  itExp(expectedOutput, expectedOutput->GetLargestPossibleRegion());
-  itk::ImageRegionConstIterator<OutputImageType>  itOut(outputImage, outputImage->GetLargestPossibleRegion());
-
-  itExp.GoToBegin();
-  itOut.GoToBegin();
-  float diffValue = 0.f;
-  while (!itExp.IsAtEnd())
-  {
-      diffValue += itk::Math::abs(itExp.Get() - itOut.Get());
-      ++itExp;
-      ++itOut;
-  }
-  diffValue /= static_cast<float>(sizeI*sizeI);
-  std::cout << diffValue << std::endl;
-  if (!(diffValue< 1.f))
-  {
-    std::cerr << "Test Failed! "<< std::endl;
-    exit(EXIT_FAILURE);
-  }
+  CheckCorrectedImage(outputImage, expectedOutput);
+
+  // Streamed correction, in bands of rows
+  GainCorrectionType::Pointer streamedGainfilter = GainCorrectionType::New();
+  streamedGainfilter->SetDarkImage(darkImage);
+  streamedGainfilter->SetGainCoefficients(gainImage);
+  streamedGainfilter->SetK(K);
+  streamedGainfilter->SetInput(testImage);
+
+  using StreamingType = itk::StreamingImageFilter<OutputImageType, OutputImageType>;
+  StreamingType::Pointer streamer = StreamingType::New();
+  streamer->SetInput(streamedGainfilter->GetOutput());
+  streamer->SetNumberOfStreamDivisions(7);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION(streamer->Update())
+  CheckCorrectedImage(streamer->GetOutput(), expectedOutput);
 
   std::cout << "\n\nTest PASSED! " << std::endl;
 
@@ -0,0 +1,180 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkDrawSheppLoganFilter.h"
+#include "rtkNUFFTForwardProjectionImageFilter.h"
+#include "rtkNUFFTBackProjectionImageFilter.h"
+
+#include <itkRandomImageSource.h>
+
+/**
+ * \file rtknufftprojectorstest.cxx
+ *
+ * \brief Functional test for the NUFFT projectors
+ *
+ * The test first checks that the NUFFT back projector is the adjoint of the
+ * NUFFT forward projector by comparing the scalar products <Rv , p> and
+ * <v, R* p> for a random volume v and random projections p in a parallel
+ * geometry with detector offsets and out-of-plane angles. It then forward
+ * projects a Shepp-Logan phantom and compares it with the analytical
+ * projections, checks that the cached spectrum of the volume is recomputed
+ * when the volume changes and that a detector displacement field is rejected.
+ */
+
+int main(int, char** )
+{
+  constexpr unsigned int Dimension = 3;
+  using OutputPixelType = double;
+  using OutputImageType = itk::Image< OutputPixelType, Dimension >;
+
+#if FAST_TESTS_NO_CHECKS
+  constexpr unsigned int NumberOfProjectionImages = 3;
+#else
+  constexpr unsigned int NumberOfProjectionImages = 60;
+#endif
+
+  // Image sources
+  using RandomImageSourceType = itk::RandomImageSource< OutputImageType >;
+  RandomImageSourceType::Pointer randomVolumeSource  = RandomImageSourceType::New();
+  RandomImageSourceType::Pointer randomProjectionsSource = RandomImageSourceType::New();
+  using ConstantImageSourceType = rtk::ConstantImageSource< OutputImageType >;
+  ConstantImageSourceType::Pointer constantVolumeSource = ConstantImageSourceType::New();
+  ConstantImageSourceType::Pointer constantProjectionsSource = ConstantImageSourceType::New();
+
+  // Volume metadata
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+  origin.Fill(-126.);
+#if FAST_TESTS_NO_CHECKS
+  size.Fill(2);
+  spacing.Fill(252.);
+#else
+  size.Fill(64);
+  spacing.Fill(4.);
+#endif
+  randomVolumeSource->SetOrigin( origin );
+  randomVolumeSource->SetSpacing( spacing );
+  randomVolumeSource->SetSize( size );
+  randomVolumeSource->SetMin( 0. );
+  randomVolumeSource->SetMax( 1. );
+  constantVolumeSource->SetOrigin( origin );
+  constantVolumeSource->SetSpacing( spacing );
+  constantVolumeSource->SetSize( size );
+  constantVolumeSource->SetConstant( 0. );
+
+  // Projections metadata
+  origin.Fill(-254.);
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  spacing.Fill(508.);
+#else
+  size[0] = 64;
+  size[1] = 64;
+  spacing.Fill(8.);
+#endif
+  size[2] = NumberOfProjectionImages;
+  randomProjectionsSource->SetOrigin( origin );
+  randomProjectionsSource->SetSpacing( spacing );
+  randomProjectionsSource->SetSize( size );
+  randomProjectionsSource->SetMin( 0. );
+  randomProjectionsSource->SetMax( 100. );
+  constantProjectionsSource->SetOrigin( origin );
+  constantProjectionsSource->SetSpacing( spacing );
+  constantProjectionsSource->SetSize( size );
+  constantProjectionsSource->SetConstant( 0. );
+
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( randomVolumeSource->Update() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( randomProjectionsSource->Update() );
+
+  // Parallel geometry with detector offsets and out-of-plane angles
+  using GeometryType = rtk::ThreeDCircularProjectionGeometry;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 0., noProj*360./NumberOfProjectionImages, 7., -5., 10.*(noProj%3));
+
+  std::cout << "\n\n****** NUFFT forward projector ******" << std::endl;
+  using FPType = rtk::NUFFTForwardProjectionImageFilter<OutputImageType, OutputImageType, double>;
+  FPType::Pointer fp = FPType::New();
+  fp->SetInput(0, constantProjectionsSource->GetOutput());
+  fp->SetInput(1, randomVolumeSource->GetOutput());
+  fp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fp->Update() );
+
+  std::cout << "\n\n****** NUFFT back projector ******" << std::endl;
+  using BPType = rtk::NUFFTBackProjectionImageFilter<OutputImageType, OutputImageType, double>;
+  BPType::Pointer bp = BPType::New();
+  bp->SetInput(0, constantVolumeSource->GetOutput());
+  bp->SetInput(1, randomProjectionsSource->GetOutput());
+  bp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bp->Update() );
+
+  CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(),
+                                                        bp->GetOutput(),
+                                                        randomProjectionsSource->GetOutput(),
+                                                        fp->GetOutput());
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  OutputImageType::Pointer randomProjections = fp->GetOutput();
+  randomProjections->DisconnectPipeline();
+  GeometryType::Pointer randomGeometry = geometry;
+
+  std::cout << "\n\n****** Shepp-Logan, NUFFT forward projector ******" << std::endl;
+  geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 0., noProj*360./NumberOfProjectionImages);
+
+  using SLPType = rtk::SheppLoganPhantomFilter<OutputImageType, OutputImageType>;
+  SLPType::Pointer slp = SLPType::New();
+  slp->SetInput( constantProjectionsSource->GetOutput() );
+  slp->SetGeometry(geometry);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() );
+
+  using DSLType = rtk::DrawSheppLoganFilter<OutputImageType, OutputImageType>;
+  DSLType::Pointer dsl = DSLType::New();
+  dsl->SetInput( constantVolumeSource->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() );
+
+  fp->SetInput(1, dsl->GetOutput());
+  fp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fp->Update() );
+
+  CheckImageQuality<OutputImageType>(fp->GetOutput(), slp->GetOutput(), 1.1, 38, 255.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Random volume again, cached spectrum ******" << std::endl;
+  fp->SetInput(1, randomVolumeSource->GetOutput());
+  fp->SetGeometry( randomGeometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fp->Update() );
+  CheckImageQuality<OutputImageType>(fp->GetOutput(), randomProjections, 1e-10, 200, 100.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Detector displacement field ******" << std::endl;
+  using FieldType = GeometryType::DetectorDisplacementFieldType;
+  FieldType::Pointer field = FieldType::New();
+  FieldType::SizeType fieldSize;
+  fieldSize.Fill(2);
+  field->SetRegions(fieldSize);
+  field->Allocate();
+  FieldType::PixelType zero;
+  zero.Fill(0.);
+  field->FillBuffer(zero);
+  geometry->SetDetectorDisplacementField(field);
+  fp->SetGeometry( geometry );
+  fp->Modified();
+  try
+    {
+    fp->Update();
+    std::cerr << "The NUFFT forward projector accepted a detector displacement field." << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
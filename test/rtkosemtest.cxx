@@ -175,6 +175,15 @@ int main(int, char** )
   CheckImageQuality<OutputImageType>(osem->GetOutput(), dsl->GetOutput(), 0.032, 25.0, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 2b: same as case 2, one forward and back projection per subset ******" << std::endl;
+
+  osem->BatchSubsetsOn();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( osem->Update() );
+
+  CheckImageQuality<OutputImageType>(osem->GetOutput(), dsl->GetOutput(), 0.032, 25.0, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  osem->BatchSubsetsOff();
+
   std::cout << "\n\n****** Case 3: Voxel-Based Backprojector, OS-EM with 10 projections per subset and 3 iterations******" << std::endl;
 
   osem->SetNumberOfIterations(3);
@@ -186,6 +195,27 @@ int main(int, char** )
   CheckImageQuality<OutputImageType>(osem->GetOutput(), dsl->GetOutput(), 0.032, 25, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 3b: same as case 3, backprojections updated concurrently ******" << std::endl;
+
+  // New filters so that both process the projections in the same random order
+  OSEMType::Pointer osemBranches[2];
+  for(unsigned int i=0; i<2; i++)
+    {
+    osemBranches[i] = OSEMType::New();
+    osemBranches[i]->SetInput(0, volumeSource->GetOutput() );
+    osemBranches[i]->SetInput(1, rei->GetOutput());
+    osemBranches[i]->SetGeometry( geometry );
+    osemBranches[i]->SetNumberOfIterations(3);
+    osemBranches[i]->SetBackProjectionFilter(OSEMType::BP_VOXELBASED);
+    osemBranches[i]->SetForwardProjectionFilter(OSEMType::FP_JOSEPH);
+    osemBranches[i]->SetNumberOfProjectionsPerSubset(10);
+    osemBranches[i]->SetConcurrentBranches( i==1 );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( osemBranches[i]->Update() );
+    }
+
+  CheckImageQuality<OutputImageType>(osemBranches[1]->GetOutput(), osemBranches[0]->GetOutput(), 1e-6, 100, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
 #ifdef USE_CUDA
   std::cout << "\n\n****** Case 4: CUDA Voxel-Based Backprojector ******" << std::endl;
 
@@ -0,0 +1,203 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkProjectionsCacheImageFilter.h"
+
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <fstream>
+
+/**
+ * \file rtkprojectionscachetest.cxx
+ *
+ * \brief Functional test for the cache of projections
+ *
+ * The test reads analytical projections of the Shepp-Logan phantom through
+ * rtk::ProjectionsCacheImageFilter, subset after subset in a shuffled order,
+ * and compares them to the projections computed at once. It checks that each
+ * projection is computed only once with an unlimited cache, with and without
+ * prefetching, and that the projections are still correct when the memory
+ * budget forces to compute them again. Finally, the projections are stored
+ * in a file and read from it asynchronously, subset after subset, and an
+ * existing file is not overwritten.
+ */
+
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image< float, Dimension >;
+using CacheType = rtk::ProjectionsCacheImageFilter<ImageType>;
+
+int ReadAllSubsets(CacheType *cache, ImageType *reference, unsigned int nProjPerSubset)
+{
+  ImageType::RegionType subsetRegion = reference->GetLargestPossibleRegion();
+  const unsigned int nProj = subsetRegion.GetSize(Dimension-1);
+  for(unsigned int i=0; i<nProj; i+=nProjPerSubset)
+    {
+    subsetRegion.SetIndex(Dimension-1, i);
+    subsetRegion.SetSize(Dimension-1, std::min(nProjPerSubset, nProj-i));
+    cache->GetOutput()->SetRequestedRegion(subsetRegion);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( cache->GetOutput()->Update() );
+
+    itk::ImageRegionConstIteratorWithIndex<ImageType> it(cache->GetOutput(), subsetRegion);
+    for(; !it.IsAtEnd(); ++it)
+      {
+      ImageType::IndexType idx = it.GetIndex();
+      idx[Dimension-1] = cache->GetProjectionOrder()[idx[Dimension-1]];
+      if( std::abs(it.Get() - reference->GetPixel(idx)) > 1e-6 )
+        {
+        std::cerr << "Test Failed, projection " << idx[Dimension-1] << " differs at "
+                  << it.GetIndex() << ": " << it.Get() << " instead of "
+                  << reference->GetPixel(idx) << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+int main(int, char** )
+{
+#if FAST_TESTS_NO_CHECKS
+  constexpr unsigned int NumberOfProjectionImages = 6;
+#else
+  constexpr unsigned int NumberOfProjectionImages = 36;
+#endif
+  constexpr unsigned int NumberOfProjectionsPerSubset = 4;
+
+  // Projections metadata
+  using ConstantImageSourceType = rtk::ConstantImageSource< ImageType >;
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+  origin.Fill(-254.);
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = NumberOfProjectionImages;
+  spacing.Fill(8.);
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  using GeometryType = rtk::ThreeDCircularProjectionGeometry;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Reference projections and lazily computed projections
+  using SLPType = rtk::SheppLoganPhantomFilter<ImageType, ImageType>;
+  SLPType::Pointer reference = SLPType::New();
+  reference->SetInput( projectionsSource->GetOutput() );
+  reference->SetGeometry(geometry);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( reference->Update() );
+
+  SLPType::Pointer slp = SLPType::New();
+  slp->SetInput( projectionsSource->GetOutput() );
+  slp->SetGeometry(geometry);
+
+  // Shuffled order of the projections
+  CacheType::ProjectionOrderType order(NumberOfProjectionImages);
+  for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+    order[i] = (5*i) % NumberOfProjectionImages;
+  std::reverse(order.begin(), order.end());
+
+  const unsigned int prefetchSizes[2] = {0, NumberOfProjectionsPerSubset};
+  for(unsigned int prefetchSize : prefetchSizes)
+    {
+    std::cout << "\n\n****** Unlimited cache, prefetch size " << prefetchSize << " ******" << std::endl;
+    CacheType::Pointer cache = CacheType::New();
+    cache->SetInput( slp->GetOutput() );
+    cache->SetProjectionOrder(order);
+    cache->SetPrefetchSize(prefetchSize);
+    for(unsigned int iter=0; iter<2; iter++)
+      if( ReadAllSubsets(cache, reference->GetOutput(), NumberOfProjectionsPerSubset) == EXIT_FAILURE )
+        return EXIT_FAILURE;
+    if( cache->GetNumberOfReadProjections() != NumberOfProjectionImages )
+      {
+      std::cerr << "Test Failed, " << cache->GetNumberOfReadProjections()
+                << " projections computed instead of " << NumberOfProjectionImages << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::cout << "\n\nTest PASSED! " << std::endl;
+    }
+
+  std::cout << "\n\n****** Cache of half of the projections ******" << std::endl;
+  CacheType::Pointer cache = CacheType::New();
+  cache->SetInput( slp->GetOutput() );
+  cache->SetProjectionOrder(order);
+  cache->SetPrefetchSize(NumberOfProjectionsPerSubset);
+  cache->SetMemoryBudget(NumberOfProjectionImages / 2 * size[0] * size[1] * sizeof(float));
+  for(unsigned int iter=0; iter<2; iter++)
+    if( ReadAllSubsets(cache, reference->GetOutput(), NumberOfProjectionsPerSubset) == EXIT_FAILURE )
+      return EXIT_FAILURE;
+  if( cache->GetNumberOfReadProjections() <= NumberOfProjectionImages )
+    {
+    std::cerr << "Test Failed, the cache should not hold all projections" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Projections stored in a file ******" << std::endl;
+  const char fileName[] = "rtkprojectionscachetest.raw";
+  if( itksys::SystemTools::FileExists(fileName) )
+    itksys::SystemTools::RemoveFile(fileName);
+  cache = CacheType::New();
+  cache->SetInput( slp->GetOutput() );
+  cache->SetProjectionOrder(order);
+  cache->SetPrefetchSize(NumberOfProjectionsPerSubset);
+  cache->SetStoreFileName(fileName);
+  for(unsigned int iter=0; iter<2; iter++)
+    if( ReadAllSubsets(cache, reference->GetOutput(), NumberOfProjectionsPerSubset) == EXIT_FAILURE )
+      return EXIT_FAILURE;
+  if( cache->GetNumberOfReadProjections() != NumberOfProjectionImages )
+    {
+    std::cerr << "Test Failed, " << cache->GetNumberOfReadProjections()
+              << " projections computed instead of " << NumberOfProjectionImages << std::endl;
+    return EXIT_FAILURE;
+    }
+  cache = nullptr;
+  if( itksys::SystemTools::FileExists(fileName) )
+    {
+    std::cerr << "Test Failed, " << fileName << " has not been deleted" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Existing store file ******" << std::endl;
+  const std::string userContent = "user data";
+  {
+  std::ofstream userFile(fileName);
+  userFile << userContent;
+  }
+  cache = CacheType::New();
+  cache->SetInput( slp->GetOutput() );
+  cache->SetStoreFileName(fileName);
+  try
+    {
+    cache->Update();
+    std::cerr << "Test Failed, the existing file " << fileName << " has been used as store" << std::endl;
+    return EXIT_FAILURE;
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    }
+  cache = nullptr;
+  std::string content;
+  {
+  std::ifstream userFile(fileName);
+  std::getline(userFile, content);
+  }
+  itksys::SystemTools::RemoveFile(fileName);
+  if( content != userContent )
+    {
+    std::cerr << "Test Failed, the existing file " << fileName << " has been modified or deleted" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
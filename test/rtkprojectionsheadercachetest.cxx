@@ -0,0 +1,214 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkProjectionsHeaderCache.h"
+#include "rtkProjectionsReader.h"
+
+#include <itkImageFileWriter.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkMetaDataObject.h>
+#include <itkMetaImageIO.h>
+#if ITK_VERSION_MAJOR<5
+  #include <itkMultiThreader.h>
+#else
+  #include <itkMultiThreaderBase.h>
+#endif
+#include <itksys/SystemTools.hxx>
+
+#include <sstream>
+
+/**
+ * \file rtkprojectionsheadercachetest.cxx
+ *
+ * \brief Test of the cache of the headers of projection files
+ *
+ * The test writes projections in MetaImage files and scans their headers
+ * with several workers. It checks that the headers are found in the cache
+ * with their dictionary, that they are not read again when they are up to
+ * date, that a modified file is read again and that an error of a worker is
+ * reported. Finally, the projections are read by rtk::ProjectionsReader
+ * which must use the cached image IO and remove the headers when it is
+ * deleted.
+ */
+
+constexpr unsigned int Dimension = 3;
+using ProjectionType = itk::Image< float, Dimension-1 >;
+using StackType = itk::Image< float, Dimension >;
+
+void WriteProjection(const std::string &fileName, float value, unsigned int sizeX)
+{
+  ProjectionType::SizeType size;
+  size[0] = sizeX;
+  size[1] = 6;
+  ProjectionType::Pointer projection = ProjectionType::New();
+  projection->SetRegions(size);
+  projection->Allocate();
+  projection->FillBuffer(value);
+
+  std::ostringstream os;
+  os << value;
+  itk::EncapsulateMetaData<std::string>(projection->GetMetaDataDictionary(), "Value", os.str());
+
+  using WriterType = itk::ImageFileWriter<ProjectionType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(fileName);
+  writer->SetInput(projection);
+  writer->Update();
+}
+
+rtk::ProjectionsHeaderCache::ImageIOPointer CreateMetaImageIO()
+{
+  return itk::MetaImageIO::New().GetPointer();
+}
+
+int main(int, char** )
+{
+  const std::string directory = "rtkprojectionsheadercachetest";
+  itksys::SystemTools::MakeDirectory(directory);
+  const unsigned int nProj = 20;
+  std::vector<std::string> fileNames;
+  for(unsigned int i=0; i<nProj; i++)
+    {
+    std::ostringstream os;
+    os << directory << "/proj" << i << ".mha";
+    fileNames.push_back(os.str());
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( WriteProjection(fileNames.back(), i, 8) )
+    }
+
+  // Several workers even on a single core
+#if ITK_VERSION_MAJOR<5
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(4);
+#else
+  itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads(4);
+#endif
+
+  std::cout << "\n\n****** Scan ******" << std::endl;
+  rtk::ProjectionsHeaderCache::Clear();
+  if(rtk::ProjectionsHeaderCache::GetImageIO(fileNames[0]))
+    {
+    std::cerr << "Test Failed, a header has been found before scanning" << std::endl;
+    return EXIT_FAILURE;
+    }
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rtk::ProjectionsHeaderCache::Scan(fileNames, CreateMetaImageIO) )
+  if(rtk::ProjectionsHeaderCache::GetNumberOfHeaders() != nProj)
+    {
+    std::cerr << "Test Failed, " << rtk::ProjectionsHeaderCache::GetNumberOfHeaders()
+              << " headers in the cache instead of " << nProj << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::vector<rtk::ProjectionsHeaderCache::ImageIOPointer> imageIOs;
+  for(unsigned int i=0; i<nProj; i++)
+    {
+    imageIOs.push_back( rtk::ProjectionsHeaderCache::GetImageIO(fileNames[i], "MetaImageIO") );
+    if(imageIOs.back().IsNull() || imageIOs.back()->GetDimensions(0) != 8)
+      {
+      std::cerr << "Test Failed, wrong header of " << fileNames[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    itk::MetaDataDictionary dic;
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( dic = rtk::ProjectionsHeaderCache::GetMetaDataDictionary(fileNames[i], "MetaImageIO") )
+    std::string value;
+    std::ostringstream os;
+    os << i;
+    if(!itk::ExposeMetaData<std::string>(dic, "Value", value) || value != os.str())
+      {
+      std::cerr << "Test Failed, wrong dictionary of " << fileNames[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if(rtk::ProjectionsHeaderCache::GetImageIO(fileNames[0], "HndImageIO"))
+    {
+    std::cerr << "Test Failed, a header has been found with another image IO" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Up to date and modified headers ******" << std::endl;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( WriteProjection(fileNames[3], 3, 10) )
+  if(rtk::ProjectionsHeaderCache::GetImageIO(fileNames[3], "MetaImageIO"))
+    {
+    std::cerr << "Test Failed, the header of a modified file is still valid" << std::endl;
+    return EXIT_FAILURE;
+    }
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rtk::ProjectionsHeaderCache::Scan(fileNames, CreateMetaImageIO) )
+  for(unsigned int i=0; i<nProj; i++)
+    {
+    rtk::ProjectionsHeaderCache::ImageIOPointer imageIO;
+    imageIO = rtk::ProjectionsHeaderCache::GetImageIO(fileNames[i], "MetaImageIO");
+    if( (i == 3) == (imageIO == imageIOs[i]) )
+      {
+      std::cerr << "Test Failed, the header of " << fileNames[i]
+                << ((i==3)?" has not":" has") << " been read again" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if(rtk::ProjectionsHeaderCache::GetImageIO(fileNames[3])->GetDimensions(0) != 10)
+    {
+    std::cerr << "Test Failed, wrong header of the modified file" << std::endl;
+    return EXIT_FAILURE;
+    }
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( WriteProjection(fileNames[3], 3, 8) )
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Error of a worker ******" << std::endl;
+  std::vector<std::string> wrongFileNames = fileNames;
+  wrongFileNames.push_back(directory + "/missing.mha");
+  bool thrown = false;
+  try
+    {
+    rtk::ProjectionsHeaderCache::Scan(wrongFileNames, CreateMetaImageIO);
+    }
+  catch(itk::ExceptionObject &)
+    {
+    thrown = true;
+    }
+  if(!thrown)
+    {
+    std::cerr << "Test Failed, the missing file has not been reported" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** ProjectionsReader ******" << std::endl;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rtk::ProjectionsHeaderCache::Scan(fileNames, CreateMetaImageIO) )
+  {
+  using ReaderType = rtk::ProjectionsReader< StackType >;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileNames(fileNames);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( reader->Update() )
+  if(reader->GetImageIO() != rtk::ProjectionsHeaderCache::GetImageIO(fileNames[0], "MetaImageIO"))
+    {
+    std::cerr << "Test Failed, the reader has not used the cached image IO" << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ImageRegionConstIteratorWithIndex<StackType> it(reader->GetOutput(),
+                                                       reader->GetOutput()->GetLargestPossibleRegion());
+  for(; !it.IsAtEnd(); ++it)
+    {
+    if(it.Get() != it.GetIndex()[Dimension-1])
+      {
+      std::cerr << "Test Failed, wrong pixel " << it.Get() << " at " << it.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Changing the file names removes the headers of the files which are not read anymore
+  std::vector<std::string> firstFileNames(fileNames.begin(), fileNames.begin()+nProj/2);
+  reader->SetFileNames(firstFileNames);
+  if(rtk::ProjectionsHeaderCache::GetNumberOfHeaders() != nProj/2)
+    {
+    std::cerr << "Test Failed, " << rtk::ProjectionsHeaderCache::GetNumberOfHeaders()
+              << " headers in the cache instead of " << nProj/2 << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+  if(rtk::ProjectionsHeaderCache::GetNumberOfHeaders() != 0)
+    {
+    std::cerr << "Test Failed, the headers have not been removed with the reader" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  itksys::SystemTools::RemoveADirectory(directory);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,204 @@
+#include "rtkTest.h"
+#include "rtkDrawSheppLoganFilter.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSARTConeBeamReconstructionFilter.h"
+#include "rtkConjugateGradientConeBeamReconstructionFilter.h"
+
+#include <itkRegionOfInterestImageFilter.h>
+
+/**
+ * \file rtkroireconstructiontest.cxx
+ *
+ * \brief Functional test for region-of-interest iterative reconstruction
+ *
+ * This test generates the projections of a Shepp-Logan phantom and
+ * reconstructs a small region of interest at fine resolution with SART and
+ * conjugate gradient. The phantom has structures inside and outside the ROI.
+ * A coarse background volume of the full field-of-view is used to compute
+ * the projections of the ROI. The results are compared to the reconstruction
+ * of the full field-of-view at the same resolution with the same algorithm,
+ * cropped to the ROI.
+ */
+
+int main(int, char** )
+{
+  constexpr unsigned int Dimension = 3;
+  using OutputPixelType = float;
+  using OutputImageType = itk::Image< OutputPixelType, Dimension >;
+
+#if FAST_TESTS_NO_CHECKS
+  constexpr unsigned int NumberOfProjectionImages = 3;
+#else
+  constexpr unsigned int NumberOfProjectionImages = 180;
+#endif
+
+  // Constant image sources
+  using ConstantImageSourceType = rtk::ConstantImageSource< OutputImageType >;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  // Coarse volume of the full field-of-view
+  ConstantImageSourceType::Pointer backgroundSource = ConstantImageSourceType::New();
+  origin.Fill(-124.);
+#if FAST_TESTS_NO_CHECKS
+  size.Fill(2);
+  spacing.Fill(248.);
+#else
+  size.Fill(32);
+  spacing.Fill(8.);
+#endif
+  backgroundSource->SetOrigin( origin );
+  backgroundSource->SetSpacing( spacing );
+  backgroundSource->SetSize( size );
+  backgroundSource->SetConstant( 0. );
+
+  // Fine volume of the region of interest
+  ConstantImageSourceType::Pointer roiSource = ConstantImageSourceType::New();
+  origin.Fill(-31.);
+#if FAST_TESTS_NO_CHECKS
+  size.Fill(2);
+  spacing.Fill(62.);
+#else
+  size.Fill(32);
+  spacing.Fill(2.);
+#endif
+  roiSource->SetOrigin( origin );
+  roiSource->SetSpacing( spacing );
+  roiSource->SetSize( size );
+  roiSource->SetConstant( 0. );
+
+  // Fine volume of the full field-of-view, its voxels include those of the
+  // region of interest
+  ConstantImageSourceType::Pointer fullSource = ConstantImageSourceType::New();
+#if FAST_TESTS_NO_CHECKS
+  origin.Fill(-93.);
+  size.Fill(4);
+#else
+  origin.Fill(-127.);
+  size.Fill(128);
+#endif
+  fullSource->SetOrigin( origin );
+  fullSource->SetSpacing( spacing );
+  fullSource->SetSize( size );
+  fullSource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -255.;
+  origin[1] = -255.;
+  origin[2] = -255.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = NumberOfProjectionImages;
+  spacing.Fill(504.);
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = NumberOfProjectionImages;
+  spacing.Fill(8.);
+#endif
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  // Geometry object
+  using GeometryType = rtk::ThreeDCircularProjectionGeometry;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Shepp-Logan PROJECTIONS
+  using SLPType = rtk::SheppLoganPhantomFilter<OutputImageType, OutputImageType>;
+  SLPType::Pointer slp = SLPType::New();
+  slp->SetInput( projectionsSource->GetOutput() );
+  slp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() );
+
+  // Coarse BACKGROUND object
+  using DSLType = rtk::DrawSheppLoganFilter<OutputImageType, OutputImageType>;
+  DSLType::Pointer background = DSLType::New();
+  background->SetInput( backgroundSource->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( background->Update() )
+
+  // Region of the full field-of-view corresponding to the ROI
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( roiSource->UpdateOutputInformation() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fullSource->UpdateOutputInformation() )
+  OutputImageType::RegionType cropRegion = roiSource->GetOutput()->GetLargestPossibleRegion();
+  OutputImageType::IndexType cropIndex;
+  fullSource->GetOutput()->TransformPhysicalPointToIndex(roiSource->GetOutput()->GetOrigin(), cropIndex);
+  cropRegion.SetIndex( cropIndex );
+  using CropType = itk::RegionOfInterestImageFilter<OutputImageType, OutputImageType>;
+  CropType::Pointer crop = CropType::New();
+  crop->SetRegionOfInterest( cropRegion );
+
+  std::cout << "\n\n****** Case 1: SART of the region of interest ******" << std::endl;
+
+  using SARTType = rtk::SARTConeBeamReconstructionFilter< OutputImageType >;
+  SARTType::Pointer sartFull = SARTType::New();
+  sartFull->SetInput( fullSource->GetOutput() );
+  sartFull->SetInput(1, slp->GetOutput());
+  sartFull->SetGeometry( geometry );
+  sartFull->SetNumberOfIterations( 1 );
+  sartFull->SetLambda( 0.5 );
+  sartFull->SetBackProjectionFilter(SARTType::BP_JOSEPH);
+  sartFull->SetForwardProjectionFilter(SARTType::FP_JOSEPH);
+  crop->SetInput( sartFull->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( crop->Update() );
+  OutputImageType::Pointer reference = crop->GetOutput();
+  reference->DisconnectPipeline();
+
+  SARTType::Pointer sart = SARTType::New();
+  sart->SetInput( roiSource->GetOutput() );
+  sart->SetInput(1, slp->GetOutput());
+  sart->SetBackgroundVolume( background->GetOutput() );
+  sart->SetGeometry( geometry );
+  sart->SetNumberOfIterations( 1 );
+  sart->SetLambda( 0.5 );
+  sart->SetBackProjectionFilter(SARTType::BP_JOSEPH);
+  sart->SetForwardProjectionFilter(SARTType::FP_JOSEPH);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+
+  CheckImageQuality<OutputImageType>(sart->GetOutput(), reference, 0.05, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: conjugate gradient of the region of interest ******" << std::endl;
+
+  ConstantImageSourceType::Pointer uniformWeightsSource = ConstantImageSourceType::New();
+  uniformWeightsSource->SetInformationFromImage(projectionsSource->GetOutput());
+  uniformWeightsSource->SetConstant(1.0);
+
+  using ConjugateGradientType = rtk::ConjugateGradientConeBeamReconstructionFilter<OutputImageType>;
+  ConjugateGradientType::Pointer conjugategradientFull = ConjugateGradientType::New();
+  conjugategradientFull->SetInput( fullSource->GetOutput() );
+  conjugategradientFull->SetInput(1, slp->GetOutput());
+  conjugategradientFull->SetInput(2, uniformWeightsSource->GetOutput());
+  conjugategradientFull->SetGeometry( geometry );
+  conjugategradientFull->SetNumberOfIterations( 5 );
+  conjugategradientFull->SetCudaConjugateGradient( false );
+  conjugategradientFull->SetBackProjectionFilter(ConjugateGradientType::BP_JOSEPH);
+  conjugategradientFull->SetForwardProjectionFilter(ConjugateGradientType::FP_JOSEPH);
+  crop->SetInput( conjugategradientFull->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( crop->Update() );
+  reference = crop->GetOutput();
+  reference->DisconnectPipeline();
+
+  ConjugateGradientType::Pointer conjugategradient = ConjugateGradientType::New();
+  conjugategradient->SetInput( roiSource->GetOutput() );
+  conjugategradient->SetInput(1, slp->GetOutput());
+  conjugategradient->SetInput(2, uniformWeightsSource->GetOutput());
+  conjugategradient->SetBackgroundVolume( background->GetOutput() );
+  conjugategradient->SetGeometry( geometry );
+  conjugategradient->SetNumberOfIterations( 5 );
+  conjugategradient->SetCudaConjugateGradient( false );
+  conjugategradient->SetBackProjectionFilter(ConjugateGradientType::BP_JOSEPH);
+  conjugategradient->SetForwardProjectionFilter(ConjugateGradientType::FP_JOSEPH);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() );
+
+  CheckImageQuality<OutputImageType>(conjugategradient->GetOutput(), reference, 0.05, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
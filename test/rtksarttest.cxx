@@ -154,6 +154,24 @@ int main(int, char** )
   CheckImageQuality<OutputImageType>(sart->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 2b: same as case 2, one forward and back projection per subset ******" << std::endl;
+
+  sart->BatchSubsetsOn();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+
+  CheckImageQuality<OutputImageType>(sart->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  sart->BatchSubsetsOff();
+
+  std::cout << "\n\n****** Case 2c: same as case 2, projections read on demand in a cache of a third of the stack ******" << std::endl;
+
+  sart->SetProjectionsCacheMemoryBudget( rei->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(OutputPixelType) / 3 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+
+  CheckImageQuality<OutputImageType>(sart->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  sart->SetProjectionsCacheMemoryBudget(0);
+
   std::cout << "\n\n****** Case 3: Joseph Backprojector ******" << std::endl;
   sart->SetNumberOfProjectionsPerSubset(1);
   sart->SetBackProjectionFilter(SARTType::BP_JOSEPH);
@@ -163,6 +181,38 @@ int main(int, char** )
   CheckImageQuality<OutputImageType>(sart->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 3c: Joseph Backprojector, OS-SART with backprojections updated concurrently ******" << std::endl;
+
+  // New filters so that both process the projections in the same random order
+  SARTType::Pointer sartBranches[2];
+  for(unsigned int i=0; i<2; i++)
+    {
+    sartBranches[i] = SARTType::New();
+    sartBranches[i]->SetInput( tomographySource->GetOutput() );
+    sartBranches[i]->SetInput(1, rei->GetOutput());
+    sartBranches[i]->SetGeometry( geometry );
+    sartBranches[i]->SetNumberOfIterations( 1 );
+    sartBranches[i]->SetLambda( 0.5 );
+    sartBranches[i]->SetNumberOfProjectionsPerSubset( 2 );
+    sartBranches[i]->SetBackProjectionFilter(SARTType::BP_JOSEPH);
+    sartBranches[i]->SetForwardProjectionFilter(SARTType::FP_JOSEPH);
+    sartBranches[i]->SetConcurrentBranches( i==1 );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( sartBranches[i]->Update() );
+    }
+
+  CheckImageQuality<OutputImageType>(sartBranches[1]->GetOutput(), sartBranches[0]->GetOutput(), 1e-6, 100, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3b: Joseph Backprojector, first iteration with a quarter of the projections ******" << std::endl;
+  sart->SetNumberOfIterations( 2 );
+  sart->SetInitialNumberOfProjections( NumberOfProjectionImages/4 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+
+  CheckImageQuality<OutputImageType>(sart->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  sart->SetNumberOfIterations( 1 );
+  sart->SetInitialNumberOfProjections( 0 );
+
 #ifdef USE_CUDA
   std::cout << "\n\n****** Case 4: CUDA Voxel-Based Backprojector ******" << std::endl;
 
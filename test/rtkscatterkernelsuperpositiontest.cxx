@@ -0,0 +1,96 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkScatterKernelSuperpositionImageFilter.h"
+
+#include <itkImageRegionConstIterator.h>
+
+#include <algorithm>
+
+/**
+ * \file rtkscatterkernelsuperpositiontest.cxx
+ *
+ * \brief Functional test for the scatter kernel superposition filter
+ *
+ * The projections of a uniform water slab have a uniform primary P and,
+ * far from the detector borders, a uniform scatter S = A P for a normalized
+ * kernel of amplitude A. The corrected projections must therefore converge
+ * to I / (1 + A) in the center of the detector, at full resolution and when
+ * the scatter is estimated on downsampled projections, for raw and for
+ * normalized intensities.
+ */
+
+constexpr unsigned int Dimension = 3;
+constexpr double amplitude = 0.5;
+
+template<class TImage>
+int CheckUniformCorrection(typename TImage::PixelType intensity, double i0, double nonNegativityThreshold)
+{
+  // Uniform projections
+  typename TImage::SizeType size;
+  size[0] = 256;
+  size[1] = 256;
+  size[2] = 3;
+  typename TImage::SpacingType spacing;
+  spacing.Fill(1.);
+  typename TImage::Pointer projections = TImage::New();
+  projections->SetRegions(size);
+  projections->SetSpacing(spacing);
+  projections->Allocate();
+  projections->FillBuffer(intensity);
+
+  // Center of the detector, far from the borders compared to the kernel width
+  typename TImage::RegionType center = projections->GetLargestPossibleRegion();
+  for(unsigned int i=0; i<2; i++)
+    {
+    center.SetIndex(i, size[i]/4);
+    center.SetSize(i, size[i]/2);
+    }
+
+  const double expected = intensity / (1. + amplitude);
+  const unsigned int factors[2] = {1, 8};
+  for(unsigned int factor : factors)
+    {
+    std::cout << "\n\n****** Downsampling factor " << factor << " ******" << std::endl;
+
+    using SKSType = rtk::ScatterKernelSuperpositionImageFilter<TImage, TImage>;
+    typename SKSType::Pointer sks = SKSType::New();
+    sks->SetInput(projections);
+    sks->InPlaceOff();
+    sks->SetKernelThicknesses(typename SKSType::VectorType(1, 50.));
+    sks->SetKernelWidths(typename SKSType::VectorType(1, 8.));
+    sks->SetKernelAmplitudes(typename SKSType::VectorType(1, amplitude));
+    sks->SetI0(i0);
+    sks->SetNonNegativityConstraintThreshold(nonNegativityThreshold);
+    sks->SetNumberOfIterations(20);
+    sks->SetDownsamplingFactor(factor);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( sks->Update() );
+
+    double maxError = 0.;
+    itk::ImageRegionConstIterator<TImage> it(sks->GetOutput(), center);
+    for(; !it.IsAtEnd(); ++it)
+      maxError = std::max(maxError, std::abs(it.Get() - expected));
+    std::cout << "Maximum error in the center: " << maxError << std::endl;
+    if(maxError > 0.01 * expected)
+      {
+      std::cerr << "Test Failed, maximum error " << maxError
+                << " is above " << 0.01 * expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+int main(int, char** )
+{
+  std::cout << "\n\n****** Raw intensities ******" << std::endl;
+  constexpr unsigned short intensity = 12000;
+  if(CheckUniformCorrection< itk::Image<unsigned short, Dimension> >(intensity, 4*intensity, 20.) == EXIT_FAILURE)
+    return EXIT_FAILURE;
+
+  std::cout << "\n\n****** Normalized intensities ******" << std::endl;
+  if(CheckUniformCorrection< itk::Image<float, Dimension> >(0.25, 1., 1e-6) == EXIT_FAILURE)
+    return EXIT_FAILURE;
+
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
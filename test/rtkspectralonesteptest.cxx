@@ -333,6 +333,17 @@ int main(int argc, char*argv[])
   CheckVectorImageQuality<MaterialVolumeType>(mechlemOneStep->GetOutput(), composeVols->GetOutput(), 0.08, 23, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 3b: Voxel-based Backprojector, 4 subsets, with regularization, backprojections updated concurrently ******" << std::endl;
+
+  MaterialVolumeType::Pointer sequential = mechlemOneStep->GetOutput();
+  sequential->DisconnectPipeline();
+  mechlemOneStep->SetConcurrentBranches( true );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( mechlemOneStep->Update() );
+
+  CheckVectorImageQuality<MaterialVolumeType>(mechlemOneStep->GetOutput(), sequential, 1e-6, 100, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  mechlemOneStep->SetConcurrentBranches( false );
+
 #ifdef RTK_USE_CUDA
   std::cout << "\n\n****** Case 4: CUDA voxel-based Backprojector, 4 subsets, with regularization ******" << std::endl;
 
@@ -0,0 +1,108 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkTuningProfile.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+
+/**
+ * \file rtktuningprofiletest.cxx
+ *
+ * \brief Test of the reading and writing of tuning profiles
+ *
+ * The test writes a profile with rtk::TuningProfile, reads it back and
+ * checks that all parameters are recovered. It also checks that a missing
+ * file is reported, that comments are skipped, that a missing value throws
+ * and that GetValue leaves the value unchanged for unknown parameters.
+ */
+
+int main(int, char** )
+{
+  const std::string fileName = "rtktuningprofiletest/profile.txt";
+  if( itksys::SystemTools::FileExists(fileName) )
+    itksys::SystemTools::RemoveFile(fileName);
+
+  std::cout << "\n\n****** Missing profile ******" << std::endl;
+  rtk::TuningProfile::ParametersType parameters;
+  bool read = true;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( read = rtk::TuningProfile::Read(fileName, parameters) )
+  if(read || !parameters.empty())
+    {
+    std::cerr << "Test Failed, a missing profile has been read" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Round trip ******" << std::endl;
+  parameters["FDKProjectionSubsetSize"] = 32;
+  parameters["FFTGreatestPrimeFactor"] = 13;
+  parameters["NumberOfStreamDivisions"] = 4;
+  parameters["JosephTileSize"] = 16;
+  parameters["JosephBrickSize"] = 0;
+  parameters["NumberOfThreads"] = 6;
+  parameters["NonIntegerValue"] = 0.125;
+  // The directory of the profile is created by Write
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rtk::TuningProfile::Write(fileName, parameters, "rtktuningprofiletest") )
+
+  rtk::TuningProfile::ParametersType readParameters;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( read = rtk::TuningProfile::Read(fileName, readParameters) )
+  if(!read || readParameters != parameters)
+    {
+    std::cerr << "Test Failed, the profile read differs from the profile written" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double value = -1.;
+  if(!rtk::TuningProfile::GetValue(readParameters, "JosephTileSize", value) || value != 16.)
+    {
+    std::cerr << "Test Failed, wrong value of JosephTileSize" << std::endl;
+    return EXIT_FAILURE;
+    }
+  value = -1.;
+  if(rtk::TuningProfile::GetValue(readParameters, "UnknownParameter", value) || value != -1.)
+    {
+    std::cerr << "Test Failed, an unknown parameter has been found" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Comments and invalid values ******" << std::endl;
+  {
+  std::ofstream os(fileName.c_str());
+  os << "# Written by hand" << std::endl
+     << std::endl
+     << "NumberOfThreads 2" << std::endl
+     << "#JosephTileSize 16" << std::endl;
+  }
+  readParameters.clear();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( read = rtk::TuningProfile::Read(fileName, readParameters) )
+  if(!read || readParameters.size() != 1 || readParameters["NumberOfThreads"] != 2.)
+    {
+    std::cerr << "Test Failed, comments or empty lines have not been skipped" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  {
+  std::ofstream os(fileName.c_str());
+  os << "NumberOfThreads" << std::endl;
+  }
+  bool thrown = false;
+  try
+    {
+    rtk::TuningProfile::Read(fileName, readParameters);
+    }
+  catch(itk::ExceptionObject &)
+    {
+    thrown = true;
+    }
+  if(!thrown)
+    {
+    std::cerr << "Test Failed, a missing value has not been reported" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  itksys::SystemTools::RemoveADirectory("rtktuningprofiletest");
+  return EXIT_SUCCESS;
+}